@@ -109,6 +109,68 @@ public class Tracker.Bus.Connection : Tracker.Sparql.Connection {
 		return new FDCursor (mem_stream.steal_data (), mem_stream.data_size, variable_names);
 	}
 
+	void send_query_page (string sparql, int page_size, string? continuation, UnixOutputStream output, Cancellable? cancellable, AsyncReadyCallback? callback) throws GLib.IOError {
+		var message = new DBusMessage.method_call (TRACKER_DBUS_SERVICE, TRACKER_DBUS_OBJECT_STEROIDS, TRACKER_DBUS_INTERFACE_STEROIDS, "QueryPage");
+		var fd_list = new UnixFDList ();
+		message.set_body (new Variant ("(sish)", sparql, page_size, continuation != null ? continuation : "", fd_list.append (output.fd)));
+		message.set_unix_fd_list (fd_list);
+
+		bus.send_message_with_reply.begin (message, DBusSendMessageFlags.NONE, int.MAX, null, cancellable, callback);
+	}
+
+	public override Sparql.Cursor query_page (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable) throws Sparql.Error, IOError, DBusError {
+		// use separate main context for sync operation
+		var context = new MainContext ();
+		var loop = new MainLoop (context, false);
+		context.push_thread_default ();
+		AsyncResult async_res = null;
+		query_page_async.begin (sparql, page_size, continuation, cancellable, (o, res) => {
+			async_res = res;
+			loop.quit ();
+		});
+		loop.run ();
+		context.pop_thread_default ();
+		return query_page_async.end (async_res, out next_continuation);
+	}
+
+	public async override Sparql.Cursor query_page_async (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		UnixInputStream input;
+		UnixOutputStream output;
+		pipe (out input, out output);
+
+		// send D-Bus request
+		AsyncResult dbus_res = null;
+		bool received_result = false;
+		send_query_page (sparql, page_size, continuation, output, cancellable, (o, res) => {
+			dbus_res = res;
+			if (received_result) {
+				query_page_async.callback ();
+			}
+		});
+
+		output = null;
+
+		// receive query results via FD
+		var mem_stream = new MemoryOutputStream (null, GLib.realloc, GLib.free);
+		yield mem_stream.splice_async (input, OutputStreamSpliceFlags.CLOSE_SOURCE | OutputStreamSpliceFlags.CLOSE_TARGET, Priority.DEFAULT, cancellable);
+
+		// wait for D-Bus reply
+		received_result = true;
+		if (dbus_res == null) {
+			yield;
+		}
+
+		var reply = bus.send_message_with_reply.end (dbus_res);
+		handle_error_reply (reply);
+
+		string[] variable_names = (string[]) reply.get_body ().get_child_value (0);
+		string next = reply.get_body ().get_child_value (1).get_string ();
+		next_continuation = next != "" ? next : null;
+
+		mem_stream.close ();
+		return new FDCursor (mem_stream.steal_data (), mem_stream.data_size, variable_names);
+	}
+
 	void send_update (string method, UnixInputStream input, Cancellable? cancellable, AsyncReadyCallback? callback) throws GLib.IOError {
 		var message = new DBusMessage.method_call (TRACKER_DBUS_SERVICE, TRACKER_DBUS_OBJECT_STEROIDS, TRACKER_DBUS_INTERFACE_STEROIDS, method);
 		var fd_list = new UnixFDList ();
@@ -221,6 +283,42 @@ public class Tracker.Bus.Connection : Tracker.Sparql.Connection {
 		return result;
 	}
 
+	public async override void update_statements_async (Sparql.StatementBuffer buffer, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		if (buffer.length == 0) {
+			return;
+		}
+
+		UnixInputStream input;
+		UnixOutputStream output;
+		pipe (out input, out output);
+
+		// send D-Bus request
+		AsyncResult dbus_res = null;
+		bool sent_update = false;
+		send_update (priority <= GLib.Priority.DEFAULT ? "InsertStatements" : "BatchInsertStatements", input, cancellable, (o, res) => {
+			dbus_res = res;
+			if (sent_update) {
+				update_statements_async.callback ();
+			}
+		});
+
+		// send serialized statements via fd
+		var data_stream = new DataOutputStream (output);
+		data_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+		data_stream.put_int32 ((int32) buffer.length);
+		data_stream.write_all (buffer.get_data (), null);
+		data_stream = null;
+
+		// wait for D-Bus reply
+		sent_update = true;
+		if (dbus_res == null) {
+			yield;
+		}
+
+		var reply = bus.send_message_with_reply.end (dbus_res);
+		handle_error_reply (reply);
+	}
+
 	public override GLib.Variant? update_blank (string sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
 		// use separate main context for sync operation
 		var context = new MainContext ();
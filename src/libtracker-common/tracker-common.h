@@ -40,6 +40,7 @@
 #include "tracker-os-dependant.h"
 #include "tracker-sched.h"
 #include "tracker-storage.h"
+#include "tracker-trace.h"
 #include "tracker-type-utils.h"
 #include "tracker-utils.h"
 #include "tracker-locale.h"
@@ -31,16 +31,30 @@
 
 #define GET_PRIV(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TRACKER_TYPE_LANGUAGE, TrackerLanguagePriv))
 
+/* Maximum number of word->stem pairs remembered per thread and stemmer,
+ * once reached the memo table is emptied and starts over. */
+#define STEM_MEMO_MAX_ENTRIES 4096
+
+/* Words longer than this are not worth memoizing */
+#define STEM_MEMO_MAX_WORD_LENGTH 64
+
 typedef struct _TrackerLanguagePriv TrackerLanguagePriv;
 typedef struct _Languages           Languages;
+typedef struct _ThreadStemmer       ThreadStemmer;
 
 struct _TrackerLanguagePriv {
 	GHashTable    *stop_words;
 	gboolean       enable_stemmer;
 	gchar         *language_code;
 
-	GMutex         stemmer_mutex;
-	gpointer       stemmer;
+	/* Interned stemmer language name, stemmer instances
+	 * themselves are kept per thread, see thread_stemmer_get() */
+	const gchar   *stem_language;
+};
+
+struct _ThreadStemmer {
+	struct sb_stemmer *stemmer;
+	GHashTable        *memo;
 };
 
 struct _Languages {
@@ -74,6 +88,7 @@ enum {
 	PROP_LANGUAGE_CODE,
 };
 
+static void         thread_stemmers_free       (gpointer       data);
 static void         language_finalize          (GObject       *object);
 static void         language_get_property      (GObject       *object,
                                                 guint          param_id,
@@ -86,6 +101,11 @@ static void         language_set_property      (GObject       *object,
 
 G_DEFINE_TYPE (TrackerLanguage, tracker_language, G_TYPE_OBJECT);
 
+/* Per-thread table of stemmer language name -> ThreadStemmer.
+ * Snowball stemmers are not thread-safe, giving each thread its own
+ * instance avoids serializing all FTS parsers on a single lock. */
+static GPrivate thread_stemmers_key = G_PRIVATE_INIT (thread_stemmers_free);
+
 static void
 tracker_language_class_init (TrackerLanguageClass *klass)
 {
@@ -134,10 +154,62 @@ tracker_language_init (TrackerLanguage *language)
 	                                          g_str_equal,
 	                                          g_free,
 	                                          NULL);
-	g_mutex_init (&priv->stemmer_mutex);
 
 	stem_language = tracker_language_get_name_by_code (NULL);
-	priv->stemmer = sb_stemmer_new (stem_language, NULL);
+	priv->stem_language = g_intern_string (stem_language);
+}
+
+static void
+thread_stemmer_free (ThreadStemmer *thread_stemmer)
+{
+	if (thread_stemmer->stemmer) {
+		sb_stemmer_delete (thread_stemmer->stemmer);
+	}
+
+	g_hash_table_unref (thread_stemmer->memo);
+	g_slice_free (ThreadStemmer, thread_stemmer);
+}
+
+static void
+thread_stemmers_free (gpointer data)
+{
+	g_hash_table_unref (data);
+}
+
+static ThreadStemmer *
+thread_stemmer_get (const gchar *stem_language)
+{
+	ThreadStemmer *thread_stemmer;
+	GHashTable *stemmers;
+
+	stemmers = g_private_get (&thread_stemmers_key);
+
+	if (G_UNLIKELY (!stemmers)) {
+		/* Keys are interned strings */
+		stemmers = g_hash_table_new_full (NULL, NULL, NULL,
+		                                  (GDestroyNotify) thread_stemmer_free);
+		g_private_set (&thread_stemmers_key, stemmers);
+	}
+
+	thread_stemmer = g_hash_table_lookup (stemmers, stem_language);
+
+	if (G_UNLIKELY (!thread_stemmer)) {
+		thread_stemmer = g_slice_new0 (ThreadStemmer);
+		thread_stemmer->stemmer = sb_stemmer_new (stem_language, NULL);
+		thread_stemmer->memo = g_hash_table_new_full (g_str_hash,
+		                                              g_str_equal,
+		                                              g_free,
+		                                              g_free);
+
+		if (!thread_stemmer->stemmer) {
+			g_message ("No stemmer could be found for language:'%s'",
+			           stem_language);
+		}
+
+		g_hash_table_insert (stemmers, (gpointer) stem_language, thread_stemmer);
+	}
+
+	return thread_stemmer;
 }
 
 static void
@@ -147,13 +219,6 @@ language_finalize (GObject *object)
 
 	priv = GET_PRIV (object);
 
-	if (priv->stemmer) {
-		g_mutex_lock (&priv->stemmer_mutex);
-		sb_stemmer_delete (priv->stemmer);
-		g_mutex_unlock (&priv->stemmer_mutex);
-	}
-	g_mutex_clear (&priv->stemmer_mutex);
-
 	if (priv->stop_words) {
 		g_hash_table_unref (priv->stop_words);
 	}
@@ -305,19 +370,8 @@ language_set_stopword_list (TrackerLanguage *language,
 	stem_language = tracker_language_get_name_by_code (language_code);
 	stem_language_lower = g_ascii_strdown (stem_language, -1);
 
-	g_mutex_lock (&priv->stemmer_mutex);
-
-	if (priv->stemmer) {
-		sb_stemmer_delete (priv->stemmer);
-	}
-
-	priv->stemmer = sb_stemmer_new (stem_language_lower, NULL);
-	if (!priv->stemmer) {
-		g_message ("No stemmer could be found for language:'%s'",
-		           stem_language_lower);
-	}
-
-	g_mutex_unlock (&priv->stemmer_mutex);
+	/* Stemmers are created lazily by each thread using them */
+	priv->stem_language = g_intern_string (stem_language_lower);
 
 	g_free (stem_language_lower);
 }
@@ -497,11 +551,74 @@ gchar *
 tracker_language_stem_word (TrackerLanguage *language,
                             const gchar     *word,
                             gint             word_length)
+{
+	gchar buffer[STEM_MEMO_MAX_WORD_LENGTH * 2];
+	gsize stem_length;
+
+	g_return_val_if_fail (TRACKER_IS_LANGUAGE (language), NULL);
+
+	if (word_length < 0) {
+		word_length = strlen (word);
+	}
+
+	stem_length = tracker_language_stem_word_to_buffer (language,
+	                                                    word,
+	                                                    word_length,
+	                                                    buffer,
+	                                                    sizeof (buffer));
+
+	if (stem_length < sizeof (buffer)) {
+		return g_strndup (buffer, stem_length);
+	} else {
+		gchar *stem_word;
+
+		/* Didn't fit, go again with a buffer big enough */
+		stem_word = g_malloc (stem_length + 1);
+		tracker_language_stem_word_to_buffer (language,
+		                                      word,
+		                                      word_length,
+		                                      stem_word,
+		                                      stem_length + 1);
+		return stem_word;
+	}
+}
+
+/**
+ * tracker_language_stem_word_to_buffer:
+ * @language: a #TrackerLanguage
+ * @word: string pointing to a word
+ * @word_length: word ascii length, or -1 if @word is nul-terminated
+ * @buffer: return location for the processed word
+ * @buffer_size: size of @buffer in bytes
+ *
+ * Allocation-free version of tracker_language_stem_word(). The
+ * processed word is copied into @buffer and nul-terminated, truncated
+ * if necessary in the same way g_strlcpy() does.
+ *
+ * This function may be called concurrently from several threads on
+ * the same @language, each thread uses its own stemmer and keeps a
+ * bounded memo table of the most recently stemmed words.
+ *
+ * Returns: the length of the processed word. If it's equal or greater
+ *          than @buffer_size, the output was truncated.
+ **/
+gsize
+tracker_language_stem_word_to_buffer (TrackerLanguage *language,
+                                      const gchar     *word,
+                                      gint             word_length,
+                                      gchar           *buffer,
+                                      gsize            buffer_size)
 {
 	TrackerLanguagePriv *priv;
+	ThreadStemmer       *thread_stemmer;
 	const gchar         *stem_word;
+	gchar               *memo_key = NULL;
+	gsize                stem_length;
 
-	g_return_val_if_fail (TRACKER_IS_LANGUAGE (language), NULL);
+	g_return_val_if_fail (TRACKER_IS_LANGUAGE (language), 0);
+	g_return_val_if_fail (word != NULL, 0);
+	g_return_val_if_fail (buffer != NULL, 0);
+	g_return_val_if_fail (buffer_size > 0, 0);
 
 	if (word_length < 0) {
 		word_length = strlen (word);
@@ -510,18 +627,69 @@ tracker_language_stem_word (TrackerLanguage *language,
 	priv = GET_PRIV (language);
 
 	if (!priv->enable_stemmer) {
-		return g_strndup (word, word_length);
+		stem_word = word;
+		stem_length = word_length;
+		goto out;
 	}
 
-	g_mutex_lock (&priv->stemmer_mutex);
+	thread_stemmer = thread_stemmer_get (priv->stem_language);
 
-	stem_word = (const gchar*) sb_stemmer_stem (priv->stemmer,
-	                                            (guchar*) word,
-	                                            word_length);
+	if (G_UNLIKELY (!thread_stemmer->stemmer)) {
+		stem_word = word;
+		stem_length = word_length;
+		goto out;
+	}
+
+	if (word_length <= STEM_MEMO_MAX_WORD_LENGTH) {
+		gchar key[STEM_MEMO_MAX_WORD_LENGTH + 1];
+
+		memcpy (key, word, word_length);
+		key[word_length] = '\0';
+
+		stem_word = g_hash_table_lookup (thread_stemmer->memo, key);
+
+		if (stem_word) {
+			stem_length = strlen (stem_word);
+			goto out;
+		}
+
+		memo_key = g_strndup (word, word_length);
+	}
+
+	stem_word = (const gchar *) sb_stemmer_stem (thread_stemmer->stemmer,
+	                                             (const guchar *) word,
+	                                             word_length);
 
-	g_mutex_unlock (&priv->stemmer_mutex);
+	if (G_UNLIKELY (!stem_word)) {
+		/* Out of memory in the stemmer, leave word as is */
+		g_free (memo_key);
+		stem_word = word;
+		stem_length = word_length;
+		goto out;
+	}
+
+	stem_length = sb_stemmer_length (thread_stemmer->stemmer);
+
+	if (memo_key) {
+		if (g_hash_table_size (thread_stemmer->memo) >= STEM_MEMO_MAX_ENTRIES) {
+			g_hash_table_remove_all (thread_stemmer->memo);
+		}
+
+		g_hash_table_insert (thread_stemmer->memo,
+		                     memo_key,
+		                     g_strndup (stem_word, stem_length));
+	}
+
+out:
+	if (stem_length < buffer_size) {
+		memcpy (buffer, stem_word, stem_length);
+		buffer[stem_length] = '\0';
+	} else {
+		memcpy (buffer, stem_word, buffer_size - 1);
+		buffer[buffer_size - 1] = '\0';
+	}
 
-	return g_strdup (stem_word);
+	return stem_length;
 }
 
 /**
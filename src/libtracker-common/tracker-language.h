@@ -64,6 +64,12 @@ void             tracker_language_set_language_code  (TrackerLanguage *language,
 gchar *          tracker_language_stem_word          (TrackerLanguage *language,
                                                       const gchar     *word,
                                                       gint             word_length);
+gsize            tracker_language_stem_word_to_buffer
+                                                     (TrackerLanguage *language,
+                                                      const gchar     *word,
+                                                      gint             word_length,
+                                                      gchar           *buffer,
+                                                      gsize            buffer_size);
 
 /* Utility functions */
 const gchar *    tracker_language_get_name_by_code   (const gchar     *language_code);
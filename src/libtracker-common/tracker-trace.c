@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "tracker-trace.h"
+
+/* Latencies are kept in log-linear buckets, every power of two is
+ * split in SUB_BUCKETS linear buckets, so values are known within
+ * 1/SUB_BUCKETS of their magnitude, from 1us up to 2^(MAX_MSB + 1)us
+ * (~25 days)
+ */
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKETS     (1 << SUB_BUCKET_BITS)
+#define MAX_MSB         40
+#define N_BUCKETS       ((MAX_MSB - SUB_BUCKET_BITS + 2) * SUB_BUCKETS)
+
+/* Only used if the TRACKER_TRACE environment variable names a
+ * directory to dump traces to, each thread keeps its last events */
+#define RING_SIZE       4096
+#define MAX_RINGS       32
+
+typedef struct {
+	guint64 count;
+	gint64 total;
+	gint64 max;
+	guint64 buckets[N_BUCKETS];
+} Histogram;
+
+typedef struct {
+	gint64 start;
+	gint64 duration;
+	TrackerTraceStage stage;
+} TraceEvent;
+
+typedef struct {
+	GMutex mutex;
+	guint tid;
+	gboolean exited;
+	guint next;
+	guint n_events;
+	TraceEvent events[RING_SIZE];
+} TraceRing;
+
+/* Histograms are only written by their own thread, so recording an
+ * event takes no lock, they are summed up when stats are requested */
+typedef struct {
+	Histogram histograms[TRACKER_TRACE_N_STAGES];
+	TraceRing *ring;
+	gboolean ring_requested;
+} TraceThread;
+
+static const gchar *stage_names[TRACKER_TRACE_N_STAGES] = {
+	"crawl",
+	"queue-wait",
+	"extract",
+	"sparql-translate",
+	"sqlite-statement",
+	"journal-write",
+	"journal-fsync",
+	"checkpoint",
+	"signal-emit"
+};
+
+/* Protects the list of threads, the histograms of exited threads
+ * and the rings, never taken while recording once a thread is set up */
+static GMutex threads_mutex;
+static GSList *threads;
+static Histogram exited_histograms[TRACKER_TRACE_N_STAGES];
+static GPtrArray *rings;
+static guint last_tid;
+
+static void trace_thread_exited (gpointer data);
+
+static GPrivate current_thread = G_PRIVATE_INIT (trace_thread_exited);
+
+static const gchar *
+trace_dir (void)
+{
+	static gsize initialized = 0;
+	static gchar *dir = NULL;
+
+	if (g_once_init_enter (&initialized)) {
+		const gchar *env;
+
+		env = g_getenv ("TRACKER_TRACE");
+
+		if (env && *env) {
+			dir = g_strdup (env);
+		}
+
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return dir;
+}
+
+static guint
+value_msb (guint64 value)
+{
+	/* g_bit_storage() takes a gulong, which may be 32 bits */
+	if (value >> 32) {
+		return 32 + g_bit_storage ((gulong) (value >> 32)) - 1;
+	}
+
+	return g_bit_storage ((gulong) value) - 1;
+}
+
+static guint
+bucket_index (gint64 value)
+{
+	guint msb, shift;
+
+	if (value < 2 * SUB_BUCKETS) {
+		return (guint) MAX (value, 0);
+	}
+
+	value = MIN (value, ((gint64) 2 << MAX_MSB) - 1);
+	msb = value_msb (value);
+	shift = msb - SUB_BUCKET_BITS;
+
+	return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+		((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+static gint64
+bucket_upper_bound (guint index)
+{
+	guint msb, shift, sub;
+
+	if (index < 2 * SUB_BUCKETS) {
+		return index;
+	}
+
+	msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	sub = index % SUB_BUCKETS;
+	shift = msb - SUB_BUCKET_BITS;
+
+	return ((gint64) (SUB_BUCKETS + sub) << shift) + ((gint64) 1 << shift) - 1;
+}
+
+static void
+histogram_merge (Histogram       *dest,
+                 const Histogram *src)
+{
+	guint i;
+
+	dest->count += src->count;
+	dest->total += src->total;
+	dest->max = MAX (dest->max, src->max);
+
+	for (i = 0; i < N_BUCKETS; i++) {
+		dest->buckets[i] += src->buckets[i];
+	}
+}
+
+static void
+trace_thread_exited (gpointer data)
+{
+	TraceThread *thread = data;
+	guint i;
+
+	g_mutex_lock (&threads_mutex);
+
+	for (i = 0; i < TRACKER_TRACE_N_STAGES; i++) {
+		histogram_merge (&exited_histograms[i], &thread->histograms[i]);
+	}
+
+	threads = g_slist_remove (threads, thread);
+
+	/* The events are kept for the dump, the ring is only
+	 * reused once there are too many threads to keep up */
+	if (thread->ring) {
+		g_mutex_lock (&thread->ring->mutex);
+		thread->ring->exited = TRUE;
+		g_mutex_unlock (&thread->ring->mutex);
+	}
+
+	g_mutex_unlock (&threads_mutex);
+
+	g_free (thread);
+}
+
+static TraceThread *
+trace_thread_get (void)
+{
+	TraceThread *thread;
+
+	thread = g_private_get (&current_thread);
+
+	if (G_LIKELY (thread)) {
+		return thread;
+	}
+
+	thread = g_new0 (TraceThread, 1);
+
+	g_mutex_lock (&threads_mutex);
+	threads = g_slist_prepend (threads, thread);
+	g_mutex_unlock (&threads_mutex);
+
+	g_private_set (&current_thread, thread);
+
+	return thread;
+}
+
+static TraceRing *
+trace_ring_get (TraceThread *thread)
+{
+	TraceRing *ring = NULL;
+	guint i;
+
+	/* Looked up once per thread, threads that found no
+	 * free ring don't keep retrying on every event */
+	if (G_LIKELY (thread->ring_requested)) {
+		return thread->ring;
+	}
+
+	thread->ring_requested = TRUE;
+
+	g_mutex_lock (&threads_mutex);
+
+	if (!rings) {
+		rings = g_ptr_array_new ();
+	}
+
+	if (rings->len < MAX_RINGS) {
+		ring = g_new0 (TraceRing, 1);
+		g_mutex_init (&ring->mutex);
+		g_ptr_array_add (rings, ring);
+	} else {
+		for (i = 0; i < rings->len; i++) {
+			TraceRing *candidate = g_ptr_array_index (rings, i);
+
+			if (candidate->exited) {
+				ring = candidate;
+				break;
+			}
+		}
+	}
+
+	if (ring) {
+		g_mutex_lock (&ring->mutex);
+		ring->tid = ++last_tid;
+		ring->exited = FALSE;
+		ring->next = 0;
+		ring->n_events = 0;
+		g_mutex_unlock (&ring->mutex);
+	}
+
+	thread->ring = ring;
+
+	g_mutex_unlock (&threads_mutex);
+
+	return ring;
+}
+
+/**
+ * tracker_trace_record:
+ * @stage: the stage the time was spent in
+ * @start: monotonic time in microseconds the stage started at
+ * @duration: time spent, in microseconds
+ *
+ * Adds @duration to the latency histogram of @stage, and to the
+ * trace of the calling thread if tracing is enabled.
+ **/
+void
+tracker_trace_record (TrackerTraceStage stage,
+                      gint64            start,
+                      gint64            duration)
+{
+	TraceThread *thread;
+	Histogram *histogram;
+
+	g_return_if_fail (stage < TRACKER_TRACE_N_STAGES);
+
+	thread = trace_thread_get ();
+	histogram = &thread->histograms[stage];
+
+	histogram->count++;
+	histogram->total += duration;
+	histogram->max = MAX (histogram->max, duration);
+	histogram->buckets[bucket_index (duration)]++;
+
+	if (G_UNLIKELY (trace_dir ())) {
+		TraceRing *ring;
+
+		ring = trace_ring_get (thread);
+
+		if (ring) {
+			TraceEvent *event;
+
+			/* Only contended while the trace is dumped */
+			g_mutex_lock (&ring->mutex);
+			event = &ring->events[ring->next];
+			event->start = start;
+			event->duration = duration;
+			event->stage = stage;
+
+			ring->next = (ring->next + 1) % RING_SIZE;
+			ring->n_events = MIN (ring->n_events + 1, RING_SIZE);
+			g_mutex_unlock (&ring->mutex);
+		}
+	}
+}
+
+/**
+ * tracker_trace_end:
+ * @stage: the stage the time was spent in
+ * @start: the value returned by tracker_trace_begin()
+ *
+ * Records the time spent in @stage since @start.
+ **/
+void
+tracker_trace_end (TrackerTraceStage stage,
+                   gint64            start)
+{
+	tracker_trace_record (stage, start, g_get_monotonic_time () - start);
+}
+
+const gchar *
+tracker_trace_stage_get_name (TrackerTraceStage stage)
+{
+	g_return_val_if_fail (stage < TRACKER_TRACE_N_STAGES, NULL);
+
+	return stage_names[stage];
+}
+
+static gint64
+histogram_percentile (Histogram *histogram,
+                      gdouble    fraction)
+{
+	guint64 rank, seen = 0;
+	guint i;
+
+	rank = MAX ((guint64) ceil (histogram->count * fraction), 1);
+
+	for (i = 0; i < N_BUCKETS; i++) {
+		seen += histogram->buckets[i];
+
+		if (seen >= rank) {
+			return MIN (bucket_upper_bound (i), histogram->max);
+		}
+	}
+
+	return histogram->max;
+}
+
+/**
+ * tracker_trace_get_stats:
+ *
+ * Returns the latencies recorded in this process for every stage
+ * that was hit, as (stage, count, total, p50, p90, p99, max) with
+ * times in microseconds. Percentiles are the upper bound of the
+ * histogram bucket they fall in.
+ *
+ * Returns: (transfer full): a #GVariant of type a(sxxxxxx)
+ **/
+GVariant *
+tracker_trace_get_stats (void)
+{
+	GVariantBuilder builder;
+	Histogram *merged;
+	GSList *l;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sxxxxxx)"));
+	merged = g_new (Histogram, 1);
+
+	g_mutex_lock (&threads_mutex);
+
+	for (i = 0; i < TRACKER_TRACE_N_STAGES; i++) {
+		/* Running threads may be updating their histograms while
+		 * they are summed up, so the result is only approximate */
+		*merged = exited_histograms[i];
+
+		for (l = threads; l; l = l->next) {
+			TraceThread *thread = l->data;
+
+			histogram_merge (merged, &thread->histograms[i]);
+		}
+
+		if (merged->count > 0) {
+			g_variant_builder_add (&builder, "(sxxxxxx)",
+			                       stage_names[i],
+			                       (gint64) merged->count,
+			                       merged->total,
+			                       histogram_percentile (merged, 0.5),
+			                       histogram_percentile (merged, 0.9),
+			                       histogram_percentile (merged, 0.99),
+			                       merged->max);
+		}
+	}
+
+	g_mutex_unlock (&threads_mutex);
+
+	g_free (merged);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/**
+ * tracker_trace_dump:
+ * @path: file to write to
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes the events kept for every thread in the Chrome trace event
+ * format, which chrome://tracing and similar viewers load. Nothing
+ * is kept unless the TRACKER_TRACE environment variable is set.
+ *
+ * Returns: %TRUE if @path was written.
+ **/
+gboolean
+tracker_trace_dump (const gchar  *path,
+                    GError      **error)
+{
+	GString *json;
+	gboolean first = TRUE, retval;
+	guint i, j;
+
+	json = g_string_new ("{\"traceEvents\":[");
+
+	g_mutex_lock (&threads_mutex);
+
+	for (i = 0; rings && i < rings->len; i++) {
+		TraceRing *ring = g_ptr_array_index (rings, i);
+
+		g_mutex_lock (&ring->mutex);
+
+		/* Oldest first */
+		for (j = 0; j < ring->n_events; j++) {
+			TraceEvent *event;
+
+			event = &ring->events[(ring->next + RING_SIZE - ring->n_events + j) % RING_SIZE];
+
+			g_string_append_printf (json,
+			                        "%s\n{\"name\":\"%s\",\"cat\":\"tracker\",\"ph\":\"X\","
+			                        "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+			                        "\"pid\":%d,\"tid\":%u}",
+			                        first ? "" : ",",
+			                        stage_names[event->stage],
+			                        event->start,
+			                        event->duration,
+			                        (gint) getpid (),
+			                        ring->tid);
+			first = FALSE;
+		}
+
+		g_mutex_unlock (&ring->mutex);
+	}
+
+	g_mutex_unlock (&threads_mutex);
+
+	g_string_append (json, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	retval = g_file_set_contents (path, json->str, json->len, error);
+	g_string_free (json, TRUE);
+
+	return retval;
+}
+
+/**
+ * tracker_trace_shutdown:
+ *
+ * Dumps the trace of this process to the directory named by the
+ * TRACKER_TRACE environment variable, if set.
+ **/
+void
+tracker_trace_shutdown (void)
+{
+	GError *error = NULL;
+	gchar *filename, *path;
+	const gchar *dir;
+
+	dir = trace_dir ();
+
+	if (!dir) {
+		return;
+	}
+
+	filename = g_strdup_printf ("%s-%d.json",
+	                            g_get_prgname () ? g_get_prgname () : "tracker",
+	                            (gint) getpid ());
+	path = g_build_filename (dir, filename, NULL);
+
+	if (tracker_trace_dump (path, &error)) {
+		g_message ("Trace written to '%s'", path);
+	} else {
+		g_warning ("Could not write trace to '%s': %s", path, error->message);
+		g_error_free (error);
+	}
+
+	g_free (filename);
+	g_free (path);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_COMMON_TRACE_H__
+#define __LIBTRACKER_COMMON_TRACE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#if !defined (__LIBTRACKER_COMMON_INSIDE__) && !defined (TRACKER_COMPILATION)
+#error "only <libtracker-common/tracker-common.h> must be included directly."
+#endif
+
+typedef enum {
+	TRACKER_TRACE_CRAWL,
+	TRACKER_TRACE_QUEUE_WAIT,
+	TRACKER_TRACE_EXTRACT,
+	TRACKER_TRACE_SPARQL_TRANSLATE,
+	TRACKER_TRACE_SQLITE_STATEMENT,
+	TRACKER_TRACE_JOURNAL_WRITE,
+	TRACKER_TRACE_JOURNAL_FSYNC,
+	TRACKER_TRACE_CHECKPOINT,
+	TRACKER_TRACE_SIGNAL_EMIT,
+	TRACKER_TRACE_N_STAGES
+} TrackerTraceStage;
+
+#define tracker_trace_begin() g_get_monotonic_time ()
+
+void         tracker_trace_end            (TrackerTraceStage   stage,
+                                           gint64              start);
+void         tracker_trace_record         (TrackerTraceStage   stage,
+                                           gint64              start,
+                                           gint64              duration);
+const gchar *tracker_trace_stage_get_name (TrackerTraceStage   stage);
+GVariant    *tracker_trace_get_stats      (void);
+gboolean     tracker_trace_dump           (const gchar        *path,
+                                           GError            **error);
+void         tracker_trace_shutdown       (void);
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_COMMON_TRACE_H__ */
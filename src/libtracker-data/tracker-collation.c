@@ -36,9 +36,12 @@
 #ifdef HAVE_LIBUNISTRING
 /* libunistring versions prior to 9.1.2 need this hack */
 #define _UNUSED_PARAMETER_
+#include <stdlib.h>
 #include <unistr.h>
+#include <uniconv.h>
 #elif HAVE_LIBICU
 #include <unicode/ucol.h>
+#include <unicode/ustring.h>
 #include <unicode/utypes.h>
 #endif
 
@@ -96,6 +99,44 @@ tracker_collation_utf8 (gpointer      collator,
 	return result;
 }
 
+guchar *
+tracker_collation_key (gpointer     collator,
+                       const gchar *str,
+                       gint         len,
+                       gint        *key_len)
+{
+	gchar *aux, *locale_str;
+	guchar *key;
+	gsize size;
+
+	/* Note: str is NOT NUL-terminated */
+	aux = (len < MAX_STACK_STR_SIZE) ? g_alloca (len + 1) : g_malloc (len + 1);
+	memcpy (aux, str, len); aux[len] = '\0';
+
+	/* u8_strcoll() converts to the locale encoding and uses
+	 * strcoll(), so strxfrm() on the same conversion gives keys
+	 * sorting the same way */
+	locale_str = u8_strconv_to_locale ((const uint8_t *) aux);
+
+	if (len >= MAX_STACK_STR_SIZE)
+		g_free (aux);
+
+	if (!locale_str) {
+		trace ("(libunistring) '%.*s' has no representation in the locale encoding",
+		       len, str);
+		return NULL;
+	}
+
+	size = strxfrm (NULL, locale_str, 0);
+	key = g_malloc (size + 1);
+	strxfrm ((gchar *) key, locale_str, size + 1);
+	*key_len = size;
+
+	free (locale_str);
+
+	return key;
+}
+
 #elif HAVE_LIBICU /* ---- ICU based collation (UTF-16) ----*/
 
 gpointer
@@ -192,6 +233,63 @@ tracker_collation_utf8 (gpointer      collator,
 	return 0;
 }
 
+guchar *
+tracker_collation_key (gpointer     collator,
+                       const gchar *str,
+                       gint         len,
+                       gint        *key_len)
+{
+	UErrorCode status = U_ZERO_ERROR;
+	UChar *ustr;
+	gint32 ulen, size;
+	guchar *key;
+
+	/* Collator must be created before trying to get keys */
+	g_return_val_if_fail (collator, NULL);
+
+	/* Preflight to get the UTF-16 length */
+	u_strFromUTF8 (NULL, 0, &ulen, str, len, &status);
+
+	if (status != U_BUFFER_OVERFLOW_ERROR && U_FAILURE (status)) {
+		g_critical ("Error converting to UTF-16: %s", u_errorName (status));
+		return NULL;
+	}
+
+	status = U_ZERO_ERROR;
+	ustr = (ulen < MAX_STACK_STR_SIZE) ? g_alloca ((ulen + 1) * sizeof (UChar)) : g_new (UChar, ulen + 1);
+	u_strFromUTF8 (ustr, ulen + 1, NULL, str, len, &status);
+
+	if (U_FAILURE (status)) {
+		g_critical ("Error converting to UTF-16: %s", u_errorName (status));
+		if (ulen >= MAX_STACK_STR_SIZE)
+			g_free (ustr);
+		return NULL;
+	}
+
+	/* The returned size includes the terminating NUL byte, which
+	 * is left out of the key, no other byte of the key is NUL */
+	size = ucol_getSortKey ((UCollator *) collator, ustr, ulen, NULL, 0);
+
+	/* 0 is how ICU reports an internal error */
+	if (size <= 0) {
+		g_critical ("Error getting sort key for '%.*s'", len, str);
+		if (ulen >= MAX_STACK_STR_SIZE)
+			g_free (ustr);
+		return NULL;
+	}
+
+	key = g_malloc (size);
+	ucol_getSortKey ((UCollator *) collator, ustr, ulen, key, size);
+	*key_len = size - 1;
+
+	trace ("(ICU) Sort key for '%.*s' is %d bytes", len, str, *key_len);
+
+	if (ulen >= MAX_STACK_STR_SIZE)
+		g_free (ustr);
+
+	return key;
+}
+
 #else /* ---- GLib based collation ---- */
 
 gpointer
@@ -243,4 +341,19 @@ tracker_collation_utf8 (gpointer      collator,
 	return result;
 }
 
+guchar *
+tracker_collation_key (gpointer     collator,
+                       const gchar *str,
+                       gint         len,
+                       gint        *key_len)
+{
+	gchar *key;
+
+	/* Same order as g_utf8_collate() */
+	key = g_utf8_collate_key (str, len);
+	*key_len = strlen (key);
+
+	return (guchar *) key;
+}
+
 #endif
@@ -550,6 +550,17 @@ tracker_data_backup_restore (GFile                *journal,
 
 	info->journal = g_object_ref (journal);
 
+#ifdef DISABLE_JOURNAL
+	/* Check the backup before the current database is moved away */
+	if (g_file_query_exists (info->journal, NULL) &&
+	    !tracker_db_backup_verify (info->journal, &info->error)) {
+		g_propagate_error (error, info->error);
+		info->error = NULL;
+		free_backup_save_info (info);
+		return;
+	}
+#endif /* DISABLE_JOURNAL */
+
 	if (g_file_query_exists (info->journal, NULL)) {
 		TrackerDBManagerFlags flags;
 		guint select_cache_size, update_cache_size;
@@ -72,6 +72,18 @@
 
 #define ZLIBBUFSIZ 8192
 
+/* Bounds for a single incremental FTS merge step: at most this many
+ * leaf pages are written, and only levels with at least this many
+ * segments are considered. */
+#define FTS_MERGE_PAGES 32
+#define FTS_MERGE_MIN_SEGMENTS 4
+
+/* Rows of a class table filled in by a single online migration step.
+ * Only copies into new domain index columns run online. Range and
+ * cardinality changes are not migrated online, they still rebuild
+ * their tables during startup, see create_decomposed_metadata_tables(). */
+#define MIGRATION_CHUNK_SIZE 2000
+
 static gchar    *ontologies_dir;
 static gboolean  initialized;
 static gboolean  reloading = FALSE;
@@ -79,6 +91,19 @@ static gboolean  reloading = FALSE;
 static gboolean  in_journal_replay;
 #endif
 
+/* A domain index column of an existing class table that is being
+ * filled in the background. Progress is kept in the Migration table,
+ * queries read the property from its own table until it is done. */
+typedef struct {
+	TrackerClass    *class;
+	TrackerProperty *property;
+	gint64           last_id;
+} Migration;
+
+/* Only modified by the update thread, queries check it concurrently */
+static GList    *migrations;
+static GMutex    migrations_mutex;
+
 typedef struct {
 	const gchar *from;
 	const gchar *to;
@@ -522,6 +547,58 @@ check_range_conversion_is_allowed (const gchar  *ontology_path,
 	}
 }
 
+/* Creates or drops the indexes a single valued property has on the
+ * table of class, which is either its domain or one of its domain
+ * index classes. */
+static void
+set_single_value_indexes (TrackerDBInterface  *iface,
+                          TrackerProperty     *property,
+                          TrackerClass        *class,
+                          gboolean             recreate,
+                          GError             **error)
+{
+	GError *internal_error = NULL;
+	TrackerProperty *secondary_index;
+	const gchar *service_name;
+	const gchar *field_name;
+
+	field_name = tracker_property_get_name (property);
+	service_name = tracker_class_get_name (class);
+
+	if (class != tracker_property_get_domain (property)) {
+		/* domain-specific index */
+		set_index_for_single_value_property (iface, service_name, field_name,
+		                                     recreate, error);
+		return;
+	}
+
+	secondary_index = tracker_property_get_secondary_index (property);
+	if (secondary_index == NULL) {
+		set_index_for_single_value_property (iface, service_name, field_name,
+		                                     recreate && tracker_property_get_indexed (property),
+		                                     &internal_error);
+	} else {
+		set_secondary_index_for_single_value_property (iface, service_name, field_name,
+		                                               tracker_property_get_name (secondary_index),
+		                                               recreate && tracker_property_get_indexed (property),
+		                                               &internal_error);
+	}
+
+	if (!internal_error && tracker_property_get_sort_key (property)) {
+		gchar *sort_key_name;
+
+		sort_key_name = g_strdup_printf ("%s:sortKey", field_name);
+		set_index_for_single_value_property (iface, service_name,
+		                                     sort_key_name, recreate,
+		                                     &internal_error);
+		g_free (sort_key_name);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+	}
+}
+
 static void
 fix_indexed (TrackerProperty  *property,
              gboolean          recreate,
@@ -529,45 +606,28 @@ fix_indexed (TrackerProperty  *property,
 {
 	GError *internal_error = NULL;
 	TrackerDBInterface *iface;
-	TrackerClass *class;
-	const gchar *service_name;
-	const gchar *field_name;
 
 	iface = tracker_db_manager_get_db_interface ();
 
-	class = tracker_property_get_domain (property);
-	field_name = tracker_property_get_name (property);
-	service_name = tracker_class_get_name (class);
-
 	if (tracker_property_get_multiple_values (property)) {
-		set_index_for_multi_value_property (iface, service_name, field_name,
+		set_index_for_multi_value_property (iface,
+		                                    tracker_class_get_name (tracker_property_get_domain (property)),
+		                                    tracker_property_get_name (property),
 		                                    tracker_property_get_indexed (property),
 		                                    recreate,
 		                                    &internal_error);
 	} else {
-		TrackerProperty *secondary_index;
 		TrackerClass **domain_index_classes;
 
-		secondary_index = tracker_property_get_secondary_index (property);
-		if (secondary_index == NULL) {
-			set_index_for_single_value_property (iface, service_name, field_name,
-			                                     recreate && tracker_property_get_indexed (property),
-			                                     &internal_error);
-		} else {
-			set_secondary_index_for_single_value_property (iface, service_name, field_name,
-			                                               tracker_property_get_name (secondary_index),
-			                                               recreate && tracker_property_get_indexed (property),
-			                                               &internal_error);
-		}
+		set_single_value_indexes (iface, property,
+		                          tracker_property_get_domain (property),
+		                          recreate, &internal_error);
 
 		/* single-valued properties may also have domain-specific indexes */
 		domain_index_classes = tracker_property_get_domain_indexes (property);
 		while (!internal_error && domain_index_classes && *domain_index_classes) {
-			set_index_for_single_value_property (iface,
-			                                     tracker_class_get_name (*domain_index_classes),
-			                                     field_name,
-			                                     recreate,
-			                                     &internal_error);
+			set_single_value_indexes (iface, property, *domain_index_classes,
+			                          recreate, &internal_error);
 			domain_index_classes++;
 		}
 	}
@@ -647,6 +707,7 @@ tracker_data_ontology_load_statement (const gchar *ontology_path,
 					tracker_property_set_indexed (property, FALSE);
 					tracker_property_set_secondary_index (property, NULL);
 					tracker_property_set_writeback (property, FALSE);
+					tracker_property_set_sort_key (property, FALSE);
 					tracker_property_set_is_inverse_functional_property (property, FALSE);
 					tracker_property_set_default_value (property, NULL);
 				}
@@ -909,6 +970,17 @@ tracker_data_ontology_load_statement (const gchar *ontology_path,
 		}
 
 		tracker_property_set_force_journal (property, (strcmp (object, "true") == 0));
+	} else if (g_strcmp0 (predicate, TRACKER_PREFIX "sortKey") == 0) {
+		TrackerProperty *property;
+
+		property = tracker_ontologies_get_property_by_uri (subject);
+
+		if (property == NULL) {
+			g_critical ("%s: Unknown property %s", ontology_path, subject);
+			return;
+		}
+
+		tracker_property_set_sort_key (property, (strcmp (object, "true") == 0));
 	} else if (g_strcmp0 (predicate, RDFS_SUB_PROPERTY_OF) == 0) {
 		TrackerProperty *property, *super_property;
 		gboolean is_new;
@@ -1502,7 +1574,7 @@ tracker_data_ontology_process_changes_post_db (GPtrArray  *seen_classes,
 
 	/* This updates property-property changes and marks classes for necessity
 	 * of having their tables recreated later. There's support for
-	 * tracker:notify, tracker:writeback and tracker:indexed */
+	 * tracker:notify, tracker:writeback, tracker:indexed and tracker:sortKey */
 
 	if (seen_classes) {
 		for (i = 0; i < seen_classes->len; i++) {
@@ -1686,6 +1758,25 @@ tracker_data_ontology_process_changes_post_db (GPtrArray  *seen_classes,
 				tracker_property_set_db_schema_changed (property, TRUE);
 			}
 
+			if (n_error) {
+				g_propagate_error (error, n_error);
+				return;
+			}
+
+			/* The sort key column is added or dropped by recreating
+			 * the table, like for default values */
+			if (update_property_value (ontology_path,
+			                           "tracker:sortKey", subject, TRACKER_PREFIX "sortKey",
+			                           tracker_property_get_sort_key (property) ? "true" : "false",
+			                           allowed_boolean_conversions,
+			                           NULL, property, &n_error)) {
+				TrackerClass *class;
+
+				class = tracker_property_get_domain (property);
+				tracker_class_set_db_schema_changed (class, TRUE);
+				tracker_property_set_db_schema_changed (property, TRUE);
+			}
+
 			if (n_error) {
 				g_propagate_error (error, n_error);
 			}
@@ -2093,6 +2184,45 @@ class_add_domain_indexes_from_db (TrackerDBInterface *iface,
 	}
 }
 
+static void
+properties_set_sort_keys_from_db (TrackerDBInterface *iface)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+
+	/* Queried apart from the other property flags: databases created
+	 * before tracker:sortKey existed only get the column once the
+	 * ontology update adding it runs, after this */
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &error,
+	                                              "SELECT (SELECT Uri FROM Resource WHERE ID = \"rdf:Property\".ID) "
+	                                              "FROM \"rdf:Property\" "
+	                                              "WHERE \"tracker:sortKey\" = 1");
+
+	if (!stmt) {
+		g_debug ("No sort keys in the database yet: %s", error->message);
+		g_error_free (error);
+		return;
+	}
+
+	cursor = tracker_db_statement_start_cursor (stmt, NULL);
+	g_object_unref (stmt);
+
+	if (cursor) {
+		while (tracker_db_cursor_iter_next (cursor, NULL, NULL)) {
+			TrackerProperty *property;
+
+			property = tracker_ontologies_get_property_by_uri (tracker_db_cursor_get_string (cursor, 0, NULL));
+
+			if (property) {
+				tracker_property_set_sort_key (property, TRUE);
+			}
+		}
+
+		g_object_unref (cursor);
+	}
+}
+
 static void
 property_add_super_properties_from_db (TrackerDBInterface *iface,
                                        TrackerProperty *property)
@@ -2430,6 +2560,8 @@ db_get_static_data (TrackerDBInterface  *iface,
 		cursor = NULL;
 	}
 
+	properties_set_sort_keys_from_db (iface);
+
 	/* Now that the properties are loaded we can do this foreach class */
 	classes = tracker_ontologies_get_classes (&n_classes);
 	for (i = 0; i < n_classes; i++) {
@@ -2577,6 +2709,10 @@ create_decomposed_metadata_property_table (TrackerDBInterface *iface,
 			}
 
 			if (in_change && !tracker_property_get_is_new (property)) {
+				/* Not an online migration either */
+				g_message ("Rebuilding table '%s_%s' for an ontology range or cardinality change",
+				           service_name, field_name);
+
 				g_debug ("Drop index: DROP INDEX IF EXISTS \"%s_%s_ID\"\nRename: ALTER TABLE \"%s_%s\" RENAME TO \"%s_%s_TEMP\"",
 				         service_name, field_name, service_name, field_name,
 				         service_name, field_name);
@@ -2739,6 +2875,49 @@ is_a_domain_index (TrackerProperty **domain_indexes, TrackerProperty *property)
 	return FALSE;
 }
 
+static void
+migration_free (Migration *migration)
+{
+	g_object_unref (migration->class);
+	g_object_unref (migration->property);
+	g_slice_free (Migration, migration);
+}
+
+/* Records that the values of @domain_index still have to be copied
+ * into the table of @dest_domain, tracker_data_manager_migrate() does
+ * so in bounded chunks once the store is running */
+static void
+schedule_domain_index_migration (TrackerDBInterface  *iface,
+                                 TrackerProperty     *domain_index,
+                                 TrackerClass        *dest_domain,
+                                 GError             **error)
+{
+	GError *internal_error = NULL;
+
+	g_debug ("Scheduling copy of '%s' into '%s'",
+	         tracker_property_get_name (domain_index),
+	         tracker_class_get_name (dest_domain));
+
+	tracker_db_interface_execute_query (iface, &internal_error,
+	                                    "CREATE TABLE IF NOT EXISTS Migration ("
+	                                    "Class INTEGER NOT NULL, "
+	                                    "Property INTEGER NOT NULL, "
+	                                    "LastID INTEGER NOT NULL, "
+	                                    "PRIMARY KEY (Class, Property))");
+
+	if (!internal_error) {
+		tracker_db_interface_execute_query (iface, &internal_error,
+		                                    "INSERT OR REPLACE INTO Migration (Class, Property, LastID) "
+		                                    "VALUES (%d, %d, 0)",
+		                                    tracker_class_get_id (dest_domain),
+		                                    tracker_property_get_id (domain_index));
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+	}
+}
+
 static void
 copy_from_domain_to_domain_index (TrackerDBInterface  *iface,
                                   TrackerProperty     *domain_index,
@@ -2831,6 +3010,11 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 	}
 
 	if (in_change) {
+		/* Not an online migration, the store stays unavailable
+		 * until the whole table has been copied */
+		g_message ("Rebuilding table '%s' for an ontology range or cardinality change",
+		           service_name);
+
 		g_debug ("Rename: ALTER TABLE \"%s\" RENAME TO \"%s_TEMP\"", service_name, service_name);
 		tracker_db_interface_execute_query (iface, &internal_error,
 		                                    "ALTER TABLE \"%s\" RENAME TO \"%s_TEMP\"",
@@ -2936,6 +3120,11 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 					g_string_append_printf (create_sql, ", \"%s:graph\" INTEGER",
 					                        field_name);
 
+					if (!is_domain_index && tracker_property_get_sort_key (property)) {
+						g_string_append_printf (create_sql, ", \"%s:sortKey\" BLOB",
+						                        field_name);
+					}
+
 					if (is_domain_index && tracker_property_get_is_new_domain_index (property, service)) {
 						schedule_copy (copy_schedule, property, field_name, ":graph");
 					}
@@ -2988,10 +3177,13 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 						g_propagate_error (error, internal_error);
 						goto error_out;
 					} else if (is_domain_index) {
-						copy_from_domain_to_domain_index (iface, property,
-						                                  field_name, NULL,
-						                                  service,
-						                                  &internal_error);
+						/* Copying the values rewrites the whole
+						 * table, that is left to the store once
+						 * it is running. Until then queries use
+						 * the table of the property. */
+						schedule_domain_index_migration (iface, property,
+						                                 service,
+						                                 &internal_error);
 						if (internal_error) {
 							g_string_free (alter_sql, TRUE);
 							g_propagate_error (error, internal_error);
@@ -3022,20 +3214,28 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 						g_string_free (alter_sql, TRUE);
 						g_propagate_error (error, internal_error);
 						goto error_out;
-					} else if (is_domain_index) {
-						copy_from_domain_to_domain_index (iface, property,
-						                                  field_name, ":graph",
-						                                  service,
-						                                  &internal_error);
+					}
+
+					g_string_free (alter_sql, TRUE);
+
+					if (!is_domain_index && tracker_property_get_sort_key (property)) {
+						/* New property, there are no values to
+						 * compute keys for yet */
+						alter_sql = g_string_new ("ALTER TABLE ");
+						g_string_append_printf (alter_sql, "\"%s\" ADD COLUMN \"%s:sortKey\" BLOB",
+						                        service_name,
+						                        field_name);
+						g_debug ("Altering: '%s'", alter_sql->str);
+						tracker_db_interface_execute_query (iface, &internal_error,
+						                                    "%s", alter_sql->str);
 						if (internal_error) {
 							g_string_free (alter_sql, TRUE);
 							g_propagate_error (error, internal_error);
 							goto error_out;
 						}
+						g_string_free (alter_sql, TRUE);
 					}
 
-					g_string_free (alter_sql, TRUE);
-
 					if (tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME) {
 						alter_sql = g_string_new ("ALTER TABLE ");
 						g_string_append_printf (alter_sql, "\"%s\" ADD COLUMN \"%s:localDate\" INTEGER",
@@ -3049,16 +3249,6 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 							g_string_free (alter_sql, TRUE);
 							g_propagate_error (error, internal_error);
 							goto error_out;
-						} else if (is_domain_index) {
-							copy_from_domain_to_domain_index (iface, property,
-							                                  field_name, ":localDate",
-							                                  service,
-							                                  &internal_error);
-							if (internal_error) {
-								g_string_free (alter_sql, TRUE);
-								g_propagate_error (error, internal_error);
-								goto error_out;
-							}
 						}
 
 						g_string_free (alter_sql, TRUE);
@@ -3074,16 +3264,6 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 							g_string_free (alter_sql, TRUE);
 							g_propagate_error (error, internal_error);
 							goto error_out;
-						} else if (is_domain_index) {
-							copy_from_domain_to_domain_index (iface, property,
-							                                  field_name, ":localTime",
-							                                  service,
-							                                  &internal_error);
-							if (internal_error) {
-								g_string_free (alter_sql, TRUE);
-								g_propagate_error (error, internal_error);
-								goto error_out;
-							}
 						}
 						g_string_free (alter_sql, TRUE);
 					}
@@ -3093,6 +3273,16 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 
 				if (in_change && put_change) {
 					range_change_for (property, in_col_sql, sel_col_sql, field_name);
+
+					/* Computed from the copied values, this also
+					 * fills the keys of properties newly flagged
+					 * with tracker:sortKey */
+					if (!is_domain_index && tracker_property_get_sort_key (property)) {
+						g_string_append_printf (in_col_sql, ", \"%s:sortKey\"",
+						                        field_name);
+						g_string_append_printf (sel_col_sql, ", SparqlCollationKey (\"%s\")",
+						                        field_name);
+					}
 				}
 			}
 		}
@@ -3145,6 +3335,22 @@ create_decomposed_metadata_tables (TrackerDBInterface  *iface,
 				}
 			}
 		}
+
+		if (!is_domain_index && tracker_property_get_sort_key (field)) {
+			gchar *sort_key_name;
+
+			sort_key_name = g_strdup_printf ("%s:sortKey",
+			                                 tracker_property_get_name (field));
+			set_index_for_single_value_property (iface, service_name,
+			                                     sort_key_name, TRUE,
+			                                     &internal_error);
+			g_free (sort_key_name);
+
+			if (internal_error) {
+				g_propagate_error (error, internal_error);
+				goto error_out;
+			}
+		}
 	}
 
 	if (in_change && sel_col_sql && in_col_sql) {
@@ -3412,6 +3618,28 @@ get_new_service_id (TrackerDBInterface *iface)
 	return ++max_service_id;
 }
 
+static void
+regenerate_sort_keys (TrackerProperty  *property,
+                      GError          **error)
+{
+	TrackerDBInterface *iface;
+	const gchar *service_name;
+	const gchar *field_name;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	service_name = tracker_class_get_name (tracker_property_get_domain (property));
+	field_name = tracker_property_get_name (property);
+
+	g_debug ("Regenerating collation keys for '%s'", field_name);
+
+	tracker_db_interface_execute_query (iface, error,
+	                                    "UPDATE \"%s\" SET \"%s:sortKey\" = SparqlCollationKey (\"%s\")",
+	                                    service_name,
+	                                    field_name,
+	                                    field_name);
+}
+
 static void
 tracker_data_manager_recreate_indexes (TrackerBusyCallback    busy_callback,
                                        gpointer               busy_user_data,
@@ -3439,6 +3667,21 @@ tracker_data_manager_recreate_indexes (TrackerBusyCallback    busy_callback,
 		}
 	}
 
+	/* Collation keys depend on the locale too, regenerate them
+	 * while their indexes are gone */
+	for (i = 0; i < n_properties; i++) {
+		if (!tracker_property_get_sort_key (properties[i])) {
+			continue;
+		}
+
+		regenerate_sort_keys (properties[i], &internal_error);
+
+		if (internal_error) {
+			g_propagate_error (error, internal_error);
+			return;
+		}
+	}
+
 	g_debug ("Starting index re-creation...");
 	for (i = 0; i < n_properties; i++) {
 		fix_indexed (properties [i], TRUE, &internal_error);
@@ -3459,6 +3702,60 @@ tracker_data_manager_recreate_indexes (TrackerBusyCallback    busy_callback,
 	g_debug ("  Finished index re-creation...");
 }
 
+/* Drops the indexes single valued properties have on the table of
+ * class, so bulk loads write a bare table, and creates them again
+ * afterwards. The tables of multi valued properties keep their
+ * indexes, their unique index is what drops duplicated values. */
+gboolean
+tracker_data_manager_set_class_indexes_enabled (TrackerClass  *class,
+                                                gboolean       enabled,
+                                                GError       **error)
+{
+	GError *internal_error = NULL;
+	TrackerDBInterface *iface;
+	TrackerProperty **properties;
+	guint n_properties;
+	guint i;
+
+	iface = tracker_db_manager_get_db_interface ();
+	properties = tracker_ontologies_get_properties (&n_properties);
+
+	g_debug ("%s indexes of table '%s'",
+	         enabled ? "Creating" : "Dropping",
+	         tracker_class_get_name (class));
+
+	for (i = 0; i < n_properties && !internal_error; i++) {
+		TrackerClass **domain_index_classes;
+
+		if (tracker_property_get_multiple_values (properties[i])) {
+			continue;
+		}
+
+		if (tracker_property_get_domain (properties[i]) == class) {
+			set_single_value_indexes (iface, properties[i], class,
+			                          enabled, &internal_error);
+			continue;
+		}
+
+		domain_index_classes = tracker_property_get_domain_indexes (properties[i]);
+		while (domain_index_classes && *domain_index_classes) {
+			if (*domain_index_classes == class) {
+				set_single_value_indexes (iface, properties[i], class,
+				                          enabled, &internal_error);
+				break;
+			}
+			domain_index_classes++;
+		}
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 gboolean
 tracker_data_manager_reload (TrackerBusyCallback   busy_callback,
                              gpointer              busy_user_data,
@@ -3537,62 +3834,772 @@ load_ontologies_gvdb (GError **error)
 	g_free (filename);
 }
 
-#if HAVE_TRACKER_FTS
-static gboolean
-ontology_get_fts_properties (gboolean     only_new,
-			     GHashTable **fts_properties,
-			     GHashTable **multivalued)
+/* The snapshot is only valid for the database it was written from.
+ * Restoring a backup, reindexing and ontology changes all alter the
+ * schema version or the modification times of the ontologies. */
+static gchar *
+get_ontologies_snapshot_stamp (TrackerDBInterface *iface)
 {
-	TrackerProperty **properties;
-	gboolean has_new = FALSE;
-	GHashTable *hashtable;
-	guint i, len;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	gint64 schema_version = 0, n_ontologies = 0, last_modified = 0;
 
-	properties = tracker_ontologies_get_properties (&len);
-	hashtable = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
-					   (GDestroyNotify) g_list_free);
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, NULL,
+	                                              "PRAGMA schema_version");
 
-	if (multivalued) {
-		*multivalued = g_hash_table_new (g_str_hash, g_str_equal);
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, NULL);
+		g_object_unref (stmt);
 	}
 
-	for (i = 0; i < len; i++) {
-		const gchar *name, *table_name;
-		GList *list;
-
-		if (!tracker_property_get_fulltext_indexed (properties[i])) {
-			continue;
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, NULL)) {
+			schema_version = tracker_db_cursor_get_int (cursor, 0);
 		}
 
-		has_new |= tracker_property_get_is_new (properties[i]);
-		table_name = tracker_property_get_table_name (properties[i]);
+		g_object_unref (cursor);
+		cursor = NULL;
+	}
 
-		if (multivalued &&
-		    tracker_property_get_multiple_values (properties[i])) {
-			g_hash_table_insert (*multivalued, (gpointer) table_name,
-					     GUINT_TO_POINTER (TRUE));
-		}
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, NULL,
+	                                              "SELECT COUNT(*), MAX(\"nao:lastModified\") "
+	                                              "FROM \"tracker:Ontology\"");
 
-		name = tracker_property_get_name (properties[i]);
-		list = g_hash_table_lookup (hashtable, table_name);
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, NULL);
+		g_object_unref (stmt);
+	}
 
-		if (!list) {
-			list = g_list_prepend (NULL, (gpointer) name);
-			g_hash_table_insert (hashtable, (gpointer) table_name, list);
-		} else {
-			list = g_list_append (list, (gpointer) name);
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, NULL)) {
+			n_ontologies = tracker_db_cursor_get_int (cursor, 0);
+			last_modified = tracker_db_cursor_get_int (cursor, 1);
 		}
-	}
 
-	if (fts_properties) {
-		*fts_properties = hashtable;
+		g_object_unref (cursor);
 	}
 
-	return has_new;
+	return g_strdup_printf ("%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+	                        schema_version, n_ontologies, last_modified);
 }
-#endif
 
-gboolean
+static void
+write_ontologies_snapshot (TrackerDBInterface *iface)
+{
+	GError *error = NULL;
+	gchar *filename, *stamp;
+
+	stamp = get_ontologies_snapshot_stamp (iface);
+
+	/* Unchanged since it was loaded or last written */
+	if (g_strcmp0 (stamp, tracker_ontologies_get_snapshot_stamp ()) == 0) {
+		g_free (stamp);
+		return;
+	}
+
+	filename = g_build_filename (g_get_user_cache_dir (),
+	                             "tracker",
+	                             "ontologies.snapshot",
+	                             NULL);
+
+	if (!tracker_ontologies_write_snapshot (filename, stamp, &error)) {
+		g_warning ("Could not write ontology snapshot: %s",
+		           error->message);
+		g_error_free (error);
+	}
+
+	g_free (filename);
+	g_free (stamp);
+}
+
+static gboolean
+load_ontologies_snapshot (TrackerDBInterface *iface)
+{
+	GError *error = NULL;
+	gchar *filename, *stamp;
+	gboolean loaded;
+
+	filename = g_build_filename (g_get_user_cache_dir (),
+	                             "tracker",
+	                             "ontologies.snapshot",
+	                             NULL);
+	stamp = get_ontologies_snapshot_stamp (iface);
+
+	loaded = tracker_ontologies_load_snapshot (filename, stamp, &error);
+
+	if (error) {
+		/* Missing on the first start, not worth more than a debug */
+		g_debug ("Could not load ontology snapshot: %s",
+		         error->message);
+		g_error_free (error);
+	}
+
+	g_free (stamp);
+	g_free (filename);
+
+	return loaded;
+}
+
+#if HAVE_TRACKER_FTS
+static gboolean
+ontology_get_fts_properties (gboolean     only_new,
+			     GHashTable **fts_properties,
+			     GHashTable **multivalued)
+{
+	TrackerProperty **properties;
+	gboolean has_new = FALSE;
+	GHashTable *hashtable;
+	guint i, len;
+
+	properties = tracker_ontologies_get_properties (&len);
+	hashtable = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+					   (GDestroyNotify) g_list_free);
+
+	if (multivalued) {
+		*multivalued = g_hash_table_new (g_str_hash, g_str_equal);
+	}
+
+	for (i = 0; i < len; i++) {
+		const gchar *name, *table_name;
+		GList *list;
+
+		if (!tracker_property_get_fulltext_indexed (properties[i])) {
+			continue;
+		}
+
+		has_new |= tracker_property_get_is_new (properties[i]);
+		table_name = tracker_property_get_table_name (properties[i]);
+
+		if (multivalued &&
+		    tracker_property_get_multiple_values (properties[i])) {
+			g_hash_table_insert (*multivalued, (gpointer) table_name,
+					     GUINT_TO_POINTER (TRUE));
+		}
+
+		name = tracker_property_get_name (properties[i]);
+		list = g_hash_table_lookup (hashtable, table_name);
+
+		if (!list) {
+			list = g_list_prepend (NULL, (gpointer) name);
+			g_hash_table_insert (hashtable, (gpointer) table_name, list);
+		} else {
+			list = g_list_append (list, (gpointer) name);
+		}
+	}
+
+	if (fts_properties) {
+		*fts_properties = hashtable;
+	}
+
+	return has_new;
+}
+
+static void
+rebuild_fts_table (TrackerDBInterface *iface)
+{
+	GHashTable *fts_properties, *multivalued;
+	GError *error = NULL;
+
+	ontology_get_fts_properties (FALSE, &fts_properties, &multivalued);
+
+	tracker_db_interface_start_transaction (iface);
+
+	if (tracker_db_interface_sqlite_fts_alter_table (iface, fts_properties,
+	                                                 multivalued, &error)) {
+		tracker_db_interface_end_db_transaction (iface, &error);
+	} else {
+		/* The prefix lengths are part of the table definition, the
+		 * old table is kept and the rebuild retried on next start */
+		tracker_db_interface_execute_query (iface, NULL, "ROLLBACK");
+	}
+
+	if (error) {
+		g_critical ("Could not rebuild FTS table: %s", error->message);
+		g_error_free (error);
+	}
+
+	g_hash_table_unref (fts_properties);
+	g_hash_table_unref (multivalued);
+}
+#endif
+
+static gint
+statistics_count (TrackerDBInterface  *iface,
+                  const gchar         *sql,
+                  GError             **error)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *internal_error = NULL;
+	gint count = 0;
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE,
+	                                              &internal_error, "%s", sql);
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+			count = (gint) tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+	}
+
+	return count;
+}
+
+static void
+statistics_count_class (TrackerDBInterface  *iface,
+                        TrackerDBStatement  *stmt,
+                        TrackerClass        *class,
+                        GError             **error)
+{
+	GError *internal_error = NULL;
+	gchar *sql;
+	gint count;
+
+	sql = g_strdup_printf ("SELECT COUNT(1) FROM \"%s\"",
+	                       tracker_class_get_name (class));
+	count = statistics_count (iface, sql, &internal_error);
+	g_free (sql);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	tracker_class_set_count (class, count);
+	tracker_db_statement_bind_int (stmt, 0, tracker_class_get_id (class));
+	tracker_db_statement_bind_int (stmt, 1, count);
+	tracker_db_statement_execute (stmt, error);
+}
+
+static void
+statistics_count_property (TrackerDBInterface  *iface,
+                           TrackerDBStatement  *stmt,
+                           TrackerProperty     *property,
+                           GError             **error)
+{
+	GError *internal_error = NULL;
+	gchar *sql;
+	gint count;
+
+	sql = g_strdup_printf ("SELECT COUNT(\"%s\") FROM \"%s\"",
+	                       tracker_property_get_name (property),
+	                       tracker_property_get_table_name (property));
+	count = statistics_count (iface, sql, &internal_error);
+	g_free (sql);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	tracker_property_set_count (property, count);
+	tracker_db_statement_bind_int (stmt, 0, tracker_property_get_id (property));
+	tracker_db_statement_bind_int (stmt, 1, count);
+	tracker_db_statement_execute (stmt, error);
+}
+
+static void
+create_statistics (TrackerDBInterface  *iface,
+                   GError             **error)
+{
+	TrackerDBStatement *stmt;
+	TrackerClass **classes;
+	TrackerProperty **properties;
+	TrackerProperty *rdf_type;
+	GError *internal_error = NULL;
+	guint i, n_classes, n_props;
+
+	classes = tracker_ontologies_get_classes (&n_classes);
+	properties = tracker_ontologies_get_properties (&n_props);
+	rdf_type = tracker_ontologies_get_rdf_type ();
+
+	tracker_db_interface_start_transaction (iface);
+
+	tracker_db_interface_execute_query (iface, &internal_error,
+	                                    "CREATE TABLE Statistics (ID INTEGER NOT NULL PRIMARY KEY, "
+	                                    "Count INTEGER NOT NULL)");
+
+	if (internal_error) {
+		goto out;
+	}
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "INSERT INTO Statistics (ID, Count) VALUES (?, ?)");
+
+	if (!stmt) {
+		goto out;
+	}
+
+	/* One full scan per table, this only happens once per database */
+	for (i = 0; i < n_classes && !internal_error; i++) {
+		/* xsd classes do not derive from rdfs:Resource and do not use separate tables */
+		if (g_str_has_prefix (tracker_class_get_name (classes[i]), "xsd:")) {
+			continue;
+		}
+
+		statistics_count_class (iface, stmt, classes[i], &internal_error);
+	}
+
+	for (i = 0; i < n_props && !internal_error; i++) {
+		/* rdf:type values are accounted for by the class counts */
+		if (properties[i] == rdf_type) {
+			continue;
+		}
+
+		statistics_count_property (iface, stmt, properties[i], &internal_error);
+	}
+
+	g_object_unref (stmt);
+
+out:
+	if (internal_error) {
+		tracker_db_interface_execute_query (iface, NULL, "ROLLBACK");
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	tracker_db_interface_end_db_transaction (iface, error);
+}
+
+/* Counts again the properties whose tables an ontology change
+ * rebuilt, the other counts are kept up to date by the ontology
+ * transaction itself */
+static void
+update_statistics (TrackerDBInterface  *iface,
+                   GPtrArray           *properties,
+                   GError             **error)
+{
+	TrackerDBStatement *stmt;
+	GError *internal_error = NULL;
+	guint i;
+
+	if (properties->len == 0) {
+		return;
+	}
+
+	tracker_db_interface_start_transaction (iface);
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "INSERT OR REPLACE INTO Statistics (ID, Count) VALUES (?, ?)");
+
+	for (i = 0; stmt && i < properties->len && !internal_error; i++) {
+		statistics_count_property (iface, stmt, g_ptr_array_index (properties, i), &internal_error);
+	}
+
+	if (stmt) {
+		g_object_unref (stmt);
+	}
+
+	if (internal_error) {
+		tracker_db_interface_execute_query (iface, NULL, "ROLLBACK");
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	tracker_db_interface_end_db_transaction (iface, error);
+}
+
+static void
+load_statistics (TrackerDBInterface  *iface,
+                 GError             **error)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	TrackerClass **classes;
+	TrackerProperty **properties;
+	GHashTable *counts;
+	GError *internal_error = NULL;
+	guint i, n_classes, n_props;
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "SELECT ID, Count FROM Statistics");
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (!cursor) {
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	counts = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	while (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+		g_hash_table_insert (counts,
+		                     GINT_TO_POINTER (tracker_db_cursor_get_int (cursor, 0)),
+		                     GINT_TO_POINTER (tracker_db_cursor_get_int (cursor, 1)));
+	}
+
+	g_object_unref (cursor);
+
+	if (internal_error) {
+		g_hash_table_unref (counts);
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	/* Classes and properties without a row have no instances or values yet */
+	classes = tracker_ontologies_get_classes (&n_classes);
+
+	for (i = 0; i < n_classes; i++) {
+		gpointer count;
+
+		count = g_hash_table_lookup (counts, GINT_TO_POINTER (tracker_class_get_id (classes[i])));
+		tracker_class_set_count (classes[i], GPOINTER_TO_INT (count));
+	}
+
+	properties = tracker_ontologies_get_properties (&n_props);
+
+	for (i = 0; i < n_props; i++) {
+		gpointer count;
+
+		count = g_hash_table_lookup (counts, GINT_TO_POINTER (tracker_property_get_id (properties[i])));
+		tracker_property_set_count (properties[i], GPOINTER_TO_INT (count));
+	}
+
+	g_hash_table_unref (counts);
+}
+
+static gboolean
+statistics_table_exists (TrackerDBInterface *iface)
+{
+	return statistics_count (iface,
+	                         "SELECT COUNT(*) FROM sqlite_master "
+	                         "WHERE type = 'table' AND name = 'Statistics'",
+	                         NULL) > 0;
+}
+
+static void
+init_statistics (TrackerDBInterface *iface,
+                 gboolean            read_only)
+{
+	GError *error = NULL;
+	gboolean exists;
+
+	exists = statistics_table_exists (iface);
+
+	if (exists) {
+		load_statistics (iface, &error);
+	} else if (!read_only) {
+		/* New database, or one created before counts were stored */
+		create_statistics (iface, &error);
+		exists = (error == NULL);
+	}
+
+	if (error) {
+		g_critical ("Could not initialize class and property statistics: %s",
+		            error->message);
+		g_error_free (error);
+		return;
+	}
+
+	if (!read_only) {
+		tracker_data_enable_statistics (exists);
+	}
+}
+
+static void
+load_migrations (TrackerDBInterface *iface,
+                 gboolean            read_only)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *error = NULL;
+	GList *loaded = NULL, *stale = NULL, *l;
+
+	g_mutex_lock (&migrations_mutex);
+	g_list_free_full (migrations, (GDestroyNotify) migration_free);
+	migrations = NULL;
+	g_mutex_unlock (&migrations_mutex);
+
+	if (statistics_count (iface,
+	                      "SELECT COUNT(*) FROM sqlite_master "
+	                      "WHERE type = 'table' AND name = 'Migration'",
+	                      NULL) == 0) {
+		return;
+	}
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &error,
+	                                              "SELECT Class, Property, LastID FROM Migration");
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+			TrackerClass *class = NULL;
+			TrackerProperty *property = NULL;
+			const gchar *uri;
+			gint class_id, property_id;
+
+			class_id = tracker_db_cursor_get_int (cursor, 0);
+			property_id = tracker_db_cursor_get_int (cursor, 1);
+
+			uri = tracker_ontologies_get_uri_by_id (class_id);
+			if (uri) {
+				class = tracker_ontologies_get_class_by_uri (uri);
+			}
+
+			uri = tracker_ontologies_get_uri_by_id (property_id);
+			if (uri) {
+				property = tracker_ontologies_get_property_by_uri (uri);
+			}
+
+			if (class && property &&
+			    is_a_domain_index (tracker_class_get_domain_indexes (class), property)) {
+				Migration *migration;
+
+				migration = g_slice_new0 (Migration);
+				migration->class = g_object_ref (class);
+				migration->property = g_object_ref (property);
+				migration->last_id = tracker_db_cursor_get_int (cursor, 2);
+
+				loaded = g_list_prepend (loaded, migration);
+			} else {
+				/* The domain index was removed again */
+				stale = g_list_prepend (stale, g_strdup_printf ("Class = %d AND Property = %d",
+				                                                class_id, property_id));
+			}
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (error) {
+		g_critical ("Could not load pending migrations: %s", error->message);
+		g_clear_error (&error);
+	}
+
+	for (l = stale; l && !read_only; l = l->next) {
+		tracker_db_interface_execute_query (iface, NULL, "DELETE FROM Migration WHERE %s",
+		                                    (gchar *) l->data);
+	}
+
+	g_list_free_full (stale, g_free);
+
+	if (loaded) {
+		g_message ("Resuming %d domain index migrations", g_list_length (loaded));
+	}
+
+	g_mutex_lock (&migrations_mutex);
+	migrations = g_list_reverse (loaded);
+	g_mutex_unlock (&migrations_mutex);
+}
+
+/* Returns the ID of the last row of the next chunk, or 0 if all rows
+ * have been copied */
+static gint64
+migration_chunk_end (TrackerDBInterface  *iface,
+                     Migration           *migration,
+                     GError             **error)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *internal_error = NULL;
+	gint64 last_id = 0;
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "SELECT MAX(ID) FROM (SELECT ID FROM \"%s\" "
+	                                              "WHERE ID > ? ORDER BY ID LIMIT %d)",
+	                                              tracker_class_get_name (migration->class),
+	                                              MIGRATION_CHUNK_SIZE);
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, migration->last_id);
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		/* MAX() of no rows is NULL, read as 0 */
+		if (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+			last_id = tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+	}
+
+	return last_id;
+}
+
+static void
+migration_copy_chunk (TrackerDBInterface  *iface,
+                      Migration           *migration,
+                      gint64               last_id,
+                      GError             **error)
+{
+	const gchar *suffixes[] = { "", ":graph", ":localDate", ":localTime" };
+	const gchar *source_name, *dest_name, *field_name;
+	GString *sql;
+	guint i, n_columns;
+
+	source_name = tracker_class_get_name (tracker_property_get_domain (migration->property));
+	dest_name = tracker_class_get_name (migration->class);
+	field_name = tracker_property_get_name (migration->property);
+
+	/* xsd:dateTime is stored in three columns:
+	 * universal time, local date, local time of day */
+	if (tracker_property_get_data_type (migration->property) == TRACKER_PROPERTY_TYPE_DATETIME) {
+		n_columns = 4;
+	} else {
+		n_columns = 2;
+	}
+
+	sql = g_string_new (NULL);
+	g_string_append_printf (sql, "UPDATE \"%s\" SET ", dest_name);
+
+	for (i = 0; i < n_columns; i++) {
+		g_string_append_printf (sql, "%s\"%s%s\"=(SELECT \"%s%s\" FROM \"%s\" "
+		                        "WHERE \"%s\".ID = \"%s\".ID)",
+		                        i > 0 ? ", " : "",
+		                        field_name, suffixes[i],
+		                        field_name, suffixes[i],
+		                        source_name, source_name, dest_name);
+	}
+
+	g_string_append_printf (sql, " WHERE ID > %" G_GINT64_FORMAT " AND ID <= %" G_GINT64_FORMAT,
+	                        migration->last_id, last_id);
+
+	g_debug ("Copying: '%s'", sql->str);
+
+	tracker_db_interface_execute_query (iface, error, "%s", sql->str);
+
+	g_string_free (sql, TRUE);
+}
+
+/**
+ * tracker_data_manager_migrate:
+ * @error: return location for errors
+ *
+ * Copies the next chunk of a pending domain index migration, a single
+ * call takes a bounded amount of time. Must be called from the update
+ * thread. Progress is committed with each chunk, so migrations resume
+ * where they stopped after a restart.
+ *
+ * Returns: %TRUE if there is more to copy
+ **/
+gboolean
+tracker_data_manager_migrate (GError **error)
+{
+	TrackerDBInterface *iface;
+	Migration *migration;
+	GError *internal_error = NULL;
+	gint64 last_id;
+	gboolean more_pending;
+
+	/* Only this thread removes migrations, no need to hold the lock */
+	migration = migrations ? migrations->data : NULL;
+
+	if (!migration) {
+		return FALSE;
+	}
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	tracker_db_interface_start_transaction (iface);
+
+	last_id = migration_chunk_end (iface, migration, &internal_error);
+
+	if (!internal_error && last_id > 0) {
+		migration_copy_chunk (iface, migration, last_id, &internal_error);
+	}
+
+	if (!internal_error) {
+		if (last_id > 0) {
+			tracker_db_interface_execute_query (iface, &internal_error,
+			                                    "UPDATE Migration SET LastID = %" G_GINT64_FORMAT " "
+			                                    "WHERE Class = %d AND Property = %d",
+			                                    last_id,
+			                                    tracker_class_get_id (migration->class),
+			                                    tracker_property_get_id (migration->property));
+		} else {
+			tracker_db_interface_execute_query (iface, &internal_error,
+			                                    "DELETE FROM Migration "
+			                                    "WHERE Class = %d AND Property = %d",
+			                                    tracker_class_get_id (migration->class),
+			                                    tracker_property_get_id (migration->property));
+		}
+	}
+
+	if (!internal_error) {
+		tracker_db_interface_end_db_transaction (iface, &internal_error);
+	}
+
+	if (internal_error) {
+		tracker_db_interface_execute_query (iface, NULL, "ROLLBACK");
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	g_mutex_lock (&migrations_mutex);
+
+	if (last_id > 0) {
+		migration->last_id = last_id;
+	} else {
+		/* Queries use the new column from now on */
+		g_message ("Domain index '%s' of '%s' is complete",
+		           tracker_property_get_name (migration->property),
+		           tracker_class_get_name (migration->class));
+
+		migrations = g_list_remove (migrations, migration);
+		migration_free (migration);
+	}
+
+	more_pending = (migrations != NULL);
+
+	g_mutex_unlock (&migrations_mutex);
+
+	return more_pending;
+}
+
+/**
+ * tracker_data_manager_domain_index_is_pending:
+ * @class: a #TrackerClass
+ * @property: a domain index of @class
+ *
+ * Returns: %TRUE if the values of @property are still being copied
+ * into the table of @class and must not be read from there yet
+ **/
+gboolean
+tracker_data_manager_domain_index_is_pending (TrackerClass    *class,
+                                              TrackerProperty *property)
+{
+	GList *l;
+	gboolean pending = FALSE;
+
+	g_mutex_lock (&migrations_mutex);
+
+	for (l = migrations; l && !pending; l = l->next) {
+		Migration *migration = l->data;
+
+		pending = (migration->class == class && migration->property == property);
+	}
+
+	g_mutex_unlock (&migrations_mutex);
+
+	return pending;
+}
+
+gboolean
 tracker_data_manager_init_fts (TrackerDBInterface *iface,
                                gboolean            create)
 {
@@ -3611,6 +4618,55 @@ tracker_data_manager_init_fts (TrackerDBInterface *iface,
 #endif
 }
 
+gboolean
+tracker_data_manager_fts_merge (GError **error)
+{
+#if HAVE_TRACKER_FTS
+	TrackerDBInterface *iface;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	return tracker_db_interface_sqlite_fts_merge (iface,
+	                                              FTS_MERGE_PAGES,
+	                                              FTS_MERGE_MIN_SEGMENTS,
+	                                              error);
+#else
+	return FALSE;
+#endif
+}
+
+gboolean
+tracker_data_manager_fts_optimize (GError **error)
+{
+#if HAVE_TRACKER_FTS
+	TrackerDBInterface *iface;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	return tracker_db_interface_sqlite_fts_optimize (iface, error);
+#else
+	return TRUE;
+#endif
+}
+
+gint
+tracker_data_manager_get_fts_segment_count (gint *n_levels)
+{
+#if HAVE_TRACKER_FTS
+	TrackerDBInterface *iface;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	return tracker_db_interface_sqlite_fts_get_segment_count (iface, n_levels);
+#else
+	if (n_levels) {
+		*n_levels = 0;
+	}
+
+	return 0;
+#endif
+}
+
 gboolean
 tracker_data_manager_init (TrackerDBManagerFlags   flags,
                            const gchar           **test_schemas,
@@ -3989,8 +5045,12 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 			}
 #endif /* DISABLE_JOURNAL */
 
-			/* Load ontology from database into memory */
-			db_get_static_data (iface, &internal_error);
+			/* Load ontology from the snapshot if it still matches the
+			 * database, otherwise from the database into memory */
+			if (!load_ontologies_snapshot (iface)) {
+				db_get_static_data (iface, &internal_error);
+			}
+
 			check_ontology = (flags & TRACKER_DB_MANAGER_DO_NOT_CHECK_ONTOLOGY) == 0;
 
 			if (internal_error) {
@@ -4003,7 +5063,7 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 			/* Skipped in the read-only case as it can't work with direct access and
 			   it reduces initialization time */
 			clean_decomposed_transient_metadata (iface);
-		} else {
+		} else if (!load_ontologies_snapshot (iface)) {
 			GError *gvdb_error = NULL;
 
 			load_ontologies_gvdb (&gvdb_error);
@@ -4021,6 +5081,8 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 					return FALSE;
 				}
 			}
+		} else {
+			check_ontology = FALSE;
 		}
 
 		tracker_data_manager_init_fts (iface, FALSE);
@@ -4034,9 +5096,29 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 		GPtrArray *seen_properties;
 		GError *n_error = NULL;
 		gboolean transaction_started = FALSE;
+		gboolean statistics_kept = FALSE;
+		GPtrArray *rebuilt_properties;
 
 		seen_classes = g_ptr_array_new ();
 		seen_properties = g_ptr_array_new ();
+		rebuilt_properties = g_ptr_array_new ();
+
+		/* Keep the counts up to date through the ontology changes,
+		 * only the properties whose tables get rebuilt are counted
+		 * again afterwards */
+		if (statistics_table_exists (iface)) {
+			GError *statistics_error = NULL;
+
+			load_statistics (iface, &statistics_error);
+
+			if (statistics_error) {
+				/* init_statistics() will report it */
+				g_error_free (statistics_error);
+			} else {
+				tracker_data_enable_statistics (TRUE);
+				statistics_kept = TRUE;
+			}
+		}
 
 		/* Get all the ontology files from ontologies_dir */
 		sorted = get_ontologies (test_schemas != NULL, ontologies_dir);
@@ -4317,8 +5399,11 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 #if HAVE_TRACKER_FTS
 				GHashTable *fts_properties, *multivalued;
 
-				if (ontology_get_fts_properties (TRUE, &fts_properties, &multivalued)) {
-					tracker_db_interface_sqlite_fts_alter_table (iface, fts_properties, multivalued);
+				if (ontology_get_fts_properties (TRUE, &fts_properties, &multivalued) &&
+				    !tracker_db_interface_sqlite_fts_alter_table (iface, fts_properties,
+				                                                  multivalued, &n_error)) {
+					g_critical ("%s", n_error->message);
+					g_clear_error (&n_error);
 				}
 
 				g_hash_table_unref (fts_properties);
@@ -4438,6 +5523,22 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 			tracker_data_ontology_process_changes_post_import (seen_classes, seen_properties);
 
 			write_ontologies_gvdb (TRUE /* overwrite */, NULL);
+
+			if (statistics_kept) {
+				TrackerProperty **properties;
+				guint n_props, i;
+
+				properties = tracker_ontologies_get_properties (&n_props);
+
+				/* Range and cardinality changes copy the values
+				 * over to a new table, some may not convert */
+				for (i = 0; i < n_props; i++) {
+					if (tracker_property_get_db_schema_changed (properties[i]) &&
+					    !tracker_property_get_is_new (properties[i])) {
+						g_ptr_array_add (rebuilt_properties, properties[i]);
+					}
+				}
+			}
 		}
 
 		tracker_data_ontology_free_seen (seen_classes);
@@ -4465,6 +5566,18 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 			}
 		}
 
+		if (statistics_kept) {
+			update_statistics (iface, rebuilt_properties, &internal_error);
+
+			if (internal_error) {
+				/* Counted from scratch by init_statistics() */
+				g_warning ("Could not update statistics: %s", internal_error->message);
+				g_clear_error (&internal_error);
+				tracker_db_interface_execute_query (iface, NULL, "DROP TABLE IF EXISTS Statistics");
+			}
+		}
+
+		g_ptr_array_free (rebuilt_properties, TRUE);
 		g_hash_table_unref (ontos_table);
 
 		g_list_foreach (ontos, (GFunc) g_free, NULL);
@@ -4572,8 +5685,31 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 		tracker_db_manager_set_current_locale ();
 	}
 
+#if HAVE_TRACKER_FTS
+	/* If the configured FTS prefix index lengths changed, rebuild
+	 * the FTS table so queries can use the new indexes */
+	if (!read_only && tracker_db_interface_sqlite_fts_prefix_lengths_changed (iface)) {
+		if (busy_callback) {
+			/* Report OPERATION - STATUS */
+			busy_status = g_strdup_printf ("%s - %s",
+			                               busy_operation,
+			                               "Rebuilding full-text index");
+			busy_callback (busy_status, 0, busy_user_data);
+			g_free (busy_status);
+		}
+
+		rebuild_fts_table (iface);
+	}
+#endif
+
+	init_statistics (iface, read_only);
+	load_migrations (iface, read_only);
+
 	if (!read_only) {
 		tracker_ontologies_sort ();
+
+		/* Done last, everything above may still change the schema */
+		write_ontologies_snapshot (iface);
 	}
 
 	initialized = TRUE;
@@ -4609,6 +5745,11 @@ tracker_data_manager_shutdown (void)
 	}
 #endif /* DISABLE_JOURNAL */
 
+	g_mutex_lock (&migrations_mutex);
+	g_list_free_full (migrations, (GDestroyNotify) migration_free);
+	migrations = NULL;
+	g_mutex_unlock (&migrations_mutex);
+
 	tracker_db_manager_shutdown ();
 	tracker_ontologies_shutdown ();
 	if (!reloading) {
@@ -28,9 +28,11 @@
 #include <libtracker-common/tracker-language.h>
 #include <libtracker-common/tracker-ontologies.h>
 
+#include <libtracker-data/tracker-class.h>
 #include <libtracker-data/tracker-data-update.h>
 #include <libtracker-data/tracker-db-interface.h>
 #include <libtracker-data/tracker-db-manager.h>
+#include <libtracker-data/tracker-property.h>
 
 G_BEGIN_DECLS
 
@@ -66,6 +68,17 @@ gboolean tracker_data_manager_reload                 (TrackerBusyCallback     bu
 gboolean tracker_data_manager_init_fts               (TrackerDBInterface     *interface,
 						      gboolean                create);
 
+gboolean tracker_data_manager_fts_merge              (GError                **error);
+gboolean tracker_data_manager_fts_optimize           (GError                **error);
+gint     tracker_data_manager_get_fts_segment_count  (gint                   *n_levels);
+
+gboolean tracker_data_manager_migrate                (GError                **error);
+gboolean tracker_data_manager_set_class_indexes_enabled (TrackerClass        *class,
+                                                        gboolean             enabled,
+                                                        GError             **error);
+gboolean tracker_data_manager_domain_index_is_pending (TrackerClass          *class,
+                                                       TrackerProperty       *property);
+
 G_END_DECLS
 
 #endif /* __LIBTRACKER_DATA_MANAGER_H__ */
@@ -51,6 +51,12 @@
 #define RDF_PROPERTY RDF_PREFIX "Property"
 #define RDF_TYPE RDF_PREFIX "type"
 
+/* most rows a bulk load writes with a single INSERT */
+#define BULK_INSERT_MAX_ROWS 128
+/* statements a bulk load writes per transaction, so the journal
+ * only ever holds that many in memory */
+#define BULK_LOAD_CHUNK_SIZE 50000
+
 typedef struct _TrackerDataUpdateBuffer TrackerDataUpdateBuffer;
 typedef struct _TrackerDataUpdateBufferResource TrackerDataUpdateBufferResource;
 typedef struct _TrackerDataUpdateBufferPredicate TrackerDataUpdateBufferPredicate;
@@ -68,9 +74,11 @@ struct _TrackerDataUpdateBuffer {
 	/* integer -> TrackerDataUpdateBufferResource */
 	GHashTable *resources_by_id;
 
-	/* the following two fields are valid per sqlite transaction, not just for same subject */
+	/* the following fields are valid per sqlite transaction, not just for same subject */
 	/* TrackerClass -> integer */
 	GHashTable *class_counts;
+	/* TrackerProperty -> integer */
+	GHashTable *property_counts;
 
 #if HAVE_TRACKER_FTS
 	gboolean fts_ever_updated;
@@ -99,6 +107,7 @@ struct _TrackerDataUpdateBufferProperty {
 	GValue value;
 	gint graph;
 	gboolean date_time : 1;
+	gboolean sort_key : 1;
 
 #if HAVE_TRACKER_FTS
 	gboolean fts : 1;
@@ -146,9 +155,43 @@ typedef struct {
 	gboolean is_uri;
 } QueuedStatement;
 
+/* Query reading the single-valued properties of a class table */
+typedef struct {
+	gchar *sql;
+	/* TrackerProperty, in the order of the selected columns */
+	GPtrArray *columns;
+} ClassColumns;
+
+/* Rows of new resources a bulk load writes to a class table with
+ * multi-row INSERTs, see bulk_insert_queue() */
+typedef struct {
+	/* INSERT INTO "table" (ID, ...), also the key in bulk_inserts */
+	gchar *sql;
+	/* (?, ...) for a single row */
+	gchar *row_sql;
+	guint n_values;
+	gboolean resource_table;
+	/* BulkInsertRow */
+	GArray *rows;
+} BulkInsert;
+
+typedef struct {
+	gint id;
+	/* TrackerDataUpdateBufferProperty, owned by the buffered resource */
+	GArray *properties;
+} BulkInsertRow;
+
 static gboolean in_transaction = FALSE;
 static gboolean in_ontology_transaction = FALSE;
 static gboolean in_journal_replay = FALSE;
+static gboolean in_bulk_load = FALSE;
+/* resources created by the bulk load have this ID or higher */
+static gint bulk_load_first_id = 0;
+/* TrackerClass -> whether the bulk load dropped the indexes of its
+ * table, for the classes without instances when the load started */
+static GHashTable *bulk_load_tables = NULL;
+/* INSERT prefix -> BulkInsert, rows not written yet */
+static GHashTable *bulk_inserts = NULL;
 static TrackerDataUpdateBuffer update_buffer;
 /* current resource */
 static TrackerDataUpdateBufferResource *resource_buffer;
@@ -162,6 +205,9 @@ static GPtrArray *delete_callbacks = NULL;
 static GPtrArray *commit_callbacks = NULL;
 static GPtrArray *rollback_callbacks = NULL;
 static gint max_service_id = 0;
+static gboolean statistics_enabled = FALSE;
+/* TrackerClass -> ClassColumns, built once per ontology */
+static GHashTable *class_columns = NULL;
 static gint max_ontology_id = 0;
 
 static gint         ensure_resource_id         (const gchar      *uri,
@@ -173,11 +219,14 @@ static void         cache_insert_value         (const gchar      *table_name,
                                                 gint              graph,
                                                 gboolean          multiple_values,
                                                 gboolean          fts,
-                                                gboolean          date_time);
+                                                gboolean          date_time,
+                                                gboolean          sort_key);
 static GArray      *get_old_property_values    (TrackerProperty  *property,
                                                 GError          **error);
 static gchar*       gvalue_to_string           (TrackerPropertyType  type,
                                                 GValue           *gvalue);
+static void         add_property_count         (TrackerProperty  *property,
+                                                gint              count);
 static gboolean     delete_metadata_decomposed (TrackerProperty  *property,
                                                 const gchar      *value,
                                                 gint              value_id,
@@ -468,6 +517,18 @@ tracker_data_update_shutdown (void)
 	max_service_id = 0;
 	max_ontology_id = 0;
 	transaction_modseq = 0;
+	statistics_enabled = FALSE;
+
+	if (class_columns) {
+		g_hash_table_unref (class_columns);
+		class_columns = NULL;
+	}
+}
+
+void
+tracker_data_enable_statistics (gboolean enable)
+{
+	statistics_enabled = enable;
 }
 
 static gint
@@ -530,7 +591,11 @@ cache_ensure_table (const gchar *table_name,
 		g_value_set_int64 (&gvalue, get_transaction_modseq ());
 		cache_insert_value ("rdfs:Resource", "tracker:modified", TRUE, &gvalue,
 		                    0,
-		                    FALSE, FALSE, FALSE);
+		                    FALSE, FALSE, FALSE, FALSE);
+
+		if (resource_buffer->create) {
+			add_property_count (tracker_ontologies_get_property_by_uri (TRACKER_PREFIX "modified"), 1);
+		}
 	}
 
 	table = g_hash_table_lookup (resource_buffer->tables, table_name);
@@ -561,7 +626,8 @@ cache_insert_value (const gchar            *table_name,
                     gint                    graph,
                     gboolean                multiple_values,
                     gboolean                fts,
-                    gboolean                date_time)
+                    gboolean                date_time,
+                    gboolean                sort_key)
 {
 	TrackerDataUpdateBufferTable    *table;
 	TrackerDataUpdateBufferProperty  property;
@@ -576,6 +642,7 @@ cache_insert_value (const gchar            *table_name,
 	property.fts = fts;
 #endif
 	property.date_time = date_time;
+	property.sort_key = sort_key;
 
 	table = cache_ensure_table (table_name, multiple_values, transient);
 	g_array_append_val (table->properties, property);
@@ -598,7 +665,8 @@ cache_delete_value (const gchar            *table_name,
                     GValue                 *value,
                     gboolean                multiple_values,
                     gboolean                fts,
-                    gboolean                date_time)
+                    gboolean                date_time,
+                    gboolean                sort_key)
 {
 	TrackerDataUpdateBufferTable    *table;
 	TrackerDataUpdateBufferProperty  property;
@@ -610,6 +678,7 @@ cache_delete_value (const gchar            *table_name,
 	property.fts = fts;
 #endif
 	property.date_time = date_time;
+	property.sort_key = sort_key;
 
 	table = cache_ensure_table (table_name, multiple_values, transient);
 	table->delete_value = TRUE;
@@ -710,6 +779,67 @@ statement_bind_gvalue (TrackerDBStatement *stmt,
 	}
 }
 
+static void
+add_property_count (TrackerProperty *property,
+                    gint             count)
+{
+	gint old_count_entry;
+
+	/* rdf:type values are accounted for by the class counts */
+	if (property == tracker_ontologies_get_rdf_type ()) {
+		return;
+	}
+
+	tracker_property_set_count (property, tracker_property_get_count (property) + count);
+
+	/* update property_counts table so that the count change can be reverted in case of rollback */
+	if (!update_buffer.property_counts) {
+		update_buffer.property_counts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+
+	old_count_entry = GPOINTER_TO_INT (g_hash_table_lookup (update_buffer.property_counts, property));
+	g_hash_table_insert (update_buffer.property_counts, property,
+	                     GINT_TO_POINTER (old_count_entry + count));
+}
+
+static gint
+count_property_values (TrackerProperty *property)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor    *cursor = NULL;
+	GError             *error = NULL;
+	gint                count = 0;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT, &error,
+	                                              "SELECT COUNT(\"%s\") FROM \"%s\" WHERE ID = ?",
+	                                              tracker_property_get_name (property),
+	                                              tracker_property_get_table_name (property));
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, resource_buffer->id);
+		cursor = tracker_db_statement_start_cursor (stmt, &error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+			count = (gint) tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (error) {
+		g_warning ("Could not count property values: %s", error->message);
+		g_error_free (error);
+	}
+
+	return count;
+}
+
 static void
 add_class_count (TrackerClass *class,
                  gint          count)
@@ -728,6 +858,194 @@ add_class_count (TrackerClass *class,
 	                     GINT_TO_POINTER (old_count_entry + count));
 }
 
+#if HAVE_TRACKER_FTS
+static gboolean
+resource_buffer_fts_deferred (void)
+{
+	/* the text of resources created by a bulk load is indexed
+	 * once the load is done, see tracker_data_load_turtle_file_bulk() */
+	return in_bulk_load && resource_buffer->id >= bulk_load_first_id;
+}
+#endif
+
+static gboolean
+bulk_load_drop_indexes (TrackerClass  *class,
+                        GError       **error)
+{
+	gpointer dropped;
+
+	/* tables that had rows before the load keep their indexes,
+	 * rebuilding those costs more than the load saves */
+	if (!g_hash_table_lookup_extended (bulk_load_tables, class, NULL, &dropped) ||
+	    GPOINTER_TO_INT (dropped)) {
+		return TRUE;
+	}
+
+	g_hash_table_insert (bulk_load_tables, class, GINT_TO_POINTER (TRUE));
+
+	return tracker_data_manager_set_class_indexes_enabled (class, FALSE, error);
+}
+
+static void
+bulk_insert_free (BulkInsert *insert)
+{
+	g_free (insert->sql);
+	g_free (insert->row_sql);
+	g_array_free (insert->rows, TRUE);
+	g_slice_free (BulkInsert, insert);
+}
+
+static void
+bulk_insert_queue (const gchar *sql,
+                   const gchar *row_sql,
+                   const gchar *table_name,
+                   gint         id,
+                   GArray      *properties)
+{
+	BulkInsert *insert;
+	BulkInsertRow row;
+	const gchar *p;
+
+	insert = g_hash_table_lookup (bulk_inserts, sql);
+
+	if (!insert) {
+		insert = g_slice_new0 (BulkInsert);
+		insert->sql = g_strdup (sql);
+		insert->row_sql = g_strdup (row_sql);
+		insert->resource_table = (strcmp (table_name, "rdfs:Resource") == 0);
+		insert->rows = g_array_new (FALSE, FALSE, sizeof (BulkInsertRow));
+
+		for (p = row_sql; *p; p++) {
+			if (*p == '?') {
+				insert->n_values++;
+			}
+		}
+
+		g_hash_table_insert (bulk_inserts, insert->sql, insert);
+	}
+
+	row.id = id;
+	row.properties = properties;
+	g_array_append_val (insert->rows, row);
+}
+
+static void
+bulk_insert_bind_row (TrackerDBStatement *stmt,
+                      gint               *param,
+                      BulkInsert         *insert,
+                      BulkInsertRow      *row)
+{
+	TrackerDataUpdateBufferProperty *property;
+	gint i;
+
+	tracker_db_statement_bind_int (stmt, (*param)++, row->id);
+
+	if (insert->resource_table) {
+		tracker_db_statement_bind_int (stmt, (*param)++, (gint64) resource_time);
+		tracker_db_statement_bind_int (stmt, (*param)++, get_transaction_modseq ());
+	}
+
+	for (i = 0; i < row->properties->len; i++) {
+		property = &g_array_index (row->properties, TrackerDataUpdateBufferProperty, i);
+
+		statement_bind_gvalue (stmt, param, &property->value);
+
+		if (property->graph != 0) {
+			tracker_db_statement_bind_int (stmt, (*param)++, property->graph);
+		} else {
+			tracker_db_statement_bind_null (stmt, (*param)++);
+		}
+
+		if (property->sort_key) {
+			statement_bind_gvalue (stmt, param, &property->value);
+		}
+	}
+}
+
+static void
+bulk_insert_write (TrackerDBInterface  *iface,
+                   BulkInsert          *insert,
+                   GError             **error)
+{
+	TrackerDBStatement *stmt;
+	GError *actual_error = NULL;
+	GString *sql;
+	guint max_rows, n_rows, first, i;
+	gint param;
+
+	max_rows = tracker_db_interface_sqlite_get_max_insert_rows (iface, insert->n_values);
+	max_rows = MIN (max_rows, BULK_INSERT_MAX_ROWS);
+
+	for (first = 0; first < insert->rows->len; first += n_rows) {
+		n_rows = MIN (max_rows, insert->rows->len - first);
+
+		sql = g_string_new (insert->sql);
+		g_string_append (sql, " VALUES ");
+
+		for (i = 0; i < n_rows; i++) {
+			if (i > 0) {
+				g_string_append (sql, ", ");
+			}
+			g_string_append (sql, insert->row_sql);
+		}
+
+		/* only full batches come back often enough to be worth caching */
+		stmt = tracker_db_interface_create_statement (iface,
+		                                              n_rows == max_rows ?
+		                                              TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE :
+		                                              TRACKER_DB_STATEMENT_CACHE_TYPE_NONE,
+		                                              &actual_error,
+		                                              "%s", sql->str);
+		g_string_free (sql, TRUE);
+
+		if (actual_error) {
+			g_propagate_error (error, actual_error);
+			return;
+		}
+
+		param = 0;
+
+		for (i = 0; i < n_rows; i++) {
+			bulk_insert_bind_row (stmt, &param, insert,
+			                      &g_array_index (insert->rows, BulkInsertRow, first + i));
+		}
+
+		tracker_db_statement_execute (stmt, &actual_error);
+		g_object_unref (stmt);
+
+		if (actual_error) {
+			g_propagate_error (error, actual_error);
+			return;
+		}
+	}
+}
+
+static void
+bulk_insert_flush (GError **error)
+{
+	TrackerDBInterface *iface;
+	GError *actual_error = NULL;
+	GList *sqls, *l;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	/* one table after the other, so each table is appended to
+	 * while its pages are still in the cache */
+	sqls = g_hash_table_get_keys (bulk_inserts);
+	sqls = g_list_sort (sqls, (GCompareFunc) strcmp);
+
+	for (l = sqls; l && !actual_error; l = l->next) {
+		bulk_insert_write (iface, g_hash_table_lookup (bulk_inserts, l->data), &actual_error);
+	}
+
+	g_list_free (sqls);
+	g_hash_table_remove_all (bulk_inserts);
+
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+	}
+}
+
 static void
 tracker_data_resource_buffer_flush (GError **error)
 {
@@ -836,6 +1154,12 @@ tracker_data_resource_buffer_flush (GError **error)
 				continue;
 			}
 
+			if (in_bulk_load && table->insert && table->class &&
+			    !bulk_load_drop_indexes (table->class, &actual_error)) {
+				g_propagate_error (error, actual_error);
+				return;
+			}
+
 			if (table->insert) {
 				sql = g_string_new ("INSERT INTO \"");
 				values_sql = g_string_new ("VALUES (?");
@@ -872,6 +1196,11 @@ tracker_data_resource_buffer_flush (GError **error)
 
 					g_string_append_printf (sql, ", \"%s:graph\"", property->name);
 					g_string_append (values_sql, ", ?");
+
+					if (property->sort_key) {
+						g_string_append_printf (sql, ", \"%s:sortKey\"", property->name);
+						g_string_append (values_sql, ", SparqlCollationKey (?)");
+					}
 				} else {
 					if (i > 0) {
 						g_string_append (sql, ", ");
@@ -884,6 +1213,10 @@ tracker_data_resource_buffer_flush (GError **error)
 					}
 
 					g_string_append_printf (sql, ", \"%s:graph\" = ?", property->name);
+
+					if (property->sort_key) {
+						g_string_append_printf (sql, ", \"%s:sortKey\" = SparqlCollationKey (?)", property->name);
+					}
 				}
 			}
 
@@ -891,6 +1224,19 @@ tracker_data_resource_buffer_flush (GError **error)
 				g_string_append (sql, ")");
 				g_string_append (values_sql, ")");
 
+				if (in_bulk_load && !table->delete_value) {
+					/* written together with the rows of the other
+					 * new resources, see bulk_insert_flush() */
+					bulk_insert_queue (sql->str,
+					                   values_sql->str + strlen ("VALUES "),
+					                   table_name,
+					                   resource_buffer->id,
+					                   table->properties);
+					g_string_free (sql, TRUE);
+					g_string_free (values_sql, TRUE);
+					continue;
+				}
+
 				stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, &actual_error,
 				                                              "%s %s", sql->str, values_sql->str);
 				g_string_free (sql, TRUE);
@@ -941,6 +1287,15 @@ tracker_data_resource_buffer_flush (GError **error)
 				} else {
 					tracker_db_statement_bind_null (stmt, param++);
 				}
+				if (property->sort_key) {
+					/* the key is computed from the value, in SQL
+					 * so it uses the collator of the connection */
+					if (table->delete_value) {
+						tracker_db_statement_bind_null (stmt, param++);
+					} else {
+						statement_bind_gvalue (stmt, &param, &property->value);
+					}
+				}
 			}
 
 			if (!table->insert) {
@@ -958,7 +1313,7 @@ tracker_data_resource_buffer_flush (GError **error)
 	}
 
 #if HAVE_TRACKER_FTS
-	if (resource_buffer->fts_updated) {
+	if (resource_buffer->fts_updated && !resource_buffer_fts_deferred ()) {
 		TrackerProperty *prop;
 		GArray *values;
 		gboolean create = resource_buffer->create;
@@ -1004,6 +1359,16 @@ tracker_data_resource_buffer_flush (GError **error)
 #endif
 }
 
+static gint
+resource_buffer_compare_id (gconstpointer a,
+                            gconstpointer b)
+{
+	const TrackerDataUpdateBufferResource *resource_a = *((TrackerDataUpdateBufferResource **) a);
+	const TrackerDataUpdateBufferResource *resource_b = *((TrackerDataUpdateBufferResource **) b);
+
+	return resource_a->id - resource_b->id;
+}
+
 static void resource_buffer_free (TrackerDataUpdateBufferResource *resource)
 {
 	g_hash_table_unref (resource->predicates);
@@ -1033,6 +1398,40 @@ tracker_data_update_buffer_flush (GError **error)
 		}
 
 		g_hash_table_remove_all (update_buffer.resources_by_id);
+	} else if (in_bulk_load) {
+		GPtrArray *resources;
+		guint i;
+
+		/* new resources have growing IDs, writing them in order
+		 * appends the rows to the end of the class tables */
+		resources = g_ptr_array_sized_new (g_hash_table_size (update_buffer.resources));
+
+		g_hash_table_iter_init (&iter, update_buffer.resources);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &resource_buffer)) {
+			g_ptr_array_add (resources, resource_buffer);
+		}
+
+		g_ptr_array_sort (resources, resource_buffer_compare_id);
+
+		for (i = 0; i < resources->len && !actual_error; i++) {
+			resource_buffer = g_ptr_array_index (resources, i);
+			tracker_data_resource_buffer_flush (&actual_error);
+		}
+
+		/* the queued rows point into the buffered resources,
+		 * write them before those go away */
+		if (!actual_error) {
+			bulk_insert_flush (&actual_error);
+		} else {
+			g_hash_table_remove_all (bulk_inserts);
+		}
+
+		if (actual_error) {
+			g_propagate_error (error, actual_error);
+		}
+
+		g_ptr_array_free (resources, TRUE);
+		g_hash_table_remove_all (update_buffer.resources);
 	} else {
 		g_hash_table_iter_init (&iter, update_buffer.resources);
 		while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &resource_buffer)) {
@@ -1066,6 +1465,10 @@ tracker_data_update_buffer_clear (void)
 	g_hash_table_remove_all (update_buffer.resource_cache);
 	resource_buffer = NULL;
 
+	if (bulk_inserts) {
+		g_hash_table_remove_all (bulk_inserts);
+	}
+
 #if HAVE_TRACKER_FTS
 	update_buffer.fts_ever_updated = FALSE;
 #endif
@@ -1087,6 +1490,24 @@ tracker_data_update_buffer_clear (void)
 
 		g_hash_table_remove_all (update_buffer.class_counts);
 	}
+
+	if (update_buffer.property_counts) {
+		/* revert property count changes */
+
+		GHashTableIter iter;
+		TrackerProperty *property;
+		gpointer count_ptr;
+
+		g_hash_table_iter_init (&iter, update_buffer.property_counts);
+		while (g_hash_table_iter_next (&iter, (gpointer*) &property, &count_ptr)) {
+			gint count;
+
+			count = GPOINTER_TO_INT (count_ptr);
+			tracker_property_set_count (property, tracker_property_get_count (property) - count);
+		}
+
+		g_hash_table_remove_all (update_buffer.property_counts);
+	}
 }
 
 static void
@@ -1201,11 +1622,11 @@ cache_create_service_decomposed (TrackerClass *cl,
 	g_value_set_int64 (&gvalue, class_id);
 	cache_insert_value ("rdfs:Resource_rdf:type", "rdf:type", FALSE, &gvalue,
 	                    final_graph_id,
-	                    TRUE, FALSE, FALSE);
+	                    TRUE, FALSE, FALSE, FALSE);
 
 	add_class_count (cl, 1);
 
-	if (!in_journal_replay && insert_callbacks) {
+	if (!in_journal_replay && !in_bulk_load && insert_callbacks) {
 		guint n;
 
 		for (n = 0; n < insert_callbacks->len; n++) {
@@ -1268,7 +1689,8 @@ cache_create_service_decomposed (TrackerClass *cl,
 			                    graph != NULL ? ensure_resource_id (graph, NULL) : graph_id,
 			                    tracker_property_get_multiple_values (*domain_indexes),
 			                    tracker_property_get_fulltext_indexed (*domain_indexes),
-			                    tracker_property_get_data_type (*domain_indexes) == TRACKER_PROPERTY_TYPE_DATETIME);
+			                    tracker_property_get_data_type (*domain_indexes) == TRACKER_PROPERTY_TYPE_DATETIME,
+			                    FALSE);
 		}
 
 		domain_indexes++;
@@ -1367,6 +1789,35 @@ check_property_domain (TrackerProperty *property)
 	return FALSE;
 }
 
+static gboolean
+cursor_get_property_value (TrackerDBCursor *cursor,
+                           gint             column,
+                           TrackerProperty *property,
+                           GValue          *gvalue)
+{
+	tracker_db_cursor_get_value (cursor, column, gvalue);
+
+	if (!G_VALUE_TYPE (gvalue)) {
+		return FALSE;
+	}
+
+	if (tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME) {
+		gdouble time;
+
+		if (G_VALUE_TYPE (gvalue) == G_TYPE_INT64) {
+			time = g_value_get_int64 (gvalue);
+		} else {
+			time = g_value_get_double (gvalue);
+		}
+		g_value_unset (gvalue);
+		g_value_init (gvalue, TRACKER_TYPE_DATE_TIME);
+		/* UTC offset is irrelevant for comparison */
+		tracker_date_time_set (gvalue, time, 0);
+	}
+
+	return TRUE;
+}
+
 static GArray *
 get_property_values (TrackerProperty *property)
 {
@@ -1411,23 +1862,7 @@ get_property_values (TrackerProperty *property)
 			while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
 				GValue gvalue = { 0 };
 
-				tracker_db_cursor_get_value (cursor, 0, &gvalue);
-
-				if (G_VALUE_TYPE (&gvalue)) {
-					if (tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME) {
-						gdouble time;
-
-						if (G_VALUE_TYPE (&gvalue) == G_TYPE_INT64) {
-							time = g_value_get_int64 (&gvalue);
-						} else {
-							time = g_value_get_double (&gvalue);
-						}
-						g_value_unset (&gvalue);
-						g_value_init (&gvalue, TRACKER_TYPE_DATE_TIME);
-						/* UTC offset is irrelevant for comparison */
-						tracker_date_time_set (&gvalue, time, 0);
-					}
-
+				if (cursor_get_property_value (cursor, 0, property, &gvalue)) {
 					g_array_append_val (old_values, gvalue);
 				}
 			}
@@ -1438,6 +1873,135 @@ get_property_values (TrackerProperty *property)
 	return old_values;
 }
 
+static void
+class_columns_free (ClassColumns *columns)
+{
+	g_free (columns->sql);
+	g_ptr_array_free (columns->columns, TRUE);
+	g_slice_free (ClassColumns, columns);
+}
+
+static ClassColumns *
+class_columns_new (TrackerClass *class)
+{
+	ClassColumns *columns;
+	TrackerProperty **properties;
+	GString *sql;
+	guint i, n_props;
+
+	columns = g_slice_new0 (ClassColumns);
+	columns->columns = g_ptr_array_new ();
+
+	properties = tracker_ontologies_get_properties (&n_props);
+	sql = g_string_new ("SELECT ");
+
+	for (i = 0; i < n_props; i++) {
+		TrackerProperty *prop = properties[i];
+
+		/* fulltext indexed values are read by get_old_property_values,
+		 * which also takes care of the old FTS entries */
+		if (tracker_property_get_domain (prop) != class ||
+		    tracker_property_get_multiple_values (prop) ||
+		    tracker_property_get_fulltext_indexed (prop)) {
+			continue;
+		}
+
+		g_string_append_printf (sql, "%s\"%s\"",
+		                        columns->columns->len > 0 ? ", " : "",
+		                        tracker_property_get_name (prop));
+		g_ptr_array_add (columns->columns, prop);
+	}
+
+	g_string_append_printf (sql, " FROM \"%s\" WHERE ID = ?",
+	                        tracker_class_get_name (class));
+
+	columns->sql = g_string_free (sql, FALSE);
+
+	return columns;
+}
+
+/* Reads the single-valued properties stored in the class table of
+ * the given property with one query, so that later updates of the
+ * same resource find their old values in the buffer */
+static void
+get_single_valued_property_values (TrackerProperty *property)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor    *cursor = NULL;
+	TrackerClass       *class;
+	ClassColumns       *columns;
+	GError             *error = NULL;
+	guint               i;
+
+	class = tracker_property_get_domain (property);
+
+	if (in_ontology_transaction) {
+		/* the ontology may still change, don't keep the query */
+		columns = class_columns_new (class);
+	} else {
+		if (!class_columns) {
+			class_columns = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+			                                       (GDestroyNotify) class_columns_free);
+		}
+
+		columns = g_hash_table_lookup (class_columns, class);
+
+		if (!columns) {
+			columns = class_columns_new (class);
+			g_hash_table_insert (class_columns, class, columns);
+		}
+	}
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT, &error,
+	                                              "%s", columns->sql);
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, resource_buffer->id);
+		cursor = tracker_db_statement_start_cursor (stmt, &error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		gboolean found;
+
+		found = tracker_db_cursor_iter_next (cursor, NULL, &error);
+
+		/* on errors get_old_property_values reads the values one by one */
+		for (i = 0; !error && i < columns->columns->len; i++) {
+			TrackerProperty *prop = g_ptr_array_index (columns->columns, i);
+			GValue gvalue = { 0 };
+			GArray *old_values;
+
+			/* values already in the buffer may have been changed */
+			if (g_hash_table_lookup (resource_buffer->predicates, prop)) {
+				continue;
+			}
+
+			old_values = g_array_sized_new (FALSE, TRUE, sizeof (GValue), 1);
+			g_array_set_clear_func (old_values, (GDestroyNotify) g_value_unset);
+			g_hash_table_insert (resource_buffer->predicates, g_object_ref (prop), old_values);
+
+			if (found && cursor_get_property_value (cursor, i, prop, &gvalue)) {
+				g_array_append_val (old_values, gvalue);
+			}
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (error) {
+		g_warning ("Could not get property values: %s\n", error->message);
+		g_error_free (error);
+	}
+
+	if (in_ontology_transaction) {
+		class_columns_free (columns);
+	}
+}
+
 static GArray *
 get_old_property_values (TrackerProperty  *property,
                          GError          **error)
@@ -1462,7 +2026,8 @@ get_old_property_values (TrackerProperty  *property,
 
 			iface = tracker_db_manager_get_db_interface ();
 
-			if (!resource_buffer->fts_updated && !resource_buffer->create) {
+			if (!resource_buffer->fts_updated && !resource_buffer->create &&
+			    !resource_buffer_fts_deferred ()) {
 				guint i, n_props;
 				TrackerProperty   **properties, *prop;
 
@@ -1634,7 +2199,8 @@ process_domain_indexes (TrackerProperty *property,
 			                    graph != NULL ? ensure_resource_id (graph, NULL) : graph_id,
 			                    FALSE,
 			                    tracker_property_get_fulltext_indexed (property),
-			                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME);
+			                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME,
+			                    FALSE);
 		}
 		domain_index_classes++;
 	}
@@ -1736,12 +2302,15 @@ cache_insert_metadata_decomposed (TrackerProperty  *property,
 		                    graph != NULL ? ensure_resource_id (graph, NULL) : graph_id,
 		                    multiple_values,
 		                    tracker_property_get_fulltext_indexed (property),
-		                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME);
+		                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME,
+		                    tracker_property_get_sort_key (property));
 
 		if (!multiple_values) {
 			process_domain_indexes (property, &gvalue, field_name, graph, graph_id);
 		}
 
+		add_property_count (property, 1);
+
 		change = TRUE;
 	}
 
@@ -1863,6 +2432,7 @@ cache_update_metadata_decomposed (TrackerProperty  *property,
 	const gchar        *field_name;
 	TrackerProperty   **super_properties;
 	GValue              gvalue = { 0 };
+	GArray             *old_values;
 	GError             *new_error = NULL;
 	gboolean            change = FALSE;
 
@@ -1878,8 +2448,6 @@ cache_update_metadata_decomposed (TrackerProperty  *property,
 			gint subject_id;
 			gchar *subject;
 
-			GArray *old_values;
-
 			/* read existing property values */
 			old_values = get_old_property_values (property, &new_error);
 			if (new_error) {
@@ -1927,6 +2495,22 @@ cache_update_metadata_decomposed (TrackerProperty  *property,
 	table_name = tracker_property_get_table_name (property);
 	field_name = tracker_property_get_name (property);
 
+	/* read existing property values, needed to keep the value
+	 * count exact, single-valued ones of the same class are read
+	 * together the first time one of them gets updated */
+	if (!multiple_values && !resource_buffer->create &&
+	    !tracker_property_get_fulltext_indexed (property) &&
+	    !g_hash_table_lookup (resource_buffer->predicates, property) &&
+	    check_property_domain (property)) {
+		get_single_valued_property_values (property);
+	}
+
+	old_values = get_old_property_values (property, &new_error);
+	if (new_error) {
+		g_propagate_error (error, new_error);
+		return FALSE;
+	}
+
 	if (value) {
 		string_to_gvalue (value, tracker_property_get_data_type (property), &gvalue, &new_error);
 		if (new_error) {
@@ -1938,13 +2522,28 @@ cache_update_metadata_decomposed (TrackerProperty  *property,
 		g_value_set_int64 (&gvalue, value_id);
 	}
 
+	if (multiple_values) {
+		if (value_set_add_value (old_values, &gvalue)) {
+			add_property_count (property, 1);
+		}
+	} else {
+		if (old_values->len == 0) {
+			add_property_count (property, 1);
+		}
+
+		/* the new value replaces the old one */
+		g_array_set_size (old_values, 0);
+		value_set_add_value (old_values, &gvalue);
+	}
+
 	cache_insert_value (table_name, field_name,
 	                    tracker_property_get_transient (property),
 	                    &gvalue,
 	                    graph != NULL ? ensure_resource_id (graph, NULL) : graph_id,
 	                    multiple_values,
 	                    tracker_property_get_fulltext_indexed (property),
-	                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME);
+	                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME,
+	                    tracker_property_get_sort_key (property));
 
 	if (!multiple_values) {
 		process_domain_indexes (property, &gvalue, field_name, graph, graph_id);
@@ -1999,7 +2598,8 @@ delete_metadata_decomposed (TrackerProperty  *property,
 		                    tracker_property_get_transient (property),
 		                    &gvalue, multiple_values,
 		                    tracker_property_get_fulltext_indexed (property),
-		                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME);
+		                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME,
+		                    tracker_property_get_sort_key (property));
 
 		if (!multiple_values) {
 			TrackerClass **domain_index_classes;
@@ -2016,12 +2616,15 @@ delete_metadata_decomposed (TrackerProperty  *property,
 					                    tracker_property_get_transient (property),
 					                    &gvalue_copy, multiple_values,
 					                    tracker_property_get_fulltext_indexed (property),
-					                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME);
+					                    tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_DATETIME,
+					                    FALSE);
 				}
 				domain_index_classes++;
 			}
 		}
 
+		add_property_count (property, -1);
+
 		change = TRUE;
 	}
 
@@ -2170,6 +2773,14 @@ cache_delete_resource_type_full (TrackerClass *class,
 		field_name = tracker_property_get_name (prop);
 
 		if (direct_delete) {
+			if (prop != tracker_ontologies_get_rdf_type ()) {
+				/* the buffer holds the current values if the
+				 * property was read or changed before */
+				old_values = g_hash_table_lookup (resource_buffer->predicates, prop);
+				add_property_count (prop, old_values ? -(gint) old_values->len :
+				                                       -count_property_values (prop));
+			}
+
 			if (multiple_values) {
 				db_delete_row (iface, table_name, resource_buffer->id);
 			}
@@ -2192,7 +2803,9 @@ cache_delete_resource_type_full (TrackerClass *class,
 			                    tracker_property_get_transient (prop),
 			                    &gvalue, multiple_values,
 			                    tracker_property_get_fulltext_indexed (prop),
-			                    tracker_property_get_data_type (prop) == TRACKER_PROPERTY_TYPE_DATETIME);
+			                    tracker_property_get_data_type (prop) == TRACKER_PROPERTY_TYPE_DATETIME,
+			                    tracker_property_get_sort_key (prop));
+			add_property_count (prop, -1);
 
 
 			if (!multiple_values) {
@@ -2209,7 +2822,8 @@ cache_delete_resource_type_full (TrackerClass *class,
 						                    tracker_property_get_transient (prop),
 						                    &gvalue_copy, multiple_values,
 						                    tracker_property_get_fulltext_indexed (prop),
-						                    tracker_property_get_data_type (prop) == TRACKER_PROPERTY_TYPE_DATETIME);
+						                    tracker_property_get_data_type (prop) == TRACKER_PROPERTY_TYPE_DATETIME,
+						                    FALSE);
 					}
 					domain_index_classes++;
 				}
@@ -2741,7 +3355,7 @@ tracker_data_insert_statement_with_uri (const gchar            *graph,
 			final_prop_id = (prop_id != 0) ? prop_id : tracker_data_query_resource_id (predicate);
 			object_id = query_resource_id (object);
 
-			if (insert_callbacks) {
+			if (insert_callbacks && !in_bulk_load) {
 				guint n;
 				for (n = 0; n < insert_callbacks->len; n++) {
 					TrackerStatementDelegate *delegate;
@@ -2823,7 +3437,7 @@ tracker_data_insert_statement_with_string (const gchar            *graph,
 		return;
 	}
 
-	if (insert_callbacks && change) {
+	if (insert_callbacks && !in_bulk_load && change) {
 		guint n;
 
 		graph_id = (graph != NULL ? query_resource_id (graph) : 0);
@@ -3332,6 +3946,11 @@ tracker_data_begin_transaction (GError **error)
 void
 tracker_data_begin_ontology_transaction (GError **error)
 {
+	/* the ontology is about to change, see get_single_valued_property_values() */
+	if (class_columns) {
+		g_hash_table_remove_all (class_columns);
+	}
+
 	in_ontology_transaction = TRUE;
 	tracker_data_begin_transaction (error);
 }
@@ -3344,6 +3963,75 @@ tracker_data_begin_transaction_for_replay (time_t time, GError **error)
 	resource_time = time;
 }
 
+static void
+statistics_write (TrackerDBStatement  *stmt,
+                  gint                 id,
+                  gint                 count,
+                  GError             **error)
+{
+	tracker_db_statement_bind_int (stmt, 0, id);
+	tracker_db_statement_bind_int (stmt, 1, count);
+	tracker_db_statement_execute (stmt, error);
+}
+
+static void
+statistics_flush (TrackerDBInterface  *iface,
+                  GError             **error)
+{
+	TrackerDBStatement *stmt;
+	GHashTableIter iter;
+	gpointer key, count_ptr;
+	GError *actual_error = NULL;
+
+	if (!statistics_enabled ||
+	    ((!update_buffer.class_counts || g_hash_table_size (update_buffer.class_counts) == 0) &&
+	     (!update_buffer.property_counts || g_hash_table_size (update_buffer.property_counts) == 0))) {
+		return;
+	}
+
+	/* the absolute counts are stored, they include the changes of
+	 * this transaction and are reverted with it on rollback */
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, &actual_error,
+	                                              "INSERT OR REPLACE INTO Statistics (ID, Count) VALUES (?, ?)");
+
+	if (!stmt) {
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
+	if (update_buffer.class_counts) {
+		g_hash_table_iter_init (&iter, update_buffer.class_counts);
+		while (!actual_error && g_hash_table_iter_next (&iter, &key, &count_ptr)) {
+			TrackerClass *class = key;
+
+			if (GPOINTER_TO_INT (count_ptr) != 0) {
+				statistics_write (stmt, tracker_class_get_id (class),
+				                  tracker_class_get_count (class),
+				                  &actual_error);
+			}
+		}
+	}
+
+	if (update_buffer.property_counts) {
+		g_hash_table_iter_init (&iter, update_buffer.property_counts);
+		while (!actual_error && g_hash_table_iter_next (&iter, &key, &count_ptr)) {
+			TrackerProperty *property = key;
+
+			if (GPOINTER_TO_INT (count_ptr) != 0) {
+				statistics_write (stmt, tracker_property_get_id (property),
+				                  tracker_property_get_count (property),
+				                  &actual_error);
+			}
+		}
+	}
+
+	g_object_unref (stmt);
+
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+	}
+}
+
 void
 tracker_data_commit_transaction (GError **error)
 {
@@ -3361,6 +4049,13 @@ tracker_data_commit_transaction (GError **error)
 		return;
 	}
 
+	statistics_flush (iface, &actual_error);
+	if (actual_error) {
+		tracker_data_rollback_transaction ();
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
 	tracker_db_interface_end_db_transaction (iface,
 	                                         &actual_error);
 
@@ -3404,13 +4099,17 @@ tracker_data_commit_transaction (GError **error)
 		g_hash_table_remove_all (update_buffer.class_counts);
 	}
 
+	if (update_buffer.property_counts) {
+		g_hash_table_remove_all (update_buffer.property_counts);
+	}
+
 #if HAVE_TRACKER_FTS
 	if (update_buffer.fts_ever_updated) {
 		update_buffer.fts_ever_updated = FALSE;
 	}
 #endif
 
-	tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", TRACKER_DB_CACHE_SIZE_DEFAULT);
+	tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", tracker_db_manager_get_cache_size ());
 
 	g_hash_table_remove_all (update_buffer.resources);
 	g_hash_table_remove_all (update_buffer.resources_by_id);
@@ -3453,7 +4152,7 @@ tracker_data_rollback_transaction (void)
 		g_error_free (ignorable);
 	}
 
-	tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", TRACKER_DB_CACHE_SIZE_DEFAULT);
+	tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", tracker_db_manager_get_cache_size ());
 
 	/* Runtime false in case of DISABLE_JOURNAL */
 	if (!in_journal_replay) {
@@ -3545,6 +4244,173 @@ tracker_data_load_turtle_file (GFile   *file,
 	g_free (path);
 }
 
+/* Gives the tables the bulk load dropped the indexes of their indexes
+ * back and adds the new resources to the fulltext index */
+static void
+bulk_load_finish (GError **error)
+{
+	GError *actual_error = NULL;
+	GHashTableIter iter;
+	gpointer class, dropped;
+
+#if HAVE_TRACKER_FTS
+	tracker_db_interface_sqlite_fts_insert_from (tracker_db_manager_get_db_interface (),
+	                                             bulk_load_first_id,
+	                                             &actual_error);
+	update_buffer.fts_ever_updated = TRUE;
+#endif
+
+	g_hash_table_iter_init (&iter, bulk_load_tables);
+	while (!actual_error && g_hash_table_iter_next (&iter, &class, &dropped)) {
+		if (GPOINTER_TO_INT (dropped)) {
+			tracker_data_manager_set_class_indexes_enabled (class, TRUE, &actual_error);
+		}
+	}
+
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+	}
+}
+
+/* Same as tracker_data_load_turtle_file(), for seeding stores with
+ * large amounts of data: statement callbacks are not called, rows of
+ * new resources are written with multi-row INSERTs, one class table
+ * after the other, and the fulltext index of new resources is filled
+ * in once at the end. So are the indexes of single valued properties
+ * on class tables that were empty before the load and get rows from
+ * it. The file is committed in chunks of BULK_LOAD_CHUNK_SIZE
+ * statements, each one a journal transaction, so the journal does not
+ * hold the whole file in memory. If the load fails, only the chunk it
+ * failed in is rolled back, the resources of the previous ones stay. */
+void
+tracker_data_load_turtle_file_bulk (GFile   *file,
+                                    GError **error)
+{
+	TrackerTurtleReader *reader;
+	GError *actual_error = NULL;
+	GError *finish_error = NULL;
+	TrackerClass **classes;
+	const gchar *subject;
+	gchar *chunk_subject = NULL;
+	guint i, n_classes, n_statements = 0;
+	gchar *path;
+
+	g_return_if_fail (G_IS_FILE (file) && g_file_is_native (file));
+
+	tracker_data_begin_transaction (&actual_error);
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
+	/* only peek at the next ID, the first new resource takes it */
+	bulk_load_first_id = tracker_data_update_get_new_service_id ();
+	max_service_id--;
+	in_bulk_load = TRUE;
+
+	bulk_inserts = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) bulk_insert_free);
+	bulk_load_tables = g_hash_table_new (NULL, NULL);
+	classes = tracker_ontologies_get_classes (&n_classes);
+
+	for (i = 0; i < n_classes; i++) {
+		if (tracker_class_get_count (classes[i]) == 0) {
+			g_hash_table_insert (bulk_load_tables, classes[i], GINT_TO_POINTER (FALSE));
+		}
+	}
+
+	path = g_file_get_path (file);
+	reader = tracker_turtle_reader_new (path, &actual_error);
+	g_free (path);
+
+	while (!actual_error && tracker_turtle_reader_next (reader, &actual_error)) {
+		subject = tracker_turtle_reader_get_subject (reader);
+
+		/* a chunk ends with the statements of its last subject,
+		 * so the resource is not split across transactions */
+		if (chunk_subject && strcmp (subject, chunk_subject) != 0) {
+			g_free (chunk_subject);
+			chunk_subject = NULL;
+			n_statements = 0;
+
+			tracker_data_commit_transaction (&actual_error);
+			if (!actual_error) {
+				tracker_data_begin_transaction (&actual_error);
+			}
+			if (actual_error) {
+				break;
+			}
+		}
+
+		if (tracker_turtle_reader_get_object_is_uri (reader)) {
+			tracker_data_insert_statement_with_uri (tracker_turtle_reader_get_graph (reader),
+			                                        subject,
+			                                        tracker_turtle_reader_get_predicate (reader),
+			                                        tracker_turtle_reader_get_object (reader),
+			                                        &actual_error);
+		} else {
+			tracker_data_insert_statement_with_string (tracker_turtle_reader_get_graph (reader),
+			                                           subject,
+			                                           tracker_turtle_reader_get_predicate (reader),
+			                                           tracker_turtle_reader_get_object (reader),
+			                                           &actual_error);
+		}
+
+		if (++n_statements == BULK_LOAD_CHUNK_SIZE) {
+			chunk_subject = g_strdup (subject);
+		}
+	}
+
+	g_free (chunk_subject);
+
+	if (reader) {
+		g_object_unref (reader);
+	}
+
+	if (!actual_error) {
+		tracker_data_update_buffer_flush (&actual_error);
+	}
+
+	if (!actual_error) {
+		bulk_load_finish (&actual_error);
+	}
+
+	if (!actual_error) {
+		tracker_data_commit_transaction (&actual_error);
+	} else if (in_transaction) {
+		/* also brings back the indexes dropped in this chunk */
+		tracker_data_rollback_transaction ();
+	}
+
+	if (actual_error) {
+		/* previous chunks are committed, their tables need their
+		 * indexes and their resources the fulltext index */
+		tracker_data_begin_transaction (&finish_error);
+		if (!finish_error) {
+			bulk_load_finish (&finish_error);
+			if (finish_error) {
+				tracker_data_rollback_transaction ();
+			} else {
+				tracker_data_commit_transaction (&finish_error);
+			}
+		}
+
+		if (finish_error) {
+			g_warning ("Could not finish partial bulk load: %s", finish_error->message);
+			g_error_free (finish_error);
+		}
+	}
+
+	g_hash_table_unref (bulk_load_tables);
+	bulk_load_tables = NULL;
+	g_hash_table_unref (bulk_inserts);
+	bulk_inserts = NULL;
+	in_bulk_load = FALSE;
+
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+	}
+}
+
 void
 tracker_data_sync (void)
 {
@@ -96,6 +96,8 @@ void     tracker_data_update_buffer_flush           (GError                   **
 void     tracker_data_update_buffer_might_flush     (GError                   **error);
 void     tracker_data_load_turtle_file              (GFile                     *file,
                                                      GError                   **error);
+void     tracker_data_load_turtle_file_bulk         (GFile                     *file,
+                                                     GError                   **error);
 
 void     tracker_data_sync                          (void);
 void     tracker_data_replay_journal                (TrackerBusyCallback        busy_callback,
@@ -121,6 +123,8 @@ void     tracker_data_remove_commit_statement_callback   (TrackerCommitCallback
 void     tracker_data_remove_rollback_statement_callback (TrackerCommitCallback      callback,
                                                           gpointer                   user_data);
 
+void     tracker_data_enable_statistics               (gboolean                   enable);
+
 void     tracker_data_update_shutdown                 (void);
 #define  tracker_data_update_init                     tracker_data_update_shutdown
 
@@ -22,6 +22,15 @@
 #include "config.h"
 
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif /* __linux__ */
+
 #include <glib.h>
 #include <glib/gstdio.h>
 
@@ -35,6 +44,88 @@
 #include "tracker-db-backup.h"
 
 #define TRACKER_DB_BACKUP_META_FILENAME_T	"meta-backup.db.tmp"
+#define TRACKER_DB_BACKUP_MANIFEST_SUFFIX	".manifest"
+
+/* Pages copied per sqlite3_backup_step() or per batch of changed
+ * pages, with a pause in between so the disk is not monopolized */
+#define BACKUP_PAGES_PER_STEP   256
+#define BACKUP_STEP_INTERVAL_MS 5
+
+/* Bump whenever the layout below changes */
+#define MANIFEST_VERSION 2
+
+/* (version, complete, page size, page count, modseq, session, epoch,
+ * page digests) */
+#define MANIFEST_TYPE "(ubuuxttay)"
+
+#define DIGEST_SIZE 16
+
+#define WAL_HEADER_SIZE       32
+#define WAL_FRAME_HEADER_SIZE 24
+
+typedef struct {
+	guint8 data[DIGEST_SIZE];
+} PageDigest;
+
+typedef struct {
+	gboolean complete;
+	guint page_size;
+	guint page_count;
+	gint64 modseq;
+	guint64 session;
+	guint64 epoch;
+	GArray *digests;
+} Manifest;
+
+typedef enum {
+	SHIM_FILE_OTHER,
+	SHIM_FILE_MAIN_DB,
+	SHIM_FILE_WAL
+} ShimFileKind;
+
+/* Both SQLite VFS below wrap the default one and only differ in what
+ * they do with writes */
+typedef struct {
+	sqlite3_vfs vfs;
+	sqlite3_vfs *base;
+} ShimVfs;
+
+typedef struct {
+	sqlite3_file parent;
+	ShimVfs *shim;
+	ShimFileKind kind;
+	sqlite3_file *real;
+} ShimFile;
+
+/* VFS for the backup destination, it records a digest of every page
+ * written for the manifest.
+ */
+typedef struct {
+	ShimVfs shim;
+	guint page_size;
+	GChecksum *checksum;
+	GArray *digests;
+} BackupVfs;
+
+/* VFS installed as the default one by the process writing the
+ * database, it records which pages of the metadata database get
+ * written, to its WAL or to the file itself. Every backup closes an
+ * epoch and takes the pages changed during it, a previous backup can
+ * be brought up to date with those only if it was taken by the same
+ * session at the start of that epoch.
+ */
+typedef struct {
+	ShimVfs shim;
+	GMutex mutex;
+	gchar *db_path;
+	gchar *wal_path;
+	guint64 session;
+	guint64 epoch;
+	guint64 n_writes;
+	guint wal_page_size;
+	gboolean lost;
+	GArray *dirty;
+} ChangeTracker;
 
 typedef struct {
 	GFile *destination;
@@ -44,12 +135,1092 @@ typedef struct {
 	GError *error;
 } BackupInfo;
 
+static ChangeTracker *change_tracker = NULL;
+
 GQuark
 tracker_db_backup_error_quark (void)
 {
 	return g_quark_from_static_string ("tracker-db-backup-error-quark");
 }
 
+static void
+page_digest (GChecksum   *checksum,
+             const void  *data,
+             gsize        len,
+             PageDigest  *digest)
+{
+	gsize digest_len = DIGEST_SIZE;
+
+	g_checksum_reset (checksum);
+	g_checksum_update (checksum, data, len);
+	g_checksum_get_digest (checksum, digest->data, &digest_len);
+}
+
+static gboolean
+page_digest_is_set (const PageDigest *digest)
+{
+	gint i;
+
+	for (i = 0; i < DIGEST_SIZE; i++) {
+		if (digest->data[i] != 0) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static guint32
+read_be32 (const guint8 *data)
+{
+	return ((guint32) data[0] << 24) | ((guint32) data[1] << 16) |
+	       ((guint32) data[2] << 8) | (guint32) data[3];
+}
+
+static void
+change_tracker_mark_page (ChangeTracker *tracker,
+                          guint          page)
+{
+	if (page == 0) {
+		tracker->lost = TRUE;
+		return;
+	}
+
+	if (page / 8 >= tracker->dirty->len) {
+		g_array_set_size (tracker->dirty, page / 8 + 1);
+	}
+
+	g_array_index (tracker->dirty, guint8, page / 8) |= 1 << (page % 8);
+}
+
+/* Anything not laid out as expected makes the epoch lose track, so
+ * the next backup copies everything rather than miss a page */
+static void
+change_tracker_record_write (ChangeTracker *tracker,
+                             ShimFileKind   kind,
+                             const guint8  *buf,
+                             gint           amount,
+                             sqlite3_int64  offset)
+{
+	g_mutex_lock (&tracker->mutex);
+
+	if (kind == SHIM_FILE_MAIN_DB) {
+		/* Once the WAL is in use these are checkpoints, which
+		 * copy pages already recorded when written to the WAL */
+		if (tracker->wal_page_size > 0) {
+			/* Nothing to record */
+		} else if (amount >= 512 && (amount & (amount - 1)) == 0 && offset % amount == 0) {
+			change_tracker_mark_page (tracker, offset / amount + 1);
+		} else {
+			tracker->lost = TRUE;
+		}
+	} else {
+		/* Commits, a checkpoint does not count as a change */
+		tracker->n_writes++;
+
+		if (offset == 0 && amount == WAL_HEADER_SIZE) {
+			tracker->wal_page_size = read_be32 (buf + 8);
+		} else if (tracker->wal_page_size == 0 || offset < WAL_HEADER_SIZE) {
+			tracker->lost = TRUE;
+		} else {
+			sqlite3_int64 frame_offset;
+
+			/* Frames are written as a header holding the page
+			 * number, followed by the page itself */
+			frame_offset = (offset - WAL_HEADER_SIZE) %
+				(tracker->wal_page_size + WAL_FRAME_HEADER_SIZE);
+
+			if (frame_offset == 0 && amount == WAL_FRAME_HEADER_SIZE) {
+				change_tracker_mark_page (tracker, read_be32 (buf));
+			} else if (frame_offset != WAL_FRAME_HEADER_SIZE ||
+			           amount != (gint) tracker->wal_page_size) {
+				tracker->lost = TRUE;
+			}
+		}
+	}
+
+	g_mutex_unlock (&tracker->mutex);
+}
+
+/* Closes the current epoch and returns the pages changed during it,
+ * or %NULL if those are not known */
+static GArray *
+change_tracker_take (guint64 *session,
+                     guint64 *epoch,
+                     guint64 *n_writes)
+{
+	ChangeTracker *tracker = change_tracker;
+	GArray *dirty = NULL;
+
+	*session = *epoch = *n_writes = 0;
+
+	if (!tracker) {
+		return NULL;
+	}
+
+	g_mutex_lock (&tracker->mutex);
+
+	if (!tracker->lost) {
+		dirty = tracker->dirty;
+		tracker->dirty = g_array_new (FALSE, TRUE, sizeof (guint8));
+	} else {
+		g_array_set_size (tracker->dirty, 0);
+		tracker->lost = FALSE;
+	}
+
+	*session = tracker->session;
+	*epoch = tracker->epoch++;
+	*n_writes = tracker->n_writes;
+
+	g_mutex_unlock (&tracker->mutex);
+
+	return dirty;
+}
+
+static guint64
+change_tracker_get_n_writes (void)
+{
+	guint64 n_writes;
+
+	if (!change_tracker) {
+		return 0;
+	}
+
+	g_mutex_lock (&change_tracker->mutex);
+	n_writes = change_tracker->n_writes;
+	g_mutex_unlock (&change_tracker->mutex);
+
+	return n_writes;
+}
+
+static int
+shim_file_close (sqlite3_file *file)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xClose (f->real);
+}
+
+static int
+shim_file_read (sqlite3_file  *file,
+                void          *buf,
+                int            amount,
+                sqlite3_int64  offset)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xRead (f->real, buf, amount, offset);
+}
+
+static int
+backup_file_write (sqlite3_file  *file,
+                   const void    *buf,
+                   int            amount,
+                   sqlite3_int64  offset)
+{
+	ShimFile *f = (ShimFile *) file;
+	BackupVfs *backup = (BackupVfs *) f->shim;
+
+	if (f->kind == SHIM_FILE_MAIN_DB &&
+	    amount == (int) backup->page_size &&
+	    offset % amount == 0) {
+		PageDigest digest;
+		guint page;
+
+		page = offset / amount;
+		page_digest (backup->checksum, buf, amount, &digest);
+
+		if (page >= backup->digests->len) {
+			g_array_set_size (backup->digests, page + 1);
+		}
+
+		g_array_index (backup->digests, PageDigest, page) = digest;
+	}
+
+	return f->real->pMethods->xWrite (f->real, buf, amount, offset);
+}
+
+static int
+tracked_file_write (sqlite3_file  *file,
+                    const void    *buf,
+                    int            amount,
+                    sqlite3_int64  offset)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	/* Recorded even if the write fails, the page may be half written */
+	if (f->kind != SHIM_FILE_OTHER) {
+		change_tracker_record_write ((ChangeTracker *) f->shim, f->kind,
+		                             buf, amount, offset);
+	}
+
+	return f->real->pMethods->xWrite (f->real, buf, amount, offset);
+}
+
+static int
+shim_file_truncate (sqlite3_file  *file,
+                    sqlite3_int64  size)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xTruncate (f->real, size);
+}
+
+static int
+shim_file_sync (sqlite3_file *file,
+                int           flags)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xSync (f->real, flags);
+}
+
+static int
+shim_file_file_size (sqlite3_file  *file,
+                     sqlite3_int64 *size)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xFileSize (f->real, size);
+}
+
+static int
+shim_file_lock (sqlite3_file *file,
+                int           lock)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xLock (f->real, lock);
+}
+
+static int
+shim_file_unlock (sqlite3_file *file,
+                  int           lock)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xUnlock (f->real, lock);
+}
+
+static int
+shim_file_check_reserved_lock (sqlite3_file *file,
+                               int          *result)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xCheckReservedLock (f->real, result);
+}
+
+static int
+shim_file_file_control (sqlite3_file *file,
+                        int           op,
+                        void         *arg)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xFileControl (f->real, op, arg);
+}
+
+static int
+shim_file_sector_size (sqlite3_file *file)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xSectorSize (f->real);
+}
+
+static int
+shim_file_device_characteristics (sqlite3_file *file)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xDeviceCharacteristics (f->real);
+}
+
+static int
+shim_file_shm_map (sqlite3_file  *file,
+                   int            region,
+                   int            region_size,
+                   int            extend,
+                   void volatile **out)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xShmMap (f->real, region, region_size, extend, out);
+}
+
+static int
+shim_file_shm_lock (sqlite3_file *file,
+                    int           offset,
+                    int           n,
+                    int           flags)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xShmLock (f->real, offset, n, flags);
+}
+
+static void
+shim_file_shm_barrier (sqlite3_file *file)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	f->real->pMethods->xShmBarrier (f->real);
+}
+
+static int
+shim_file_shm_unmap (sqlite3_file *file,
+                     int           delete_flag)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	return f->real->pMethods->xShmUnmap (f->real, delete_flag);
+}
+
+#if SQLITE_VERSION_NUMBER >= 3007017
+/* Memory mapped reads, SQLite never writes through the mapping */
+static int
+shim_file_fetch (sqlite3_file   *file,
+                 sqlite3_int64   offset,
+                 int             amount,
+                 void          **out)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	if (f->real->pMethods->iVersion < 3) {
+		*out = NULL;
+		return SQLITE_OK;
+	}
+
+	return f->real->pMethods->xFetch (f->real, offset, amount, out);
+}
+
+static int
+shim_file_unfetch (sqlite3_file  *file,
+                   sqlite3_int64  offset,
+                   void          *data)
+{
+	ShimFile *f = (ShimFile *) file;
+
+	if (f->real->pMethods->iVersion < 3) {
+		return SQLITE_OK;
+	}
+
+	return f->real->pMethods->xUnfetch (f->real, offset, data);
+}
+
+#define SHIM_IO_METHODS_VERSION 3
+#define SHIM_IO_METHODS_FETCH , shim_file_fetch, shim_file_unfetch
+#else  /* SQLITE_VERSION_NUMBER >= 3007017 */
+#define SHIM_IO_METHODS_VERSION 2
+#define SHIM_IO_METHODS_FETCH
+#endif /* SQLITE_VERSION_NUMBER >= 3007017 */
+
+static const sqlite3_io_methods backup_io_methods = {
+	SHIM_IO_METHODS_VERSION,
+	shim_file_close,
+	shim_file_read,
+	backup_file_write,
+	shim_file_truncate,
+	shim_file_sync,
+	shim_file_file_size,
+	shim_file_lock,
+	shim_file_unlock,
+	shim_file_check_reserved_lock,
+	shim_file_file_control,
+	shim_file_sector_size,
+	shim_file_device_characteristics,
+	shim_file_shm_map,
+	shim_file_shm_lock,
+	shim_file_shm_barrier,
+	shim_file_shm_unmap
+	SHIM_IO_METHODS_FETCH
+};
+
+static const sqlite3_io_methods tracked_io_methods = {
+	SHIM_IO_METHODS_VERSION,
+	shim_file_close,
+	shim_file_read,
+	tracked_file_write,
+	shim_file_truncate,
+	shim_file_sync,
+	shim_file_file_size,
+	shim_file_lock,
+	shim_file_unlock,
+	shim_file_check_reserved_lock,
+	shim_file_file_control,
+	shim_file_sector_size,
+	shim_file_device_characteristics,
+	shim_file_shm_map,
+	shim_file_shm_lock,
+	shim_file_shm_barrier,
+	shim_file_shm_unmap
+	SHIM_IO_METHODS_FETCH
+};
+
+static int
+shim_vfs_open_real (ShimVfs                  *shim,
+                    const char               *name,
+                    sqlite3_file             *file,
+                    int                       flags,
+                    int                      *out_flags,
+                    const sqlite3_io_methods *methods,
+                    ShimFileKind              kind)
+{
+	ShimFile *f = (ShimFile *) file;
+	int rc;
+
+	f->real = (sqlite3_file *) &f[1];
+	rc = shim->base->xOpen (shim->base, name, f->real, flags, out_flags);
+
+	if (rc != SQLITE_OK) {
+		f->parent.pMethods = NULL;
+		return rc;
+	}
+
+	f->shim = shim;
+	f->kind = kind;
+	f->parent.pMethods = methods;
+
+	return SQLITE_OK;
+}
+
+static int
+backup_vfs_open (sqlite3_vfs  *vfs,
+                 const char   *name,
+                 sqlite3_file *file,
+                 int           flags,
+                 int          *out_flags)
+{
+	return shim_vfs_open_real ((ShimVfs *) vfs, name, file, flags, out_flags,
+	                           &backup_io_methods,
+	                           (flags & SQLITE_OPEN_MAIN_DB) != 0 ?
+	                           SHIM_FILE_MAIN_DB : SHIM_FILE_OTHER);
+}
+
+static int
+tracked_vfs_open (sqlite3_vfs  *vfs,
+                  const char   *name,
+                  sqlite3_file *file,
+                  int           flags,
+                  int          *out_flags)
+{
+	ChangeTracker *tracker = (ChangeTracker *) vfs;
+	ShimFileKind kind = SHIM_FILE_OTHER;
+
+	if (name) {
+		g_mutex_lock (&tracker->mutex);
+
+		if ((flags & SQLITE_OPEN_MAIN_DB) != 0 &&
+		    g_strcmp0 (name, tracker->db_path) == 0) {
+			kind = SHIM_FILE_MAIN_DB;
+		} else if ((flags & SQLITE_OPEN_WAL) != 0 &&
+		           g_strcmp0 (name, tracker->wal_path) == 0) {
+			kind = SHIM_FILE_WAL;
+		}
+
+		g_mutex_unlock (&tracker->mutex);
+	}
+
+	return shim_vfs_open_real ((ShimVfs *) vfs, name, file, flags, out_flags,
+	                           &tracked_io_methods, kind);
+}
+
+static int
+shim_vfs_delete (sqlite3_vfs *vfs,
+                 const char  *name,
+                 int          sync_dir)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xDelete (shim->base, name, sync_dir);
+}
+
+static int
+shim_vfs_access (sqlite3_vfs *vfs,
+                 const char  *name,
+                 int          flags,
+                 int         *result)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xAccess (shim->base, name, flags, result);
+}
+
+static int
+shim_vfs_full_pathname (sqlite3_vfs *vfs,
+                        const char  *name,
+                        int          n_out,
+                        char        *out)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xFullPathname (shim->base, name, n_out, out);
+}
+
+static int
+shim_vfs_randomness (sqlite3_vfs *vfs,
+                     int          n_bytes,
+                     char        *out)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xRandomness (shim->base, n_bytes, out);
+}
+
+static int
+shim_vfs_sleep (sqlite3_vfs *vfs,
+                int          microseconds)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xSleep (shim->base, microseconds);
+}
+
+static int
+shim_vfs_current_time (sqlite3_vfs *vfs,
+                       double      *time)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xCurrentTime (shim->base, time);
+}
+
+static int
+shim_vfs_get_last_error (sqlite3_vfs *vfs,
+                         int          n_bytes,
+                         char        *out)
+{
+	ShimVfs *shim = (ShimVfs *) vfs;
+
+	return shim->base->xGetLastError (shim->base, n_bytes, out);
+}
+
+static void
+shim_vfs_init (ShimVfs     *shim,
+               sqlite3_vfs *base,
+               const gchar *name,
+               int        (*open_func) (sqlite3_vfs *, const char *, sqlite3_file *, int, int *))
+{
+	shim->base = base;
+
+	shim->vfs.iVersion = 1;
+	shim->vfs.szOsFile = sizeof (ShimFile) + base->szOsFile;
+	shim->vfs.mxPathname = base->mxPathname;
+	shim->vfs.zName = g_strdup (name);
+	shim->vfs.xOpen = open_func;
+	shim->vfs.xDelete = shim_vfs_delete;
+	shim->vfs.xAccess = shim_vfs_access;
+	shim->vfs.xFullPathname = shim_vfs_full_pathname;
+	shim->vfs.xRandomness = shim_vfs_randomness;
+	shim->vfs.xSleep = shim_vfs_sleep;
+	shim->vfs.xCurrentTime = shim_vfs_current_time;
+	shim->vfs.xGetLastError = shim_vfs_get_last_error;
+}
+
+static BackupVfs *
+backup_vfs_new (guint page_size)
+{
+	BackupVfs *backup;
+	sqlite3_vfs *base;
+	gchar *name;
+
+	/* The destination is not worth tracking */
+	base = change_tracker ? change_tracker->shim.base : sqlite3_vfs_find (NULL);
+
+	backup = g_slice_new0 (BackupVfs);
+	backup->page_size = page_size;
+	backup->checksum = g_checksum_new (G_CHECKSUM_MD5);
+	backup->digests = g_array_new (FALSE, TRUE, sizeof (PageDigest));
+
+	/* Unique per backup, the VFS carries this backup's state */
+	name = g_strdup_printf ("tracker-backup-%p", backup);
+	shim_vfs_init (&backup->shim, base, name, backup_vfs_open);
+	g_free (name);
+
+	sqlite3_vfs_register (&backup->shim.vfs, 0);
+
+	return backup;
+}
+
+static void
+backup_vfs_free (BackupVfs *backup)
+{
+	sqlite3_vfs_unregister (&backup->shim.vfs);
+
+	g_array_unref (backup->digests);
+	g_checksum_free (backup->checksum);
+	g_free ((gchar *) backup->shim.vfs.zName);
+
+	g_slice_free (BackupVfs, backup);
+}
+
+/* Starts recording the pages of @db_path written from this process,
+ * so backups only need to copy the pages changed since the previous
+ * one. Called before the database is opened, and again whenever the
+ * file may be replaced, which starts a new session and makes the next
+ * backup a full one. */
+void
+tracker_db_backup_track_changes (const gchar *db_path)
+{
+	ChangeTracker *tracker;
+	gchar *full_path;
+
+	if (!change_tracker) {
+		tracker = g_new0 (ChangeTracker, 1);
+		g_mutex_init (&tracker->mutex);
+		tracker->dirty = g_array_new (FALSE, TRUE, sizeof (guint8));
+
+		shim_vfs_init (&tracker->shim, sqlite3_vfs_find (NULL),
+		               "tracker-tracked", tracked_vfs_open);
+
+		/* Stays in place for the lifetime of the process */
+		sqlite3_vfs_register (&tracker->shim.vfs, 1);
+		change_tracker = tracker;
+	}
+
+	tracker = change_tracker;
+
+	/* The same name SQLite passes when opening the files */
+	full_path = g_malloc0 (tracker->shim.base->mxPathname + 1);
+
+	if (tracker->shim.base->xFullPathname (tracker->shim.base, db_path,
+	                                       tracker->shim.base->mxPathname + 1,
+	                                       full_path) != SQLITE_OK) {
+		g_free (full_path);
+		full_path = g_strdup (db_path);
+	}
+
+	g_mutex_lock (&tracker->mutex);
+
+	g_free (tracker->db_path);
+	g_free (tracker->wal_path);
+	tracker->db_path = full_path;
+	tracker->wal_path = g_strconcat (full_path, "-wal", NULL);
+
+	/* Never 0, which manifests without a session have */
+	tracker->session = ((guint64) g_random_int () << 32) | g_random_int () | 1;
+	tracker->epoch = 1;
+	tracker->wal_page_size = 0;
+	tracker->lost = FALSE;
+	g_array_set_size (tracker->dirty, 0);
+
+	g_mutex_unlock (&tracker->mutex);
+}
+
+static GFile *
+manifest_file_for_backup (GFile *backup)
+{
+	GFile *parent, *manifest;
+	gchar *basename, *name;
+
+	parent = g_file_get_parent (backup);
+	basename = g_file_get_basename (backup);
+	name = g_strconcat (basename, TRACKER_DB_BACKUP_MANIFEST_SUFFIX, NULL);
+
+	manifest = g_file_get_child (parent, name);
+
+	g_object_unref (parent);
+	g_free (basename);
+	g_free (name);
+
+	return manifest;
+}
+
+static void
+manifest_clear (Manifest *manifest)
+{
+	if (manifest->digests) {
+		g_array_unref (manifest->digests);
+		manifest->digests = NULL;
+	}
+}
+
+static gboolean
+manifest_load (GFile     *backup,
+               Manifest  *manifest,
+               GError   **error)
+{
+	GFile *file;
+	GVariant *variant, *digests;
+	gchar *contents;
+	gsize len, n_digests;
+	guint32 version;
+	gconstpointer data;
+
+	memset (manifest, 0, sizeof (Manifest));
+
+	file = manifest_file_for_backup (backup);
+
+	if (!g_file_load_contents (file, NULL, &contents, &len, NULL, error)) {
+		g_object_unref (file);
+		return FALSE;
+	}
+
+	g_object_unref (file);
+
+	variant = g_variant_new_from_data (G_VARIANT_TYPE (MANIFEST_TYPE),
+	                                   contents, len, FALSE,
+	                                   g_free, contents);
+	g_variant_ref_sink (variant);
+
+	g_variant_get (variant, "(ubuuxtt@ay)",
+	               &version, &manifest->complete,
+	               &manifest->page_size, &manifest->page_count,
+	               &manifest->modseq, &manifest->session,
+	               &manifest->epoch, &digests);
+
+	data = g_variant_get_fixed_array (digests, &n_digests, 1);
+
+	if (version != MANIFEST_VERSION ||
+	    n_digests != (gsize) manifest->page_count * DIGEST_SIZE) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_CORRUPT,
+		             "Backup manifest is invalid");
+		g_variant_unref (digests);
+		g_variant_unref (variant);
+		return FALSE;
+	}
+
+	manifest->digests = g_array_sized_new (FALSE, TRUE, sizeof (PageDigest), manifest->page_count);
+	g_array_append_vals (manifest->digests, data, manifest->page_count);
+
+	g_variant_unref (digests);
+	g_variant_unref (variant);
+
+	return TRUE;
+}
+
+static gboolean
+manifest_save (GFile     *backup,
+               Manifest  *manifest,
+               GError   **error)
+{
+	GFile *file;
+	GVariant *variant;
+	gboolean retval;
+	guint n_digests;
+
+	n_digests = manifest->digests ? manifest->digests->len : 0;
+
+	variant = g_variant_new ("(ubuuxtt@ay)",
+	                         MANIFEST_VERSION,
+	                         manifest->complete,
+	                         manifest->page_size,
+	                         n_digests,
+	                         manifest->modseq,
+	                         manifest->session,
+	                         manifest->epoch,
+	                         g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+	                                                    n_digests > 0 ? manifest->digests->data : NULL,
+	                                                    n_digests * DIGEST_SIZE, 1));
+	g_variant_ref_sink (variant);
+
+	file = manifest_file_for_backup (backup);
+
+	/* Replaced atomically, a crash leaves either manifest in place */
+	retval = g_file_replace_contents (file,
+	                                  g_variant_get_data (variant),
+	                                  g_variant_get_size (variant),
+	                                  NULL, FALSE,
+	                                  G_FILE_CREATE_REPLACE_DESTINATION,
+	                                  NULL, NULL, error);
+
+	g_object_unref (file);
+	g_variant_unref (variant);
+
+	return retval;
+}
+
+static gboolean
+query_source_info (sqlite3 *db,
+                   guint   *page_size,
+                   guint   *page_count,
+                   gint64  *modseq)
+{
+	sqlite3_stmt *stmt;
+
+	*page_size = 0;
+	*page_count = 0;
+	*modseq = 0;
+
+	if (sqlite3_prepare_v2 (db, "PRAGMA page_size", -1, &stmt, NULL) != SQLITE_OK) {
+		return FALSE;
+	}
+
+	if (sqlite3_step (stmt) == SQLITE_ROW) {
+		*page_size = sqlite3_column_int (stmt, 0);
+	}
+
+	sqlite3_finalize (stmt);
+
+	if (sqlite3_prepare_v2 (db, "PRAGMA page_count", -1, &stmt, NULL) != SQLITE_OK) {
+		return FALSE;
+	}
+
+	if (sqlite3_step (stmt) == SQLITE_ROW) {
+		*page_count = sqlite3_column_int (stmt, 0);
+	}
+
+	sqlite3_finalize (stmt);
+
+	/* Informative, lets a restore tell how recent the backup is */
+	if (sqlite3_prepare_v2 (db, "SELECT MAX(\"tracker:modified\") FROM \"rdfs:Resource\"",
+	                        -1, &stmt, NULL) == SQLITE_OK) {
+		if (sqlite3_step (stmt) == SQLITE_ROW) {
+			*modseq = sqlite3_column_int64 (stmt, 0);
+		}
+
+		sqlite3_finalize (stmt);
+	}
+
+	return *page_size > 0;
+}
+
+/* Starts the read transaction the whole backup is taken from. Returns
+ * in @frozen whether the database file alone holds that snapshot: the
+ * WAL got fully checkpointed and nothing was written since @n_writes,
+ * then the transaction keeps further checkpoints from touching the
+ * file, so its pages can be read directly */
+static gboolean
+begin_snapshot (sqlite3   *db,
+                guint64    n_writes,
+                gboolean  *frozen)
+{
+	gint log = -1, checkpointed = -1, rc;
+
+	/* The connection only finds the WAL on its first read, before
+	 * that a checkpoint does nothing */
+	if (sqlite3_exec (db, "SELECT COUNT(*) FROM sqlite_master",
+	                  NULL, NULL, NULL) != SQLITE_OK) {
+		return FALSE;
+	}
+
+	rc = sqlite3_wal_checkpoint_v2 (db, NULL, SQLITE_CHECKPOINT_PASSIVE,
+	                                &log, &checkpointed);
+
+	if (sqlite3_exec (db, "BEGIN; SELECT COUNT(*) FROM sqlite_master",
+	                  NULL, NULL, NULL) != SQLITE_OK) {
+		return FALSE;
+	}
+
+	*frozen = (change_tracker != NULL &&
+	           rc == SQLITE_OK &&
+	           log == checkpointed &&
+	           change_tracker_get_n_writes () == n_writes);
+
+	return TRUE;
+}
+
+static gboolean
+dirty_page_is_set (GArray *dirty,
+                   guint   page)
+{
+	return (page / 8 < dirty->len &&
+	        (g_array_index (dirty, guint8, page / 8) & (1 << (page % 8))) != 0);
+}
+
+/* Clones the previous backup into @temp, sharing its blocks, and
+ * writes over it the pages changed since, as read from the frozen
+ * database file. Fails where the filesystem can not clone files */
+static gboolean
+backup_update (sqlite3   *src_db,
+               GFile     *previous,
+               GFile     *temp,
+               GArray    *dirty,
+               guint      page_size,
+               guint      page_count,
+               Manifest  *manifest,
+               GError   **error)
+{
+	sqlite3_file *src = NULL;
+	GChecksum *checksum = NULL;
+	gchar *previous_path, *temp_path;
+	gint previous_fd = -1, temp_fd = -1;
+	guchar *page = NULL;
+	guint i, n_copied = 0;
+	gboolean retval = FALSE;
+
+	previous_path = g_file_get_path (previous);
+	temp_path = g_file_get_path (temp);
+
+	/* SQLite's own handle, closing another descriptor of the file
+	 * would drop the locks SQLite holds on it */
+	if (sqlite3_file_control (src_db, "main", SQLITE_FCNTL_FILE_POINTER, &src) != SQLITE_OK ||
+	    !src || !src->pMethods) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not access database file");
+		goto out;
+	}
+
+	previous_fd = g_open (previous_path, O_RDONLY, 0);
+
+	if (previous_fd == -1) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not open '%s': %s", previous_path, g_strerror (errno));
+		goto out;
+	}
+
+	temp_fd = g_open (temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+	if (temp_fd == -1) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not create '%s': %s", temp_path, g_strerror (errno));
+		goto out;
+	}
+
+#ifdef FICLONE
+	if (ioctl (temp_fd, FICLONE, previous_fd) == -1) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not clone '%s': %s", previous_path, g_strerror (errno));
+		goto out;
+	}
+#else  /* FICLONE */
+	g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+	             "Cloning files is not supported");
+	goto out;
+#endif /* FICLONE */
+
+	checksum = g_checksum_new (G_CHECKSUM_MD5);
+	page = g_malloc (page_size);
+
+	/* Unset digests for pages appended that were never written */
+	g_array_set_size (manifest->digests, page_count);
+
+	for (i = 1; i <= page_count; i++) {
+		sqlite3_int64 offset;
+
+		if (!dirty_page_is_set (dirty, i)) {
+			continue;
+		}
+
+		offset = (sqlite3_int64) (i - 1) * page_size;
+
+		if (src->pMethods->xRead (src, page, page_size, offset) != SQLITE_OK) {
+			g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+			             "Could not read page %u of the database", i);
+			goto out;
+		}
+
+		if (pwrite (temp_fd, page, page_size, offset) != (gssize) page_size) {
+			g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+			             "Could not write '%s': %s", temp_path, g_strerror (errno));
+			goto out;
+		}
+
+		page_digest (checksum, page, page_size,
+		             &g_array_index (manifest->digests, PageDigest, i - 1));
+
+		if (++n_copied % BACKUP_PAGES_PER_STEP == 0) {
+			g_usleep (BACKUP_STEP_INTERVAL_MS * 1000);
+		}
+	}
+
+	if (ftruncate (temp_fd, (off_t) page_count * page_size) == -1 ||
+	    fsync (temp_fd) == -1) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not write '%s': %s", temp_path, g_strerror (errno));
+		goto out;
+	}
+
+	g_debug ("Backup of %u pages updated, %u changed", page_count, n_copied);
+	retval = TRUE;
+
+out:
+	if (temp_fd != -1) {
+		close (temp_fd);
+	}
+
+	if (previous_fd != -1) {
+		close (previous_fd);
+	}
+
+	if (checksum) {
+		g_checksum_free (checksum);
+	}
+
+	g_free (page);
+	g_free (temp_path);
+	g_free (previous_path);
+
+	return retval;
+}
+
+/* Copies every page to @temp_path in chunked steps, all taken from
+ * the snapshot held by @src_db so the copy never restarts */
+static gboolean
+backup_copy (sqlite3      *src_db,
+             const gchar  *temp_path,
+             guint         page_size,
+             guint         page_count,
+             Manifest     *manifest,
+             GError      **error)
+{
+	BackupVfs *backup_vfs;
+	sqlite3 *temp_db = NULL;
+	sqlite3_backup *backup = NULL;
+	GError *inner_error = NULL;
+	gint rc = SQLITE_OK;
+
+	backup_vfs = backup_vfs_new (page_size);
+
+	if (sqlite3_open_v2 (temp_path, &temp_db,
+	                     SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+	                     backup_vfs->shim.vfs.zName) != SQLITE_OK) {
+		g_set_error (&inner_error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+		             "Could not open sqlite3 database:'%s'", temp_path);
+	} else {
+		/* The copy is a single transaction on the destination */
+		sqlite3_exec (temp_db, "PRAGMA journal_mode = DELETE", NULL, NULL, NULL);
+		backup = sqlite3_backup_init (temp_db, "main", src_db, "main");
+
+		if (!backup) {
+			g_set_error (&inner_error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+			             "Unable to initialize sqlite3 backup to '%s'", temp_path);
+		}
+	}
+
+	while (backup) {
+		rc = sqlite3_backup_step (backup, BACKUP_PAGES_PER_STEP);
+
+		if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+			break;
+		}
+
+		sqlite3_sleep (BACKUP_STEP_INTERVAL_MS);
+	}
+
+	if (backup) {
+		if (sqlite3_backup_finish (backup) != SQLITE_OK || rc != SQLITE_DONE) {
+			g_set_error (&inner_error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+			             "Unable to complete sqlite3 backup: %s",
+			             sqlite3_errmsg (temp_db));
+		}
+	}
+
+	if (temp_db) {
+		sqlite3_close (temp_db);
+	}
+
+	if (!inner_error) {
+		g_debug ("Backup of %u pages copied", page_count);
+
+		manifest->digests = g_array_ref (backup_vfs->digests);
+
+		/* Drops pages past a truncation, or leaves unset digests
+		 * for pages never written */
+		g_array_set_size (manifest->digests, page_count);
+	}
+
+	backup_vfs_free (backup_vfs);
+
+	if (inner_error) {
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 static gboolean
 perform_callback (gpointer user_data)
 {
@@ -89,68 +1260,94 @@ backup_job (GTask        *task,
 	BackupInfo *info = task_data;
 
 	const gchar *src_path;
-	GFile *parent_file, *temp_file;
+	GFile *parent_file, *temp_file, *temp_manifest_file, *manifest_file;
 	gchar *temp_path;
+	Manifest manifest = { 0 };
+	GArray *dirty = NULL;
+	guint page_size = 0, page_count = 0;
+	guint64 session, epoch, n_writes;
+	gboolean frozen = FALSE, updated = FALSE;
+	gint64 modseq = 0;
 
 	sqlite3 *src_db = NULL;
-	sqlite3 *temp_db = NULL;
-	sqlite3_backup *backup = NULL;
 
 	src_path = tracker_db_manager_get_file (TRACKER_DB_METADATA);
 	parent_file = g_file_get_parent (info->destination);
 	temp_file = g_file_get_child (parent_file, TRACKER_DB_BACKUP_META_FILENAME_T);
+	temp_manifest_file = manifest_file_for_backup (temp_file);
+	manifest_file = manifest_file_for_backup (info->destination);
 	g_file_delete (temp_file, NULL, NULL);
+	g_file_delete (temp_manifest_file, NULL, NULL);
 	temp_path = g_file_get_path (temp_file);
 
-	if (sqlite3_open_v2 (src_path, &src_db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+	/* Writable only so it can checkpoint, nothing is written through it */
+	if (sqlite3_open_v2 (src_path, &src_db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
 		g_set_error (&info->error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
 		             "Could not open sqlite3 database:'%s'", src_path);
 	}
 
-	if (!info->error && sqlite3_open (temp_path, &temp_db) != SQLITE_OK) {
-		g_set_error (&info->error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
-		             "Could not open sqlite3 database:'%s'", temp_path);
-	}
-
 	if (!info->error) {
-		backup = sqlite3_backup_init (temp_db, "main", src_db, "main");
+		/* Pages written from here on are left to the next backup */
+		dirty = change_tracker_take (&session, &epoch, &n_writes);
 
-		if (!backup) {
+		if (!begin_snapshot (src_db, n_writes, &frozen)) {
 			g_set_error (&info->error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
-				     "Unable to initialize sqlite3 backup from '%s' to '%s'", src_path, temp_path);
+			             "Could not start reading sqlite3 database:'%s'", src_path);
 		}
 	}
 
-	if (!info->error && sqlite3_backup_step (backup, -1) != SQLITE_DONE) {
+	if (!info->error && !query_source_info (src_db, &page_size, &page_count, &modseq)) {
 		g_set_error (&info->error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_UNKNOWN,
-		             "Unable to complete sqlite3 backup");
+		             "Could not query page size of sqlite3 database:'%s'", src_path);
 	}
 
-	if (backup) {
-		if (sqlite3_backup_finish (backup) != SQLITE_OK) {
-			if (info->error) {
-				/* sqlite3_backup_finish can provide more detailed error message */
-				g_clear_error (&info->error);
-			}
-			g_set_error (&info->error,
-			             TRACKER_DB_BACKUP_ERROR,
-			             TRACKER_DB_BACKUP_ERROR_UNKNOWN,
-				     "Unable to finish sqlite3 backup: %s",
-				     sqlite3_errmsg (temp_db));
+	/* A complete previous backup, taken by this session when the
+	 * epoch just closed started, only lacks the pages changed in it.
+	 * The previous backup itself is left alone until it is replaced */
+	if (!info->error && dirty && frozen &&
+	    manifest_load (info->destination, &manifest, NULL) &&
+	    manifest.complete &&
+	    manifest.session == session &&
+	    manifest.epoch == epoch &&
+	    manifest.page_size == page_size) {
+		GError *update_error = NULL;
+
+		updated = backup_update (src_db, info->destination, temp_file, dirty,
+		                         page_size, page_count, &manifest, &update_error);
+
+		if (!updated) {
+			g_message ("Could not update previous backup, copying all pages: %s",
+			           update_error->message);
+			g_error_free (update_error);
+			g_file_delete (temp_file, NULL, NULL);
 		}
-		backup = NULL;
 	}
 
-	if (temp_db) {
-		sqlite3_close (temp_db);
-		temp_db = NULL;
+	if (!info->error && !updated) {
+		manifest_clear (&manifest);
+		backup_copy (src_db, temp_path, page_size, page_count, &manifest, &info->error);
 	}
 
 	if (src_db) {
+		sqlite3_exec (src_db, "COMMIT", NULL, NULL, NULL);
 		sqlite3_close (src_db);
 		src_db = NULL;
 	}
 
+	if (!info->error) {
+		manifest.complete = TRUE;
+		manifest.page_size = page_size;
+		manifest.page_count = page_count;
+		manifest.modseq = modseq;
+		manifest.session = session;
+		manifest.epoch = epoch + 1;
+
+		manifest_save (temp_file, &manifest, &info->error);
+	}
+
+	/* Each file is renamed into place atomically. A crash between
+	 * both renames leaves a backup that does not match its manifest,
+	 * which verification refuses rather than trusting it */
 	if (!info->error) {
 		g_file_move (temp_file, info->destination,
 		             G_FILE_COPY_OVERWRITE,
@@ -158,7 +1355,26 @@ backup_job (GTask        *task,
 		             &info->error);
 	}
 
+	if (!info->error) {
+		g_file_move (temp_manifest_file, manifest_file,
+		             G_FILE_COPY_OVERWRITE,
+		             NULL, NULL, NULL,
+		             &info->error);
+	}
+
+	if (info->error) {
+		g_file_delete (temp_file, NULL, NULL);
+		g_file_delete (temp_manifest_file, NULL, NULL);
+	}
+
+	if (dirty) {
+		g_array_unref (dirty);
+	}
+
+	manifest_clear (&manifest);
 	g_free (temp_path);
+	g_object_unref (manifest_file);
+	g_object_unref (temp_manifest_file);
 	g_object_unref (temp_file);
 	g_object_unref (parent_file);
 
@@ -190,3 +1406,87 @@ tracker_db_backup_save (GFile                   *destination,
 	g_object_unref (task);
 }
 
+/* Checks every page of @backup against the manifest written along
+ * with it. Backups without a manifest, as written by older versions,
+ * are accepted as they are. */
+gboolean
+tracker_db_backup_verify (GFile   *backup,
+                          GError **error)
+{
+	GFileInputStream *stream;
+	GChecksum *checksum;
+	Manifest manifest;
+	GError *inner_error = NULL;
+	guchar *page;
+	guint i;
+
+	if (!manifest_load (backup, &manifest, &inner_error)) {
+		if (g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
+			g_debug ("Backup has no manifest, not verifying it");
+			g_error_free (inner_error);
+			return TRUE;
+		}
+
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
+
+	if (!manifest.complete) {
+		g_set_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_CORRUPT,
+		             "Backup was interrupted and is incomplete");
+		manifest_clear (&manifest);
+		return FALSE;
+	}
+
+	stream = g_file_read (backup, NULL, error);
+
+	if (!stream) {
+		manifest_clear (&manifest);
+		return FALSE;
+	}
+
+	checksum = g_checksum_new (G_CHECKSUM_MD5);
+	page = g_malloc (manifest.page_size);
+
+	for (i = 0; i < manifest.page_count && !inner_error; i++) {
+		PageDigest *expected, digest;
+		gsize n_read;
+
+		if (!g_input_stream_read_all (G_INPUT_STREAM (stream), page, manifest.page_size,
+		                              &n_read, NULL, &inner_error)) {
+			break;
+		}
+
+		if (n_read != manifest.page_size) {
+			g_set_error (&inner_error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_CORRUPT,
+			             "Backup is truncated at page %u of %u", i, manifest.page_count);
+			break;
+		}
+
+		expected = &g_array_index (manifest.digests, PageDigest, i);
+
+		/* Pages SQLite never writes, like the lock byte page */
+		if (!page_digest_is_set (expected)) {
+			continue;
+		}
+
+		page_digest (checksum, page, n_read, &digest);
+
+		if (memcmp (expected, &digest, sizeof (PageDigest)) != 0) {
+			g_set_error (&inner_error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_CORRUPT,
+			             "Backup page %u does not match the manifest", i);
+		}
+	}
+
+	g_free (page);
+	g_checksum_free (checksum);
+	g_object_unref (stream);
+	manifest_clear (&manifest);
+
+	if (inner_error) {
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
@@ -33,6 +33,7 @@ G_BEGIN_DECLS
 
 typedef enum {
 	TRACKER_DB_BACKUP_ERROR_UNKNOWN,
+	TRACKER_DB_BACKUP_ERROR_CORRUPT
 } TrackerDBBackupError;
 
 typedef void (*TrackerDBBackupFinished)   (GError *error, gpointer user_data);
@@ -43,6 +44,9 @@ void      tracker_db_backup_save        (GFile                   *destination,
                                          TrackerDBBackupFinished  callback,
                                          gpointer                 user_data,
                                          GDestroyNotify           destroy);
+gboolean  tracker_db_backup_verify      (GFile                   *backup,
+                                         GError                 **error);
+void      tracker_db_backup_track_changes (const gchar          *db_path);
 
 G_END_DECLS
 
@@ -35,6 +35,8 @@
 /* Default values */
 #define DEFAULT_JOURNAL_CHUNK_SIZE           50
 #define DEFAULT_JOURNAL_ROTATE_DESTINATION   ""
+#define DEFAULT_MMAP_SIZE                    0
+#define DEFAULT_CACHE_MEMORY                 0
 
 static void config_set_property (GObject      *object,
                                  guint         param_id,
@@ -52,7 +54,11 @@ enum {
 
 	/* Journal */
 	PROP_JOURNAL_CHUNK_SIZE,
-	PROP_JOURNAL_ROTATE_DESTINATION
+	PROP_JOURNAL_ROTATE_DESTINATION,
+
+	/* Memory */
+	PROP_MMAP_SIZE,
+	PROP_CACHE_MEMORY
 };
 
 static TrackerConfigMigrationEntry migration[] = {
@@ -90,6 +96,26 @@ tracker_db_config_class_init (TrackerDBConfigClass *klass)
 	                                                      DEFAULT_JOURNAL_ROTATE_DESTINATION,
 	                                                      G_PARAM_READWRITE));
 
+	g_object_class_install_property (object_class,
+	                                 PROP_MMAP_SIZE,
+	                                 g_param_spec_int ("mmap-size",
+	                                                   "Memory mapped I/O size",
+	                                                   " Size in MB of the database read through memory mapping. Use 0 to disable",
+	                                                   0,
+	                                                   65536,
+	                                                   DEFAULT_MMAP_SIZE,
+	                                                   G_PARAM_READWRITE));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_CACHE_MEMORY,
+	                                 g_param_spec_int ("cache-memory",
+	                                                   "Cache memory",
+	                                                   " Size in MB shared by the page caches of all connections. Use 0 for fixed size caches per connection",
+	                                                   0,
+	                                                   65536,
+	                                                   DEFAULT_CACHE_MEMORY,
+	                                                   G_PARAM_READWRITE));
+
 }
 
 static void
@@ -113,6 +139,16 @@ config_set_property (GObject      *object,
 		tracker_db_config_set_journal_rotate_destination (TRACKER_DB_CONFIG (object),
 		                                                  g_value_get_string(value));
 		break;
+
+		/* Memory */
+	case PROP_MMAP_SIZE:
+		tracker_db_config_set_mmap_size (TRACKER_DB_CONFIG (object),
+		                                 g_value_get_int (value));
+		break;
+	case PROP_CACHE_MEMORY:
+		tracker_db_config_set_cache_memory (TRACKER_DB_CONFIG (object),
+		                                    g_value_get_int (value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
 		break;
@@ -134,6 +170,12 @@ config_get_property (GObject    *object,
 	case PROP_JOURNAL_ROTATE_DESTINATION:
 		g_value_take_string (value, tracker_db_config_get_journal_rotate_destination (config));
 		break;
+	case PROP_MMAP_SIZE:
+		g_value_set_int (value, tracker_db_config_get_mmap_size (config));
+		break;
+	case PROP_CACHE_MEMORY:
+		g_value_set_int (value, tracker_db_config_get_cache_memory (config));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
 		break;
@@ -201,6 +243,22 @@ tracker_db_config_get_journal_rotate_destination (TrackerDBConfig *config)
 	return g_settings_get_string (G_SETTINGS (config), "journal-rotate-destination");
 }
 
+gint
+tracker_db_config_get_mmap_size (TrackerDBConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_DB_CONFIG (config), DEFAULT_MMAP_SIZE);
+
+	return g_settings_get_int (G_SETTINGS (config), "mmap-size");
+}
+
+gint
+tracker_db_config_get_cache_memory (TrackerDBConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_DB_CONFIG (config), DEFAULT_CACHE_MEMORY);
+
+	return g_settings_get_int (G_SETTINGS (config), "cache-memory");
+}
+
 void
 tracker_db_config_set_journal_chunk_size (TrackerDBConfig *config,
                                           gint             value)
@@ -220,3 +278,23 @@ tracker_db_config_set_journal_rotate_destination (TrackerDBConfig *config,
 	g_settings_set_string (G_SETTINGS (config), "journal-rotate-destination", value);
 	g_object_notify (G_OBJECT (config), "journal-rotate-destination");
 }
+
+void
+tracker_db_config_set_mmap_size (TrackerDBConfig *config,
+                                 gint             value)
+{
+	g_return_if_fail (TRACKER_IS_DB_CONFIG (config));
+
+	g_settings_set_int (G_SETTINGS (config), "mmap-size", value);
+	g_object_notify (G_OBJECT (config), "mmap-size");
+}
+
+void
+tracker_db_config_set_cache_memory (TrackerDBConfig *config,
+                                    gint             value)
+{
+	g_return_if_fail (TRACKER_IS_DB_CONFIG (config));
+
+	g_settings_set_int (G_SETTINGS (config), "cache-memory", value);
+	g_object_notify (G_OBJECT (config), "cache-memory");
+}
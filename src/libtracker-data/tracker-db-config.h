@@ -58,11 +58,17 @@ gboolean         tracker_db_config_save                           (TrackerDBConf
 
 gint             tracker_db_config_get_journal_chunk_size         (TrackerDBConfig *config);
 gchar *          tracker_db_config_get_journal_rotate_destination (TrackerDBConfig *config);
+gint             tracker_db_config_get_mmap_size                  (TrackerDBConfig *config);
+gint             tracker_db_config_get_cache_memory               (TrackerDBConfig *config);
 
 void             tracker_db_config_set_journal_chunk_size         (TrackerDBConfig *config,
                                                                    gint             value);
 void             tracker_db_config_set_journal_rotate_destination (TrackerDBConfig *config,
                                                                    const gchar     *value);
+void             tracker_db_config_set_mmap_size                  (TrackerDBConfig *config,
+                                                                   gint             value);
+void             tracker_db_config_set_cache_memory               (TrackerDBConfig *config,
+                                                                   gint             value);
 
 G_END_DECLS
 
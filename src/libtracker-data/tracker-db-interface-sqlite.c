@@ -28,6 +28,7 @@
 
 #include <libtracker-common/tracker-date-time.h>
 #include <libtracker-common/tracker-locale.h>
+#include <libtracker-common/tracker-trace.h>
 
 #include <libtracker-sparql/tracker-sparql.h>
 
@@ -55,6 +56,9 @@
 
 #define UNKNOWN_STATUS 0.5
 
+/* Milliseconds a statement waits on locks held by other connections */
+#define BUSY_TIMEOUT 100000
+
 typedef struct {
 	TrackerDBStatement *head;
 	TrackerDBStatement *tail;
@@ -90,6 +94,7 @@ struct TrackerDBInterface {
 	gchar *busy_status;
 
 	gchar *fts_insert_str;
+	gchar *fts_bulk_insert_str;
 };
 
 struct TrackerDBInterfaceClass {
@@ -101,6 +106,7 @@ struct TrackerDBCursor {
 	sqlite3_stmt *stmt;
 	TrackerDBStatement *ref_stmt;
 	gboolean finished;
+	gint64 trace_start;
 	TrackerPropertyType *types;
 	gint n_types;
 	gchar **variable_names;
@@ -170,6 +176,37 @@ tracker_db_interface_sqlite_enable_shared_cache (void)
 	sqlite3_enable_shared_cache (1);
 }
 
+void
+tracker_db_interface_sqlite_set_heap_limit (gint64 limit)
+{
+	/* Page caches of all connections give memory back once the
+	 * process goes over this limit */
+	sqlite3_soft_heap_limit64 (limit);
+}
+
+void
+tracker_db_interface_sqlite_get_cache_stats (TrackerDBInterface *db_interface,
+                                             gint64             *hits,
+                                             gint64             *misses,
+                                             gint64             *used)
+{
+	int current, highwater;
+
+	/* The connection may be in use by its own thread, these are
+	 * plain counter reads so at worst slightly stale values */
+	sqlite3_db_status (db_interface->db, SQLITE_DBSTATUS_CACHE_HIT,
+	                   &current, &highwater, 0);
+	*hits = current;
+
+	sqlite3_db_status (db_interface->db, SQLITE_DBSTATUS_CACHE_MISS,
+	                   &current, &highwater, 0);
+	*misses = current;
+
+	sqlite3_db_status (db_interface->db, SQLITE_DBSTATUS_CACHE_USED,
+	                   &current, &highwater, 0);
+	*used = current;
+}
+
 static void
 function_sparql_string_join (sqlite3_context *context,
                              int              argc,
@@ -426,6 +463,37 @@ function_sparql_format_time (sqlite3_context *context,
 	sqlite3_result_text (context, str, -1, g_free);
 }
 
+static void
+function_sparql_collation_key (sqlite3_context *context,
+                               int              argc,
+                               sqlite3_value   *argv[])
+{
+	guchar *key;
+	gint key_len;
+
+	if (argc != 1) {
+		sqlite3_result_error (context, "Invalid argument count", -1);
+		return;
+	}
+
+	if (sqlite3_value_type (argv[0]) == SQLITE_NULL) {
+		sqlite3_result_null (context);
+		return;
+	}
+
+	key = tracker_collation_key (sqlite3_user_data (context),
+	                             (const gchar *) sqlite3_value_text (argv[0]),
+	                             sqlite3_value_bytes (argv[0]),
+	                             &key_len);
+
+	if (!key) {
+		sqlite3_result_null (context);
+		return;
+	}
+
+	sqlite3_result_blob (context, key, key_len, g_free);
+}
+
 static void
 function_sparql_cartesian_distance (sqlite3_context *context,
                                     int              argc,
@@ -1016,7 +1084,7 @@ open_database (TrackerDBInterface  *db_interface,
 	                         NULL, NULL);
 
 	sqlite3_extended_result_codes (db_interface->db, 0);
-	sqlite3_busy_timeout (db_interface->db, 100000);
+	sqlite3_busy_timeout (db_interface->db, BUSY_TIMEOUT);
 }
 
 static gboolean
@@ -1159,24 +1227,35 @@ tracker_db_interface_sqlite_fts_init (TrackerDBInterface  *db_interface,
 	fts_columns = _fts_create_properties (properties);
 
 	if (fts_columns) {
-		GString *insert, *select;
+		GString *insert, *select, *not_null;
 		gint i = 0;
 
 		insert = g_string_new ("INSERT INTO fts (docid");
 		select = g_string_new ("SELECT rowid");
+		not_null = g_string_new ("");
 
 		while (fts_columns[i]) {
 			g_string_append_printf (insert, ", \"%s\"",
 						fts_columns[i]);
 			g_string_append_printf (select, ", \"%s\"",
 						fts_columns[i]);
+			g_string_append_printf (not_null, "%s\"%s\" IS NOT NULL",
+						i > 0 ? " OR " : "",
+						fts_columns[i]);
 			i++;
 		}
 
-		g_string_append (select, " FROM fts_view WHERE rowid=?");
 		g_string_append (insert, ") ");
 		g_string_append (insert, select->str);
 
+		/* Bulk loads index every new resource with some text at once */
+		db_interface->fts_bulk_insert_str =
+			g_strdup_printf ("%s FROM fts_view WHERE rowid >= ? AND (%s)",
+			                 insert->str, not_null->str);
+
+		g_string_append (insert, " FROM fts_view WHERE rowid=?");
+
+		g_string_free (not_null, TRUE);
 		g_string_free (select, TRUE);
 		db_interface->fts_insert_str = g_string_free (insert, FALSE);
 
@@ -1186,14 +1265,28 @@ tracker_db_interface_sqlite_fts_init (TrackerDBInterface  *db_interface,
 }
 
 #if HAVE_TRACKER_FTS
-void
+gboolean
 tracker_db_interface_sqlite_fts_alter_table (TrackerDBInterface  *db_interface,
 					     GHashTable          *properties,
-					     GHashTable          *multivalued)
+					     GHashTable          *multivalued,
+					     GError             **error)
 {
 	if (!tracker_fts_alter_table (db_interface->db, "fts", properties, multivalued)) {
-		g_critical ("Failed to update FTS columns");
+		g_set_error (error,
+		             TRACKER_DB_INTERFACE_ERROR,
+		             TRACKER_DB_QUERY_ERROR,
+		             "Failed to update FTS columns: %s",
+		             sqlite3_errmsg (db_interface->db));
+		return FALSE;
 	}
+
+	return TRUE;
+}
+
+gboolean
+tracker_db_interface_sqlite_fts_prefix_lengths_changed (TrackerDBInterface *db_interface)
+{
+	return tracker_fts_prefix_lengths_changed (db_interface->db, "fts");
 }
 
 gboolean
@@ -1251,6 +1344,39 @@ tracker_db_interface_sqlite_fts_update_text (TrackerDBInterface  *db_interface,
 	return TRUE;
 }
 
+gboolean
+tracker_db_interface_sqlite_fts_insert_from (TrackerDBInterface  *db_interface,
+                                             int                  first_id,
+                                             GError             **error)
+{
+	TrackerDBStatement *stmt;
+	GError *internal_error = NULL;
+
+	if (!db_interface->fts_bulk_insert_str) {
+		/* No fulltext indexed properties */
+		return TRUE;
+	}
+
+	stmt = tracker_db_interface_create_statement (db_interface,
+	                                              TRACKER_DB_STATEMENT_CACHE_TYPE_NONE,
+	                                              &internal_error,
+	                                              "%s",
+	                                              db_interface->fts_bulk_insert_str);
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, first_id);
+		tracker_db_statement_execute (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 gboolean
 tracker_db_interface_sqlite_fts_delete_text (TrackerDBInterface *db_interface,
                                              int                 id,
@@ -1287,6 +1413,90 @@ tracker_db_interface_sqlite_fts_delete_text (TrackerDBInterface *db_interface,
 	return TRUE;
 }
 
+gboolean
+tracker_db_interface_sqlite_fts_merge (TrackerDBInterface  *db_interface,
+                                       gint                 n_pages,
+                                       gint                 min_segments,
+                                       GError             **error)
+{
+	GError *internal_error = NULL;
+	gint changes;
+
+	changes = sqlite3_total_changes (db_interface->db);
+
+	/* Incremental merge, see "merge=X,Y" in the FTS4 documentation */
+	tracker_db_interface_execute_query (db_interface,
+	                                    &internal_error,
+	                                    "INSERT INTO fts(fts) VALUES('merge=%d,%d')",
+	                                    n_pages, min_segments);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	/* Less than 2 rows changed means there was nothing left to merge */
+	return (sqlite3_total_changes (db_interface->db) - changes) >= 2;
+}
+
+gboolean
+tracker_db_interface_sqlite_fts_optimize (TrackerDBInterface  *db_interface,
+                                          GError             **error)
+{
+	GError *internal_error = NULL;
+
+	tracker_db_interface_execute_query (db_interface,
+	                                    &internal_error,
+	                                    "INSERT INTO fts(fts) VALUES('optimize')");
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+gint
+tracker_db_interface_sqlite_fts_get_segment_count (TrackerDBInterface *db_interface,
+                                                   gint               *n_levels)
+{
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gint n_segments = -1;
+
+	stmt = tracker_db_interface_create_statement (db_interface,
+	                                              TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT,
+	                                              &error,
+	                                              "SELECT COUNT(*), COUNT(DISTINCT level) "
+	                                              "FROM fts_segdir");
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &error);
+		g_object_unref (stmt);
+
+		if (cursor) {
+			if (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+				n_segments = tracker_db_cursor_get_int (cursor, 0);
+
+				if (n_levels) {
+					*n_levels = tracker_db_cursor_get_int (cursor, 1);
+				}
+			}
+
+			g_object_unref (cursor);
+		}
+	}
+
+	if (error) {
+		g_warning ("Could not get FTS segment count: %s", error->message);
+		g_error_free (error);
+	}
+
+	return n_segments;
+}
+
 #endif
 
 void
@@ -1305,6 +1515,18 @@ tracker_db_interface_sqlite_reset_collator (TrackerDBInterface *db_interface)
 		g_critical ("Couldn't set collation function: %s",
 		            sqlite3_errmsg (db_interface->db));
 	}
+
+	/* Sort keys need their own collator, for the same locale */
+	if (sqlite3_create_function_v2 (db_interface->db,
+	                                "SparqlCollationKey", 1, SQLITE_ANY,
+	                                tracker_collation_init (),
+	                                function_sparql_collation_key,
+	                                NULL, NULL,
+	                                tracker_collation_shutdown) != SQLITE_OK)
+	{
+		g_critical ("Couldn't set collation key function: %s",
+		            sqlite3_errmsg (db_interface->db));
+	}
 }
 
 static gint
@@ -1325,6 +1547,78 @@ tracker_db_interface_sqlite_wal_hook (TrackerDBInterface   *interface,
 	sqlite3_wal_hook (interface->db, wal_hook, callback);
 }
 
+/*
+ * Returns FALSE without setting @error if the checkpoint could not
+ * complete because of other connections, in which case @n_checkpointed
+ * tells how far it got. RESTART and TRUNCATE give up right away rather
+ * than waiting on readers, so they never stall writers for long.
+ */
+gboolean
+tracker_db_interface_sqlite_wal_checkpoint (TrackerDBInterface        *interface,
+                                            TrackerDBCheckpointMode    mode,
+                                            gint                      *n_log,
+                                            gint                      *n_checkpointed,
+                                            GError                   **error)
+{
+	gint sqlite_mode, log = -1, checkpointed = -1;
+	gint64 start;
+	gint result;
+
+	switch (mode) {
+	case TRACKER_DB_CHECKPOINT_RESTART:
+		sqlite_mode = SQLITE_CHECKPOINT_RESTART;
+		break;
+	case TRACKER_DB_CHECKPOINT_TRUNCATE:
+#ifdef SQLITE_CHECKPOINT_TRUNCATE
+		sqlite_mode = SQLITE_CHECKPOINT_TRUNCATE;
+#else
+		/* Needs SQLite 3.8.8, the WAL is then only rewound */
+		sqlite_mode = SQLITE_CHECKPOINT_RESTART;
+#endif
+		break;
+	case TRACKER_DB_CHECKPOINT_PASSIVE:
+	default:
+		sqlite_mode = SQLITE_CHECKPOINT_PASSIVE;
+		break;
+	}
+
+	if (sqlite_mode != SQLITE_CHECKPOINT_PASSIVE) {
+		sqlite3_busy_timeout (interface->db, 0);
+	}
+
+	start = tracker_trace_begin ();
+	result = sqlite3_wal_checkpoint_v2 (interface->db, NULL, sqlite_mode,
+	                                    &log, &checkpointed);
+	tracker_trace_end (TRACKER_TRACE_CHECKPOINT, start);
+
+	if (sqlite_mode != SQLITE_CHECKPOINT_PASSIVE) {
+		sqlite3_busy_timeout (interface->db, BUSY_TIMEOUT);
+	}
+
+	if (n_log) {
+		*n_log = log;
+	}
+
+	if (n_checkpointed) {
+		*n_checkpointed = checkpointed;
+	}
+
+	if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+		return FALSE;
+	} else if (result != SQLITE_OK) {
+		g_set_error (error,
+		             TRACKER_DB_INTERFACE_ERROR,
+		             TRACKER_DB_QUERY_ERROR,
+		             "Could not checkpoint WAL: %s",
+		             sqlite3_errmsg (interface->db));
+		return FALSE;
+	}
+
+	/* A passive checkpoint is only complete if readers let it
+	 * copy back every frame */
+	return (log == checkpointed);
+}
+
 
 static void
 tracker_db_interface_sqlite_finalize (GObject *object)
@@ -1335,6 +1629,7 @@ tracker_db_interface_sqlite_finalize (GObject *object)
 
 	close_database (db_interface);
 	g_free (db_interface->fts_insert_str);
+	g_free (db_interface->fts_bulk_insert_str);
 
 	g_message ("Closed sqlite3 database:'%s'", db_interface->filename);
 
@@ -1604,6 +1899,7 @@ execute_stmt (TrackerDBInterface  *interface,
               GCancellable        *cancellable,
               GError             **error)
 {
+	gint64 start;
 	gint result;
 
 	result = SQLITE_OK;
@@ -1615,6 +1911,8 @@ execute_stmt (TrackerDBInterface  *interface,
 		tracker_db_interface_sqlite_reset_collator (interface);
 	}
 
+	start = tracker_trace_begin ();
+
 	while (result == SQLITE_OK  ||
 	       result == SQLITE_ROW) {
 
@@ -1640,6 +1938,7 @@ execute_stmt (TrackerDBInterface  *interface,
 		}
 	}
 
+	tracker_trace_end (TRACKER_TRACE_SQLITE_STATEMENT, start);
 
 	if (result == SQLITE_DONE) {
 		/* Statement finished, check if we got a request to reset the
@@ -1791,6 +2090,31 @@ tracker_db_interface_sqlite_get_last_insert_id (TrackerDBInterface *interface)
 	return (gint64) sqlite3_last_insert_rowid (interface->db);
 }
 
+/* How many rows of @n_values values a single INSERT ... VALUES may
+ * write, 1 if SQLite can not write several rows at once */
+guint
+tracker_db_interface_sqlite_get_max_insert_rows (TrackerDBInterface *interface,
+                                                 guint               n_values)
+{
+	gint max_rows;
+
+	g_return_val_if_fail (TRACKER_IS_DB_INTERFACE (interface), 1);
+
+	/* Multi-row VALUES came with 3.7.11 */
+	if (sqlite3_libversion_number () < 3007011 || n_values == 0) {
+		return 1;
+	}
+
+	max_rows = sqlite3_limit (interface->db, SQLITE_LIMIT_VARIABLE_NUMBER, -1) / n_values;
+
+	/* Before 3.8.8 every row counted as a compound SELECT term */
+	if (sqlite3_libversion_number () < 3008008) {
+		max_rows = MIN (max_rows, sqlite3_limit (interface->db, SQLITE_LIMIT_COMPOUND_SELECT, -1));
+	}
+
+	return MAX (max_rows, 1);
+}
+
 static void
 tracker_db_statement_finalize (GObject *object)
 {
@@ -1833,6 +2157,17 @@ tracker_db_statement_sqlite_new (TrackerDBInterface *db_interface,
 	return stmt;
 }
 
+static void
+db_cursor_trace_end (TrackerDBCursor *cursor)
+{
+	/* Statements are timed from their first step until they are
+	 * done or dropped, rather than on every row */
+	if (cursor->trace_start != 0) {
+		tracker_trace_end (TRACKER_TRACE_SQLITE_STATEMENT, cursor->trace_start);
+		cursor->trace_start = 0;
+	}
+}
+
 static void
 tracker_db_cursor_close (TrackerDBCursor *cursor)
 {
@@ -1845,6 +2180,8 @@ tracker_db_cursor_close (TrackerDBCursor *cursor)
 		return;
 	}
 
+	db_cursor_trace_end (cursor);
+
 	/* As soon as we finalize the cursor, check if we need a collator reset
 	 * and notify the iface about the removed cursor */
 	iface = cursor->ref_stmt->db_interface;
@@ -2083,6 +2420,7 @@ tracker_db_cursor_rewind (TrackerDBCursor *cursor)
 		tracker_db_manager_lock ();
 	}
 
+	db_cursor_trace_end (cursor);
 	sqlite3_reset (cursor->stmt);
 	cursor->finished = FALSE;
 
@@ -2123,6 +2461,10 @@ db_cursor_iter_next (TrackerDBCursor *cursor,
 			result = SQLITE_INTERRUPT;
 			sqlite3_reset (cursor->stmt);
 		} else {
+			if (cursor->trace_start == 0) {
+				cursor->trace_start = tracker_trace_begin ();
+			}
+
 			/* only one statement can be active at the same time per interface */
 			iface->cancellable = cancellable;
 			result = stmt_step (cursor->stmt);
@@ -2143,6 +2485,10 @@ db_cursor_iter_next (TrackerDBCursor *cursor,
 
 		cursor->finished = (result != SQLITE_ROW);
 
+		if (cursor->finished) {
+			db_cursor_trace_end (cursor);
+		}
+
 		if (cursor->threadsafe) {
 			tracker_db_manager_unlock ();
 		}
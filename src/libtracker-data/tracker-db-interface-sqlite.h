@@ -34,12 +34,25 @@ G_BEGIN_DECLS
 
 typedef void (*TrackerDBWalCallback) (gint n_pages);
 
+typedef enum {
+	TRACKER_DB_CHECKPOINT_PASSIVE,
+	TRACKER_DB_CHECKPOINT_RESTART,
+	TRACKER_DB_CHECKPOINT_TRUNCATE
+} TrackerDBCheckpointMode;
+
 TrackerDBInterface *tracker_db_interface_sqlite_new                    (const gchar              *filename,
                                                                         GError                  **error);
 TrackerDBInterface *tracker_db_interface_sqlite_new_ro                 (const gchar              *filename,
                                                                         GError                  **error);
 gint64              tracker_db_interface_sqlite_get_last_insert_id     (TrackerDBInterface       *interface);
+guint               tracker_db_interface_sqlite_get_max_insert_rows    (TrackerDBInterface       *interface,
+                                                                        guint                     n_values);
 void                tracker_db_interface_sqlite_enable_shared_cache    (void);
+void                tracker_db_interface_sqlite_set_heap_limit         (gint64                    limit);
+void                tracker_db_interface_sqlite_get_cache_stats        (TrackerDBInterface       *interface,
+                                                                        gint64                   *hits,
+                                                                        gint64                   *misses,
+                                                                        gint64                   *used);
 void                tracker_db_interface_sqlite_fts_init               (TrackerDBInterface       *interface,
                                                                         GHashTable               *properties,
                                                                         GHashTable               *multivalued,
@@ -47,20 +60,38 @@ void                tracker_db_interface_sqlite_fts_init               (TrackerD
 void                tracker_db_interface_sqlite_reset_collator         (TrackerDBInterface       *interface);
 void                tracker_db_interface_sqlite_wal_hook               (TrackerDBInterface       *interface,
                                                                         TrackerDBWalCallback      callback);
+gboolean            tracker_db_interface_sqlite_wal_checkpoint         (TrackerDBInterface       *interface,
+                                                                        TrackerDBCheckpointMode   mode,
+                                                                        gint                     *n_log,
+                                                                        gint                     *n_checkpointed,
+                                                                        GError                  **error);
 
 #if HAVE_TRACKER_FTS
-void                tracker_db_interface_sqlite_fts_alter_table        (TrackerDBInterface       *interface,
+gboolean            tracker_db_interface_sqlite_fts_alter_table        (TrackerDBInterface       *interface,
                                                                         GHashTable               *properties,
-                                                                        GHashTable               *multivalued);
+                                                                        GHashTable               *multivalued,
+                                                                        GError                  **error);
 int                 tracker_db_interface_sqlite_fts_update_text        (TrackerDBInterface       *interface,
                                                                         int                       id,
                                                                         const gchar             **properties,
                                                                         const char              **text,
                                                                         gboolean                  create);
 
+gboolean            tracker_db_interface_sqlite_fts_insert_from        (TrackerDBInterface       *interface,
+                                                                        int                       first_id,
+                                                                        GError                  **error);
 gboolean            tracker_db_interface_sqlite_fts_delete_text        (TrackerDBInterface       *db_interface,
 									int                       id,
 									const gchar              *property);
+gboolean            tracker_db_interface_sqlite_fts_prefix_lengths_changed (TrackerDBInterface *interface);
+gboolean            tracker_db_interface_sqlite_fts_merge              (TrackerDBInterface       *interface,
+                                                                        gint                      n_pages,
+                                                                        gint                      min_segments,
+                                                                        GError                  **error);
+gboolean            tracker_db_interface_sqlite_fts_optimize           (TrackerDBInterface       *interface,
+                                                                        GError                  **error);
+gint                tracker_db_interface_sqlite_fts_get_segment_count  (TrackerDBInterface       *interface,
+                                                                        gint                     *n_levels);
 void                tracker_db_interface_sqlite_fts_update_commit      (TrackerDBInterface       *interface);
 void                tracker_db_interface_sqlite_fts_update_rollback    (TrackerDBInterface       *interface);
 #endif
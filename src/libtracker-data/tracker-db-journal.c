@@ -40,6 +40,7 @@
 #endif
 
 #include <libtracker-common/tracker-crc32.h>
+#include <libtracker-common/tracker-trace.h>
 
 #include "tracker-db-journal.h"
 
@@ -1145,6 +1146,7 @@ db_journal_writer_commit_db_transaction (JournalWriter  *jwriter,
 	guint begin_pos;
 	guint size;
 	guint offset;
+	gint64 start;
 
 	g_return_val_if_fail (jwriter->journal > 0, FALSE);
 
@@ -1172,10 +1174,14 @@ db_journal_writer_commit_db_transaction (JournalWriter  *jwriter,
 	crc = tracker_crc32 (jwriter->cur_block + offset, jwriter->cur_block_len - offset);
 	cur_setnum (jwriter->cur_block, &begin_pos, crc);
 
+	start = tracker_trace_begin ();
+
 	if (!write_all_data (jwriter->journal, jwriter->cur_block, jwriter->cur_block_len, error)) {
 		return FALSE;
 	}
 
+	tracker_trace_end (TRACKER_TRACE_JOURNAL_WRITE, start);
+
 	/* Update journal size */
 	jwriter->cur_size += jwriter->cur_block_len;
 
@@ -1219,9 +1225,16 @@ tracker_db_journal_commit_db_transaction (GError **error)
 gboolean
 tracker_db_journal_fsync (void)
 {
+	gboolean retval;
+	gint64 start;
+
 	g_return_val_if_fail (writer.journal > 0, FALSE);
 
-	return fsync (writer.journal) == 0;
+	start = tracker_trace_begin ();
+	retval = fsync (writer.journal) == 0;
+	tracker_trace_end (TRACKER_TRACE_JOURNAL_FSYNC, start);
+
+	return retval;
 }
 
 /*
@@ -42,6 +42,8 @@
 #include <libtracker-fts/tracker-fts.h>
 #endif
 
+#include "tracker-db-backup.h"
+#include "tracker-db-config.h"
 #include "tracker-db-journal.h"
 #include "tracker-db-manager.h"
 #include "tracker-db-interface-sqlite.h"
@@ -141,6 +143,8 @@ static TrackerDBDefinition dbs[] = {
 	  0 },
 };
 
+static void                db_register_connection                   (TrackerDBInterface   *iface,
+                                                                     const gchar          *name);
 static gboolean            db_exec_no_reply                        (TrackerDBInterface   *iface,
                                                                     const gchar          *query,
                                                                     ...);
@@ -164,6 +168,20 @@ static guint                 u_cache_size;
 
 static GPrivate              interface_data_key = G_PRIVATE_INIT ((GDestroyNotify)g_object_unref);
 
+/* Memory settings from TrackerDBConfig, in bytes and KiB */
+static gint64                mmap_size;
+static gint                  cache_memory;
+
+/* All open connections, for cache statistics */
+typedef struct {
+	TrackerDBInterface *iface;
+	gchar *name;
+} ConnectionInfo;
+
+static GMutex                connections_mutex;
+static GList                *connections;
+static guint                 connections_serial;
+
 /* mutex used by singleton connection in libtracker-direct, not used by tracker-store */
 static GMutex                global_mutex;
 
@@ -210,6 +228,7 @@ tracker_db_manager_get_flags (guint *select_cache_size, guint *update_cache_size
 
 static void
 db_set_params (TrackerDBInterface   *iface,
+               const gchar          *name,
                gint                  cache_size,
                gint                  page_size,
                GError              **error)
@@ -278,9 +297,138 @@ db_set_params (TrackerDBInterface   *iface,
 			tracker_db_interface_execute_query (iface, NULL, "PRAGMA page_size = %d", page_size);
 		}
 
-		tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", cache_size);
-		g_message ("  Setting cache size to %d", cache_size);
+		if (cache_memory > 0) {
+			/* Negative values are in KiB, the soft heap limit
+			 * keeps all connections together within this size */
+			tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", -cache_memory);
+			g_message ("  Setting shared cache size to %d KiB", cache_memory);
+		} else {
+			tracker_db_interface_execute_query (iface, NULL, "PRAGMA cache_size = %d", cache_size);
+			g_message ("  Setting cache size to %d", cache_size);
+		}
+
+		if (mmap_size > 0) {
+			/* Pages read through the mapping live in the OS page
+			 * cache, shared by all connections and processes */
+			tracker_db_interface_execute_query (iface, NULL, "PRAGMA mmap_size = %" G_GINT64_FORMAT, mmap_size);
+		}
+	}
+
+	db_register_connection (iface, name);
+}
+
+static void
+connection_info_free (ConnectionInfo *info)
+{
+	g_free (info->name);
+	g_slice_free (ConnectionInfo, info);
+}
+
+static void
+db_connection_finalized (gpointer  user_data,
+                         GObject  *where_the_object_was)
+{
+	GList *l;
+
+	g_mutex_lock (&connections_mutex);
+
+	for (l = connections; l; l = l->next) {
+		ConnectionInfo *info = l->data;
+
+		if ((GObject *) info->iface == where_the_object_was) {
+			connections = g_list_delete_link (connections, l);
+			connection_info_free (info);
+			break;
+		}
+	}
+
+	g_mutex_unlock (&connections_mutex);
+}
+
+static void
+db_register_connection (TrackerDBInterface *iface,
+                        const gchar        *name)
+{
+	ConnectionInfo *info;
+
+	info = g_slice_new (ConnectionInfo);
+	info->iface = iface;
+
+	g_mutex_lock (&connections_mutex);
+	info->name = g_strdup_printf ("%s#%u", name, ++connections_serial);
+	connections = g_list_prepend (connections, info);
+	g_mutex_unlock (&connections_mutex);
+
+	g_object_weak_ref (G_OBJECT (iface), db_connection_finalized, NULL);
+}
+
+static void
+db_init_memory_settings (void)
+{
+	TrackerDBConfig *db_config;
+
+	db_config = tracker_db_config_new ();
+	mmap_size = (gint64) tracker_db_config_get_mmap_size (db_config) * 1024 * 1024;
+	cache_memory = tracker_db_config_get_cache_memory (db_config) * 1024;
+	g_object_unref (db_config);
+
+	if (mmap_size > 0) {
+		g_message ("Using memory mapped I/O for up to %" G_GINT64_FORMAT " bytes",
+		           mmap_size);
+	}
+
+	if (cache_memory > 0) {
+		tracker_db_interface_sqlite_set_heap_limit ((gint64) cache_memory * 1024);
+	}
+}
+
+/**
+ * tracker_db_manager_get_cache_size:
+ *
+ * Returns the value to restore PRAGMA cache_size to after temporarily
+ * changing it, either a size in pages or, if negative, in KiB.
+ **/
+gint
+tracker_db_manager_get_cache_size (void)
+{
+	if (cache_memory > 0) {
+		return -cache_memory;
+	}
+
+	return TRACKER_DB_CACHE_SIZE_DEFAULT;
+}
+
+/**
+ * tracker_db_manager_get_cache_statistics:
+ *
+ * Gets page cache statistics for every open database connection.
+ *
+ * returns: (transfer full): a #GVariant of type a(sxxx), holding the
+ * connection name, cache hits, cache misses and bytes used by the cache
+ **/
+GVariant *
+tracker_db_manager_get_cache_statistics (void)
+{
+	GVariantBuilder builder;
+	GList *l;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sxxx)"));
+
+	g_mutex_lock (&connections_mutex);
+
+	for (l = connections; l; l = l->next) {
+		ConnectionInfo *info = l->data;
+		gint64 hits, misses, used;
+
+		tracker_db_interface_sqlite_get_cache_stats (info->iface,
+		                                             &hits, &misses, &used);
+		g_variant_builder_add (&builder, "(sxxx)",
+		                       info->name, hits, misses, used);
 	}
+
+	g_mutex_unlock (&connections_mutex);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
 }
 
 
@@ -333,6 +481,7 @@ db_interface_get (TrackerDB   type,
 	}
 
 	db_set_params (iface,
+	               dbs[type].name,
 	               dbs[type].cache_size,
 	               dbs[type].page_size,
 	               &internal_error);
@@ -980,7 +1129,16 @@ tracker_db_manager_init (TrackerDBManagerFlags   flags,
 		}
 	}
 
+#ifdef DISABLE_JOURNAL
+	if ((flags & TRACKER_DB_MANAGER_READONLY) == 0) {
+		/* Lets backups copy only the pages changed since the last one */
+		tracker_db_backup_track_changes (dbs[TRACKER_DB_METADATA].abs_filename);
+	}
+#endif /* DISABLE_JOURNAL */
+
 	/* Set general database options */
+	db_init_memory_settings ();
+
 	if (shared_cache) {
 		g_message ("Enabling database shared cache");
 		tracker_db_interface_sqlite_enable_shared_cache ();
@@ -1387,6 +1545,7 @@ tracker_db_manager_get_db_interfaces (GError **error,
 			}
 
 			db_set_params (connection,
+			               dbs[db].name,
 			               dbs[db].cache_size,
 			               dbs[db].page_size,
 			               &internal_error);
@@ -1439,6 +1598,7 @@ tracker_db_manager_get_db_interfaces_ro (GError **error,
 			}
 
 			db_set_params (connection,
+			               dbs[db].name,
 			               dbs[db].cache_size,
 			               dbs[db].page_size,
 			               &internal_error);
@@ -71,6 +71,9 @@ static GvdbTable *gvdb_namespaces_table;
 static GvdbTable *gvdb_classes_table;
 static GvdbTable *gvdb_properties_table;
 
+/* Stamp of the snapshot the ontology was loaded from or written to */
+static gchar      *snapshot_stamp;
+
 void
 tracker_ontologies_init (void)
 {
@@ -175,6 +178,9 @@ tracker_ontologies_shutdown (void)
 		gvdb_table = NULL;
 	}
 
+	g_free (snapshot_stamp);
+	snapshot_stamp = NULL;
+
 	initialized = FALSE;
 }
 
@@ -560,6 +566,10 @@ tracker_ontologies_write_gvdb (const gchar  *filename,
 			gvdb_hash_table_insert_variant (table, item, uri, "fulltext-indexed", g_variant_new_boolean (TRUE));
 		}
 
+		if (tracker_property_get_sort_key (property)) {
+			gvdb_hash_table_insert_variant (table, item, uri, "sort-key", g_variant_new_boolean (TRUE));
+		}
+
 		domain_indexes = tracker_property_get_domain_indexes (property);
 		if (domain_indexes) {
 			g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
@@ -597,6 +607,414 @@ tracker_ontologies_load_gvdb (const gchar  *filename,
 	gvdb_properties_table = gvdb_table_get_table (gvdb_table, "properties");
 }
 
+/* Bump whenever the layout below changes, older snapshots are then
+ * ignored and rewritten from the database */
+#define SNAPSHOT_VERSION 2
+
+/* (version, stamp, ontologies, namespaces, classes, properties), see
+ * tracker_ontologies_write_snapshot() for the fields of each entry */
+#define SNAPSHOT_TYPE "(usa(sx)a(ss)a(isbasas)a(isssbbsbbbbbbmsas))"
+
+static GVariant *
+snapshot_class_uris (TrackerClass **list)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
+
+	while (list && *list) {
+		g_variant_builder_add (&builder, "s", tracker_class_get_uri (*list));
+		list++;
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+static GVariant *
+snapshot_property_uris (TrackerProperty **list)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
+
+	while (list && *list) {
+		g_variant_builder_add (&builder, "s", tracker_property_get_uri (*list));
+		list++;
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+/*
+ * Unlike the gvdb file, which only answers the handful of lookups
+ * libtracker-direct needs, the snapshot holds everything
+ * db_get_static_data() reads from the database, so the complete
+ * ontology model can be rebuilt without running a single query.
+ * Table, column and index names are derived from the URIs and the
+ * flags stored here.
+ */
+gboolean
+tracker_ontologies_write_snapshot (const gchar  *filename,
+                                   const gchar  *stamp,
+                                   GError      **error)
+{
+	GVariantBuilder builder;
+	GVariant *snapshot;
+	gboolean retval;
+	gint i;
+
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (stamp != NULL, FALSE);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE (SNAPSHOT_TYPE));
+	g_variant_builder_add (&builder, "u", SNAPSHOT_VERSION);
+	g_variant_builder_add (&builder, "s", stamp);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sx)"));
+	for (i = 0; i < ontologies->len; i++) {
+		TrackerOntology *ontology;
+
+		ontology = ontologies->pdata[i];
+
+		g_variant_builder_add (&builder, "(sx)",
+		                       tracker_ontology_get_uri (ontology),
+		                       (gint64) tracker_ontology_get_last_modified (ontology));
+	}
+	g_variant_builder_close (&builder);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(ss)"));
+	for (i = 0; i < namespaces->len; i++) {
+		TrackerNamespace *namespace;
+
+		namespace = namespaces->pdata[i];
+
+		g_variant_builder_add (&builder, "(ss)",
+		                       tracker_namespace_get_uri (namespace),
+		                       tracker_namespace_get_prefix (namespace));
+	}
+	g_variant_builder_close (&builder);
+
+	/* id, uri, notify, super classes, domain indexes */
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(isbasas)"));
+	for (i = 0; i < classes->len; i++) {
+		TrackerClass *class;
+
+		class = classes->pdata[i];
+
+		g_variant_builder_add (&builder, "(isb@as@as)",
+		                       tracker_class_get_id (class),
+		                       tracker_class_get_uri (class),
+		                       tracker_class_get_notify (class),
+		                       snapshot_class_uris (tracker_class_get_super_classes (class)),
+		                       snapshot_property_uris (tracker_class_get_domain_indexes (class)));
+	}
+	g_variant_builder_close (&builder);
+
+	/* id, uri, domain, range, multiple values, indexed, secondary
+	 * index ("" if none), fulltext indexed, transient, writeback,
+	 * inverse functional, force journal, sort key, default value,
+	 * super properties */
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(isssbbsbbbbbbmsas)"));
+	for (i = 0; i < properties->len; i++) {
+		TrackerProperty *property, *secondary_index;
+
+		property = properties->pdata[i];
+		secondary_index = tracker_property_get_secondary_index (property);
+
+		g_variant_builder_add (&builder, "(isssbbsbbbbbbms@as)",
+		                       tracker_property_get_id (property),
+		                       tracker_property_get_uri (property),
+		                       tracker_class_get_uri (tracker_property_get_domain (property)),
+		                       tracker_class_get_uri (tracker_property_get_range (property)),
+		                       tracker_property_get_multiple_values (property),
+		                       tracker_property_get_indexed (property),
+		                       secondary_index ? tracker_property_get_uri (secondary_index) : "",
+		                       tracker_property_get_fulltext_indexed (property),
+		                       tracker_property_get_transient (property),
+		                       tracker_property_get_writeback (property),
+		                       tracker_property_get_is_inverse_functional_property (property),
+		                       tracker_property_get_force_journal (property),
+		                       tracker_property_get_sort_key (property),
+		                       tracker_property_get_default_value (property),
+		                       snapshot_property_uris (tracker_property_get_super_properties (property)));
+	}
+	g_variant_builder_close (&builder);
+
+	snapshot = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+	/* g_file_set_contents() replaces the file atomically, so readers
+	 * that still have the previous snapshot mapped are not affected */
+	retval = g_file_set_contents (filename,
+	                              g_variant_get_data (snapshot),
+	                              g_variant_get_size (snapshot),
+	                              error);
+
+	g_variant_unref (snapshot);
+
+	if (retval) {
+		g_free (snapshot_stamp);
+		snapshot_stamp = g_strdup (stamp);
+	}
+
+	return retval;
+}
+
+static gboolean
+snapshot_corrupt (const gchar  *filename,
+                  GError      **error)
+{
+	/* Leave no partially loaded ontology behind */
+	tracker_ontologies_shutdown ();
+	tracker_ontologies_init ();
+
+	g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+	             "Ontology snapshot '%s' is corrupt", filename);
+
+	return FALSE;
+}
+
+/*
+ * Returns FALSE without setting @error if the snapshot was written by
+ * another version or for a database other than the one described by
+ * @stamp.
+ */
+gboolean
+tracker_ontologies_load_snapshot (const gchar  *filename,
+                                  const gchar  *stamp,
+                                  GError      **error)
+{
+	GMappedFile *mapped_file;
+	GVariant *snapshot, *list, *classes_list, *properties_list;
+	GVariant *uris, *domain_indexes;
+	GVariantIter iter;
+	const gchar *file_stamp, *uri, *prefix;
+	const gchar *domain_uri, *range_uri, *secondary_index_uri, *default_value;
+	gboolean notify, multiple_values, indexed, fulltext_indexed;
+	gboolean transient, writeback, inverse_functional, force_journal;
+	gboolean sort_key;
+	gint64 last_modified;
+	guint32 version;
+	gint id;
+
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (stamp != NULL, FALSE);
+
+	tracker_ontologies_shutdown ();
+
+	tracker_ontologies_init ();
+
+	mapped_file = g_mapped_file_new (filename, FALSE, error);
+	if (!mapped_file) {
+		return FALSE;
+	}
+
+	/* Not trusted: a truncated or foreign file must not crash us,
+	 * GVariant hands out default values for malformed data instead */
+	snapshot = g_variant_new_from_data (G_VARIANT_TYPE (SNAPSHOT_TYPE),
+	                                    g_mapped_file_get_contents (mapped_file),
+	                                    g_mapped_file_get_length (mapped_file),
+	                                    FALSE,
+	                                    (GDestroyNotify) g_mapped_file_unref,
+	                                    mapped_file);
+	g_variant_ref_sink (snapshot);
+
+	g_variant_get_child (snapshot, 0, "u", &version);
+	g_variant_get_child (snapshot, 1, "&s", &file_stamp);
+
+	if (version != SNAPSHOT_VERSION || strcmp (file_stamp, stamp) != 0) {
+		g_debug ("Ontology snapshot '%s' is out of date", filename);
+		g_variant_unref (snapshot);
+		return FALSE;
+	}
+
+	list = g_variant_get_child_value (snapshot, 2);
+	g_variant_iter_init (&iter, list);
+	while (g_variant_iter_next (&iter, "(&sx)", &uri, &last_modified)) {
+		TrackerOntology *ontology;
+
+		ontology = tracker_ontology_new ();
+		tracker_ontology_set_is_new (ontology, FALSE);
+		tracker_ontology_set_uri (ontology, uri);
+		tracker_ontology_set_last_modified (ontology, (time_t) last_modified);
+		tracker_ontologies_add_ontology (ontology);
+
+		g_object_unref (ontology);
+	}
+	g_variant_unref (list);
+
+	list = g_variant_get_child_value (snapshot, 3);
+	g_variant_iter_init (&iter, list);
+	while (g_variant_iter_next (&iter, "(&s&s)", &uri, &prefix)) {
+		TrackerNamespace *namespace;
+
+		namespace = tracker_namespace_new (FALSE);
+		tracker_namespace_set_is_new (namespace, FALSE);
+		tracker_namespace_set_uri (namespace, uri);
+		tracker_namespace_set_prefix (namespace, prefix);
+		tracker_ontologies_add_namespace (namespace);
+
+		g_object_unref (namespace);
+	}
+	g_variant_unref (list);
+
+	/* Classes and properties refer to each other, so create all of
+	 * them first and link them up afterwards */
+	classes_list = g_variant_get_child_value (snapshot, 4);
+	g_variant_iter_init (&iter, classes_list);
+	while (g_variant_iter_next (&iter, "(i&sb@as@as)", &id, &uri, &notify, NULL, NULL)) {
+		TrackerClass *class;
+
+		class = tracker_class_new (FALSE);
+		tracker_class_set_db_schema_changed (class, FALSE);
+		tracker_class_set_is_new (class, FALSE);
+		tracker_class_set_uri (class, uri);
+		tracker_class_set_notify (class, notify);
+
+		tracker_ontologies_add_class (class);
+		tracker_ontologies_add_id_uri_pair (id, uri);
+		tracker_class_set_id (class, id);
+
+		g_object_unref (class);
+	}
+
+	properties_list = g_variant_get_child_value (snapshot, 5);
+	g_variant_iter_init (&iter, properties_list);
+	while (g_variant_iter_next (&iter, "(i&s&s&sbb&sbbbbbbm&s@as)",
+	                            &id, &uri, &domain_uri, &range_uri,
+	                            &multiple_values, &indexed, NULL,
+	                            &fulltext_indexed, &transient, &writeback,
+	                            &inverse_functional, &force_journal,
+	                            &sort_key, &default_value, NULL)) {
+		TrackerProperty *property;
+		TrackerClass *domain, *range;
+
+		domain = tracker_ontologies_get_class_by_uri (domain_uri);
+		range = tracker_ontologies_get_class_by_uri (range_uri);
+
+		if (!domain || !range) {
+			goto corrupt;
+		}
+
+		property = tracker_property_new (FALSE);
+		tracker_property_set_is_new_domain_index (property, domain, FALSE);
+		tracker_property_set_is_new (property, FALSE);
+		tracker_property_set_transient (property, transient);
+		tracker_property_set_uri (property, uri);
+		tracker_property_set_id (property, id);
+		tracker_property_set_domain (property, domain);
+		tracker_property_set_range (property, range);
+		tracker_property_set_multiple_values (property, multiple_values);
+		tracker_property_set_indexed (property, indexed);
+		tracker_property_set_default_value (property, default_value);
+		tracker_property_set_force_journal (property, force_journal);
+		tracker_property_set_sort_key (property, sort_key);
+		tracker_property_set_db_schema_changed (property, FALSE);
+		tracker_property_set_writeback (property, writeback);
+		tracker_property_set_fulltext_indexed (property, fulltext_indexed);
+		tracker_property_set_is_inverse_functional_property (property, inverse_functional);
+
+		tracker_ontologies_add_property (property);
+		tracker_ontologies_add_id_uri_pair (id, uri);
+
+		g_object_unref (property);
+	}
+
+	g_variant_iter_init (&iter, properties_list);
+	while (g_variant_iter_next (&iter, "(i&s&s&sbb&sbbbbbbm&s@as)",
+	                            NULL, &uri, NULL, NULL, NULL, NULL,
+	                            &secondary_index_uri, NULL, NULL, NULL,
+	                            NULL, NULL, NULL, NULL, &uris)) {
+		TrackerProperty *property, *related;
+		GVariantIter uri_iter;
+		const gchar *related_uri;
+
+		property = tracker_ontologies_get_property_by_uri (uri);
+
+		if (secondary_index_uri[0] != '\0') {
+			related = tracker_ontologies_get_property_by_uri (secondary_index_uri);
+			if (!related) {
+				g_variant_unref (uris);
+				goto corrupt;
+			}
+
+			tracker_property_set_secondary_index (property, related);
+		}
+
+		g_variant_iter_init (&uri_iter, uris);
+		while (g_variant_iter_next (&uri_iter, "&s", &related_uri)) {
+			related = tracker_ontologies_get_property_by_uri (related_uri);
+			if (!related) {
+				g_variant_unref (uris);
+				goto corrupt;
+			}
+
+			tracker_property_add_super_property (property, related);
+		}
+
+		g_variant_unref (uris);
+	}
+
+	g_variant_iter_init (&iter, classes_list);
+	while (g_variant_iter_next (&iter, "(i&sb@as@as)", NULL, &uri, NULL, &uris, &domain_indexes)) {
+		TrackerClass *class, *super_class;
+		TrackerProperty *domain_index;
+		GVariantIter uri_iter;
+		const gchar *related_uri;
+		gboolean valid = TRUE;
+
+		class = tracker_ontologies_get_class_by_uri (uri);
+
+		g_variant_iter_init (&uri_iter, uris);
+		while (valid && g_variant_iter_next (&uri_iter, "&s", &related_uri)) {
+			super_class = tracker_ontologies_get_class_by_uri (related_uri);
+			valid = (super_class != NULL);
+
+			if (valid) {
+				tracker_class_add_super_class (class, super_class);
+			}
+		}
+
+		g_variant_iter_init (&uri_iter, domain_indexes);
+		while (valid && g_variant_iter_next (&uri_iter, "&s", &related_uri)) {
+			domain_index = tracker_ontologies_get_property_by_uri (related_uri);
+			valid = (domain_index != NULL);
+
+			if (valid) {
+				tracker_class_add_domain_index (class, domain_index);
+				tracker_property_add_domain_index (domain_index, class);
+			}
+		}
+
+		g_variant_unref (uris);
+		g_variant_unref (domain_indexes);
+
+		if (!valid) {
+			goto corrupt;
+		}
+	}
+
+	g_variant_unref (properties_list);
+	g_variant_unref (classes_list);
+	g_variant_unref (snapshot);
+
+	snapshot_stamp = g_strdup (stamp);
+
+	return TRUE;
+
+corrupt:
+	g_variant_unref (properties_list);
+	g_variant_unref (classes_list);
+	g_variant_unref (snapshot);
+
+	return snapshot_corrupt (filename, error);
+}
+
+const gchar *
+tracker_ontologies_get_snapshot_stamp (void)
+{
+	return snapshot_stamp;
+}
+
 GVariant *
 tracker_ontologies_get_namespace_value_gvdb (const gchar *uri,
                                              const gchar *predicate)
@@ -64,6 +64,13 @@ void               tracker_ontologies_write_gvdb           (const gchar      *fi
                                                             GError          **error);
 void               tracker_ontologies_load_gvdb            (const gchar      *filename,
                                                             GError          **error);
+gboolean           tracker_ontologies_write_snapshot       (const gchar      *filename,
+                                                            const gchar      *stamp,
+                                                            GError          **error);
+gboolean           tracker_ontologies_load_snapshot        (const gchar      *filename,
+                                                            const gchar      *stamp,
+                                                            GError          **error);
+const gchar *      tracker_ontologies_get_snapshot_stamp   (void);
 GVariant *         tracker_ontologies_get_namespace_value_gvdb  (const gchar      *uri,
                                                                  const gchar      *predicate);
 const gchar *      tracker_ontologies_get_namespace_string_gvdb (const gchar      *uri,
@@ -52,6 +52,7 @@ struct _TrackerPropertyPrivate {
 	TrackerClass   *domain_index;
 	TrackerClass   *range;
 	gint           weight;
+	gint           count;
 	gint           id;
 	gboolean       indexed;
 	TrackerProperty *secondary_index;
@@ -63,6 +64,7 @@ struct _TrackerPropertyPrivate {
 	gboolean       is_new;
 	gboolean       db_schema_changed;
 	gboolean       writeback;
+	gboolean       sort_key;
 	gchar         *default_value;
 	GPtrArray     *is_new_domain_index;
 	gboolean       force_journal;
@@ -421,6 +423,18 @@ tracker_property_get_weight (TrackerProperty *property)
 	return priv->weight;
 }
 
+gint
+tracker_property_get_count (TrackerProperty *property)
+{
+	TrackerPropertyPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_PROPERTY (property), 0);
+
+	priv = GET_PRIV (property);
+
+	return priv->count;
+}
+
 gint
 tracker_property_get_id (TrackerProperty *property)
 {
@@ -536,6 +550,37 @@ tracker_property_get_writeback (TrackerProperty *property)
 	return priv->writeback;
 }
 
+gboolean
+tracker_property_get_sort_key (TrackerProperty *property)
+{
+	TrackerPropertyPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_PROPERTY (property), FALSE);
+
+	priv = GET_PRIV (property);
+
+	if (priv->use_gvdb) {
+		GVariant *value;
+		gboolean result;
+
+		value = tracker_ontologies_get_property_value_gvdb (priv->uri, "sort-key");
+		if (value != NULL) {
+			result = g_variant_get_boolean (value);
+			g_variant_unref (value);
+		} else {
+			result = FALSE;
+		}
+
+		return result;
+	}
+
+	/* Collation keys are only kept in the table of the domain, for
+	 * single valued strings */
+	return (priv->sort_key &&
+	        !tracker_property_get_multiple_values (property) &&
+	        tracker_property_get_data_type (property) == TRACKER_PROPERTY_TYPE_STRING);
+}
+
 gboolean
 tracker_property_get_db_schema_changed (TrackerProperty *property)
 {
@@ -846,6 +891,18 @@ tracker_property_set_weight (TrackerProperty *property,
 	priv->weight = value;
 }
 
+void
+tracker_property_set_count (TrackerProperty *property,
+                            gint             value)
+{
+	TrackerPropertyPrivate *priv;
+	g_return_if_fail (TRACKER_IS_PROPERTY (property));
+
+	priv = GET_PRIV (property);
+
+	priv->count = value;
+}
+
 
 void
 tracker_property_set_id (TrackerProperty *property,
@@ -945,6 +1002,19 @@ tracker_property_set_writeback (TrackerProperty *property,
 	priv->writeback = value;
 }
 
+void
+tracker_property_set_sort_key (TrackerProperty *property,
+                               gboolean         value)
+{
+	TrackerPropertyPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_PROPERTY (property));
+
+	priv = GET_PRIV (property);
+
+	priv->sort_key = value;
+}
+
 void
 tracker_property_set_db_schema_changed (TrackerProperty *property,
                                         gboolean         value)
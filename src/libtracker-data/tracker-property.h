@@ -82,6 +82,7 @@ TrackerClass *      tracker_property_get_domain              (TrackerProperty
 TrackerClass *      tracker_property_get_range               (TrackerProperty      *property);
 TrackerClass **     tracker_property_get_domain_indexes      (TrackerProperty      *property);
 gint                tracker_property_get_weight              (TrackerProperty      *property);
+gint                tracker_property_get_count               (TrackerProperty      *property);
 gint                tracker_property_get_id                  (TrackerProperty      *property);
 gboolean            tracker_property_get_indexed             (TrackerProperty      *property);
 TrackerProperty *   tracker_property_get_secondary_index     (TrackerProperty      *property);
@@ -93,6 +94,7 @@ gboolean            tracker_property_get_is_new              (TrackerProperty
 gboolean            tracker_property_get_is_new_domain_index (TrackerProperty      *property,
                                                               TrackerClass         *class);
 gboolean            tracker_property_get_writeback           (TrackerProperty      *property);
+gboolean            tracker_property_get_sort_key            (TrackerProperty      *property);
 const gchar *       tracker_property_get_default_value       (TrackerProperty      *property);
 gboolean            tracker_property_get_db_schema_changed   (TrackerProperty      *property);
 gboolean            tracker_property_get_is_inverse_functional_property
@@ -112,6 +114,8 @@ void                tracker_property_set_range               (TrackerProperty
                                                               TrackerClass         *range);
 void                tracker_property_set_weight              (TrackerProperty      *property,
                                                               gint                  value);
+void                tracker_property_set_count               (TrackerProperty      *property,
+                                                              gint                  value);
 void                tracker_property_set_id                  (TrackerProperty      *property,
                                                               gint                  value);
 void                tracker_property_set_indexed             (TrackerProperty      *property,
@@ -133,6 +137,8 @@ void                tracker_property_set_is_new_domain_index (TrackerProperty
                                                               gboolean              value);
 void                tracker_property_set_writeback           (TrackerProperty      *property,
                                                                gboolean              value);
+void                tracker_property_set_sort_key            (TrackerProperty      *property,
+                                                              gboolean              value);
 void                tracker_property_set_default_value       (TrackerProperty      *property,
                                                               const gchar          *value);
 void                tracker_property_set_db_schema_changed   (TrackerProperty      *property,
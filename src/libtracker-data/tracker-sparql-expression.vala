@@ -27,6 +27,8 @@ class Tracker.Sparql.Expression : Object {
 	const string TRACKER_NS = "http://www.tracker-project.org/ontologies/tracker#";
 
 	string? fts_sql;
+	// last variable translated, used to spot ORDER BY ?var
+	Variable? last_variable;
 
 	public Expression (Query query) {
 		this.query = query;
@@ -232,24 +234,47 @@ class Tracker.Sparql.Expression : Object {
 		return type;
 	}
 
-	void translate_expression_as_order_condition (StringBuilder sql) throws Sparql.Error {
+	internal PropertyType translate_expression_as_order_condition (StringBuilder sql) throws Sparql.Error {
 		long begin = sql.len;
-		if (translate_expression (sql) == PropertyType.RESOURCE) {
+		var type = translate_expression (sql);
+		if (type == PropertyType.RESOURCE) {
 			// ID => Uri
 			sql.insert (begin, "(SELECT Uri FROM Resource WHERE ID = ");
 			sql.append (")");
+			type = PropertyType.STRING;
+		}
+		return type;
+	}
+
+	void translate_order_expression (StringBuilder sql) throws Sparql.Error {
+		long begin = sql.len;
+
+		last_variable = null;
+		translate_expression_as_order_condition (sql);
+
+		if (last_variable == null || !last_variable.sort_key) {
+			return;
+		}
+
+		// a plain variable bound to a property with collation keys,
+		// the keys compare with memcmp and the column is indexed
+		string collated = "%s COLLATE %s".printf (last_variable.sql_expression, COLLATION_NAME);
+		string expression = sql.str.substring (begin);
+		if (expression == collated || expression == "(%s)".printf (collated)) {
+			sql.truncate (begin);
+			sql.append (last_variable.get_extra_sql_expression ("sortKey"));
 		}
 	}
 
 	internal void translate_order_condition (StringBuilder sql) throws Sparql.Error {
 		if (accept (SparqlTokenType.ASC)) {
-			translate_expression_as_order_condition (sql);
+			translate_order_expression (sql);
 			sql.append (" ASC");
 		} else if (accept (SparqlTokenType.DESC)) {
-			translate_expression_as_order_condition (sql);
+			translate_order_expression (sql);
 			sql.append (" DESC");
 		} else {
-			translate_expression_as_order_condition (sql);
+			translate_order_expression (sql);
 		}
 	}
 
@@ -1124,6 +1149,7 @@ class Tracker.Sparql.Expression : Object {
 			string variable_name = get_last_string ().substring (1);
 			var variable = context.get_variable (variable_name);
 			sql.append (variable.sql_expression);
+			last_variable = variable;
 
 			if (variable.binding == null) {
 				return PropertyType.UNKNOWN;
@@ -159,6 +159,10 @@ class Tracker.Sparql.Pattern : Object {
 	weak Query query;
 	weak Expression expression;
 
+	// Joins are forced into the estimated order when the largest table is
+	// at least this many times larger than the first
+	const int FORCE_JOIN_ORDER_RATIO = 10;
+
 	int counter;
 
 	int next_table_index;
@@ -254,6 +258,8 @@ class Tracker.Sparql.Pattern : Object {
 
 		var pattern_sql = new StringBuilder ();
 		var old_bindings = (owned) query.bindings;
+		bool paged = !subquery && query.page_size > 0;
+		bool distinct = false;
 
 		sql.append ("SELECT ");
 
@@ -261,6 +267,7 @@ class Tracker.Sparql.Pattern : Object {
 
 		if (accept (SparqlTokenType.DISTINCT)) {
 			sql.append ("DISTINCT ");
+			distinct = true;
 		} else if (accept (SparqlTokenType.REDUCED)) {
 		}
 
@@ -360,6 +367,8 @@ class Tracker.Sparql.Pattern : Object {
 			sql.append ("NULL");
 		}
 
+		long projection_end = sql.len;
+
 		// select from results of WHERE clause
 		sql.append (" FROM (");
 		sql.append (pattern_sql.str);
@@ -367,6 +376,12 @@ class Tracker.Sparql.Pattern : Object {
 
 		set_location (after_where);
 
+		if (paged && (distinct || current () == SparqlTokenType.GROUP)) {
+			throw new Sparql.Error.UNSUPPORTED ("DISTINCT and GROUP BY are not supported in paged queries");
+		}
+
+		string? order_sql = null;
+
 		if (accept (SparqlTokenType.GROUP)) {
 			expect (SparqlTokenType.BY);
 			sql.append (" GROUP BY ");
@@ -386,7 +401,9 @@ class Tracker.Sparql.Pattern : Object {
 			}
 		}
 
-		if (accept (SparqlTokenType.ORDER)) {
+		if (paged) {
+			order_sql = translate_paged_order (sql, projection_end, result);
+		} else if (accept (SparqlTokenType.ORDER)) {
 			expect (SparqlTokenType.BY);
 			sql.append (" ORDER BY ");
 			bool first_order = true;
@@ -400,6 +417,13 @@ class Tracker.Sparql.Pattern : Object {
 			} while (current () != SparqlTokenType.LIMIT && current () != SparqlTokenType.OFFSET && current () != SparqlTokenType.CLOSE_BRACE && current () != SparqlTokenType.CLOSE_PARENS && current () != SparqlTokenType.EOF);
 		}
 
+		if (subquery) {
+			// collation keys are not part of the projection
+			foreach (var variable in context.var_set.get_keys ()) {
+				variable.sort_key = false;
+			}
+		}
+
 		int limit = -1;
 		int offset = -1;
 
@@ -419,6 +443,14 @@ class Tracker.Sparql.Pattern : Object {
 			}
 		}
 
+		if (paged) {
+			if (limit >= 0 || offset >= 0) {
+				throw new Sparql.Error.UNSUPPORTED ("LIMIT and OFFSET are not supported in paged queries");
+			}
+
+			sql.append_printf (" LIMIT %d", query.page_size);
+		}
+
 		// LIMIT and OFFSET
 		if (limit >= 0) {
 			sql.append (" LIMIT ?");
@@ -459,9 +491,18 @@ class Tracker.Sparql.Pattern : Object {
 				str.append (fts_var);
 			}
 
+			for (int i = 0; i < query.n_sort_keys && paged; i++) {
+				str.append_printf (", \"_k%d\"", i);
+			}
+
 			str.append (" FROM fts JOIN (");
 			sql.prepend (str.str);
 			sql.append_printf (") AS ranks USING (docid) WHERE fts %s".printf (match_str.str));
+
+			if (paged) {
+				// the join does not preserve the order of the page
+				sql.append (order_sql);
+			}
 		}
 
 		context = context.parent_context;
@@ -473,6 +514,124 @@ class Tracker.Sparql.Pattern : Object {
 		return result;
 	}
 
+	static int compare_variable_names (Variable a, Variable b) {
+		return strcmp (a.name, b.name);
+	}
+
+	// Translates ORDER BY of a paged query, see Query.paged. Returns the
+	// ORDER BY clause on the hidden sort key columns.
+	string translate_paged_order (StringBuilder sql, long projection_end, SelectContext result) throws Sparql.Error {
+		string[] keys = {};
+		bool[] descending = {};
+		PropertyType[] types = {};
+
+		if (accept (SparqlTokenType.ORDER)) {
+			expect (SparqlTokenType.BY);
+			do {
+				var key_sql = new StringBuilder ();
+				uint n_bindings = query.bindings.length ();
+
+				if (accept (SparqlTokenType.DESC)) {
+					descending += true;
+				} else {
+					accept (SparqlTokenType.ASC);
+					descending += false;
+				}
+
+				types += expression.translate_expression_as_order_condition (key_sql);
+				keys += key_sql.str;
+
+				// sort keys are repeated in the projection and the
+				// continuation condition, literals would need to be
+				// bound more than once
+				if (query.bindings.length () != n_bindings) {
+					throw new Sparql.Error.UNSUPPORTED ("Literals in ORDER BY are not supported in paged queries");
+				}
+			} while (current () != SparqlTokenType.LIMIT && current () != SparqlTokenType.OFFSET && current () != SparqlTokenType.CLOSE_BRACE && current () != SparqlTokenType.CLOSE_PARENS && current () != SparqlTokenType.EOF);
+		}
+
+		// all variables of the solution break ties between equal ORDER BY
+		// keys so that rows are never skipped or repeated across pages,
+		// resources alone do not tell apart the rows of multi-valued
+		// literal properties
+		var tie_breakers = new List<Variable> ();
+		foreach (var variable in context.var_set.get_keys ()) {
+			if (variable.binding != null) {
+				tie_breakers.insert_sorted (variable, compare_variable_names);
+			}
+		}
+
+		foreach (var variable in tie_breakers) {
+			// the continuation compares values by type, rows could
+			// be skipped if the type of a column is not known
+			if (variable.binding.data_type == PropertyType.UNKNOWN) {
+				throw new Sparql.Error.UNSUPPORTED ("Variables of unknown type are not supported in paged queries");
+			}
+
+			keys += variable.sql_expression;
+			descending += false;
+			types += variable.binding.data_type;
+		}
+
+		if (keys.length == 0) {
+			throw new Sparql.Error.UNSUPPORTED ("Paged queries need a sort key");
+		}
+
+		query.n_sort_keys = keys.length;
+		query.sort_key_types = types;
+
+		var key_columns = new StringBuilder ();
+		for (int i = 0; i < keys.length; i++) {
+			key_columns.append_printf (", %s AS \"_k%d\"", keys[i], i);
+			result.types += types[i];
+			result.variable_names += "_k%d".printf (i);
+		}
+		sql.insert (projection_end, key_columns.str);
+
+		if (query.continuation != null) {
+			// rows sorting after the last row of the previous page,
+			// NULL sorts before any other value
+			var values = query.parse_continuation ();
+
+			sql.append (" WHERE ");
+			for (int i = 0; i < keys.length; i++) {
+				if (i > 0) {
+					sql.append (" OR ");
+				}
+				sql.append ("(");
+				for (int j = 0; j < i; j++) {
+					if (values[j] == null) {
+						sql.append_printf ("%s IS NULL AND ", keys[j]);
+					} else {
+						sql.append_printf ("%s = %s AND ", keys[j], values[j]);
+					}
+				}
+				if (values[i] == null) {
+					sql.append (descending[i] ? "0" : "%s IS NOT NULL".printf (keys[i]));
+				} else if (descending[i]) {
+					sql.append_printf ("(%s < %s OR %s IS NULL)", keys[i], values[i], keys[i]);
+				} else {
+					sql.append_printf ("%s > %s", keys[i], values[i]);
+				}
+				sql.append (")");
+			}
+
+			// every page has different literals
+			query.no_cache = true;
+		}
+
+		var order_sql = new StringBuilder (" ORDER BY ");
+		for (int i = 0; i < keys.length; i++) {
+			if (i > 0) {
+				order_sql.append (", ");
+			}
+			order_sql.append_printf ("\"_k%d\"%s", i, descending[i] ? " DESC" : "");
+		}
+		sql.append (order_sql.str);
+
+		return order_sql.str;
+	}
+
 	internal void translate_exists (StringBuilder sql) throws Sparql.Error {
 		bool not = accept (SparqlTokenType.NOT);
 		expect (SparqlTokenType.EXISTS);
@@ -678,15 +837,116 @@ class Tracker.Sparql.Pattern : Object {
 		sql.append ("SELECT ");
 	}
 
+	// Orders the tables of the triples block for joining, smallest first,
+	// each following table being the smallest one whose rows can be looked
+	// up through an index from the tables before it. Returns null to keep
+	// the order of the query when not all tables have estimates.
+	// force_order is set when the estimates differ enough for the order to
+	// be imposed on SQLite, which has no statistics on our tables.
+	DataTable[]? order_tables (out bool force_order) {
+		DataTable[] tables = { };
+
+		force_order = false;
+
+		foreach (DataTable table in triple_context.tables) {
+			if (table.sql_db_tablename == null || table.no_estimate || table.estimated_rows < 0) {
+				// predicate variable tables also bind parameters
+				return null;
+			}
+			tables += table;
+		}
+
+		int n = tables.length;
+		if (n < 2) {
+			return null;
+		}
+
+		// lookup[i * n + j]: rows of table j can be looked up by a
+		// variable bound in table i
+		var lookup = new bool[n * n];
+		foreach (var variable in triple_context.variables) {
+			foreach (VariableBinding from in triple_context.var_bindings.lookup (variable).list) {
+				foreach (VariableBinding to in triple_context.var_bindings.lookup (variable).list) {
+					if (from.table == null || to.table == null || from.table == to.table || !to.indexed) {
+						continue;
+					}
+					int i = -1, j = -1;
+					for (int k = 0; k < n; k++) {
+						if (tables[k] == from.table) {
+							i = k;
+						}
+						if (tables[k] == to.table) {
+							j = k;
+						}
+					}
+					if (i >= 0 && j >= 0) {
+						lookup[i * n + j] = true;
+					}
+				}
+			}
+		}
+
+		DataTable[] ordered = { };
+		var placed = new bool[n];
+		bool all_looked_up = true;
+		int max_rows = 0;
+
+		for (int step = 0; step < n; step++) {
+			int best = -1;
+			bool best_looked_up = false;
+
+			for (int j = 0; j < n; j++) {
+				if (placed[j]) {
+					continue;
+				}
+
+				bool looked_up = false;
+				for (int i = 0; i < n && !looked_up; i++) {
+					looked_up = placed[i] && lookup[i * n + j];
+				}
+
+				// ties keep the order of the query
+				if (best < 0 || (looked_up && !best_looked_up) ||
+				    (looked_up == best_looked_up && tables[j].estimated_rows < tables[best].estimated_rows)) {
+					best = j;
+					best_looked_up = looked_up;
+				}
+			}
+
+			if (step > 0 && !best_looked_up) {
+				all_looked_up = false;
+			}
+
+			placed[best] = true;
+			ordered += tables[best];
+			max_rows = int.max (max_rows, tables[best].estimated_rows);
+		}
+
+		// a forced order is only safe if every join is an index lookup
+		force_order = all_looked_up && max_rows / FORCE_JOIN_ORDER_RATIO >= int.max (ordered[0].estimated_rows, 1);
+
+		return ordered;
+	}
+
 	void end_triples_block (StringBuilder sql, ref bool first_where, bool in_group_graph_pattern) throws Sparql.Error {
 		// remove last comma and space
 		sql.truncate (sql.len - 2);
 
+		bool force_order;
+		DataTable[]? ordered = order_tables (out force_order);
+		if (ordered == null) {
+			ordered = { };
+			foreach (DataTable table in triple_context.tables) {
+				ordered += table;
+			}
+		}
+
 		sql.append (" FROM ");
 		bool first = true;
-		foreach (DataTable table in triple_context.tables) {
+		foreach (DataTable table in ordered) {
 			if (!first) {
-				sql.append (", ");
+				// CROSS JOIN keeps SQLite from reordering the tables
+				sql.append (force_order ? " CROSS JOIN " : ", ");
 			} else {
 				first = false;
 			}
@@ -1064,6 +1324,11 @@ class Tracker.Sparql.Pattern : Object {
 						select.append ("1");
 					}
 
+					// collation keys are not part of the select list
+					foreach (var v in context.parent_context.var_set.get_keys ()) {
+						v.sort_key = false;
+					}
+
 					context = context.parent_context;
 
 					select.append (" FROM (");
@@ -1207,6 +1472,8 @@ class Tracker.Sparql.Pattern : Object {
 				}
 				projection.append ("SELECT ");
 				foreach (var v in all_vars) {
+					// collation keys are not part of the projection
+					v.sort_key = false;
 					if (contexts[i].var_set.lookup (v) == 0) {
 						// variable not used in this subgraph
 						// use NULL
@@ -1285,6 +1552,13 @@ class Tracker.Sparql.Pattern : Object {
 					binding.variable.get_extra_sql_expression ("localTime"));
 			}
 
+			if (binding.has_sort_key) {
+				sql.append_printf ("%s AS %s, ",
+					binding.get_extra_sql_expression ("sortKey"),
+					binding.variable.get_extra_sql_expression ("sortKey"));
+				binding.variable.sort_key = true;
+			}
+
 			context.var_set.insert (binding.variable, variable_state);
 		}
 		binding_list.list.append (binding);
@@ -1359,6 +1633,10 @@ class Tracker.Sparql.Pattern : Object {
 					if (list != null && list.list != null) {
 						bool stop = false;
 						foreach (Class cl in prop.get_domain_indexes ()) {
+							if (Data.Manager.domain_index_is_pending (cl, prop)) {
+								// still being filled in, see Data.Manager.migrate
+								continue;
+							}
 							foreach (VariableBinding b in list.list) {
 								if (b.type == cl) {
 									db_table = cl.name;
@@ -1414,6 +1692,10 @@ class Tracker.Sparql.Pattern : Object {
 				}
 			}
 			table = get_table (current_subject, db_table, share_table, out newtable);
+
+			if (!in_simple_optional) {
+				estimate_table_rows (table, subject_type, rdftype, prop, object_is_var);
+			}
 		} else {
 			// variable in predicate
 			newtable = true;
@@ -1458,6 +1740,7 @@ class Tracker.Sparql.Pattern : Object {
 					binding.sql_db_column_name = "docid";
 				} else {
 					binding.sql_db_column_name = "ID";
+					binding.indexed = true;
 				}
 
 				add_variable_binding (sql, binding, VariableState.BOUND);
@@ -1489,6 +1772,10 @@ class Tracker.Sparql.Pattern : Object {
 						binding.maybe_null = true;
 						binding.in_simple_optional = in_simple_optional;
 					}
+					// domain index tables have no collation keys
+					binding.has_sort_key = prop.sort_key && db_table == prop.table_name;
+					// columns of domain indexes are always indexed
+					binding.indexed = prop.indexed || prop.is_inverse_functional_property || db_table != prop.table_name;
 				} else {
 					// variable as predicate
 					binding.data_type = PropertyType.STRING;
@@ -1584,6 +1871,37 @@ class Tracker.Sparql.Pattern : Object {
 		}
 	}
 
+	// Estimates the rows of the table matching the triple from the class
+	// and property counts. A literal subject matches one row, like a
+	// value of an inverse functional property; other literal values are
+	// assumed to match a tenth of the rows.
+	void estimate_table_rows (DataTable table, Class? subject_type, bool rdftype, Property? prop, bool object_is_var) {
+		int rows;
+
+		if (rdftype) {
+			rows = subject_type.count;
+		} else if (prop != null && prop.uri != "http://www.w3.org/1999/02/22-rdf-syntax-ns#type") {
+			rows = prop.count;
+
+			if (!object_is_var) {
+				rows = prop.is_inverse_functional_property ? int.min (rows, 1) : (rows + 9) / 10;
+			}
+		} else {
+			// fts:match and predicate variables, rdf:type values are
+			// only counted per class
+			table.no_estimate = true;
+			return;
+		}
+
+		if (!current_subject_is_var) {
+			rows = int.min (rows, 1);
+		}
+
+		if (table.estimated_rows < 0 || rows < table.estimated_rows) {
+			table.estimated_rows = rows;
+		}
+	}
+
 	DataTable get_table (string subject, string db_table, bool share_table, out bool newtable) {
 		string tablestring = "%s.%s".printf (subject, db_table);
 		DataTable table = null;
@@ -29,6 +29,9 @@ namespace Tracker.Sparql {
 		public string sql_db_tablename; // as in db schema
 		public string sql_query_tablename; // temp. name, generated
 		public PredicateVariable predicate_variable;
+		// rows matching the triples on this table, -1 if not estimated
+		public int estimated_rows = -1;
+		public bool no_estimate;
 	}
 
 	abstract class DataBinding : Object {
@@ -65,6 +68,10 @@ namespace Tracker.Sparql {
 		public bool maybe_null;
 		public bool in_simple_optional;
 		public Class? type;
+		// Collation keys of the value are in the same table
+		public bool has_sort_key;
+		// Rows of the table can be looked up by this column
+		public bool indexed;
 	}
 
 	class VariableBindingList : Object {
@@ -76,6 +83,9 @@ namespace Tracker.Sparql {
 		public int index { get; private set; }
 		public string sql_expression { get; private set; }
 		public VariableBinding binding;
+		// Whether the collation keys of the value are projected along
+		// with it, for ORDER BY
+		public bool sort_key;
 		string sql_identifier;
 
 		public Variable (string name, int index) {
@@ -243,6 +253,14 @@ public class Tracker.Sparql.Query : Object {
 
 	public bool no_cache { get; set; }
 
+	// Keyset pagination, see Pattern.translate_select
+	internal int page_size;
+	internal string? continuation;
+	internal PropertyType[] sort_key_types;
+
+	// Number of hidden sort key columns following the selected columns
+	public int n_sort_keys { get; internal set; }
+
 	public Query (string query) {
 		no_cache = false; /* Start with false, expression sets it */
 		tokens = new TokenInfo[BUFFER_SIZE];
@@ -262,6 +280,20 @@ public class Tracker.Sparql.Query : Object {
 		this.update_extensions = true;
 	}
 
+	/*
+	 * Paged queries return at most page_size rows, sorted by the ORDER BY
+	 * keys followed by all variables of the pattern as tie
+	 * breakers. The sort keys of each row are returned as extra columns
+	 * so get_continuation () can remember where the page ended and the
+	 * next page can resume after it with a keyset condition instead of
+	 * making SQLite generate and skip all previous rows with OFFSET.
+	 */
+	public Query.paged (string query, int page_size, string? continuation) {
+		this (query);
+		this.page_size = page_size;
+		this.continuation = continuation;
+	}
+
 	string get_uuid_for_name (uchar[] base_uuid, string name) {
 		var checksum = new Checksum (ChecksumType.SHA1);
 		// base UUID, unique per file
@@ -414,18 +446,19 @@ public class Tracker.Sparql.Query : Object {
 
 
 	public DBCursor? execute_cursor (bool threadsafe) throws DBInterfaceError, Sparql.Error, DateError {
+		int64 start = Trace.begin ();
 
 		prepare_execute ();
 
 		switch (current ()) {
 		case SparqlTokenType.SELECT:
-			return execute_select_cursor (threadsafe);
+			return execute_select_cursor (threadsafe, start);
 		case SparqlTokenType.CONSTRUCT:
 			throw get_internal_error ("CONSTRUCT is not supported");
 		case SparqlTokenType.DESCRIBE:
 			throw get_internal_error ("DESCRIBE is not supported");
 		case SparqlTokenType.ASK:
-			return execute_ask_cursor (threadsafe);
+			return execute_ask_cursor (threadsafe, start);
 		case SparqlTokenType.INSERT:
 		case SparqlTokenType.DELETE:
 		case SparqlTokenType.DROP:
@@ -498,6 +531,89 @@ public class Tracker.Sparql.Query : Object {
 		return result;
 	}
 
+	static bool is_integer_sort_key (PropertyType type) {
+		switch (type) {
+		case PropertyType.INTEGER:
+		case PropertyType.BOOLEAN:
+		case PropertyType.DATE:
+		case PropertyType.RESOURCE:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static bool is_double_sort_key (PropertyType type) {
+		return type == PropertyType.DOUBLE || type == PropertyType.DATETIME;
+	}
+
+	public string get_continuation (DBCursor cursor) {
+		var builder = new VariantBuilder (new VariantType ("amv"));
+		int first_key = cursor.n_columns - n_sort_keys;
+
+		for (int i = 0; i < n_sort_keys; i++) {
+			int column = first_key + i;
+			Variant? value = null;
+
+			if (cursor.get_value_type (column) != Sparql.ValueType.UNBOUND) {
+				if (is_integer_sort_key (sort_key_types[i])) {
+					value = new Variant.int64 (cursor.get_integer (column));
+				} else if (is_double_sort_key (sort_key_types[i])) {
+					value = new Variant.double (cursor.get_double (column));
+				} else {
+					value = new Variant.string (cursor.get_string (column));
+				}
+			}
+
+			builder.add_value (new Variant.maybe (VariantType.VARIANT, value != null ? new Variant.variant (value) : null));
+		}
+
+		var token = new Variant ("(u@amv)", query_string.hash (), builder.end ());
+
+		return Base64.encode ((uchar[]) token.get_data_as_bytes ().get_data ());
+	}
+
+	// Returns the sort keys of the continuation token as SQL literals,
+	// null for unbound keys
+	internal string?[] parse_continuation () throws Sparql.Error {
+		var data = Base64.decode (continuation);
+		var token = new Variant.from_bytes (new VariantType ("(uamv)"), new Bytes ((uint8[]) data), false);
+
+		if (!token.is_normal_form () || token.get_child_value (0).get_uint32 () != query_string.hash ()) {
+			throw new Sparql.Error.PARSE ("Continuation token does not belong to this query");
+		}
+
+		var keys = token.get_child_value (1);
+		if (keys.n_children () != sort_key_types.length) {
+			throw new Sparql.Error.PARSE ("Continuation token does not belong to this query");
+		}
+
+		var result = new string?[sort_key_types.length];
+
+		for (int i = 0; i < sort_key_types.length; i++) {
+			var maybe = keys.get_child_value (i).get_maybe ();
+			if (maybe == null) {
+				result[i] = null;
+				continue;
+			}
+
+			var value = maybe.get_variant ();
+			var type = sort_key_types[i];
+
+			if (is_integer_sort_key (type) && value.is_of_type (VariantType.INT64)) {
+				result[i] = value.get_int64 ().to_string ();
+			} else if (is_double_sort_key (type) && value.is_of_type (VariantType.DOUBLE) && value.get_double ().is_finite ()) {
+				result[i] = value.get_double ().to_string ();
+			} else if (!is_integer_sort_key (type) && !is_double_sort_key (type) && value.is_of_type (VariantType.STRING)) {
+				result[i] = "'%s'".printf (value.get_string ().replace ("'", "''"));
+			} else {
+				throw new Sparql.Error.PARSE ("Invalid continuation token");
+			}
+		}
+
+		return result;
+	}
+
 	DBStatement prepare_for_exec (string sql) throws DBInterfaceError, Sparql.Error, DateError {
 		var iface = DBManager.get_db_interface ();
 		var stmt = iface.create_statement (no_cache ? DBStatementCacheType.NONE : DBStatementCacheType.SELECT, "%s", sql);
@@ -546,10 +662,12 @@ public class Tracker.Sparql.Query : Object {
 		return sql.str;
 	}
 
-	DBCursor? execute_select_cursor (bool threadsafe) throws DBInterfaceError, Sparql.Error, DateError {
+	DBCursor? execute_select_cursor (bool threadsafe, int64 start) throws DBInterfaceError, Sparql.Error, DateError {
 		SelectContext context;
 		string sql = get_select_query (out context);
 
+		Trace.end (TraceStage.SPARQL_TRANSLATE, start);
+
 		return exec_sql_cursor (sql, context.types, context.variable_names, true);
 	}
 
@@ -584,8 +702,12 @@ public class Tracker.Sparql.Query : Object {
 		return sql.str;
 	}
 
-	DBCursor? execute_ask_cursor (bool threadsafe) throws DBInterfaceError, Sparql.Error, DateError {
-		return exec_sql_cursor (get_ask_query (), new PropertyType[] { PropertyType.BOOLEAN }, new string[] { "result" }, true);
+	DBCursor? execute_ask_cursor (bool threadsafe, int64 start) throws DBInterfaceError, Sparql.Error, DateError {
+		string sql = get_ask_query ();
+
+		Trace.end (TraceStage.SPARQL_TRANSLATE, start);
+
+		return exec_sql_cursor (sql, new PropertyType[] { PropertyType.BOOLEAN }, new string[] { "result" }, true);
 	}
 
 	private void parse_from_or_into_param () throws Sparql.Error {
@@ -46,6 +46,8 @@ struct _TrackerExtractInfo
 	gchar *mimetype;
 	gchar *graph;
 
+	guint64 bytes_read;
+
 	gint ref_count;
 };
 
@@ -294,3 +296,41 @@ tracker_extract_info_set_where_clause (TrackerExtractInfo *info,
 	g_free (info->where_clause);
 	info->where_clause = g_strdup (where);
 }
+
+/**
+ * tracker_extract_info_add_bytes_read:
+ * @info: a #TrackerExtractInfo
+ * @bytes: number of bytes read from the file
+ *
+ * Accounts @bytes as read from the file while extracting @info. This
+ * is done by #TrackerFileReader, modules doing their own I/O can call
+ * it directly so their reads show in the extractor statistics.
+ *
+ * Since: 1.2
+ **/
+void
+tracker_extract_info_add_bytes_read (TrackerExtractInfo *info,
+                                     gsize               bytes)
+{
+	g_return_if_fail (info != NULL);
+
+	info->bytes_read += bytes;
+}
+
+/**
+ * tracker_extract_info_get_bytes_read:
+ * @info: a #TrackerExtractInfo
+ *
+ * Returns the number of bytes accounted as read from the file.
+ *
+ * Returns: the number of bytes read.
+ *
+ * Since: 1.2
+ **/
+guint64
+tracker_extract_info_get_bytes_read (TrackerExtractInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->bytes_read;
+}
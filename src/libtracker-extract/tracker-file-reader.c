@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <gio/gio.h>
+
+#include <libtracker-common/tracker-file-utils.h>
+
+#include "tracker-file-reader.h"
+
+/**
+ * SECTION:tracker-file-reader
+ * @title: Bounded file reads
+ * @short_description: Read only the parts of a file a module needs
+ * @stability: Stable
+ * @include: libtracker-extract/tracker-extract.h
+ *
+ * #TrackerFileReader gives extractor modules mapped windows on the
+ * file being inspected, so that only the byte ranges actually parsed
+ * are faulted in from disk. Readahead is tuned to the access pattern
+ * given at construction, mapped ranges are dropped from the page cache
+ * once the reader is freed, and the bytes read are accounted on the
+ * #TrackerExtractInfo so that per-module I/O shows in the extractor
+ * statistics.
+ **/
+
+typedef struct {
+	gpointer data;
+	gsize length;
+} FileWindow;
+
+struct _TrackerFileReader {
+	TrackerExtractInfo *info;
+	TrackerFileReadPattern pattern;
+	gint fd;
+	goffset size;
+	GArray *windows;
+	guint64 bytes_read;
+};
+
+static gsize
+page_size (void)
+{
+	static gsize size = 0;
+
+	if (G_UNLIKELY (size == 0)) {
+		size = sysconf (_SC_PAGESIZE);
+	}
+
+	return size;
+}
+
+/**
+ * tracker_file_reader_new:
+ * @info: a #TrackerExtractInfo
+ * @pattern: how the file will be read
+ * @error: return location for a #GError, or %NULL
+ *
+ * Opens the file being extracted in @info for reading. The file is
+ * opened without updating its access time where possible.
+ *
+ * Returns: a new #TrackerFileReader, or %NULL if the file could not
+ *          be opened. Free with tracker_file_reader_free().
+ *
+ * Since: 1.2
+ **/
+TrackerFileReader *
+tracker_file_reader_new (TrackerExtractInfo      *info,
+                         TrackerFileReadPattern   pattern,
+                         GError                 **error)
+{
+	TrackerFileReader *reader;
+	struct stat st;
+	gchar *path;
+	gint fd;
+
+	g_return_val_if_fail (info != NULL, NULL);
+
+	path = g_file_get_path (tracker_extract_info_get_file (info));
+
+	if (!path) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+		             "File has no local path");
+		return NULL;
+	}
+
+	fd = tracker_file_open_fd (path);
+
+	if (fd == -1) {
+		g_set_error (error, G_IO_ERROR,
+		             g_io_error_from_errno (errno),
+		             "Could not open '%s': %s",
+		             path, g_strerror (errno));
+		g_free (path);
+		return NULL;
+	}
+
+	if (fstat (fd, &st) == -1) {
+		g_set_error (error, G_IO_ERROR,
+		             g_io_error_from_errno (errno),
+		             "Could not stat '%s': %s",
+		             path, g_strerror (errno));
+		close (fd);
+		g_free (path);
+		return NULL;
+	}
+
+	g_free (path);
+
+#ifdef HAVE_POSIX_FADVISE
+	posix_fadvise (fd, 0, 0,
+	               pattern == TRACKER_FILE_READ_SEQUENTIAL ?
+	               POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+#endif /* HAVE_POSIX_FADVISE */
+
+	reader = g_slice_new0 (TrackerFileReader);
+	reader->info = tracker_extract_info_ref (info);
+	reader->pattern = pattern;
+	reader->fd = fd;
+	reader->size = st.st_size;
+	reader->windows = g_array_new (FALSE, FALSE, sizeof (FileWindow));
+
+	return reader;
+}
+
+/**
+ * tracker_file_reader_free:
+ * @reader: a #TrackerFileReader
+ *
+ * Unmaps every window returned by @reader, drops the file from the
+ * page cache and closes it. The bytes read are added to the
+ * #TrackerExtractInfo @reader was created for.
+ *
+ * Since: 1.2
+ **/
+void
+tracker_file_reader_free (TrackerFileReader *reader)
+{
+	guint i;
+
+	g_return_if_fail (reader != NULL);
+
+	for (i = 0; i < reader->windows->len; i++) {
+		FileWindow *window;
+
+		window = &g_array_index (reader->windows, FileWindow, i);
+		munmap (window->data, window->length);
+	}
+
+	g_array_free (reader->windows, TRUE);
+
+#ifdef HAVE_POSIX_FADVISE
+	posix_fadvise (reader->fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif /* HAVE_POSIX_FADVISE */
+
+	close (reader->fd);
+
+	tracker_extract_info_add_bytes_read (reader->info, reader->bytes_read);
+	tracker_extract_info_unref (reader->info);
+
+	g_slice_free (TrackerFileReader, reader);
+}
+
+/**
+ * tracker_file_reader_get_size:
+ * @reader: a #TrackerFileReader
+ *
+ * Returns: the size of the file in bytes.
+ *
+ * Since: 1.2
+ **/
+goffset
+tracker_file_reader_get_size (TrackerFileReader *reader)
+{
+	g_return_val_if_fail (reader != NULL, 0);
+
+	return reader->size;
+}
+
+/**
+ * tracker_file_reader_get_fd:
+ * @reader: a #TrackerFileReader
+ *
+ * Returns the file descriptor, for libraries that need one. The
+ * descriptor is owned by @reader and must not be closed. Reads done
+ * through it are not accounted.
+ *
+ * Returns: the file descriptor.
+ *
+ * Since: 1.2
+ **/
+gint
+tracker_file_reader_get_fd (TrackerFileReader *reader)
+{
+	g_return_val_if_fail (reader != NULL, -1);
+
+	return reader->fd;
+}
+
+/**
+ * tracker_file_reader_map:
+ * @reader: a #TrackerFileReader
+ * @offset: offset of the window in the file
+ * @length: length of the window
+ * @length_out: (out) (allow-none): return location for the mapped length
+ *
+ * Maps @length bytes of the file starting at @offset, clamped to the
+ * end of the file. The window stays valid until @reader is freed.
+ * Pages are only read from disk as they are touched, but the whole
+ * window is accounted as read, so keep windows to the ranges parsed.
+ *
+ * Returns: (transfer none): a pointer to the data at @offset, or %NULL
+ *          if the range is empty or could not be mapped.
+ *
+ * Since: 1.2
+ **/
+const guchar *
+tracker_file_reader_map (TrackerFileReader *reader,
+                         goffset            offset,
+                         gsize              length,
+                         gsize             *length_out)
+{
+	FileWindow window;
+	goffset aligned;
+	gsize delta;
+
+	g_return_val_if_fail (reader != NULL, NULL);
+
+	if (length_out) {
+		*length_out = 0;
+	}
+
+	if (offset < 0 || offset >= reader->size || length == 0) {
+		return NULL;
+	}
+
+	length = MIN ((goffset) length, reader->size - offset);
+
+	/* mmap() offsets must be page aligned */
+	aligned = offset - (offset % page_size ());
+	delta = offset - aligned;
+
+	window.length = length + delta;
+	window.data = mmap (NULL, window.length, PROT_READ, MAP_PRIVATE,
+	                    reader->fd, aligned);
+
+	if (window.data == MAP_FAILED) {
+		g_warning ("Could not map %" G_GSIZE_FORMAT " bytes at offset %"
+		           G_GOFFSET_FORMAT ": %s",
+		           length, offset, g_strerror (errno));
+		return NULL;
+	}
+
+#ifdef HAVE_POSIX_MADVISE
+	posix_madvise (window.data, window.length,
+	               reader->pattern == TRACKER_FILE_READ_SEQUENTIAL ?
+	               POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+#endif /* HAVE_POSIX_MADVISE */
+
+	g_array_append_val (reader->windows, window);
+	reader->bytes_read += length;
+
+	if (length_out) {
+		*length_out = length;
+	}
+
+	return (const guchar *) window.data + delta;
+}
+
+/**
+ * tracker_file_reader_map_head:
+ * @reader: a #TrackerFileReader
+ * @max_length: maximum length of the window
+ * @length_out: (out) (allow-none): return location for the mapped length
+ *
+ * Maps at most @max_length bytes from the start of the file.
+ *
+ * Returns: (transfer none): the mapped data, or %NULL on error.
+ *
+ * Since: 1.2
+ **/
+const guchar *
+tracker_file_reader_map_head (TrackerFileReader *reader,
+                              gsize              max_length,
+                              gsize             *length_out)
+{
+	return tracker_file_reader_map (reader, 0, max_length, length_out);
+}
+
+/**
+ * tracker_file_reader_map_tail:
+ * @reader: a #TrackerFileReader
+ * @max_length: maximum length of the window
+ * @length_out: (out) (allow-none): return location for the mapped length
+ *
+ * Maps at most @max_length bytes up to the end of the file, as used
+ * for trailing tags and index sections.
+ *
+ * Returns: (transfer none): the mapped data, or %NULL on error.
+ *
+ * Since: 1.2
+ **/
+const guchar *
+tracker_file_reader_map_tail (TrackerFileReader *reader,
+                              gsize              max_length,
+                              gsize             *length_out)
+{
+	goffset offset;
+
+	g_return_val_if_fail (reader != NULL, NULL);
+
+	offset = MAX (0, reader->size - (goffset) max_length);
+
+	return tracker_file_reader_map (reader, offset,
+	                                reader->size - offset,
+	                                length_out);
+}
+
+/**
+ * tracker_file_reader_read:
+ * @reader: a #TrackerFileReader
+ * @offset: offset in the file to read from
+ * @buffer: buffer to read into
+ * @length: number of bytes to read
+ *
+ * Copies up to @length bytes at @offset into @buffer, for small reads
+ * where a mapping is not worth it.
+ *
+ * Returns: the number of bytes read, or -1 on error.
+ *
+ * Since: 1.2
+ **/
+gssize
+tracker_file_reader_read (TrackerFileReader *reader,
+                          goffset            offset,
+                          gpointer           buffer,
+                          gsize              length)
+{
+	gssize n_read;
+
+	g_return_val_if_fail (reader != NULL, -1);
+	g_return_val_if_fail (buffer != NULL, -1);
+
+	do {
+		n_read = pread (reader->fd, buffer, length, offset);
+	} while (n_read == -1 && errno == EINTR);
+
+	if (n_read > 0) {
+		reader->bytes_read += n_read;
+	}
+
+	return n_read;
+}
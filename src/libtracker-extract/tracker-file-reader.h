@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_EXTRACT_FILE_READER_H__
+#define __LIBTRACKER_EXTRACT_FILE_READER_H__
+
+#if !defined (__LIBTRACKER_EXTRACT_INSIDE__) && !defined (TRACKER_COMPILATION)
+#error "only <libtracker-extract/tracker-extract.h> must be included directly."
+#endif
+
+#include <glib.h>
+
+#include "tracker-extract-info.h"
+
+G_BEGIN_DECLS
+
+/**
+ * TrackerFileReadPattern:
+ * @TRACKER_FILE_READ_SEQUENTIAL: the file is read front to back, as
+ * with text and most documents.
+ * @TRACKER_FILE_READ_SPARSE: only a few ranges are read, such as
+ * container headers and trailing tags.
+ *
+ * Hints on how a file will be read, used to tune readahead.
+ *
+ * Since: 1.2
+ **/
+typedef enum {
+	TRACKER_FILE_READ_SEQUENTIAL,
+	TRACKER_FILE_READ_SPARSE
+} TrackerFileReadPattern;
+
+typedef struct _TrackerFileReader TrackerFileReader;
+
+TrackerFileReader * tracker_file_reader_new      (TrackerExtractInfo     *info,
+                                                  TrackerFileReadPattern  pattern,
+                                                  GError                **error);
+void                tracker_file_reader_free     (TrackerFileReader      *reader);
+
+goffset             tracker_file_reader_get_size (TrackerFileReader      *reader);
+gint                tracker_file_reader_get_fd   (TrackerFileReader      *reader);
+
+const guchar *      tracker_file_reader_map      (TrackerFileReader      *reader,
+                                                  goffset                 offset,
+                                                  gsize                   length,
+                                                  gsize                  *length_out);
+const guchar *      tracker_file_reader_map_head (TrackerFileReader      *reader,
+                                                  gsize                   max_length,
+                                                  gsize                  *length_out);
+const guchar *      tracker_file_reader_map_tail (TrackerFileReader      *reader,
+                                                  gsize                   max_length,
+                                                  gsize                  *length_out);
+gssize              tracker_file_reader_read     (TrackerFileReader      *reader,
+                                                  goffset                 offset,
+                                                  gpointer                buffer,
+                                                  gsize                   length);
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_EXTRACT_FILE_READER_H__ */
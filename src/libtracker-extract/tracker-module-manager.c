@@ -21,18 +21,45 @@
 
 #include <string.h>
 
+#include <glib/gstdio.h>
+
 #include "tracker-module-manager.h"
 
 #define EXTRACTOR_FUNCTION "tracker_extract_get_metadata"
 #define INIT_FUNCTION      "tracker_extract_module_init"
 #define SHUTDOWN_FUNCTION  "tracker_extract_module_shutdown"
 
+/* Bump whenever the layout below changes, older caches are then
+ * ignored and rewritten from the rule files */
+#define RULES_CACHE_VERSION 1
+
+/* (version, stamp, rules, exact matches, prefixes, globs), rules are
+ * (module path, fallback rdf types), the rest map a mimetype or
+ * pattern to the indexes of the rules it comes from */
+#define RULES_CACHE_TYPE "(usa(sas)a(sau)a(sau)a(su))"
+
 typedef struct {
 	const gchar *module_path; /* intern string */
-	GList *patterns;
 	GStrv fallback_rdf_types;
 } RuleInfo;
 
+/* Character trie of the "prefix*" patterns, which is what nearly all
+ * wildcard rules look like */
+typedef struct _RuleTrieNode RuleTrieNode;
+
+struct _RuleTrieNode {
+	gchar c;
+	RuleTrieNode *children;
+	RuleTrieNode *next;
+	GArray *rules;
+};
+
+typedef struct {
+	GPatternSpec *pattern;
+	gchar *pattern_str;
+	guint rule;
+} GlobRule;
+
 typedef struct {
 	GModule *module;
 	TrackerModuleThreadAwareness thread_awareness;
@@ -47,6 +74,11 @@ static GHashTable *mimetype_map = NULL;
 static gboolean initialized = FALSE;
 static GArray *rules = NULL;
 
+/* Rules compiled per pattern kind, all hold indexes into rules */
+static GHashTable *exact_rules = NULL;
+static RuleTrieNode *prefix_rules = NULL;
+static GArray *glob_rules = NULL;
+
 struct _TrackerMimetypeInfo {
 	const GList *rules;
 	const GList *cur;
@@ -54,6 +86,99 @@ struct _TrackerMimetypeInfo {
 	ModuleInfo *cur_module_info;
 };
 
+static void
+rule_indexes_add (GArray *indexes,
+                  guint   rule)
+{
+	guint i;
+
+	for (i = 0; i < indexes->len; i++) {
+		if (g_array_index (indexes, guint, i) == rule) {
+			return;
+		}
+	}
+
+	g_array_append_val (indexes, rule);
+}
+
+static RuleTrieNode *
+rule_trie_insert (RuleTrieNode *node,
+                  const gchar  *prefix,
+                  gsize         len)
+{
+	gsize i;
+
+	for (i = 0; i < len; i++) {
+		RuleTrieNode *child;
+
+		for (child = node->children; child; child = child->next) {
+			if (child->c == prefix[i]) {
+				break;
+			}
+		}
+
+		if (!child) {
+			child = g_slice_new0 (RuleTrieNode);
+			child->c = prefix[i];
+			child->next = node->children;
+			node->children = child;
+		}
+
+		node = child;
+	}
+
+	if (!node->rules) {
+		node->rules = g_array_new (FALSE, FALSE, sizeof (guint));
+	}
+
+	return node;
+}
+
+static void
+add_rule_pattern (const gchar *pattern,
+                  guint        rule)
+{
+	const gchar *wildcard;
+	GArray *indexes;
+
+	wildcard = strpbrk (pattern, "*?");
+
+	if (!wildcard) {
+		indexes = g_hash_table_lookup (exact_rules, pattern);
+
+		if (!indexes) {
+			indexes = g_array_new (FALSE, FALSE, sizeof (guint));
+			g_hash_table_insert (exact_rules, g_strdup (pattern), indexes);
+		}
+
+		rule_indexes_add (indexes, rule);
+	} else if (wildcard[0] == '*' && wildcard[1] == '\0') {
+		RuleTrieNode *node;
+
+		node = rule_trie_insert (prefix_rules, pattern, wildcard - pattern);
+		rule_indexes_add (node->rules, rule);
+	} else {
+		GlobRule glob;
+
+		glob.pattern = g_pattern_spec_new (pattern);
+		glob.pattern_str = g_strdup (pattern);
+		glob.rule = rule;
+		g_array_append_val (glob_rules, glob);
+	}
+}
+
+static void
+rules_init (void)
+{
+	rules = g_array_new (FALSE, TRUE, sizeof (RuleInfo));
+	exact_rules = g_hash_table_new_full (g_str_hash,
+	                                     g_str_equal,
+	                                     (GDestroyNotify) g_free,
+	                                     (GDestroyNotify) g_array_unref);
+	prefix_rules = g_slice_new0 (RuleTrieNode);
+	glob_rules = g_array_new (FALSE, FALSE, sizeof (GlobRule));
+}
+
 static gboolean
 load_extractor_rule (GKeyFile  *key_file,
                      GError   **error)
@@ -61,6 +186,7 @@ load_extractor_rule (GKeyFile  *key_file,
 	gchar *module_path, **mimetypes;
 	gsize n_mimetypes, i;
 	RuleInfo rule = { 0 };
+	guint rule_index;
 
 	module_path = g_key_file_get_string (key_file, "ExtractorRule", "ModulePath", error);
 
@@ -87,31 +213,329 @@ load_extractor_rule (GKeyFile  *key_file,
 
 	/* Construct the rule */
 	rule.module_path = g_intern_string (module_path);
+	rule_index = rules->len;
+	g_array_append_val (rules, rule);
 
 	for (i = 0; i < n_mimetypes; i++) {
-		GPatternSpec *pattern;
-
-		pattern = g_pattern_spec_new (mimetypes[i]);
-		rule.patterns = g_list_prepend (rule.patterns, pattern);
-	}
-
-	if (G_UNLIKELY (!rules)) {
-		rules = g_array_new (FALSE, TRUE, sizeof (RuleInfo));
+		add_rule_pattern (mimetypes[i], rule_index);
 	}
 
-	g_array_append_val (rules, rule);
 	g_strfreev (mimetypes);
 	g_free (module_path);
 
 	return TRUE;
 }
 
+static void
+load_extractor_rules (const gchar *extractors_dir,
+                      GList       *files)
+{
+	GError *error = NULL;
+	GList *l;
+
+	g_message ("Loading extractor rules... (%s)", extractors_dir);
+
+	for (l = files; l; l = l->next) {
+		GKeyFile *key_file;
+		const gchar *name;
+		gchar *path;
+
+		name = l->data;
+
+		if (!g_str_has_suffix (l->data, ".rule")) {
+			g_message ("  Skipping file '%s', no '.rule' suffix", name);
+			continue;
+		}
+
+		path = g_build_filename (extractors_dir, name, NULL);
+		key_file = g_key_file_new ();
+
+		if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &error) ||
+		    !load_extractor_rule (key_file, &error)) {
+			g_warning ("  Could not load extractor rule file '%s': %s", name, error->message);
+			g_clear_error (&error);
+		} else {
+			g_debug ("  Loaded rule '%s'", name);
+		}
+
+		g_key_file_free (key_file);
+		g_free (path);
+	}
+
+	g_message ("Extractor rules loaded");
+}
+
+static gchar *
+rules_cache_path (void)
+{
+	return g_build_filename (g_get_user_cache_dir (),
+	                         "tracker",
+	                         "extract-rules.cache",
+	                         NULL);
+}
+
+/* Rule files are only stat()ed to tell whether the cache is current */
+static gchar *
+rules_cache_stamp (const gchar *extractors_dir,
+                   GList       *files)
+{
+	GChecksum *checksum;
+	gchar *stamp;
+	GList *l;
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+	g_checksum_update (checksum, (const guchar *) extractors_dir, -1);
+	g_checksum_update (checksum, (const guchar *) TRACKER_EXTRACTORS_DIR, -1);
+
+	for (l = files; l; l = l->next) {
+		const gchar *name = l->data;
+		GStatBuf st;
+		gchar *path, *entry;
+
+		if (!g_str_has_suffix (name, ".rule")) {
+			continue;
+		}
+
+		path = g_build_filename (extractors_dir, name, NULL);
+
+		if (g_stat (path, &st) != 0) {
+			g_free (path);
+			g_checksum_free (checksum);
+			return NULL;
+		}
+
+		entry = g_strdup_printf (";%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+		                         name, (gint64) st.st_mtime, (gint64) st.st_size);
+		g_checksum_update (checksum, (const guchar *) entry, -1);
+
+		g_free (entry);
+		g_free (path);
+	}
+
+	stamp = g_strdup (g_checksum_get_string (checksum));
+	g_checksum_free (checksum);
+
+	return stamp;
+}
+
+static void
+rule_indexes_serialize (GVariantBuilder *builder,
+                        const gchar     *pattern,
+                        GArray          *indexes)
+{
+	guint i;
+
+	g_variant_builder_open (builder, G_VARIANT_TYPE ("(sau)"));
+	g_variant_builder_add (builder, "s", pattern);
+	g_variant_builder_open (builder, G_VARIANT_TYPE ("au"));
+
+	for (i = 0; i < indexes->len; i++) {
+		g_variant_builder_add (builder, "u", g_array_index (indexes, guint, i));
+	}
+
+	g_variant_builder_close (builder);
+	g_variant_builder_close (builder);
+}
+
+static void
+rule_trie_serialize (RuleTrieNode    *node,
+                     GString         *prefix,
+                     GVariantBuilder *builder)
+{
+	RuleTrieNode *child;
+
+	if (node->rules) {
+		gchar *pattern;
+
+		pattern = g_strconcat (prefix->str, "*", NULL);
+		rule_indexes_serialize (builder, pattern, node->rules);
+		g_free (pattern);
+	}
+
+	for (child = node->children; child; child = child->next) {
+		g_string_append_c (prefix, child->c);
+		rule_trie_serialize (child, prefix, builder);
+		g_string_truncate (prefix, prefix->len - 1);
+	}
+}
+
+static void
+rules_cache_write (const gchar *stamp)
+{
+	GVariantBuilder builder;
+	GVariant *cache;
+	GError *error = NULL;
+	GList *mimetypes, *l;
+	GString *prefix;
+	gchar *path, *dir;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE (RULES_CACHE_TYPE));
+	g_variant_builder_add (&builder, "u", RULES_CACHE_VERSION);
+	g_variant_builder_add (&builder, "s", stamp);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sas)"));
+	for (i = 0; i < rules->len; i++) {
+		RuleInfo *info = &g_array_index (rules, RuleInfo, i);
+		gchar *empty[] = { NULL };
+
+		g_variant_builder_add (&builder, "(s^as)",
+		                       info->module_path,
+		                       info->fallback_rdf_types ? info->fallback_rdf_types : empty);
+	}
+	g_variant_builder_close (&builder);
+
+	/* Exact matches sorted, so the table reads in a stable order */
+	mimetypes = g_list_sort (g_hash_table_get_keys (exact_rules),
+	                         (GCompareFunc) g_strcmp0);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sau)"));
+	for (l = mimetypes; l; l = l->next) {
+		rule_indexes_serialize (&builder, l->data,
+		                        g_hash_table_lookup (exact_rules, l->data));
+	}
+	g_variant_builder_close (&builder);
+	g_list_free (mimetypes);
+
+	prefix = g_string_new (NULL);
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sau)"));
+	rule_trie_serialize (prefix_rules, prefix, &builder);
+	g_variant_builder_close (&builder);
+	g_string_free (prefix, TRUE);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(su)"));
+	for (i = 0; i < glob_rules->len; i++) {
+		GlobRule *glob = &g_array_index (glob_rules, GlobRule, i);
+
+		g_variant_builder_add (&builder, "(su)", glob->pattern_str, glob->rule);
+	}
+	g_variant_builder_close (&builder);
+
+	cache = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+	path = rules_cache_path ();
+	dir = g_path_get_dirname (path);
+	g_mkdir_with_parents (dir, 0700);
+
+	/* g_file_set_contents() replaces the file atomically, so other
+	 * processes loading the rules never see it half written */
+	if (!g_file_set_contents (path,
+	                          g_variant_get_data (cache),
+	                          g_variant_get_size (cache),
+	                          &error)) {
+		g_debug ("Could not write extractor rules cache: %s", error->message);
+		g_error_free (error);
+	}
+
+	g_variant_unref (cache);
+	g_free (dir);
+	g_free (path);
+}
+
+static void
+rules_cache_load_patterns (GVariant *list)
+{
+	GVariantIter iter;
+	const gchar *pattern;
+	GVariant *indexes;
+
+	g_variant_iter_init (&iter, list);
+
+	while (g_variant_iter_next (&iter, "(&s@au)", &pattern, &indexes)) {
+		const guint32 *values;
+		gsize n_values, i;
+
+		values = g_variant_get_fixed_array (indexes, &n_values, sizeof (guint32));
+
+		for (i = 0; i < n_values; i++) {
+			if (values[i] < rules->len) {
+				add_rule_pattern (pattern, values[i]);
+			}
+		}
+
+		g_variant_unref (indexes);
+	}
+}
+
+static gboolean
+rules_cache_load (const gchar *stamp)
+{
+	GVariant *cache, *rule_list, *exact_list, *prefix_list, *glob_list;
+	GMappedFile *mapped_file;
+	const gchar *cache_stamp, *pattern, *module_path;
+	GVariantIter iter;
+	gchar **fallback_rdf_types;
+	gchar *path;
+	guint32 version, rule;
+
+	path = rules_cache_path ();
+	mapped_file = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+
+	if (!mapped_file) {
+		return FALSE;
+	}
+
+	cache = g_variant_new_from_data (G_VARIANT_TYPE (RULES_CACHE_TYPE),
+	                                 g_mapped_file_get_contents (mapped_file),
+	                                 g_mapped_file_get_length (mapped_file),
+	                                 FALSE,
+	                                 (GDestroyNotify) g_mapped_file_unref,
+	                                 mapped_file);
+	g_variant_ref_sink (cache);
+
+	g_variant_get (cache, "(u&s@a(sas)@a(sau)@a(sau)@a(su))",
+	               &version, &cache_stamp,
+	               &rule_list, &exact_list, &prefix_list, &glob_list);
+
+	if (version == RULES_CACHE_VERSION &&
+	    g_strcmp0 (cache_stamp, stamp) == 0) {
+		g_variant_iter_init (&iter, rule_list);
+
+		while (g_variant_iter_next (&iter, "(&s^as)", &module_path, &fallback_rdf_types)) {
+			RuleInfo info = { 0 };
+
+			info.module_path = g_intern_string (module_path);
+
+			if (fallback_rdf_types[0]) {
+				info.fallback_rdf_types = fallback_rdf_types;
+			} else {
+				g_strfreev (fallback_rdf_types);
+			}
+
+			g_array_append_val (rules, info);
+		}
+
+		rules_cache_load_patterns (exact_list);
+		rules_cache_load_patterns (prefix_list);
+
+		g_variant_iter_init (&iter, glob_list);
+
+		while (g_variant_iter_next (&iter, "(&su)", &pattern, &rule)) {
+			if (rule < rules->len) {
+				add_rule_pattern (pattern, rule);
+			}
+		}
+	} else {
+		version = 0;
+	}
+
+	g_variant_unref (rule_list);
+	g_variant_unref (exact_list);
+	g_variant_unref (prefix_list);
+	g_variant_unref (glob_list);
+	g_variant_unref (cache);
+
+	return version == RULES_CACHE_VERSION;
+}
+
 gboolean
 tracker_extract_module_manager_init (void)
 {
 	const gchar *extractors_dir, *name;
-	GList *files = NULL, *l;
+	GList *files = NULL;
 	GError *error = NULL;
+	gchar *stamp;
 	GDir *dir;
 
 	if (initialized) {
@@ -142,36 +566,21 @@ tracker_extract_module_manager_init (void)
 		files = g_list_insert_sorted (files, (gpointer) name, (GCompareFunc) g_strcmp0);
 	}
 
-	g_message ("Loading extractor rules... (%s)", extractors_dir);
+	rules_init ();
+	stamp = rules_cache_stamp (extractors_dir, files);
 
-	for (l = files; l; l = l->next) {
-		GKeyFile *key_file;
-		const gchar *name;
-		gchar *path;
-
-		name = l->data;
-
-		if (!g_str_has_suffix (l->data, ".rule")) {
-			g_message ("  Skipping file '%s', no '.rule' suffix", name);
-			continue;
-		}
-
-		path = g_build_filename (extractors_dir, name, NULL);
-		key_file = g_key_file_new ();
+	/* Parsing the rule files is skipped while none of them changed */
+	if (stamp && rules_cache_load (stamp)) {
+		g_message ("Extractor rules loaded from cache (%s)", extractors_dir);
+	} else {
+		load_extractor_rules (extractors_dir, files);
 
-		if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &error) ||
-		    !load_extractor_rule (key_file, &error)) {
-			g_warning ("  Could not load extractor rule file '%s': %s", name, error->message);
-			g_clear_error (&error);
-		} else {
-			g_debug ("  Loaded rule '%s'", name);
+		if (stamp) {
+			rules_cache_write (stamp);
 		}
-
-		g_key_file_free (key_file);
-		g_free (path);
 	}
 
-	g_message ("Extractor rules loaded");
+	g_free (stamp);
 	g_list_free (files);
 	g_dir_close (dir);
 
@@ -185,50 +594,103 @@ tracker_extract_module_manager_init (void)
 	return TRUE;
 }
 
+static gint
+compare_rule_indexes (gconstpointer a,
+                      gconstpointer b)
+{
+	guint rule_a = *(const guint *) a;
+	guint rule_b = *(const guint *) b;
+
+	return (rule_a > rule_b) - (rule_a < rule_b);
+}
+
 static GList *
 lookup_rules (const gchar *mimetype)
 {
 	GList *mimetype_rules = NULL;
-	RuleInfo *info;
-	gchar *reversed;
-	gint len, i;
+	RuleTrieNode *node;
+	GArray *indexes, *matches;
+	const gchar *p;
+	gpointer value;
+	guint i;
 
-	if (!rules) {
+	if (!rules || rules->len == 0) {
 		return NULL;
 	}
 
-	if (mimetype_map) {
-		mimetype_rules = g_hash_table_lookup (mimetype_map, mimetype);
+	if (mimetype_map &&
+	    g_hash_table_lookup_extended (mimetype_map, mimetype, NULL, &value)) {
+		return value;
+	}
+
+	matches = g_array_new (FALSE, FALSE, sizeof (guint));
+
+	indexes = g_hash_table_lookup (exact_rules, mimetype);
+
+	if (indexes) {
+		g_array_append_vals (matches, indexes->data, indexes->len);
+	}
+
+	/* Every node along the mimetype path is a matching prefix */
+	for (node = prefix_rules, p = mimetype; node; p++) {
+		RuleTrieNode *child;
+
+		if (node->rules) {
+			g_array_append_vals (matches, node->rules->data, node->rules->len);
+		}
 
-		if (mimetype_rules) {
-			return mimetype_rules;
+		if (*p == '\0') {
+			break;
 		}
+
+		for (child = node->children; child && child->c != *p; child = child->next)
+			;
+
+		node = child;
 	}
 
-	reversed = g_strdup (mimetype);
-	g_strreverse (reversed);
-	len = strlen (mimetype);
+	if (glob_rules->len > 0) {
+		gchar *reversed;
+		gsize len;
 
-	/* Apply the rules! */
-	for (i = 0; i < rules->len; i++) {
-		GList *l;
+		reversed = g_strdup (mimetype);
+		g_strreverse (reversed);
+		len = strlen (mimetype);
 
-		info = &g_array_index (rules, RuleInfo, i);
+		for (i = 0; i < glob_rules->len; i++) {
+			GlobRule *glob = &g_array_index (glob_rules, GlobRule, i);
 
-		for (l = info->patterns; l; l = l->next) {
-			if (g_pattern_match (l->data, len, mimetype, reversed)) {
-				/* Match, store for future queries and return */
-				mimetype_rules = g_list_prepend (mimetype_rules, info);
+			if (g_pattern_match (glob->pattern, len, mimetype, reversed)) {
+				g_array_append_val (matches, glob->rule);
 			}
 		}
+
+		g_free (reversed);
 	}
 
-	if (mimetype_rules) {
-		mimetype_rules = g_list_reverse (mimetype_rules);
-		g_hash_table_insert (mimetype_map, g_strdup (mimetype), mimetype_rules);
+	/* Rules apply in the order their files sort in, a rule matching
+	 * through several of its patterns is only listed once */
+	g_array_sort (matches, compare_rule_indexes);
+
+	for (i = matches->len; i > 0; i--) {
+		guint rule = g_array_index (matches, guint, i - 1);
+
+		if (i < matches->len &&
+		    rule == g_array_index (matches, guint, i)) {
+			continue;
+		}
+
+		mimetype_rules = g_list_prepend (mimetype_rules,
+		                                 &g_array_index (rules, RuleInfo, rule));
 	}
 
-	g_free (reversed);
+	g_array_free (matches, TRUE);
+
+	/* Mimetypes no rule matches are stored too, so that each
+	 * mimetype is only ever matched once */
+	if (mimetype_map) {
+		g_hash_table_insert (mimetype_map, g_strdup (mimetype), mimetype_rules);
+	}
 
 	return mimetype_rules;
 }
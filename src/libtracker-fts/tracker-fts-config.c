@@ -309,6 +309,33 @@ tracker_fts_config_get_max_words_to_index (TrackerFTSConfig *config)
 	return g_settings_get_int (G_SETTINGS (config), "max-words-to-index");
 }
 
+gint *
+tracker_fts_config_get_prefix_lengths (TrackerFTSConfig *config,
+                                       gsize            *n_lengths)
+{
+	GVariant *value;
+	const gint32 *lengths;
+	gint *retval;
+	gsize n, i;
+
+	g_return_val_if_fail (TRACKER_IS_FTS_CONFIG (config), NULL);
+	g_return_val_if_fail (n_lengths != NULL, NULL);
+
+	value = g_settings_get_value (G_SETTINGS (config), "prefix-lengths");
+	lengths = g_variant_get_fixed_array (value, &n, sizeof (gint32));
+
+	retval = g_new (gint, n);
+
+	for (i = 0; i < n; i++) {
+		retval[i] = lengths[i];
+	}
+
+	g_variant_unref (value);
+	*n_lengths = n;
+
+	return retval;
+}
+
 void
 tracker_fts_config_set_max_word_length (TrackerFTSConfig *config,
                                         gint              value)
@@ -54,6 +54,8 @@ gboolean          tracker_fts_config_get_enable_unaccent    (TrackerFTSConfig *c
 gboolean          tracker_fts_config_get_ignore_numbers     (TrackerFTSConfig *config);
 gboolean          tracker_fts_config_get_ignore_stop_words  (TrackerFTSConfig *config);
 gint              tracker_fts_config_get_max_words_to_index (TrackerFTSConfig *config);
+gint *            tracker_fts_config_get_prefix_lengths     (TrackerFTSConfig *config,
+                                                             gsize            *n_lengths);
 void              tracker_fts_config_set_enable_stemmer     (TrackerFTSConfig *config,
                                                              gboolean          value);
 void              tracker_fts_config_set_enable_unaccent    (TrackerFTSConfig *config,
@@ -40,6 +40,11 @@ struct TrackerTokenizer {
   gboolean enable_unaccent;
   gboolean ignore_numbers;
   gboolean ignore_stop_words;
+
+  /* Parser kept around after a cursor is closed, so the next cursor
+  ** can reuse its buffers instead of allocating new ones.
+  */
+  TrackerParser *spare_parser;
 };
 
 struct TrackerCursor {
@@ -94,6 +99,9 @@ static int trackerCreate(
 */
 static int trackerDestroy(sqlite3_tokenizer *pTokenizer){
   TrackerTokenizer *p = (TrackerTokenizer *)pTokenizer;
+  if (p->spare_parser){
+    tracker_parser_free (p->spare_parser);
+  }
   g_object_unref (p->language);
   sqlite3_free(p);
   return SQLITE_OK;
@@ -119,7 +127,14 @@ static int trackerOpen(
     nInput = strlen(zInput);
   }
 
-  parser = tracker_parser_new (p->language);
+  /* Several cursors may be open at once, only the first one
+  ** gets the spare parser.
+  */
+  parser = g_atomic_pointer_get (&p->spare_parser);
+  if (!parser || !g_atomic_pointer_compare_and_exchange (&p->spare_parser, parser, NULL)){
+    parser = tracker_parser_new (p->language);
+  }
+
   tracker_parser_reset (parser, zInput, nInput,
 			p->max_word_length,
 			p->enable_stemmer,
@@ -142,8 +157,11 @@ static int trackerOpen(
 */
 static int trackerClose(sqlite3_tokenizer_cursor *pCursor){
   TrackerCursor *pCsr = (TrackerCursor *)pCursor;
+  TrackerTokenizer *p = pCsr->tokenizer;
 
-  tracker_parser_free (pCsr->parser);
+  if (!g_atomic_pointer_compare_and_exchange (&p->spare_parser, NULL, pCsr->parser)){
+    tracker_parser_free (pCsr->parser);
+  }
   sqlite3_free(pCsr);
   return SQLITE_OK;
 }
@@ -183,6 +201,9 @@ static int trackerNext(
     }
   } while (stop_word && p->ignore_stop_words);
 
+  /* The token points to the parser buffer, valid until the next
+  ** call, FTS copies it itself if needed.
+  */
   *ppToken = pToken;
   *piStartOffset = start;
   *piEndOffset = end;
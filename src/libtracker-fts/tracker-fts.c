@@ -20,7 +20,12 @@
  */
 
 #include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
 #include <sqlite3.h>
+#include "tracker-fts-config.h"
 #include "tracker-fts-tokenizer.h"
 #include "tracker-fts.h"
 
@@ -28,6 +33,9 @@
 #  include "fts3.h"
 #endif
 
+/* Longer prefixes are selective enough for the regular term index */
+#define MAX_PREFIX_LENGTH 8
+
 static gchar **property_names;
 
 gboolean
@@ -239,6 +247,155 @@ tracker_fts_init_db (sqlite3 *db,
 	return TRUE;
 }
 
+static gint
+compare_int (gconstpointer a,
+             gconstpointer b)
+{
+	return *((const gint *) a) - *((const gint *) b);
+}
+
+/* Returns the value for the FTS4 prefix= option, or NULL if no
+ * prefix indexes should be built */
+static gchar *
+fts_get_prefix_option (void)
+{
+	const gchar *lengths_env;
+	GArray *lengths;
+	GString *str;
+	gint last = 0;
+	guint i;
+
+	lengths = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	/* TRACKER_FTS_PREFIX_LENGTHS overrides the configured lengths, e.g.
+	 * "1,2,3", an empty value disables prefix indexes - used by tests */
+	lengths_env = g_getenv ("TRACKER_FTS_PREFIX_LENGTHS");
+
+	if (lengths_env) {
+		gchar **strv;
+
+		strv = g_strsplit (lengths_env, ",", -1);
+
+		for (i = 0; strv[i]; i++) {
+			gint len;
+
+			if (strv[i][0] == '\0') {
+				continue;
+			}
+
+			len = atoi (strv[i]);
+			g_array_append_val (lengths, len);
+		}
+
+		g_strfreev (strv);
+	} else {
+		TrackerFTSConfig *config;
+		gint *values;
+		gsize n_values;
+
+		config = tracker_fts_config_new ();
+		values = tracker_fts_config_get_prefix_lengths (config, &n_values);
+		g_array_append_vals (lengths, values, n_values);
+		g_free (values);
+		g_object_unref (config);
+	}
+
+	g_array_sort (lengths, compare_int);
+	str = g_string_new (NULL);
+
+	for (i = 0; i < lengths->len; i++) {
+		gint len = g_array_index (lengths, gint, i);
+
+		/* Skip duplicates and out of range values */
+		if (len <= last || len > MAX_PREFIX_LENGTH) {
+			continue;
+		}
+
+		if (str->len > 0) {
+			g_string_append_c (str, ',');
+		}
+
+		g_string_append_printf (str, "%d", len);
+		last = len;
+	}
+
+	g_array_free (lengths, TRUE);
+
+	if (str->len == 0) {
+		g_string_free (str, TRUE);
+		return NULL;
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+/* Returns the prefix= option the table was created with, if any */
+static gchar *
+fts_get_table_prefix_option (sqlite3     *db,
+                             const gchar *table_name,
+                             gboolean    *exists)
+{
+	sqlite3_stmt *stmt;
+	gchar *prefix = NULL;
+	int rc;
+
+	*exists = FALSE;
+
+	rc = sqlite3_prepare_v2 (db,
+	                         "SELECT sql FROM sqlite_master "
+	                         "WHERE type = 'table' AND name = ?",
+	                         -1, &stmt, NULL);
+
+	if (rc != SQLITE_OK) {
+		return NULL;
+	}
+
+	sqlite3_bind_text (stmt, 1, table_name, -1, SQLITE_STATIC);
+
+	if (sqlite3_step (stmt) == SQLITE_ROW) {
+		const gchar *sql, *start, *end;
+
+		*exists = TRUE;
+		sql = (const gchar *) sqlite3_column_text (stmt, 0);
+		start = sql ? strstr (sql, "prefix=\"") : NULL;
+
+		if (start) {
+			start += strlen ("prefix=\"");
+			end = strchr (start, '"');
+
+			if (end) {
+				prefix = g_strndup (start, end - start);
+			}
+		}
+	}
+
+	sqlite3_finalize (stmt);
+
+	return prefix;
+}
+
+gboolean
+tracker_fts_prefix_lengths_changed (sqlite3     *db,
+                                    const gchar *table_name)
+{
+	gchar *wanted, *current;
+	gboolean changed, exists;
+
+	current = fts_get_table_prefix_option (db, table_name, &exists);
+
+	if (!exists) {
+		return FALSE;
+	}
+
+	wanted = fts_get_prefix_option ();
+	changed = (g_strcmp0 (wanted, current) != 0);
+
+	g_free (wanted);
+	g_free (current);
+
+	return changed;
+}
+
 gboolean
 tracker_fts_create_table (sqlite3    *db,
                           gchar      *table_name,
@@ -248,6 +405,7 @@ tracker_fts_create_table (sqlite3    *db,
 	GString *str, *from, *fts;
 	GHashTableIter iter;
 	gchar *index_table;
+	gchar *prefix;
 	GList *columns;
 	gint rc;
 
@@ -297,6 +455,15 @@ tracker_fts_create_table (sqlite3    *db,
 		return FALSE;
 	}
 
+	/* FTS4 prefix indexes cover all columns of the table, that is
+	 * every property the ontology marks as fulltext indexed */
+	prefix = fts_get_prefix_option ();
+
+	if (prefix) {
+		g_string_append_printf (fts, "prefix=\"%s\", ", prefix);
+		g_free (prefix);
+	}
+
 	g_string_append (fts, "tokenize=TrackerTokenizer)");
 	rc = sqlite3_exec(db, fts->str, NULL, 0, NULL);
 	g_string_free (fts, TRUE);
@@ -315,28 +482,23 @@ tracker_fts_alter_table (sqlite3    *db,
 
 	tmp_name = g_strdup_printf ("%s_TMP", table_name);
 
-	query = g_strdup_printf ("DROP VIEW fts_view");
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
+	rc = sqlite3_exec (db, "DROP VIEW fts_view", NULL, NULL, NULL);
 
-	if (!tracker_fts_create_table (db, tmp_name, tables, grouped_columns)) {
+	if (rc != SQLITE_OK) {
 		g_free (tmp_name);
-		g_free (query);
 		return FALSE;
 	}
 
-	query = g_strdup_printf ("INSERT INTO %s (docid) SELECT docid FROM %s",
-				 tmp_name, table_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
-	g_free (query);
-
-	if (rc != SQLITE_OK) {
+	if (!tracker_fts_create_table (db, tmp_name, tables, grouped_columns)) {
 		g_free (tmp_name);
 		return FALSE;
 	}
 
+	/* Repopulates the new table, including its prefix indexes,
+	 * from the content view */
 	query = g_strdup_printf ("INSERT INTO %s(%s) VALUES('rebuild')",
 				 tmp_name, tmp_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
+	rc = sqlite3_exec (db, query, NULL, NULL, NULL);
 	g_free (query);
 
 	if (rc != SQLITE_OK) {
@@ -344,17 +506,20 @@ tracker_fts_alter_table (sqlite3    *db,
 		return FALSE;
 	}
 
-	query = g_strdup_printf ("ALTER TABLE %s RENAME TO %s",
-				 tmp_name, table_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
+	query = g_strdup_printf ("DROP TABLE %s", table_name);
+	rc = sqlite3_exec (db, query, NULL, NULL, NULL);
 	g_free (query);
-	g_free (tmp_name);
-
 
 	if (rc != SQLITE_OK) {
 		g_free (tmp_name);
 		return FALSE;
 	}
 
-	return TRUE;
+	query = g_strdup_printf ("ALTER TABLE %s RENAME TO %s",
+				 tmp_name, table_name);
+	rc = sqlite3_exec (db, query, NULL, NULL, NULL);
+	g_free (query);
+	g_free (tmp_name);
+
+	return (rc == SQLITE_OK);
 }
@@ -38,6 +38,8 @@ gboolean    tracker_fts_alter_table      (sqlite3    *db,
                                           gchar      *table_name,
                                           GHashTable *tables,
                                           GHashTable *grouped_columns);
+gboolean    tracker_fts_prefix_lengths_changed (sqlite3     *db,
+                                                const gchar *table_name);
 
 
 G_END_DECLS
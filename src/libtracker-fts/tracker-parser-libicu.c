@@ -30,6 +30,7 @@
 #include <unicode/ustring.h>
 #include <unicode/uchar.h>
 #include <unicode/unorm.h>
+#include <unicode/uloc.h>
 
 #include "tracker-parser.h"
 #include "tracker-parser-utils.h"
@@ -44,6 +45,19 @@ typedef enum {
 /* Max possible length of a UChar encoded string (just a safety limit) */
 #define WORD_BUFFER_LENGTH 512
 
+/* Every UChar may take up to 3 bytes in UTF-8, plus the last NIL */
+#define WORD_BUFFER_LENGTH_UTF8 (3 * WORD_BUFFER_LENGTH + 1)
+
+/* Classes of ASCII characters, as far as word breaking is concerned */
+typedef enum {
+	ASCII_CLASS_OTHER,
+	ASCII_CLASS_ALETTER,
+	ASCII_CLASS_NUMERIC,
+	ASCII_CLASS_EXTEND_NUM_LET,
+	ASCII_CLASS_MID_NUM_LET,
+	ASCII_CLASS_MID_NUM
+} AsciiClass;
+
 struct TrackerParser {
 	const gchar           *txt;
 	gint                   txt_size;
@@ -58,15 +72,29 @@ struct TrackerParser {
 	gboolean               enable_forced_wordbreaks;
 
 	/* Private members */
-	gchar                 *word;
+	const gchar           *word;
 	gint                   word_length;
 	guint                  word_position;
 
+	/* Scratch buffer the processed words are written to, words
+	 * returned by tracker_parser_next() point here */
+	gchar                  word_buffer[WORD_BUFFER_LENGTH_UTF8];
+
+	/* Pure ASCII input is split in words without going through ICU */
+	gboolean               ascii_fast_path;
+	/* Whether ASCII letters lowercase to ASCII in the current locale */
+	gboolean               ascii_lowercase_safe;
+	/* Unset by tests comparing the fast path with ICU */
+	gboolean               ascii_fast_path_enabled;
+
 	/* Text as UChars */
 	UChar                 *utxt;
 	gint                   utxt_size;
 	/* Original offset of each UChar in the input txt string */
 	gint32                *offsets;
+	/* Allocated size (in elements) of utxt and offsets, these
+	 * are reused across resets */
+	gint                   utxt_allocated;
 
 	/* The word-break iterator */
 	UBreakIterator        *bi;
@@ -207,53 +235,85 @@ tracker_parser_unaccent_nfkd_string (gpointer  str,
 	return TRUE;
 }
 
-static gchar *
+static gboolean
 convert_UChar_to_utf8 (const UChar *word,
                        gsize        uchar_len,
+                       gchar       *utf8_str,
+                       gsize        utf8_size,
                        gsize       *utf8_len)
 {
-	gchar *utf8_str;
 	UErrorCode icu_error = U_ZERO_ERROR;
-	UConverter *converter;
-	gsize new_utf8_len;
-
-	g_return_val_if_fail (word, NULL);
-	g_return_val_if_fail (utf8_len, NULL);
-
-	/* Open converter UChar to UTF-16BE */
-	converter = ucnv_open ("UTF-8", &icu_error);
-	if (!converter) {
-		g_warning ("Cannot open UTF-8 converter: '%s'",
-		           U_FAILURE (icu_error) ? u_errorName (icu_error) : "none");
-		return NULL;
-	}
-
-	/* A character encoded in 2 bytes in UTF-16 may get expanded to 3 or 4 bytes
-	 *  in UTF-8. */
-	utf8_str = g_malloc (2 * uchar_len * sizeof (UChar) + 1);
-
-	/* Convert from UChar to UTF-8 (NIL-terminated) */
-	new_utf8_len = ucnv_fromUChars (converter,
-	                                utf8_str,
-	                                2 * uchar_len * sizeof (UChar) + 1,
-	                                word,
-	                                uchar_len,
-	                                &icu_error);
-	if (U_FAILURE (icu_error)) {
+	int32_t new_utf8_len;
+
+	g_return_val_if_fail (word, FALSE);
+	g_return_val_if_fail (utf8_len, FALSE);
+
+	/* Convert from UChar to UTF-8 (NIL-terminated), invalid
+	 * sequences are replaced the same way the UTF-8 converter does */
+	u_strToUTF8WithSub (utf8_str,
+	                    utf8_size,
+	                    &new_utf8_len,
+	                    word,
+	                    uchar_len,
+	                    0xFFFD,
+	                    NULL,
+	                    &icu_error);
+	if (U_FAILURE (icu_error) ||
+	    icu_error == U_STRING_NOT_TERMINATED_WARNING) {
 		g_warning ("Cannot convert from UChar to UTF-8: '%s'",
 		           u_errorName (icu_error));
-		g_free (utf8_str);
-		ucnv_close (converter);
-		return NULL;
+		return FALSE;
 	}
 
 	*utf8_len = new_utf8_len;
-	ucnv_close (converter);
 
-	return utf8_str;
+	return TRUE;
 }
 
-static gchar *
+/* Stop word check and stemming, done in place on the UTF-8 word
+ * already written to the parser word buffer */
+static gboolean
+process_word_utf8 (TrackerParser *parser,
+                   gsize          length,
+                   gboolean      *stop_word)
+{
+	gchar *utf8_str = parser->word_buffer;
+
+	/* Check if stop word */
+	if (parser->ignore_stop_words) {
+		*stop_word = tracker_language_is_stop_word (parser->language,
+		                                            utf8_str);
+	}
+
+	/* Stemming needed? */
+	if (parser->enable_stemmer) {
+		gchar stemmed[WORD_BUFFER_LENGTH_UTF8];
+		gsize stemmed_length;
+
+		/* Input for stemmer ALWAYS in UTF-8, as well as output */
+		stemmed_length = tracker_language_stem_word_to_buffer (parser->language,
+		                                                       utf8_str,
+		                                                       length,
+		                                                       stemmed,
+		                                                       sizeof (stemmed));
+
+		/* Log after stemming */
+		tracker_parser_message_hex ("    After stemming",
+		                            stemmed, strlen (stemmed));
+
+		if (stemmed_length < sizeof (stemmed)) {
+			memcpy (utf8_str, stemmed, stemmed_length + 1);
+			length = stemmed_length;
+		}
+	}
+
+	parser->word = utf8_str;
+	parser->word_length = length;
+
+	return TRUE;
+}
+
+static gboolean
 process_word_uchar (TrackerParser         *parser,
                     const UChar           *word,
                     gint                   length,
@@ -262,7 +322,6 @@ process_word_uchar (TrackerParser         *parser,
 {
 	UErrorCode error = U_ZERO_ERROR;
 	UChar normalized_buffer[WORD_BUFFER_LENGTH];
-	gchar *utf8_str = NULL;
 	gsize new_word_length;
 
 	/* Log original word */
@@ -284,7 +343,7 @@ process_word_uchar (TrackerParser         *parser,
 		if (U_FAILURE (error)) {
 			g_warning ("Error casefolding: '%s'",
 			           u_errorName (error));
-			return NULL;
+			return FALSE;
 		}
 		if (new_word_length > WORD_BUFFER_LENGTH)
 			new_word_length = WORD_BUFFER_LENGTH;
@@ -305,7 +364,7 @@ process_word_uchar (TrackerParser         *parser,
 		if (U_FAILURE (error)) {
 			g_warning ("Error normalizing: '%s'",
 			           u_errorName (error));
-			return NULL;
+			return FALSE;
 		}
 
 		if (new_word_length > WORD_BUFFER_LENGTH)
@@ -326,7 +385,7 @@ process_word_uchar (TrackerParser         *parser,
 		if (U_FAILURE (error)) {
 			g_warning ("Error lowercasing: '%s'",
 			           u_errorName (error));
-			return NULL;
+			return FALSE;
 		}
 
 		/* Log after casefolding */
@@ -346,43 +405,20 @@ process_word_uchar (TrackerParser         *parser,
 	}
 
 	/* Finally, convert to UTF-8 */
-	utf8_str = convert_UChar_to_utf8 (normalized_buffer,
-	                                  new_word_length,
-	                                  &new_word_length);
+	if (!convert_UChar_to_utf8 (normalized_buffer,
+	                            new_word_length,
+	                            parser->word_buffer,
+	                            sizeof (parser->word_buffer),
+	                            &new_word_length)) {
+		return FALSE;
+	}
 
 	/* Log after unaccenting */
 	tracker_parser_message_hex ("   After UTF8 conversion",
-	                            utf8_str,
+	                            parser->word_buffer,
 	                            new_word_length);
 
-	/* Check if stop word */
-	if (parser->ignore_stop_words) {
-		*stop_word = tracker_language_is_stop_word (parser->language,
-		                                            utf8_str);
-	}
-
-	/* Stemming needed? */
-	if (utf8_str &&
-	    parser->enable_stemmer) {
-		gchar *stemmed;
-
-		/* Input for stemmer ALWAYS in UTF-8, as well as output */
-		stemmed = tracker_language_stem_word (parser->language,
-		                                      utf8_str,
-		                                      new_word_length);
-
-		/* Log after stemming */
-		tracker_parser_message_hex ("    After stemming",
-		                            stemmed, strlen (stemmed));
-
-		/* If stemmed wanted and succeeded, free previous and return it */
-		if (stemmed) {
-			g_free (utf8_str);
-			return stemmed;
-		}
-	}
-
-	return utf8_str;
+	return process_word_utf8 (parser, new_word_length, stop_word);
 }
 
 static gboolean
@@ -426,6 +462,206 @@ parser_check_forced_wordbreaks (const UChar *buffer,
 	return FALSE;
 }
 
+static inline AsciiClass
+ascii_class (gchar c)
+{
+	if (g_ascii_isalpha (c)) {
+		return ASCII_CLASS_ALETTER;
+	} else if (g_ascii_isdigit (c)) {
+		return ASCII_CLASS_NUMERIC;
+	}
+
+	switch (c) {
+	case '_':
+		return ASCII_CLASS_EXTEND_NUM_LET;
+	case '\'':
+		return ASCII_CLASS_MID_NUM_LET;
+	case ',':
+	case ';':
+		return ASCII_CLASS_MID_NUM;
+	default:
+		/* Note that '.' (MidNumLet for UAX #29) is a forced
+		 * wordbreak for us, so it is handled as any other
+		 * separator here */
+		return ASCII_CLASS_OTHER;
+	}
+}
+
+/* Returns the end offset of the word starting at @start. This implements
+ * the subset of the UAX #29 word boundary rules that apply to ASCII
+ * text, as the ICU word break iterator does, plus our forced
+ * wordbreaks. */
+static gsize
+ascii_find_word_end (const gchar *txt,
+                     gsize        txt_size,
+                     gsize        start)
+{
+	AsciiClass current;
+	gsize i = start;
+
+	current = ascii_class (txt[i]);
+
+	if (current != ASCII_CLASS_ALETTER &&
+	    current != ASCII_CLASS_NUMERIC &&
+	    current != ASCII_CLASS_EXTEND_NUM_LET) {
+		/* Separators, we don't care about these being
+		 * split differently, they're all skipped */
+		return start + 1;
+	}
+
+	while (i + 1 < txt_size) {
+		AsciiClass next;
+
+		next = ascii_class (txt[i + 1]);
+
+		/* WB5, WB8, WB9, WB10, WB13a, WB13b */
+		if (next == ASCII_CLASS_ALETTER ||
+		    next == ASCII_CLASS_NUMERIC ||
+		    next == ASCII_CLASS_EXTEND_NUM_LET) {
+			current = next;
+			i++;
+			continue;
+		}
+
+		if (i + 2 < txt_size) {
+			AsciiClass after;
+
+			after = ascii_class (txt[i + 2]);
+
+			/* WB6, WB7: letter ' letter */
+			if (current == ASCII_CLASS_ALETTER &&
+			    next == ASCII_CLASS_MID_NUM_LET &&
+			    after == ASCII_CLASS_ALETTER) {
+				i += 2;
+				continue;
+			}
+
+			/* WB11, WB12: number [,;'] number */
+			if (current == ASCII_CLASS_NUMERIC &&
+			    (next == ASCII_CLASS_MID_NUM ||
+			     next == ASCII_CLASS_MID_NUM_LET) &&
+			    after == ASCII_CLASS_NUMERIC) {
+				i += 2;
+				continue;
+			}
+		}
+
+		break;
+	}
+
+	return i + 1;
+}
+
+static gboolean
+process_word_ascii (TrackerParser *parser,
+                    const gchar   *word,
+                    gsize          length,
+                    gboolean      *stop_word)
+{
+	gsize i;
+
+	/* Log original word */
+	tracker_parser_message_hex ("ORIGINAL word", word, length);
+
+	if (length >= sizeof (parser->word_buffer)) {
+		length = sizeof (parser->word_buffer) - 1;
+	}
+
+	/* For ASCII-only, just tolower() each character */
+	for (i = 0; i < length; i++) {
+		parser->word_buffer[i] = g_ascii_tolower (word[i]);
+	}
+
+	parser->word_buffer[length] = '\0';
+
+	/* Log after lowercasing */
+	tracker_parser_message_hex (" After lowercase",
+	                            parser->word_buffer, length);
+
+	return process_word_utf8 (parser, length, stop_word);
+}
+
+/* Same as parser_next(), for pure ASCII text. Offsets in the input
+ * text are byte offsets, and no UChar conversion is needed at all */
+static gboolean
+parser_next_ascii (TrackerParser *parser,
+                   gint          *byte_offset_start,
+                   gint          *byte_offset_end,
+                   gboolean      *stop_word)
+{
+	*byte_offset_start = 0;
+	*byte_offset_end = 0;
+
+	while (parser->cursor < parser->txt_size) {
+		gsize word_start, word_length;
+		gchar first;
+
+		word_start = parser->cursor;
+		parser->cursor = ascii_find_word_end (parser->txt,
+		                                      parser->txt_size,
+		                                      word_start);
+		word_length = parser->cursor - word_start;
+
+		/* Ignore the word if longer than the maximum allowed */
+		if (word_length >= parser->max_word_length) {
+			continue;
+		}
+
+		/* Ignore the word if not an allowed word start */
+		first = parser->txt[word_start];
+
+		if (!g_ascii_isalpha (first) &&
+		    !IS_UNDERSCORE_UCS4 ((guint32) first) &&
+		    (parser->ignore_numbers || !g_ascii_isdigit (first))) {
+			continue;
+		}
+
+		/* Check if word is reserved */
+		if (parser->ignore_reserved_words &&
+		    tracker_parser_is_reserved_word_utf8 (&parser->txt[word_start],
+		                                          word_length)) {
+			continue;
+		}
+
+		if (!process_word_ascii (parser,
+		                         &parser->txt[word_start],
+		                         word_length,
+		                         stop_word)) {
+			continue;
+		}
+
+		*byte_offset_start = word_start;
+		*byte_offset_end = parser->cursor;
+
+		return TRUE;
+	}
+
+	/* No more words... */
+	return FALSE;
+}
+
+static gboolean
+text_takes_ascii_fast_path (const gchar *txt,
+                            gsize        txt_size)
+{
+	gsize i;
+
+	for (i = 0; i < txt_size; i++) {
+		if (txt[i] & 0x80) {
+			return FALSE;
+		}
+
+		/* ':' is MidLetter in the ICU word break rules, so
+		 * whether "a:b" is one word depends on the ICU version
+		 * and locale, leave those texts to ICU */
+		if (txt[i] == ':') {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
 static gboolean
 parser_next (TrackerParser *parser,
              gint          *byte_offset_start,
@@ -434,7 +670,7 @@ parser_next (TrackerParser *parser,
 {
 	gsize word_length_uchar = 0;
 	gsize word_length_utf8 = 0;
-	gchar *processed_word = NULL;
+	gboolean processed_word = FALSE;
 	gsize current_word_offset_utf8;
 
 	*byte_offset_start = 0;
@@ -530,8 +766,8 @@ parser_next (TrackerParser *parser,
 		                    2 * WORD_BUFFER_LENGTH);
 
 		/* Process the word here. If it fails, we can still go
-		 *  to the next one. Returns newly allocated UTF-8
-		 *  string always.
+		 *  to the next one. The processed UTF-8 string is left
+		 *  in the parser word buffer.
 		 * Enable UNAC stripping only if no ASCII and no CJK
 		 * Note we are passing UChar encoded string here!
 		 */
@@ -556,9 +792,6 @@ parser_next (TrackerParser *parser,
 		/* Update cursor */
 		parser->cursor += word_length_uchar;
 
-		parser->word_length = strlen (processed_word);
-		parser->word = processed_word;
-
 		return TRUE;
 	}
 
@@ -567,7 +800,8 @@ parser_next (TrackerParser *parser,
 }
 
 TrackerParser *
-tracker_parser_new (TrackerLanguage *language)
+tracker_parser_new_full (TrackerLanguage *language,
+                         gboolean         ascii_fast_path)
 {
 	TrackerParser *parser;
 
@@ -577,9 +811,23 @@ tracker_parser_new (TrackerLanguage *language)
 
 	parser->language = g_object_ref (language);
 
+	/* In turkic locales, ASCII 'I' lowercases to a dotless i,
+	 * so lowercasing can't be done byte by byte there */
+	parser->ascii_lowercase_safe =
+		(strncmp (uloc_getDefault (), "tr", 2) != 0 &&
+		 strncmp (uloc_getDefault (), "az", 2) != 0);
+
+	parser->ascii_fast_path_enabled = ascii_fast_path;
+
 	return parser;
 }
 
+TrackerParser *
+tracker_parser_new (TrackerLanguage *language)
+{
+	return tracker_parser_new_full (language, TRUE);
+}
+
 void
 tracker_parser_free (TrackerParser *parser)
 {
@@ -596,8 +844,6 @@ tracker_parser_free (TrackerParser *parser)
 	g_free (parser->utxt);
 	g_free (parser->offsets);
 
-	g_free (parser->word);
-
 	g_free (parser);
 }
 
@@ -635,22 +881,28 @@ tracker_parser_reset (TrackerParser *parser,
 	parser->txt_size = txt_size;
 	parser->txt = txt;
 
-	g_free (parser->word);
 	parser->word = NULL;
 
 	if (parser->bi) {
 		ubrk_close (parser->bi);
 		parser->bi = NULL;
 	}
-	g_free (parser->utxt);
-	parser->utxt = NULL;
-	g_free (parser->offsets);
-	parser->offsets = NULL;
+	parser->utxt_size = 0;
 
 	parser->word_position = 0;
 
 	parser->cursor = 0;
 
+	/* Pure ASCII text is split in words and lowercased by
+	 * ourselves, no need to go through UChars at all */
+	parser->ascii_fast_path = (parser->ascii_lowercase_safe &&
+	                           parser->ascii_fast_path_enabled &&
+	                           text_takes_ascii_fast_path (txt, txt_size));
+
+	if (parser->ascii_fast_path) {
+		return;
+	}
+
 	/* Open converter UTF-8 to UChar */
 	converter = ucnv_open ("UTF-8", &error);
 	if (!converter) {
@@ -659,10 +911,17 @@ tracker_parser_reset (TrackerParser *parser,
 		return;
 	}
 
-	/* Allocate UChars and offsets buffers */
+	/* Allocate UChars and offsets buffers, if the previous
+	 * ones are not big enough */
 	parser->utxt_size = txt_size + 1;
-	parser->utxt = g_malloc (parser->utxt_size * sizeof (UChar));
-	parser->offsets = g_malloc (parser->utxt_size * sizeof (gint32));
+
+	if (parser->utxt_size > parser->utxt_allocated) {
+		parser->utxt_allocated = parser->utxt_size;
+		parser->utxt = g_realloc (parser->utxt,
+		                          parser->utxt_allocated * sizeof (UChar));
+		parser->offsets = g_realloc (parser->offsets,
+		                             parser->utxt_allocated * sizeof (gint32));
+	}
 
 	/* last_uchar and last_utf8 will be also an output parameter! */
 	last_uchar = parser->utxt;
@@ -703,6 +962,7 @@ tracker_parser_reset (TrackerParser *parser,
 		g_free (parser->offsets);
 		parser->offsets = NULL;
 		parser->utxt_size = 0;
+		parser->utxt_allocated = 0;
 		if (parser->bi) {
 			ubrk_close (parser->bi);
 			parser->bi = NULL;
@@ -726,12 +986,16 @@ tracker_parser_next (TrackerParser *parser,
 
 	str = NULL;
 
-	g_free (parser->word);
 	parser->word = NULL;
+	parser->word_length = 0;
 
 	*stop_word = FALSE;
 
-	if (parser_next (parser, &byte_start, &byte_end, stop_word)) {
+	if (parser->ascii_fast_path) {
+		if (parser_next_ascii (parser, &byte_start, &byte_end, stop_word)) {
+			str = parser->word;
+		}
+	} else if (parser_next (parser, &byte_start, &byte_end, stop_word)) {
 		str = parser->word;
 	}
 
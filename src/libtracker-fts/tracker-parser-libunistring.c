@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* libunistring versions prior to 9.1.2 need this hack */
@@ -57,14 +58,21 @@ struct TrackerParser {
 	gboolean               enable_forced_wordbreaks;
 
 	/* Private members */
-	gchar                 *word;
+	const gchar           *word;
 	gint                   word_length;
 	guint                  word_position;
 
+	/* Scratch buffer the processed words are written to, words
+	 * returned by tracker_parser_next() point here. It is grown
+	 * if ever needed and reused across words and resets */
+	gchar                 *word_buffer;
+	gsize                  word_buffer_size;
+
 	/* Cursor, as index of the input array of bytes */
 	gsize                  cursor;
 	/* libunistring flags array */
 	gchar                 *word_break_flags;
+	gsize                  word_break_flags_size;
 	/* general category of the  start character in words */
 	uc_general_category_t  allowed_start;
 };
@@ -218,20 +226,29 @@ tracker_parser_unaccent_nfkd_string (gpointer  str,
 	return TRUE;
 }
 
-static gchar *
+static void
+parser_ensure_word_buffer (TrackerParser *parser,
+                           gsize          size)
+{
+	if (size > parser->word_buffer_size) {
+		parser->word_buffer_size = MAX (size, 2 * parser->word_buffer_size);
+		parser->word_buffer = g_realloc (parser->word_buffer,
+		                                 parser->word_buffer_size);
+	}
+}
+
+static gboolean
 process_word_utf8 (TrackerParser         *parser,
                    const gchar           *word,
                    gint                   length,
                    TrackerParserWordType  type,
                    gboolean              *stop_word)
 {
-	gchar word_buffer [WORD_BUFFER_LENGTH];
-	gchar *normalized = NULL;
-	gchar *stemmed = NULL;
+	gchar *normalized;
 	size_t new_word_length;
 
-	g_return_val_if_fail (parser != NULL, NULL);
-	g_return_val_if_fail (word != NULL, NULL);
+	g_return_val_if_fail (parser != NULL, FALSE);
+	g_return_val_if_fail (word != NULL, FALSE);
 
 	/* If length is set as -1, the input word MUST be NIL-terminated.
 	 * Otherwise, this restriction is not needed as the length to process
@@ -246,29 +263,34 @@ process_word_utf8 (TrackerParser         *parser,
 
 	/* Normalization and case-folding ONLY for non-ASCII */
 	if (type != TRACKER_PARSER_WORD_TYPE_ASCII) {
+		gchar *casefolded;
+
 		/* Leave space for last NIL */
-		new_word_length = WORD_BUFFER_LENGTH - 1;
+		new_word_length = parser->word_buffer_size - 1;
 
 		/* Casefold and NFKD normalization in output.
 		 * NOTE: if the output buffer is not big enough, u8_casefold will
 		 * return a newly-allocated buffer. */
-		normalized = u8_casefold ((const uint8_t *)word,
+		casefolded = u8_casefold ((const uint8_t *)word,
 		                          length,
 		                          uc_locale_language (),
 		                          UNINORM_NFKD,
-		                          word_buffer,
+		                          parser->word_buffer,
 		                          &new_word_length);
 
 		/* Case folding + Normalization failed, ignore this word */
-		g_return_val_if_fail (normalized != NULL, NULL);
-
-		/* If output buffer is not the same as the one passed to
-		 * u8_casefold, we know it was newly-allocated, so need
-		 * to resize it in 1 byte to add last NIL */
-		if (normalized != word_buffer) {
-			normalized = g_realloc (normalized, new_word_length + 1);
+		g_return_val_if_fail (casefolded != NULL, FALSE);
+
+		/* If output buffer is not the one passed to u8_casefold,
+		 * it was newly-allocated, so grow our buffer to fit it */
+		if (casefolded != parser->word_buffer) {
+			parser_ensure_word_buffer (parser, new_word_length + 1);
+			memcpy (parser->word_buffer, casefolded, new_word_length);
+			free (casefolded);
 		}
 
+		normalized = parser->word_buffer;
+
 		/* Log after Normalization */
 		tracker_parser_message_hex (" After Casefolding and NFKD normalization",
 		                            normalized, new_word_length);
@@ -276,7 +298,8 @@ process_word_utf8 (TrackerParser         *parser,
 		/* For ASCII-only, just tolower() each character */
 		gsize i;
 
-		normalized = length > WORD_BUFFER_LENGTH ? g_malloc (length + 1) : word_buffer;
+		parser_ensure_word_buffer (parser, length + 1);
+		normalized = parser->word_buffer;
 
 		for (i = 0; i < length; i++) {
 			normalized[i] = g_ascii_tolower (word[i]);
@@ -309,27 +332,30 @@ process_word_utf8 (TrackerParser         *parser,
 
 	/* Stemming needed? */
 	if (parser->enable_stemmer) {
-		stemmed = tracker_language_stem_word (parser->language,
-		                                      normalized,
-		                                      new_word_length);
+		gchar stem_buffer [WORD_BUFFER_LENGTH];
+		gsize stem_length;
+
+		stem_length = tracker_language_stem_word_to_buffer (parser->language,
+		                                                    normalized,
+		                                                    new_word_length,
+		                                                    stem_buffer,
+		                                                    sizeof (stem_buffer));
 
 		/* Log after stemming */
 		tracker_parser_message_hex ("   After stemming",
-		                            stemmed, strlen (stemmed));
-	}
+		                            stem_buffer, strlen (stem_buffer));
 
-	/* If stemmed wanted and succeeded, free previous and return it */
-	if (stemmed) {
-		if (normalized != word_buffer) {
-			g_free (normalized);
+		if (stem_length < sizeof (stem_buffer)) {
+			parser_ensure_word_buffer (parser, stem_length + 1);
+			memcpy (parser->word_buffer, stem_buffer, stem_length + 1);
+			new_word_length = stem_length;
 		}
-		return stemmed;
 	}
 
-	/* It may be the case that no stripping and no stemming was needed, and
-	 * that the output buffer in stack was enough for case-folding and
-	 * normalization. In this case, need to strdup() the string to return it */
-	return normalized == word_buffer ? g_strdup (word_buffer) : normalized;
+	parser->word = parser->word_buffer;
+	parser->word_length = new_word_length;
+
+	return TRUE;
 }
 
 static gboolean
@@ -339,7 +365,7 @@ parser_next (TrackerParser *parser,
              gboolean      *stop_word)
 {
 	gsize word_length = 0;
-	gchar *processed_word = NULL;
+	gboolean processed_word = FALSE;
 
 	*byte_offset_start = 0;
 	*byte_offset_end = 0;
@@ -393,8 +419,8 @@ parser_next (TrackerParser *parser,
 		                    WORD_BUFFER_LENGTH - 1);
 
 		/* Process the word here. If it fails, we can still go
-		 *  to the next one. Returns newly allocated string
-		 *  always */
+		 *  to the next one. The processed string is left in
+		 *  the parser word buffer */
 		processed_word = process_word_utf8 (parser,
 		                                    &(parser->txt[parser->cursor]),
 		                                    truncated_length,
@@ -416,9 +442,6 @@ parser_next (TrackerParser *parser,
 		/* Update cursor */
 		parser->cursor += word_length;
 
-		parser->word_length = strlen (processed_word);
-		parser->word = processed_word;
-
 		return TRUE;
 	}
 
@@ -437,6 +460,9 @@ tracker_parser_new (TrackerLanguage *language)
 
 	parser->language = g_object_ref (language);
 
+	parser->word_buffer_size = WORD_BUFFER_LENGTH;
+	parser->word_buffer = g_malloc (parser->word_buffer_size);
+
 	return parser;
 }
 
@@ -451,7 +477,7 @@ tracker_parser_free (TrackerParser *parser)
 
 	g_free (parser->word_break_flags);
 
-	g_free (parser->word);
+	g_free (parser->word_buffer);
 
 	g_free (parser);
 }
@@ -485,17 +511,19 @@ tracker_parser_reset (TrackerParser *parser,
 	parser->txt_size = txt_size;
 	parser->txt = txt;
 
-	g_free (parser->word);
 	parser->word = NULL;
 
 	parser->word_position = 0;
 
 	parser->cursor = 0;
 
-	g_free (parser->word_break_flags);
-
-	/* Create array of flags, same size as original text. */
-	parser->word_break_flags = g_malloc (txt_size);
+	/* Create array of flags, same size as original text. The
+	 * previous one is reused if big enough */
+	if ((gsize) txt_size > parser->word_break_flags_size) {
+		parser->word_break_flags_size = txt_size;
+		parser->word_break_flags = g_realloc (parser->word_break_flags,
+		                                      parser->word_break_flags_size);
+	}
 
 	/* Get wordbreak flags in the whole string */
 	u8_wordbreaks ((const uint8_t *)txt,
@@ -523,8 +551,8 @@ tracker_parser_next (TrackerParser *parser,
 
 	str = NULL;
 
-	g_free (parser->word);
 	parser->word = NULL;
+	parser->word_length = 0;
 
 	*stop_word = FALSE;
 
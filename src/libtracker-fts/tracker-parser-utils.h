@@ -28,6 +28,8 @@
 #include <unicode/utypes.h>
 #endif
 
+#include "tracker-parser.h"
+
 G_BEGIN_DECLS
 
 /* ASCII-7 is in range [0x00,0x7F] */
@@ -64,6 +66,13 @@ G_BEGIN_DECLS
 gboolean tracker_parser_is_reserved_word_utf8 (const gchar *word,
                                                gsize word_length);
 
+#ifdef HAVE_LIBICU
+/* Only for tests comparing the ASCII fast path of the ICU parser
+ * with the ICU word break iterator */
+TrackerParser *tracker_parser_new_full (TrackerLanguage *language,
+                                        gboolean         ascii_fast_path);
+#endif
+
 
 /* Define to 1 if you want to enable debugging logs showing HEX contents
  * of the words being parsed */
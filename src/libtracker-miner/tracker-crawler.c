@@ -19,6 +19,8 @@
 
 #include "config.h"
 
+#include <libtracker-common/tracker-trace.h>
+
 #include "tracker-crawler.h"
 #include "tracker-utils.h"
 
@@ -106,6 +108,7 @@ typedef struct {
 	DirectoryProcessingData *dir_info;
 	GFile *dir_file;
 	GCancellable *cancellable;
+	gint64 start;
 } EnumeratorData;
 
 static void     crawler_finalize        (GObject         *object);
@@ -599,6 +602,7 @@ enumerator_data_new (TrackerCrawler          *crawler,
 	 * iterating it */
 	ed->dir_file = g_object_ref (G_FILE (dir_info->node->data));
 	ed->cancellable = g_cancellable_new ();
+	ed->start = tracker_trace_begin ();
 
 	crawler->priv->cancellables = g_list_prepend (crawler->priv->cancellables,
 						      ed->cancellable);
@@ -710,6 +714,7 @@ file_enumerate_next_cb (GObject      *object,
 
 		if (!cancelled) {
 			enumerator_data_process (ed);
+			tracker_trace_end (TRACKER_TRACE_CRAWL, ed->start);
 		}
 
 		enumerator_data_free (ed);
@@ -179,7 +179,10 @@ tracker_media_art_queue_remove (const gchar *uri,
 
 	g_return_val_if_fail (uri != NULL, FALSE);
 
-	if (mime_type && (g_str_has_prefix (mime_type, "video/") || g_str_has_prefix (mime_type, "audio/"))) {
+	/* Removals only mark the media art cache as dirty, however many
+	 * there are, it is then checked once against the whole store.
+	 * Directories are removed without a mime type, so may hold media */
+	if (!mime_type || g_str_has_prefix (mime_type, "video/") || g_str_has_prefix (mime_type, "audio/")) {
 		had_any = TRUE;
 	}
 
@@ -191,8 +194,9 @@ on_timer_callback (gpointer data)
 {
 	TrackerSparqlConnection *connection = data;
 
+	/* One row per album still having songs, not one per song */
 	tracker_sparql_connection_query_async (connection,
-	                                       "SELECT ?title nmm:artistName (?artist) WHERE { "
+	                                       "SELECT DISTINCT ?title nmm:artistName (?artist) WHERE { "
 	                                       "  ?mpiece nmm:musicAlbum ?album . "
 	                                       "  ?album nmm:albumTitle ?title . "
 	                                       "  OPTIONAL { ?album nmm:albumArtist ?artist } "
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_MINER_FS_INTERNAL_H__
+#define __LIBTRACKER_MINER_FS_INTERNAL_H__
+
+#include "tracker-miner-fs.h"
+
+G_BEGIN_DECLS
+
+/* Not part of the public API, only used by the miners shipped with
+ * Tracker. This header is not installed. */
+void tracker_miner_fs_file_notify_unchanged (TrackerMinerFS *fs,
+                                             GFile          *file);
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_MINER_FS_INTERNAL_H__ */
@@ -23,10 +23,12 @@
 #include <libtracker-common/tracker-dbus.h>
 #include <libtracker-common/tracker-file-utils.h>
 #include <libtracker-common/tracker-log.h>
+#include <libtracker-common/tracker-trace.h>
 #include <libtracker-common/tracker-utils.h>
 
 #include "tracker-crawler.h"
 #include "tracker-miner-fs.h"
+#include "tracker-miner-fs-internal.h"
 #include "tracker-media-art.h"
 #include "tracker-monitor.h"
 #include "tracker-utils.h"
@@ -166,6 +168,7 @@ struct _TrackerMinerFSPrivate {
 	GQuark          quark_attribute_updated;
 	GQuark          quark_directory_found_crawling;
 	GQuark          quark_reentry_counter;
+	GQuark          quark_queued_time;
 
 	GTimer         *timer;
 	GTimer         *extraction_timer;
@@ -614,6 +617,7 @@ tracker_miner_fs_init (TrackerMinerFS *object)
 	priv->quark_directory_found_crawling = g_quark_from_static_string ("tracker-directory-found-crawling");
 	priv->quark_attribute_updated = g_quark_from_static_string ("tracker-attribute-updated");
 	priv->quark_reentry_counter = g_quark_from_static_string ("tracker-reentry-counter");
+	priv->quark_queued_time = g_quark_from_static_string ("tracker-queued-time");
 
 	priv->mtime_checking = TRUE;
 	priv->initial_crawling = TRUE;
@@ -1168,7 +1172,8 @@ do_process_file (TrackerMinerFS *fs,
 static void
 item_add_or_update_cb (TrackerMinerFS *fs,
                        TrackerTask    *extraction_task,
-                       const GError   *error)
+                       const GError   *error,
+                       gboolean        unchanged)
 {
 	UpdateProcessingTaskContext *ctxt;
 	TrackerTask *sparql_task = NULL;
@@ -1191,6 +1196,15 @@ item_add_or_update_cb (TrackerMinerFS *fs,
 			sparql_task = tracker_sparql_task_new_with_sparql (task_file,
 			                                                   ctxt->builder);
 		}
+	} else if (unchanged && ctxt->urn) {
+		/* The implementation found the item unchanged through
+		 * tracker_miner_fs_file_notify_unchanged(), so keep the
+		 * data in the store untouched */
+		g_debug ("Item '%s' with urn '%s' is unchanged", uri, ctxt->urn);
+
+		if (tracker_sparql_builder_get_length (ctxt->builder) > 0) {
+			sparql_task = tracker_sparql_task_new_with_sparql (task_file, ctxt->builder);
+		}
 	} else {
 		if (ctxt->urn) {
 			gboolean attribute_update_only;
@@ -2173,6 +2187,18 @@ item_queue_handlers_cb (gpointer user_data)
 		return FALSE;
 	}
 
+	if (file) {
+		gint64 *queued_time;
+
+		queued_time = g_object_steal_qdata (G_OBJECT (file),
+		                                    fs->priv->quark_queued_time);
+
+		if (queued_time) {
+			tracker_trace_end (TRACKER_TRACE_QUEUE_WAIT, *queued_time);
+			g_free (queued_time);
+		}
+	}
+
 	if (file && queue != QUEUE_DELETED &&
 	    tracker_file_is_locked (file)) {
 		gchar *uri;
@@ -2545,8 +2571,17 @@ miner_fs_queue_file (TrackerMinerFS       *fs,
 		     TrackerPriorityQueue *item_queue,
 		     GFile                *file)
 {
+	gint64 *queued_time;
 	gint priority;
 
+	/* Kept to tell how long items wait before being processed */
+	queued_time = g_new (gint64, 1);
+	*queued_time = tracker_trace_begin ();
+	g_object_set_qdata_full (G_OBJECT (file),
+	                         fs->priv->quark_queued_time,
+	                         queued_time,
+	                         g_free);
+
 	priority = miner_fs_get_queue_priority (fs, file);
 	tracker_priority_queue_add (item_queue, g_object_ref (file), priority);
 }
@@ -3391,28 +3426,14 @@ tracker_miner_fs_check_directory (TrackerMinerFS *fs,
 	                                                check_parents);
 }
 
-/**
- * tracker_miner_fs_file_notify:
- * @fs: a #TrackerMinerFS
- * @file: a #GFile
- * @error: a #GError with the error that happened during processing, or %NULL.
- *
- * Notifies @fs that all processing on @file has been finished, if any error
- * happened during file data processing, it should be passed in @error, else
- * that parameter will contain %NULL to reflect success.
- *
- * Since: 0.8
- **/
-void
-tracker_miner_fs_file_notify (TrackerMinerFS *fs,
-                              GFile          *file,
-                              const GError   *error)
+static void
+file_notify (TrackerMinerFS *fs,
+             GFile          *file,
+             const GError   *error,
+             gboolean        unchanged)
 {
 	TrackerTask *task;
 
-	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
-	g_return_if_fail (G_IS_FILE (file));
-
 	fs->priv->total_files_notified++;
 
 	task = tracker_task_pool_find (fs->priv->task_pool, file);
@@ -3440,7 +3461,54 @@ tracker_miner_fs_file_notify (TrackerMinerFS *fs,
 		return;
 	}
 
-	item_add_or_update_cb (fs, task, error);
+	item_add_or_update_cb (fs, task, error, unchanged);
+}
+
+/**
+ * tracker_miner_fs_file_notify:
+ * @fs: a #TrackerMinerFS
+ * @file: a #GFile
+ * @error: a #GError with the error that happened during processing, or %NULL.
+ *
+ * Notifies @fs that all processing on @file has been finished, if any error
+ * happened during file data processing, it should be passed in @error, else
+ * that parameter will contain %NULL to reflect success.
+ *
+ * Since: 0.8
+ **/
+void
+tracker_miner_fs_file_notify (TrackerMinerFS *fs,
+                              GFile          *file,
+                              const GError   *error)
+{
+	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
+	g_return_if_fail (G_IS_FILE (file));
+
+	file_notify (fs, file, error, FALSE);
+}
+
+/*
+ * tracker_miner_fs_file_notify_unchanged:
+ * @fs: a #TrackerMinerFS
+ * @file: a #GFile
+ *
+ * Notifies @fs that processing on @file has finished successfully and
+ * that @file was found unchanged since it was last indexed, so its data
+ * in the store should be left untouched. Anything added to the
+ * #TrackerSparqlBuilder given in #TrackerMinerFS::process-file is still
+ * executed, without deleting the existing data first.
+ *
+ * This should only be used for files that already exist in the store,
+ * other files are handled as with tracker_miner_fs_file_notify().
+ */
+void
+tracker_miner_fs_file_notify_unchanged (TrackerMinerFS *fs,
+                                        GFile          *file)
+{
+	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
+	g_return_if_fail (G_IS_FILE (file));
+
+	file_notify (fs, file, NULL, TRUE);
 }
 
 /**
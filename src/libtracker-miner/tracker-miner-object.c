@@ -24,6 +24,7 @@
 #include <glib/gi18n.h>
 
 #include <libtracker-common/tracker-dbus.h>
+#include <libtracker-common/tracker-trace.h>
 #include <libtracker-common/tracker-type-utils.h>
 
 #include "tracker-miner-object.h"
@@ -100,6 +101,9 @@ static const gchar introspection_xml[] =
   "    <method name='IgnoreNextUpdate'>"
   "      <arg type='as' name='urls' direction='in' />"
   "    </method>"
+  "    <method name='GetLatency'>"
+  "      <arg type='a(sxxxxxx)' name='latency_stats' direction='out' />"
+  "    </method>"
   "    <signal name='Started' />"
   "    <signal name='Stopped' />"
   "    <signal name='Paused' />"
@@ -1392,6 +1396,25 @@ handle_method_call_get_status (TrackerMiner          *miner,
 
 }
 
+static void
+handle_method_call_get_latency (TrackerMiner          *miner,
+                                GDBusMethodInvocation *invocation,
+                                GVariant              *parameters)
+{
+	TrackerDBusRequest *request;
+	GVariant *stats;
+
+	request = tracker_g_dbus_request_begin (invocation, "%s()", __PRETTY_FUNCTION__);
+
+	/* Latencies are per process, not per miner */
+	stats = tracker_trace_get_stats ();
+
+	tracker_dbus_request_end (request, NULL);
+	g_dbus_method_invocation_return_value (invocation,
+	                                       g_variant_new ("(@a(sxxxxxx))", stats));
+	g_variant_unref (stats);
+}
+
 static void
 handle_method_call (GDBusConnection       *connection,
                     const gchar           *sender,
@@ -1422,6 +1445,8 @@ handle_method_call (GDBusConnection       *connection,
 		handle_method_call_get_progress (miner, invocation, parameters);
 	} else if (g_strcmp0 (method_name, "GetStatus") == 0) {
 		handle_method_call_get_status (miner, invocation, parameters);
+	} else if (g_strcmp0 (method_name, "GetLatency") == 0) {
+		handle_method_call_get_latency (miner, invocation, parameters);
 	} else {
 		g_assert_not_reached ();
 	}
@@ -47,6 +47,17 @@
 #define THUMBMAN_PATH           "/org/freedesktop/thumbnails/Thumbnailer1"
 #define THUMBMAN_INTERFACE      "org.freedesktop.thumbnails.Thumbnailer1"
 
+/* URIs sent per D-Bus call, pending requests flushed on their own
+ * once there are this many, or after this many seconds */
+#define MAX_URIS_PER_REQUEST    500
+#define FLUSH_THRESHOLD         2000
+#define FLUSH_TIMEOUT           10
+
+typedef struct {
+	gchar *from;
+	gchar *to;
+} ThumbnailMove;
+
 typedef struct {
 	GDBusProxy *cache_proxy;
 	GDBusProxy *manager_proxy;
@@ -54,9 +65,12 @@ typedef struct {
 
 	GStrv supported_mime_types;
 
-	GSList *removes;
-	GSList *moves_to;
-	GSList *moves_from;
+	/* Removed URIs, and moves in request order indexed by
+	 * destination so chains of moves collapse into one */
+	GHashTable *removes;
+	GQueue *moves;
+	GHashTable *moves_by_dest;
+	guint flush_id;
 
 	guint request_id;
 	gboolean service_is_available;
@@ -69,6 +83,25 @@ G_DEFINE_TYPE_WITH_CODE (TrackerThumbnailer, tracker_thumbnailer, G_TYPE_OBJECT,
 						tracker_thumbnailer_initable_iface_init)
 			 G_ADD_PRIVATE (TrackerThumbnailer))
 
+static void
+thumbnail_move_free (ThumbnailMove *move)
+{
+	g_free (move->from);
+	g_free (move->to);
+	g_slice_free (ThumbnailMove, move);
+}
+
+static void
+thumbnailer_clear_queues (TrackerThumbnailerPrivate *private)
+{
+	g_hash_table_remove_all (private->removes);
+	g_hash_table_remove_all (private->moves_by_dest);
+
+	while (!g_queue_is_empty (private->moves)) {
+		thumbnail_move_free (g_queue_pop_head (private->moves));
+	}
+}
+
 static void
 tracker_thumbnailer_finalize (GObject *object)
 {
@@ -92,14 +125,14 @@ tracker_thumbnailer_finalize (GObject *object)
 
 	g_strfreev (private->supported_mime_types);
 
-	g_slist_foreach (private->removes, (GFunc) g_free, NULL);
-	g_slist_free (private->removes);
-
-	g_slist_foreach (private->moves_to, (GFunc) g_free, NULL);
-	g_slist_free (private->moves_to);
+	if (private->flush_id) {
+		g_source_remove (private->flush_id);
+	}
 
-	g_slist_foreach (private->moves_from, (GFunc) g_free, NULL);
-	g_slist_free (private->moves_from);
+	thumbnailer_clear_queues (private);
+	g_hash_table_unref (private->removes);
+	g_hash_table_unref (private->moves_by_dest);
+	g_queue_free (private->moves);
 
 	G_OBJECT_CLASS (tracker_thumbnailer_parent_class)->finalize (object);
 }
@@ -254,6 +287,53 @@ tracker_thumbnailer_class_init (TrackerThumbnailerClass *klass)
 static void
 tracker_thumbnailer_init (TrackerThumbnailer *thumbnailer)
 {
+	TrackerThumbnailerPrivate *private;
+
+	private = tracker_thumbnailer_get_instance_private (thumbnailer);
+
+	private->removes = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                          g_free, NULL);
+	private->moves = g_queue_new ();
+
+	/* Keys are owned by the ThumbnailMove in the queue */
+	private->moves_by_dest = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static gboolean
+flush_cb (gpointer user_data)
+{
+	TrackerThumbnailer *thumbnailer = user_data;
+	TrackerThumbnailerPrivate *private;
+
+	private = tracker_thumbnailer_get_instance_private (thumbnailer);
+	private->flush_id = 0;
+
+	tracker_thumbnailer_send (thumbnailer);
+
+	return FALSE;
+}
+
+static void
+thumbnailer_schedule_flush (TrackerThumbnailer *thumbnailer)
+{
+	TrackerThumbnailerPrivate *private;
+	guint pending;
+
+	private = tracker_thumbnailer_get_instance_private (thumbnailer);
+	pending = g_hash_table_size (private->removes) +
+		g_queue_get_length (private->moves);
+
+	if (pending >= FLUSH_THRESHOLD) {
+		if (private->flush_id) {
+			g_source_remove (private->flush_id);
+		}
+
+		private->flush_id = g_idle_add (flush_cb, thumbnailer);
+	} else if (private->flush_id == 0) {
+		private->flush_id = g_timeout_add_seconds (FLUSH_TIMEOUT,
+		                                           flush_cb,
+		                                           thumbnailer);
+	}
 }
 
 TrackerThumbnailer *
@@ -283,6 +363,8 @@ tracker_thumbnailer_move_add (TrackerThumbnailer *thumbnailer,
                               const gchar        *to_uri)
 {
 	TrackerThumbnailerPrivate *private;
+	ThumbnailMove *move = NULL;
+	GList *link;
 
 	/* mime_type can be NULL */
 	g_return_val_if_fail (TRACKER_IS_THUMBNAILER (thumbnailer), FALSE);
@@ -299,8 +381,44 @@ tracker_thumbnailer_move_add (TrackerThumbnailer *thumbnailer,
 		return FALSE;
 	}
 
-	private->moves_from = g_slist_prepend (private->moves_from, g_strdup (from_uri));
-	private->moves_to = g_slist_prepend (private->moves_to, g_strdup (to_uri));
+	link = g_hash_table_lookup (private->moves_by_dest, from_uri);
+
+	if (link) {
+		move = link->data;
+
+		/* Anything moved onto the original location since must
+		 * keep its place in the queue, so only merge otherwise */
+		if (!g_hash_table_contains (private->moves_by_dest, move->from)) {
+			g_hash_table_remove (private->moves_by_dest, move->to);
+			g_queue_delete_link (private->moves, link);
+
+			if (g_strcmp0 (move->from, to_uri) == 0) {
+				/* Moved back to where it was */
+				g_debug ("Thumbnailer request to move uri from:'%s' to:'%s' cancels a queued move",
+				         from_uri,
+				         to_uri);
+				thumbnail_move_free (move);
+				return TRUE;
+			}
+
+			g_free (move->to);
+			move->to = g_strdup (to_uri);
+		} else {
+			move = NULL;
+		}
+	}
+
+	if (!move) {
+		move = g_slice_new (ThumbnailMove);
+		move->from = g_strdup (from_uri);
+		move->to = g_strdup (to_uri);
+	}
+
+	g_queue_push_tail (private->moves, move);
+	g_hash_table_replace (private->moves_by_dest,
+	                      move->to,
+	                      g_queue_peek_tail_link (private->moves));
+	thumbnailer_schedule_flush (thumbnailer);
 
 	g_debug ("Thumbnailer request to move uri from:'%s' to:'%s' queued",
 	         from_uri,
@@ -328,6 +446,7 @@ tracker_thumbnailer_remove_add (TrackerThumbnailer *thumbnailer,
                                 const gchar        *mime_type)
 {
 	TrackerThumbnailerPrivate *private;
+	GList *link;
 
 	g_return_val_if_fail (TRACKER_IS_THUMBNAILER (thumbnailer), FALSE);
 	/* mime_type can be NULL */
@@ -343,7 +462,29 @@ tracker_thumbnailer_remove_add (TrackerThumbnailer *thumbnailer,
 		return FALSE;
 	}
 
-	private->removes = g_slist_prepend (private->removes, g_strdup (uri));
+	link = g_hash_table_lookup (private->moves_by_dest, uri);
+
+	if (link) {
+		ThumbnailMove *move = link->data;
+
+		/* The move was not sent yet, so the thumbnail is still
+		 * at its source. Removes are sent before any move, so
+		 * that is removed even if something else is moved there
+		 * later on */
+		g_hash_table_remove (private->moves_by_dest, move->to);
+		g_queue_delete_link (private->moves, link);
+
+		g_hash_table_add (private->removes, move->from);
+		move->from = NULL;
+		thumbnail_move_free (move);
+
+		thumbnailer_schedule_flush (thumbnailer);
+
+		return TRUE;
+	}
+
+	g_hash_table_add (private->removes, g_strdup (uri));
+	thumbnailer_schedule_flush (thumbnailer);
 
 	g_debug ("Thumbnailer request to remove uri:'%s', appended to queue", uri);
 
@@ -394,11 +535,62 @@ tracker_thumbnailer_cleanup (TrackerThumbnailer *thumbnailer,
 	return TRUE;
 }
 
+static void
+thumbnailer_send_removes (TrackerThumbnailerPrivate *private,
+                          GPtrArray                 *uris)
+{
+	g_ptr_array_add (uris, NULL);
+
+	g_dbus_proxy_call (private->cache_proxy,
+	                   "Delete",
+	                   g_variant_new ("(^as)", (gchar **) uris->pdata),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   NULL,
+	                   NULL,
+	                   NULL);
+
+	g_message ("Thumbnailer removes queue sent with %d items to thumbnailer daemon, request ID:%d...",
+	           uris->len - 1,
+	           private->request_id++);
+
+	g_ptr_array_set_size (uris, 0);
+}
+
+static void
+thumbnailer_send_moves (TrackerThumbnailerPrivate *private,
+                        GPtrArray                 *from,
+                        GPtrArray                 *to)
+{
+	g_ptr_array_add (from, NULL);
+	g_ptr_array_add (to, NULL);
+
+	g_dbus_proxy_call (private->cache_proxy,
+	                   "Move",
+	                   g_variant_new ("(^as^as)",
+	                                  (gchar **) from->pdata,
+	                                  (gchar **) to->pdata),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   NULL,
+	                   NULL,
+	                   NULL);
+
+	g_message ("Thumbnailer moves queue sent with %d items to thumbnailer daemon, request ID:%d...",
+	           from->len - 1,
+	           private->request_id++);
+
+	g_ptr_array_set_size (from, 0);
+	g_ptr_array_set_size (to, 0);
+}
+
 /**
  * tracker_thumbnailer_send:
  * @thumbnailer: Thumbnailer object
  *
- * Sends to the thumbnailer all stored requests.
+ * Sends to the thumbnailer all stored requests. Pending requests are
+ * also sent on their own once enough of them are queued, or a few
+ * seconds after the first one.
  *
  * Since: 0.8
  */
@@ -406,7 +598,10 @@ void
 tracker_thumbnailer_send (TrackerThumbnailer *thumbnailer)
 {
 	TrackerThumbnailerPrivate *private;
-	guint list_len;
+	GPtrArray *from, *to;
+	GHashTableIter iter;
+	gpointer key;
+	GList *l;
 
 	g_return_if_fail (TRACKER_IS_THUMBNAILER (thumbnailer));
 
@@ -416,69 +611,46 @@ tracker_thumbnailer_send (TrackerThumbnailer *thumbnailer)
 		return;
 	}
 
-	list_len = g_slist_length (private->removes);
-
-	if (list_len > 0) {
-		GStrv uri_strv;
-
-		uri_strv = tracker_dbus_slist_to_strv (private->removes);
+	if (private->flush_id) {
+		g_source_remove (private->flush_id);
+		private->flush_id = 0;
+	}
 
-		g_dbus_proxy_call (private->cache_proxy,
-		                   "Delete",
-		                   g_variant_new ("(^as)", uri_strv),
-		                   G_DBUS_CALL_FLAGS_NONE,
-		                   -1,
-		                   NULL,
-		                   NULL,
-		                   NULL);
+	from = g_ptr_array_sized_new (MAX_URIS_PER_REQUEST + 1);
+	to = g_ptr_array_sized_new (MAX_URIS_PER_REQUEST + 1);
 
-		g_message ("Thumbnailer removes queue sent with %d items to thumbnailer daemon, request ID:%d...",
-		           list_len,
-		           private->request_id++);
+	g_hash_table_iter_init (&iter, private->removes);
 
-		/* Clean up newly created GStrv */
-		g_strfreev (uri_strv);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		g_ptr_array_add (from, key);
 
-		/* Clean up privately held data */
-		g_slist_foreach (private->removes, (GFunc) g_free, NULL);
-		g_slist_free (private->removes);
-		private->removes = NULL;
+		if (from->len == MAX_URIS_PER_REQUEST) {
+			thumbnailer_send_removes (private, from);
+		}
 	}
 
-	list_len = g_slist_length (private->moves_from);
-
-	if (list_len > 0) {
-		GStrv from_strv, to_strv;
-
-		g_assert (list_len == g_slist_length (private->moves_to));
+	if (from->len > 0) {
+		thumbnailer_send_removes (private, from);
+	}
 
-		from_strv = tracker_dbus_slist_to_strv (private->moves_from);
-		to_strv = tracker_dbus_slist_to_strv (private->moves_to);
+	/* Moves are sent in the order they happened */
+	for (l = private->moves->head; l; l = l->next) {
+		ThumbnailMove *move = l->data;
 
-		g_dbus_proxy_call (private->cache_proxy,
-		                   "Move",
-		                   g_variant_new ("(^as^as)", from_strv, to_strv),
-		                   G_DBUS_CALL_FLAGS_NONE,
-		                   -1,
-		                   NULL,
-		                   NULL,
-		                   NULL);
+		g_ptr_array_add (from, move->from);
+		g_ptr_array_add (to, move->to);
 
-		g_message ("Thumbnailer moves queue sent with %d items to thumbnailer daemon, request ID:%d...",
-		           list_len,
-		           private->request_id++);
+		if (from->len == MAX_URIS_PER_REQUEST) {
+			thumbnailer_send_moves (private, from, to);
+		}
+	}
 
-		/* Clean up newly created GStrv */
-		g_strfreev (from_strv);
-		g_strfreev (to_strv);
+	if (from->len > 0) {
+		thumbnailer_send_moves (private, from, to);
+	}
 
-		/* Clean up privately held data */
-		g_slist_foreach (private->moves_from, (GFunc) g_free, NULL);
-		g_slist_free (private->moves_from);
-		private->moves_from = NULL;
+	g_ptr_array_free (from, TRUE);
+	g_ptr_array_free (to, TRUE);
 
-		g_slist_foreach (private->moves_to, (GFunc) g_free, NULL);
-		g_slist_free (private->moves_to);
-		private->moves_to = NULL;
-	}
+	thumbnailer_clear_queues (private);
 }
@@ -109,6 +109,22 @@ class Tracker.Sparql.Backend : Connection {
 		}
 	}
 
+	public override Cursor query_page (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		debug ("%s(page_size:%d): '%s'", Log.METHOD, page_size, sparql);
+		if (bus == null) {
+			throw new Sparql.Error.UNSUPPORTED ("Paged queries not available for direct-only connection");
+		}
+		return bus.query_page (sparql, page_size, continuation, out next_continuation, cancellable);
+	}
+
+	public async override Cursor query_page_async (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		debug ("%s(page_size:%d): '%s'", Log.METHOD, page_size, sparql);
+		if (bus == null) {
+			throw new Sparql.Error.UNSUPPORTED ("Paged queries not available for direct-only connection");
+		}
+		return yield bus.query_page_async (sparql, page_size, continuation, out next_continuation, cancellable);
+	}
+
 	public override void update (string sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
 		debug ("%s(priority:%d): '%s'", Log.METHOD, priority, sparql);
 		if (bus == null) {
@@ -140,6 +156,14 @@ class Tracker.Sparql.Backend : Connection {
 		return yield bus.update_array_async (sparql, priority, cancellable);
 	}
 
+	public async override void update_statements_async (StatementBuffer buffer, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		debug ("%s(priority:%d): %d statements", Log.METHOD, priority, buffer.length);
+		if (bus == null) {
+			throw new Sparql.Error.UNSUPPORTED ("Update support not available for direct-only connection");
+		}
+		yield bus.update_statements_async (buffer, priority, cancellable);
+	}
+
 	public async override GLib.Variant? update_blank_async (string sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
 		debug ("%s(priority:%d): '%s'", Log.METHOD, priority, sparql);
 		if (bus == null) {
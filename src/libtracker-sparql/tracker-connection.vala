@@ -256,6 +256,81 @@ public abstract class Tracker.Sparql.Connection : Object {
 	 */
 	public async abstract Cursor query_async (string sparql, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError;
 
+	/**
+	 * tracker_sparql_connection_query_page:
+	 * @self: a #TrackerSparqlConnection
+	 * @sparql: string containing the SPARQL query, without LIMIT or OFFSET
+	 * @page_size: maximum number of results to return
+	 * @continuation: (allow-none): token returned for the previous page,
+	 *                or %NULL for the first page
+	 * @next_continuation: (out) (allow-none): return location for the
+	 *                     token of the next page, or %NULL after the last page
+	 * @cancellable: a #GCancellable used to cancel the operation
+	 * @error: #GError for error reporting.
+	 *
+	 * Executes a SPARQL query returning at most @page_size results. The
+	 * results are sorted by the ORDER BY clause of @sparql, results with
+	 * equal sort keys are further sorted by the resources they match.
+	 *
+	 * Pass @next_continuation back along with the same @sparql to get the
+	 * following page. The store resumes right after the last result of
+	 * the previous page, so unlike OFFSET, fetching a page does not get
+	 * slower the further the page is into the results.
+	 *
+	 * Queries using DISTINCT, GROUP BY or literals in ORDER BY can not be
+	 * paged and fail with %TRACKER_SPARQL_ERROR_UNSUPPORTED, as do
+	 * connections without support for paged queries.
+	 *
+	 * The API call is completely synchronous, so it may block.
+	 *
+	 * Returns: a #TrackerSparqlCursor if results were found, #NULL otherwise.
+	 * On error, #NULL is returned and the @error is set accordingly.
+	 * Call g_object_unref() on the returned cursor when no longer needed.
+	 *
+	 * Since: 1.2
+	 */
+	public virtual Cursor query_page (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		throw new Sparql.Error.UNSUPPORTED ("Paged queries are not supported by this connection");
+	}
+
+	/**
+	 * tracker_sparql_connection_query_page_finish:
+	 * @self: a #TrackerSparqlConnection
+	 * @_res_: a #GAsyncResult with the result of the operation
+	 * @next_continuation: (out) (allow-none): return location for the
+	 *                     token of the next page, or %NULL after the last page
+	 * @error: #GError for error reporting.
+	 *
+	 * Finishes the asynchronous paged SPARQL query operation.
+	 *
+	 * Returns: a #TrackerSparqlCursor if results were found, #NULL otherwise.
+	 * On error, #NULL is returned and the @error is set accordingly.
+	 * Call g_object_unref() on the returned cursor when no longer needed.
+	 *
+	 * Since: 1.2
+	 */
+
+	/**
+	 * tracker_sparql_connection_query_page_async:
+	 * @self: a #TrackerSparqlConnection
+	 * @sparql: string containing the SPARQL query, without LIMIT or OFFSET
+	 * @page_size: maximum number of results to return
+	 * @continuation: (allow-none): token returned for the previous page,
+	 *                or %NULL for the first page
+	 * @cancellable: a #GCancellable used to cancel the operation
+	 * @_callback_: user-defined #GAsyncReadyCallback to be called when
+	 *              asynchronous operation is finished.
+	 * @_user_data_: user-defined data to be passed to @_callback_
+	 *
+	 * Executes asynchronously a paged SPARQL query. See
+	 * tracker_sparql_connection_query_page().
+	 *
+	 * Since: 1.2
+	 */
+	public async virtual Cursor query_page_async (string sparql, int page_size, string? continuation, out string? next_continuation, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		throw new Sparql.Error.UNSUPPORTED ("Paged queries are not supported by this connection");
+	}
+
 	/**
 	 * tracker_sparql_connection_update:
 	 * @self: a #TrackerSparqlConnection
@@ -368,6 +443,44 @@ public abstract class Tracker.Sparql.Connection : Object {
 		return null;
 	}
 
+	/**
+	 * tracker_sparql_connection_update_statements_async:
+	 * @self: a #TrackerSparqlConnection
+	 * @buffer: a #TrackerSparqlStatementBuffer with the statements to insert
+	 * @priority: the priority for the asynchronous operation
+	 * @cancellable: a #GCancellable used to cancel the operation
+	 * @_callback_: user-defined #GAsyncReadyCallback to be called when
+	 *              asynchronous operation is finished.
+	 * @_user_data_: user-defined data to be passed to @_callback_
+	 *
+	 * Executes asynchronously the insertion of all statements in @buffer
+	 * in a single transaction. If one of the statements fails, none of
+	 * them is inserted.
+	 *
+	 * Connections that can not insert statements directly fall back to
+	 * an equivalent SPARQL update.
+	 *
+	 * Since: 1.2
+	 */
+
+	/**
+	 * tracker_sparql_connection_update_statements_finish:
+	 * @self: a #TrackerSparqlConnection
+	 * @_res_: a #GAsyncResult with the result of the operation
+	 * @error: #GError for error reporting.
+	 *
+	 * Finishes the asynchronous insertion of statements.
+	 *
+	 * Since: 1.2
+	 */
+	public async virtual void update_statements_async (StatementBuffer buffer, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		if (buffer.length == 0) {
+			return;
+		}
+
+		yield update_async (buffer.to_sparql (), priority, cancellable);
+	}
+
 	/**
 	 * tracker_sparql_connection_update_blank:
 	 * @self: a #TrackerSparqlConnection
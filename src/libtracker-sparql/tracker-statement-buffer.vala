@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * SECTION: tracker-sparql-statement-buffer
+ * @short_description: Inserting triples without SPARQL parsing.
+ * @title: TrackerSparqlStatementBuffer
+ * @stability: Unstable
+ * @include: tracker-sparql.h
+ *
+ * <para>
+ * #TrackerSparqlStatementBuffer gathers subject/predicate/object
+ * triples in a compact binary form that tracker-store can insert
+ * directly, skipping the generation and parsing of a SPARQL update.
+ * This is meant for bulk producers such as miners, which insert
+ * many statements with known IRIs.
+ * </para>
+ *
+ * <para>
+ * Subjects, predicates and IRI objects must be full IRIs, prefixed
+ * names and blank nodes are not supported. Values are converted by
+ * tracker-store according to the range of the predicate, exactly as
+ * for literals in a SPARQL update.
+ * </para>
+ */
+
+/**
+ * TrackerSparqlStatementBuffer:
+ *
+ * The <structname>TrackerSparqlStatementBuffer</structname> object
+ * represents a set of statements to insert.
+ */
+
+/**
+ * tracker_sparql_statement_buffer_new:
+ *
+ * Creates an empty #TrackerSparqlStatementBuffer.
+ *
+ * Returns: a newly created #TrackerSparqlStatementBuffer. Free with g_object_unref() when done
+ *
+ * Since: 1.2
+ */
+public class Tracker.Sparql.StatementBuffer : Object {
+	/* Kind of object, as sent over the wire */
+	enum ObjectKind {
+		IRI,
+		STRING
+	}
+
+	MemoryOutputStream memory_stream;
+	DataOutputStream data_stream;
+
+	/**
+	 * tracker_sparql_statement_buffer_get_length:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 *
+	 * Returns the number of statements added to @self.
+	 *
+	 * Returns: the number of statements contained.
+	 *
+	 * Since: 1.2
+	 */
+
+	/**
+	 * TrackerSparqlStatementBuffer:length:
+	 *
+	 * Number of statements added to the #TrackerSparqlStatementBuffer.
+	 *
+	 * Since: 1.2
+	 */
+	public int length {
+		get;
+		private set;
+	}
+
+	public StatementBuffer () {
+		memory_stream = new MemoryOutputStream (null, realloc, free);
+		data_stream = new DataOutputStream (memory_stream);
+		data_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+	}
+
+	void put_value (string? value) throws IOError {
+		if (value == null) {
+			data_stream.put_int32 (-1);
+		} else {
+			data_stream.put_int32 ((int32) value.length);
+			data_stream.put_string (value);
+		}
+	}
+
+	void add (ObjectKind kind, string? graph, string subject, string predicate, string object) {
+		try {
+			data_stream.put_int32 ((int32) kind);
+			put_value (graph);
+			put_value (subject);
+			put_value (predicate);
+			put_value (object);
+		} catch (IOError e) {
+			/* Writes to a resizable memory stream only fail on OOM */
+			critical ("Could not add statement: %s", e.message);
+			return;
+		}
+
+		length++;
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_iri:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @iri: IRI of the object
+	 *
+	 * Appends a statement whose object is a resource.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_iri (string? graph, string subject, string predicate, string iri) {
+		add (ObjectKind.IRI, graph, subject, predicate, iri);
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_string:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @literal: object value, unescaped
+	 *
+	 * Appends a statement whose object is a literal. @literal is
+	 * converted to the range of @predicate by tracker-store.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_string (string? graph, string subject, string predicate, string literal) {
+		add (ObjectKind.STRING, graph, subject, predicate, literal);
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_boolean:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @literal: object as a #gboolean
+	 *
+	 * Appends a statement with a #gboolean object.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_boolean (string? graph, string subject, string predicate, bool literal) {
+		add (ObjectKind.STRING, graph, subject, predicate, literal ? "true" : "false");
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_int64:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @literal: object as a #gint64
+	 *
+	 * Appends a statement with a #gint64 object.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_int64 (string? graph, string subject, string predicate, int64 literal) {
+		add (ObjectKind.STRING, graph, subject, predicate, literal.to_string ());
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_double:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @literal: object as a #gdouble
+	 *
+	 * Appends a statement with a #gdouble object.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_double (string? graph, string subject, string predicate, double literal) {
+		add (ObjectKind.STRING, graph, subject, predicate, literal.to_string ());
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_insert_date:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 * @graph: (allow-none): IRI of the graph, or %NULL for the default graph
+	 * @subject: IRI of the subject
+	 * @predicate: IRI of the predicate
+	 * @literal: object as a #time_t
+	 *
+	 * Appends a statement with a #time_t object, converted to the
+	 * date format used by tracker-store.
+	 *
+	 * Since: 1.2
+	 */
+	public void insert_date (string? graph, string subject, string predicate, ref time_t literal) {
+		var tm = Time.gm (literal);
+
+		add (ObjectKind.STRING, graph, subject, predicate,
+		     "%04d-%02d-%02dT%02d:%02d:%02dZ".printf (tm.year + 1900, tm.month + 1, tm.day, tm.hour, tm.minute, tm.second));
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_get_data:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 *
+	 * Returns the serialized statements, in the format expected by
+	 * tracker-store. This is used by #TrackerSparqlConnection
+	 * implementations.
+	 *
+	 * Returns: (transfer none): the serialized statements.
+	 *
+	 * Since: 1.2
+	 */
+	public unowned uint8[] get_data () {
+		unowned uint8[] data = (uint8[]) memory_stream.get_data ();
+		data.length = (int) memory_stream.get_data_size ();
+		return data;
+	}
+
+	/**
+	 * tracker_sparql_statement_buffer_to_sparql:
+	 * @self: a #TrackerSparqlStatementBuffer
+	 *
+	 * Creates a SPARQL update equivalent to the contained statements,
+	 * for connections that can not insert statements directly.
+	 *
+	 * Returns: a newly allocated SPARQL update. Free with g_free() when done
+	 *
+	 * Since: 1.2
+	 */
+	public string to_sparql () {
+		var sparql = new StringBuilder ("INSERT {");
+		var data_input = new DataInputStream (new MemoryInputStream.from_bytes (new Bytes.static (get_data ())));
+		data_input.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+
+		try {
+			for (int i = 0; i < length; i++) {
+				var kind = (ObjectKind) data_input.read_int32 ();
+				string? graph = read_value (data_input);
+				string subject = read_value (data_input);
+				string predicate = read_value (data_input);
+				string object = read_value (data_input);
+
+				if (graph != null) {
+					sparql.append_printf (" GRAPH <%s> {", graph);
+				}
+
+				sparql.append_printf (" <%s> <%s> ", subject, predicate);
+
+				if (kind == ObjectKind.IRI) {
+					sparql.append_printf ("<%s>", object);
+				} else {
+					sparql.append_printf ("\"%s\"", escape_string (object));
+				}
+
+				sparql.append (graph != null ? " . }" : " .");
+			}
+		} catch (IOError e) {
+			critical ("Could not read statements: %s", e.message);
+		}
+
+		sparql.append (" }");
+
+		return sparql.str;
+	}
+
+	static string? read_value (DataInputStream data_input) throws IOError {
+		size_t bytes_read;
+
+		int size = data_input.read_int32 ();
+		if (size < 0) {
+			return null;
+		}
+
+		/* We malloc one more char to ensure string is 0 terminated */
+		uint8[] value = new uint8[size + 1];
+		data_input.read_all (value[0:size], out bytes_read);
+
+		return (string) value;
+	}
+}
@@ -37,6 +37,7 @@
 #include <libtracker-common/tracker-ontologies.h>
 #include <libtracker-common/tracker-file-utils.h>
 #include <libtracker-common/tracker-sched.h>
+#include <libtracker-common/tracker-trace.h>
 #include <libtracker-common/tracker-enums.h>
 
 #include <libtracker-miner/tracker-miner.h>
@@ -1108,6 +1109,7 @@ main (gint argc, gchar *argv[])
 	g_slist_free (miners);
 
 	tracker_writeback_shutdown ();
+	tracker_trace_shutdown ();
 	tracker_log_shutdown ();
 
 	g_array_free (disable_options, TRUE);
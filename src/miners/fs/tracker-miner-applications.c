@@ -23,6 +23,8 @@
 #include <libtracker-common/tracker-ontologies.h>
 #include <libtracker-common/tracker-locale.h>
 
+#include <libtracker-miner/tracker-miner-fs-internal.h>
+
 #include "tracker-miner-applications.h"
 #include "tracker-miner-locale.h"
 
@@ -37,6 +39,13 @@
 #define SOFTWARE_CATEGORY_URN_PREFIX "urn:software-category:"
 #define THEME_ICON_URN_PREFIX        "urn:theme-icon:"
 
+/* Bump whenever the layout below changes, older caches are then
+ * ignored and every desktop file is parsed again */
+#define DESKTOP_HASHES_VERSION 1
+
+/* (version, language, desktop file URI to checksum of its contents) */
+#define DESKTOP_HASHES_TYPE "(usa{ss})"
+
 static void     miner_applications_initable_iface_init     (GInitableIface       *iface);
 static gboolean miner_applications_initable_init           (GInitable            *initable,
                                                             GCancellable         *cancellable,
@@ -88,6 +97,130 @@ tracker_miner_applications_class_init (TrackerMinerApplicationsClass *klass)
 static void
 tracker_miner_applications_init (TrackerMinerApplications *ma)
 {
+	ma->desktop_hashes = g_hash_table_new_full (g_str_hash,
+	                                            g_str_equal,
+	                                            (GDestroyNotify) g_free,
+	                                            (GDestroyNotify) g_free);
+}
+
+static gchar *
+desktop_hashes_path (void)
+{
+	return g_build_filename (g_get_user_cache_dir (),
+	                         "tracker",
+	                         "applications.cache",
+	                         NULL);
+}
+
+static void
+desktop_hashes_load (TrackerMinerApplications *app)
+{
+	GVariant *cache, *hashes;
+	GMappedFile *mapped_file;
+	const gchar *language, *uri, *checksum;
+	GVariantIter iter;
+	guint32 version;
+	gchar *path, *lang;
+
+	path = desktop_hashes_path ();
+	mapped_file = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+
+	if (!mapped_file) {
+		return;
+	}
+
+	cache = g_variant_new_from_data (G_VARIANT_TYPE (DESKTOP_HASHES_TYPE),
+	                                 g_mapped_file_get_contents (mapped_file),
+	                                 g_mapped_file_get_length (mapped_file),
+	                                 FALSE,
+	                                 (GDestroyNotify) g_mapped_file_unref,
+	                                 mapped_file);
+	g_variant_ref_sink (cache);
+
+	g_variant_get (cache, "(u&s@a{ss})", &version, &language, &hashes);
+	lang = tracker_locale_get (TRACKER_LOCALE_LANGUAGE);
+
+	/* Localized keys are indexed in the current language only, so a
+	 * cache written for another one says nothing about the store */
+	if (version == DESKTOP_HASHES_VERSION &&
+	    g_strcmp0 (language, lang) == 0) {
+		g_variant_iter_init (&iter, hashes);
+
+		while (g_variant_iter_next (&iter, "{&s&s}", &uri, &checksum)) {
+			g_hash_table_insert (app->desktop_hashes,
+			                     g_strdup (uri),
+			                     g_strdup (checksum));
+		}
+
+		g_message ("Loaded %d desktop file checksums from cache",
+		           g_hash_table_size (app->desktop_hashes));
+	}
+
+	g_variant_unref (hashes);
+	g_variant_unref (cache);
+	g_free (lang);
+}
+
+static void
+desktop_hashes_save (TrackerMinerApplications *app)
+{
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	gpointer key, value;
+	GError *error = NULL;
+	GVariant *cache;
+	gchar *path, *dir, *lang;
+
+	if (!app->desktop_hashes_dirty) {
+		return;
+	}
+
+	lang = tracker_locale_get (TRACKER_LOCALE_LANGUAGE);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE (DESKTOP_HASHES_TYPE));
+	g_variant_builder_add (&builder, "u", DESKTOP_HASHES_VERSION);
+	g_variant_builder_add (&builder, "s", lang ? lang : "");
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{ss}"));
+	g_hash_table_iter_init (&iter, app->desktop_hashes);
+
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		gchar *filename;
+
+		/* Forget desktop files removed since they were indexed */
+		filename = g_filename_from_uri (key, NULL, NULL);
+
+		if (filename && g_file_test (filename, G_FILE_TEST_EXISTS)) {
+			g_variant_builder_add (&builder, "{ss}", key, value);
+		} else {
+			g_hash_table_iter_remove (&iter);
+		}
+
+		g_free (filename);
+	}
+
+	g_variant_builder_close (&builder);
+	cache = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+	path = desktop_hashes_path ();
+	dir = g_path_get_dirname (path);
+	g_mkdir_with_parents (dir, 0700);
+
+	if (g_file_set_contents (path,
+	                         g_variant_get_data (cache),
+	                         g_variant_get_size (cache),
+	                         &error)) {
+		app->desktop_hashes_dirty = FALSE;
+	} else {
+		g_debug ("Could not write desktop file checksums: %s", error->message);
+		g_error_free (error);
+	}
+
+	g_variant_unref (cache);
+	g_free (dir);
+	g_free (path);
+	g_free (lang);
 }
 
 static void
@@ -204,6 +337,8 @@ miner_finished_cb (TrackerMinerFS *fs,
 	if (tracker_miner_locale_changed ()) {
 		tracker_miner_locale_set_current ();
 	}
+
+	desktop_hashes_save (TRACKER_MINER_APPLICATIONS (fs));
 }
 
 static gboolean
@@ -243,6 +378,8 @@ miner_applications_initable_init (GInitable     *initable,
 	                  G_CALLBACK (miner_finished_cb),
 	                  NULL);
 
+	desktop_hashes_load (app);
+
 	miner_applications_add_directories (fs);
 
 #ifdef HAVE_MEEGOTOUCH
@@ -266,6 +403,9 @@ miner_applications_finalize (GObject *object)
 
 	tracker_locale_notify_remove (app->locale_notification_id);
 
+	desktop_hashes_save (app);
+	g_hash_table_unref (app->desktop_hashes);
+
 #ifdef HAVE_MEEGOTOUCH
 	tracker_miner_applications_meego_shutdown ();
 #endif /* HAVE_MEEGOTOUCH */
@@ -304,9 +444,11 @@ insert_data_from_desktop_file (TrackerSparqlBuilder *sparql,
 }
 
 static GKeyFile *
-get_desktop_key_file (GFile   *file,
-                      gchar  **type,
-                      GError **error)
+get_desktop_key_file (GFile        *file,
+                      const gchar  *contents,
+                      gsize         length,
+                      gchar       **type,
+                      GError      **error)
 {
 	GKeyFile *key_file;
 	gchar *path;
@@ -316,7 +458,7 @@ get_desktop_key_file (GFile   *file,
 	key_file = g_key_file_new ();
 	*type = NULL;
 
-	if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL)) {
+	if (!g_key_file_load_from_data (key_file, contents, length, G_KEY_FILE_NONE, NULL)) {
 		g_set_error (error, miner_applications_error_quark, 0, "Couldn't load desktop file:'%s'", path);
 		g_key_file_free (key_file);
 		g_free (path);
@@ -793,6 +935,98 @@ process_application_data_free (ProcessApplicationData *data)
 	g_slice_free (ProcessApplicationData, data);
 }
 
+static gboolean
+process_desktop_file_contents (ProcessApplicationData  *data,
+                               GFileInfo               *file_info,
+                               GError                 **error)
+{
+	TrackerMinerApplications *app;
+	const gchar *urn, *cached;
+	gchar *contents, *checksum, *uri;
+	gsize length;
+
+	app = TRACKER_MINER_APPLICATIONS (data->miner);
+
+	if (!g_file_load_contents (data->file, data->cancellable,
+	                           &contents, &length, NULL, error)) {
+		return FALSE;
+	}
+
+	uri = g_file_get_uri (data->file);
+	checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA1,
+	                                        (const guchar *) contents,
+	                                        length);
+
+	/* Package upgrades touch lots of desktop files without changing
+	 * them, these are notified as unchanged to keep the stored data */
+	urn = tracker_miner_fs_get_urn (data->miner, data->file);
+	cached = g_hash_table_lookup (app->desktop_hashes, uri);
+
+	if (urn && g_strcmp0 (cached, checksum) == 0) {
+		guint64 time;
+
+		g_debug ("Desktop file '%s' is unchanged, not parsing it again", uri);
+
+		/* Only the modification time changed, store it so the
+		 * crawler doesn't queue the file again on the next run */
+		time = g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+		tracker_sparql_builder_delete_open (data->sparql, NULL);
+		tracker_sparql_builder_subject_iri (data->sparql, urn);
+		tracker_sparql_builder_predicate (data->sparql, "nfo:fileLastModified");
+		tracker_sparql_builder_object_variable (data->sparql, "time");
+		tracker_sparql_builder_delete_close (data->sparql);
+
+		tracker_sparql_builder_where_open (data->sparql);
+		tracker_sparql_builder_subject_iri (data->sparql, urn);
+		tracker_sparql_builder_predicate (data->sparql, "nfo:fileLastModified");
+		tracker_sparql_builder_object_variable (data->sparql, "time");
+		tracker_sparql_builder_where_close (data->sparql);
+
+		tracker_sparql_builder_insert_open (data->sparql, TRACKER_MINER_FS_GRAPH_URN);
+		tracker_sparql_builder_subject_iri (data->sparql, urn);
+		tracker_sparql_builder_predicate (data->sparql, "nfo:fileLastModified");
+		tracker_sparql_builder_object_date (data->sparql, (time_t *) &time);
+		tracker_sparql_builder_insert_close (data->sparql);
+
+		g_free (checksum);
+		g_free (contents);
+		g_free (uri);
+		return TRUE;
+	}
+
+	data->key_file = get_desktop_key_file (data->file, contents, length, &data->type, error);
+
+	if (!data->key_file) {
+		g_warning ("Couldn't properly parse desktop file '%s': '%s'",
+		           uri,
+		           *error ? (*error)->message : "unknown error");
+		g_clear_error (error);
+
+		g_set_error_literal (error, miner_applications_error_quark, 0, "File is not a key file");
+	} else if (g_key_file_get_boolean (data->key_file, GROUP_DESKTOP_ENTRY, "Hidden", NULL)) {
+		g_set_error_literal (error, miner_applications_error_quark, 0, "Desktop file is 'hidden', not gathering metadata for it");
+	} else {
+		process_desktop_file (data, file_info, error);
+	}
+
+	if (*error) {
+		if (g_hash_table_remove (app->desktop_hashes, uri)) {
+			app->desktop_hashes_dirty = TRUE;
+		}
+
+		g_free (checksum);
+		g_free (uri);
+	} else {
+		g_hash_table_replace (app->desktop_hashes, uri, checksum);
+		app->desktop_hashes_dirty = TRUE;
+	}
+
+	g_free (contents);
+
+	return FALSE;
+}
+
 static void
 process_file_cb (GObject      *object,
                  GAsyncResult *result,
@@ -801,6 +1035,7 @@ process_file_cb (GObject      *object,
 	ProcessApplicationData *data;
 	GFileInfo *file_info;
 	GError *error = NULL;
+	gboolean unchanged = FALSE;
 	GFile *file;
 
 	data = user_data;
@@ -817,26 +1052,14 @@ process_file_cb (GObject      *object,
 	if (g_file_info_get_file_type (file_info) == G_FILE_TYPE_DIRECTORY) {
 		process_directory (data, file_info, &error);
 	} else {
-		data->key_file = get_desktop_key_file (file, &data->type, &error);
-		if (!data->key_file) {
-			gchar *uri;
-
-			uri = g_file_get_uri (file);
-			g_warning ("Couldn't properly parse desktop file '%s': '%s'",
-			           uri,
-			           error ? error->message : "unknown error");
-			g_free (uri);
-			g_clear_error (&error);
-
-			error = g_error_new_literal (miner_applications_error_quark, 0, "File is not a key file");
-		} else if (g_key_file_get_boolean (data->key_file, GROUP_DESKTOP_ENTRY, "Hidden", NULL)) {
-			error = g_error_new_literal (miner_applications_error_quark, 0, "Desktop file is 'hidden', not gathering metadata for it");
-		} else {
-			process_desktop_file (data, file_info, &error);
-		}
+		unchanged = process_desktop_file_contents (data, file_info, &error);
 	}
 
-	tracker_miner_fs_file_notify (TRACKER_MINER_FS (data->miner), data->file, error);
+	if (unchanged) {
+		tracker_miner_fs_file_notify_unchanged (TRACKER_MINER_FS (data->miner), data->file);
+	} else {
+		tracker_miner_fs_file_notify (TRACKER_MINER_FS (data->miner), data->file, error);
+	}
 	process_application_data_free (data);
 
 	if (error) {
@@ -903,9 +1126,15 @@ miner_applications_process_file_attributes (TrackerMinerFS       *fs,
 static void
 miner_applications_reset (TrackerMiner *miner)
 {
+	TrackerMinerApplications *app;
 	GError *error = NULL;
 	TrackerSparqlBuilder *sparql;
 
+	/* Nothing in the store matches the cached checksums anymore */
+	app = TRACKER_MINER_APPLICATIONS (miner);
+	g_hash_table_remove_all (app->desktop_hashes);
+	app->desktop_hashes_dirty = TRUE;
+
 	sparql = tracker_sparql_builder_new_update ();
 
 	/* (a) all elements which are nfo:softwareIcon of a given nfo:Software */
@@ -37,6 +37,8 @@ typedef struct _TrackerMinerApplicationsClass TrackerMinerApplicationsClass;
 struct _TrackerMinerApplications {
 	TrackerMinerFS parent_instance;
 	gpointer locale_notification_id;
+	GHashTable *desktop_hashes;
+	gboolean desktop_hashes_dirty;
 };
 
 struct _TrackerMinerApplicationsClass {
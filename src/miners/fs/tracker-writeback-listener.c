@@ -29,22 +29,32 @@
 #define TRACKER_RESOURCES_OBJECT        "/org/freedesktop/Tracker1/Resources"
 #define TRACKER_INTERFACE_RESOURCES     "org.freedesktop.Tracker1.Resources"
 
+/* Writeback requests are gathered for this long, so that consecutive
+ * edits of a file are written once, and handled in batches of at most
+ * this many subjects */
+#define WRITEBACK_DELAY_MS              500
+#define MAX_SUBJECTS_PER_BATCH          200
+
+/* Columns of the rows given to writeback modules: url, subject,
+ * predicate and object */
+#define WRITEBACK_COLUMNS               4
+
 typedef struct {
 	TrackerMinerFiles *files_miner;
 	GDBusConnection *d_connection;
 	TrackerSparqlConnection *connection;
 	guint d_signal;
-} TrackerWritebackListenerPrivate;
 
-typedef struct {
-	TrackerWritebackListener *self;
-	GStrv rdf_types;
-} QueryData;
+	/* Subject ID -> GArray of rdf:type IDs */
+	GHashTable *pending;
+	guint flush_id;
+} TrackerWritebackListenerPrivate;
 
 typedef struct {
-	GVariantIter *iter1;
 	TrackerWritebackListener *self;
-} DelayedLoopData;
+	GHashTable *subjects;
+	GHashTable *rdf_types;
+} BatchData;
 
 enum {
 	PROP_0,
@@ -150,6 +160,12 @@ writeback_listener_finalize (GObject *object)
 {
 	TrackerWritebackListenerPrivate *priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (object);
 
+	if (priv->flush_id) {
+		g_source_remove (priv->flush_id);
+	}
+
+	g_hash_table_unref (priv->pending);
+
 	if (priv->connection && priv->d_signal) {
 		g_dbus_connection_signal_unsubscribe (priv->d_connection, priv->d_signal);
 	}
@@ -171,6 +187,11 @@ writeback_listener_finalize (GObject *object)
 static void
 tracker_writeback_listener_init (TrackerWritebackListener *object)
 {
+	TrackerWritebackListenerPrivate *priv;
+
+	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (object);
+	priv->pending = g_hash_table_new_full (NULL, NULL, NULL,
+	                                       (GDestroyNotify) g_array_unref);
 }
 
 static gboolean
@@ -232,234 +253,283 @@ tracker_writeback_listener_new (TrackerMinerFiles  *miner_files,
 	return (TrackerWritebackListener *) miner;
 }
 
-static QueryData*
-query_data_new (TrackerWritebackListener *self)
+static BatchData *
+batch_data_new (TrackerWritebackListener *self)
 {
-	QueryData *data = g_slice_new0 (QueryData);
+	BatchData *data = g_slice_new0 (BatchData);
 
 	data->self = g_object_ref (self);
+	data->subjects = g_hash_table_new_full (NULL, NULL, NULL,
+	                                        (GDestroyNotify) g_array_unref);
+	data->rdf_types = g_hash_table_new_full (NULL, NULL, NULL, g_free);
 
 	return data;
 }
 
 static void
-query_data_free (QueryData *data)
+batch_data_free (BatchData *data)
 {
 	g_object_unref (data->self);
-	if (data->rdf_types) {
-		g_strfreev (data->rdf_types);
-	}
-	g_slice_free (QueryData, data);
+	g_hash_table_unref (data->subjects);
+	g_hash_table_unref (data->rdf_types);
+	g_slice_free (BatchData, data);
 }
 
-static void
-sparql_query_cb (GObject      *object,
-                 GAsyncResult *result,
-                 gpointer      user_data)
+static GStrv
+batch_data_get_rdf_types (BatchData *data,
+                          gint       subject_id)
 {
-	QueryData *data = user_data;
-	TrackerWritebackListener *self = TRACKER_WRITEBACK_LISTENER (data->self);
-	TrackerWritebackListenerPrivate *priv;
-	TrackerSparqlCursor *cursor;
-	GError *error = NULL;
+	GArray *type_ids, *rdf_types;
+	guint i;
 
-	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (self);
+	type_ids = g_hash_table_lookup (data->subjects, GINT_TO_POINTER (subject_id));
+	rdf_types = g_array_new (TRUE, TRUE, sizeof (gchar *));
 
-	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object), result, &error);
+	for (i = 0; type_ids && i < type_ids->len; i++) {
+		gchar *uri;
 
-	if (!error) {
-		guint cols = tracker_sparql_cursor_get_n_columns (cursor);
-		GPtrArray *results = NULL;
-		GFile *file = NULL;
-
-		while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-			GStrv row = NULL;
-			guint i;
-
-			if (file == NULL) {
-				file = g_file_new_for_uri (tracker_sparql_cursor_get_string (cursor, 0, NULL));
-				if (!g_file_query_exists (file, NULL)) {
-					g_object_unref (file);
-					g_message ("  No files qualify for updates");
-					query_data_free (data);
-					g_object_unref (cursor);
-					return;
-				}
-			}
-
-			for (i = 0; i < cols; i++) {
-				if (!row) {
-					row = g_new0 (gchar*, cols);
-				}
-				row[i] = g_strdup (tracker_sparql_cursor_get_string (cursor, i, NULL));
-			}
-
-			if (!results) {
-				results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_strfreev);
-			}
-
-			g_ptr_array_add (results, row);
-		}
+		uri = g_hash_table_lookup (data->rdf_types,
+		                           GINT_TO_POINTER (g_array_index (type_ids, gint, i)));
 
-		if (results != NULL && results->len > 0) {
-			tracker_miner_fs_writeback_file (TRACKER_MINER_FS (priv->files_miner),
-			                                 file,
-			                                 data->rdf_types,
-			                                 results);
-		} else {
-			g_message ("  No files qualify for updates");
+		if (uri) {
+			uri = g_strdup (uri);
+			g_array_append_val (rdf_types, uri);
 		}
+	}
 
-		if (file) {
-			g_object_unref (file);
-		}
+	return (GStrv) g_array_free (rdf_types, FALSE);
+}
 
-		if (results) {
-			g_ptr_array_unref (results);
-		}
+static void
+batch_writeback_file (BatchData *data,
+                      gint       subject_id,
+                      GPtrArray *results)
+{
+	TrackerWritebackListenerPrivate *priv;
+	GStrv row, rdf_types;
+	GFile *file;
 
-		g_object_unref (cursor);
-	} else {
-		g_message ("  No files qualify for updates (%s)", error->message);
-		g_error_free (error);
+	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (data->self);
+
+	row = g_ptr_array_index (results, 0);
+	file = g_file_new_for_uri (row[0]);
+
+	if (!g_file_query_exists (file, NULL)) {
+		g_message ("  No files qualify for updates ('%s' does not exist)", row[0]);
+		g_object_unref (file);
+		return;
 	}
 
-	query_data_free (data);
+	rdf_types = batch_data_get_rdf_types (data, subject_id);
+	tracker_miner_fs_writeback_file (TRACKER_MINER_FS (priv->files_miner),
+	                                 file,
+	                                 rdf_types,
+	                                 results);
+	g_strfreev (rdf_types);
+	g_object_unref (file);
 }
 
 static void
-rdf_types_to_uris_cb (GObject      *object,
-                      GAsyncResult *result,
-                      gpointer      user_data)
+sparql_query_cb (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
 {
-	QueryData *data = user_data;
-	TrackerWritebackListener *self = TRACKER_WRITEBACK_LISTENER (data->self);
-	TrackerWritebackListenerPrivate *priv;
+	BatchData *data = user_data;
 	TrackerSparqlCursor *cursor;
-	TrackerSparqlConnection *connection;
+	GPtrArray *results = NULL;
 	GError *error = NULL;
+	gint current_id = 0;
+	guint n_files = 0;
 
-	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (self);
-	connection = priv->connection;
+	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object), result, &error);
 
-	cursor = tracker_sparql_connection_query_finish (connection, result, &error);
+	if (error) {
+		g_message ("  No files qualify for updates (%s)", error->message);
+		g_error_free (error);
+		batch_data_free (data);
+		return;
+	}
 
-	if (!error) {
-		gchar *query;
-		GArray *rdf_types;
-		gchar *subject = NULL;
+	/* Rows come sorted by subject, the last column is only used
+	 * to split them per file and is not passed to the modules */
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		GStrv row;
+		gint subject_id;
+		guint i;
 
-		rdf_types = g_array_new (TRUE, TRUE, sizeof (gchar *));
+		subject_id = (gint) tracker_sparql_cursor_get_integer (cursor, WRITEBACK_COLUMNS);
 
-		while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-			gchar *uri = g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL));
-			if (subject == NULL) {
-				subject = g_strdup (tracker_sparql_cursor_get_string (cursor, 1, NULL));
-			}
-			g_array_append_val (rdf_types, uri);
+		if (results && subject_id != current_id) {
+			batch_writeback_file (data, current_id, results);
+			g_ptr_array_unref (results);
+			results = NULL;
+			n_files++;
 		}
 
-		g_object_unref (cursor);
+		if (!results) {
+			results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_strfreev);
+			current_id = subject_id;
+		}
 
-		data->rdf_types = (GStrv) rdf_types->data;
-		g_array_free (rdf_types, FALSE);
+		row = g_new0 (gchar *, WRITEBACK_COLUMNS + 1);
 
-		if (subject == NULL) {
-			goto trouble;
+		for (i = 0; i < WRITEBACK_COLUMNS; i++) {
+			row[i] = g_strdup (tracker_sparql_cursor_get_string (cursor, i, NULL));
 		}
 
-		query = g_strdup_printf ("SELECT ?url '%s' ?predicate ?object { "
-		                            "<%s> a nfo:FileDataObject . "
-		                            "<%s> ?predicate ?object ; nie:url ?url . "
-		                            "?predicate tracker:writeback true . "
-		                            "FILTER (NOT EXISTS { GRAPH <"TRACKER_MINER_FS_GRAPH_URN"> "
-		                              "{ <%s> ?predicate ?object } }) } ",
-		                         subject, subject, subject, subject);
-
-		tracker_sparql_connection_query_async (connection,
-		                                       query,
-		                                       NULL,
-		                                       sparql_query_cb,
-		                                       data);
+		g_ptr_array_add (results, row);
+	}
 
-		g_free (subject);
-		g_free (query);
+	if (results) {
+		batch_writeback_file (data, current_id, results);
+		g_ptr_array_unref (results);
+		n_files++;
+	}
 
+	if (n_files == 0) {
+		g_message ("  No files qualify for updates");
 	} else {
-		goto trouble;
+		g_message ("  %d of %d subjects qualify for updates",
+		           n_files, g_hash_table_size (data->subjects));
 	}
 
-	return;
+	g_object_unref (cursor);
+	batch_data_free (data);
+}
+
+static void
+append_ids (GString *query,
+            GList   *ids)
+{
+	GList *l;
+
+	for (l = ids; l; l = l->next) {
+		g_string_append_printf (query, "%s%d",
+		                        l == ids ? "" : ", ",
+		                        GPOINTER_TO_INT (l->data));
+	}
+}
+
+static void
+rdf_types_to_uris_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+	BatchData *data = user_data;
+	TrackerWritebackListenerPrivate *priv;
+	TrackerSparqlCursor *cursor;
+	GError *error = NULL;
+	GString *query;
+	GList *subject_ids;
+
+	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (data->self);
+
+	cursor = tracker_sparql_connection_query_finish (priv->connection, result, &error);
 
-trouble:
 	if (error) {
 		g_message ("  No files qualify for updates (%s)", error->message);
 		g_error_free (error);
+		batch_data_free (data);
+		return;
 	}
-	query_data_free (data);
+
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		g_hash_table_insert (data->rdf_types,
+		                     GINT_TO_POINTER (tracker_sparql_cursor_get_integer (cursor, 0)),
+		                     g_strdup (tracker_sparql_cursor_get_string (cursor, 1, NULL)));
+	}
+
+	g_object_unref (cursor);
+
+	/* The metadata of every subject in the batch in one go */
+	query = g_string_new ("SELECT ?url ?subject ?predicate ?object tracker:id (?subject) { "
+	                      "?subject a nfo:FileDataObject ; "
+	                      "nie:url ?url ; "
+	                      "?predicate ?object . "
+	                      "?predicate tracker:writeback true . "
+	                      "FILTER (tracker:id (?subject) IN (");
+
+	subject_ids = g_hash_table_get_keys (data->subjects);
+	append_ids (query, subject_ids);
+	g_list_free (subject_ids);
+
+	g_string_append (query,
+	                 ")) "
+	                 "FILTER (NOT EXISTS { GRAPH <"TRACKER_MINER_FS_GRAPH_URN"> "
+	                 "{ ?subject ?predicate ?object } }) "
+	                 "} ORDER BY tracker:id (?subject)");
+
+	tracker_sparql_connection_query_async (priv->connection,
+	                                       query->str,
+	                                       NULL,
+	                                       sparql_query_cb,
+	                                       data);
+
+	g_string_free (query, TRUE);
 }
 
 static gboolean
-delayed_loop_idle (gpointer user_data)
+flush_pending_cb (gpointer user_data)
 {
-	DelayedLoopData *ldata = user_data;
-	GVariantIter *iter2;
-	gint subject_id = 0, rdf_type = 0;
+	TrackerWritebackListener *self = user_data;
+	TrackerWritebackListenerPrivate *priv;
+	GHashTableIter iter;
+	gpointer key, value;
+	GHashTable *type_ids;
+	GList *ids;
+	BatchData *data;
+	GString *query;
 
-	if (g_variant_iter_next (ldata->iter1, "{iai}", &subject_id, &iter2)) {
-		TrackerWritebackListenerPrivate *priv;
-		QueryData *data = NULL;
-		GString *query;
-		gboolean comma = FALSE;
+	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (self);
+	data = batch_data_new (self);
+	type_ids = g_hash_table_new (NULL, NULL);
 
-		priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (ldata->self);
+	g_hash_table_iter_init (&iter, priv->pending);
 
-		data = query_data_new (ldata->self);
+	while (g_hash_table_size (data->subjects) < MAX_SUBJECTS_PER_BATCH &&
+	       g_hash_table_iter_next (&iter, &key, &value)) {
+		GArray *types = value;
+		guint i;
 
-		/* Two queries are grouped together here to reduce the amount of
-		 * queries that must be made. tracker:uri() is idd unrelated to
-		 * the other part of the query (and is repeated each result, idd) */
+		for (i = 0; i < types->len; i++) {
+			g_hash_table_add (type_ids,
+			                  GINT_TO_POINTER (g_array_index (types, gint, i)));
+		}
 
-		query = g_string_new ("SELECT ");
-		g_string_append_printf (query, "?resource tracker:uri (%d) { "
-		                               "?resource a rdfs:Class . "
-		                               "FILTER (tracker:id (?resource) IN (",
-		                        subject_id);
+		g_hash_table_iter_steal (&iter);
+		g_hash_table_insert (data->subjects, key, types);
+	}
 
-		while (g_variant_iter_loop (iter2, "i", &rdf_type)) {
-			if (comma) {
-				g_string_append_printf (query, ", %d", rdf_type);
-			} else {
-				g_string_append_printf (query, "%d", rdf_type);
-				comma = TRUE;
-			}
-		}
+	g_message ("Writeback requested for %d subjects",
+	           g_hash_table_size (data->subjects));
 
-		g_string_append (query, ")) }");
+	query = g_string_new ("SELECT tracker:id (?resource) ?resource { "
+	                      "?resource a rdfs:Class . "
+	                      "FILTER (tracker:id (?resource) IN (");
 
-		tracker_sparql_connection_query_async (priv->connection,
-		                                       query->str,
-		                                       NULL,
-		                                       rdf_types_to_uris_cb,
-		                                       data);
+	ids = g_hash_table_get_keys (type_ids);
+	append_ids (query, ids);
+	g_list_free (ids);
 
-		g_string_free (query, TRUE);
+	g_string_append (query, ")) }");
 
-		g_variant_iter_free (iter2);
+	tracker_sparql_connection_query_async (priv->connection,
+	                                       query->str,
+	                                       NULL,
+	                                       rdf_types_to_uris_cb,
+	                                       data);
+
+	g_string_free (query, TRUE);
+	g_hash_table_unref (type_ids);
 
+	if (g_hash_table_size (priv->pending) > 0) {
+		/* Keep going with the next batch */
 		return TRUE;
 	}
 
-	return FALSE;
-}
+	priv->flush_id = 0;
 
-static void
-delayed_loop_finished (gpointer user_data)
-{
-	DelayedLoopData *ldata = user_data;
-	g_variant_iter_free (ldata->iter1);
-	g_object_unref (ldata->self);
-	g_free (ldata);
+	return FALSE;
 }
 
 static void
@@ -472,13 +542,35 @@ on_writeback_cb (GDBusConnection      *connection,
                  gpointer              user_data)
 {
 	TrackerWritebackListener *self = TRACKER_WRITEBACK_LISTENER (user_data);
-	DelayedLoopData *data = g_new (DelayedLoopData, 1);
+	TrackerWritebackListenerPrivate *priv;
+	GVariantIter *iter1, *iter2;
+	gint subject_id = 0, rdf_type = 0;
 
-	data->self = g_object_ref (self);
-	g_variant_get (parameters, "(a{iai})", &data->iter1);
+	priv = TRACKER_WRITEBACK_LISTENER_GET_PRIVATE (self);
+
+	g_variant_get (parameters, "(a{iai})", &iter1);
+
+	/* Later requests for a subject replace queued ones, the metadata
+	 * is only queried once the batch is flushed */
+	while (g_variant_iter_next (iter1, "{iai}", &subject_id, &iter2)) {
+		GArray *types;
 
-	g_idle_add_full (G_PRIORITY_LOW,
-	                 delayed_loop_idle,
-	                 data,
-	                 delayed_loop_finished);
+		types = g_array_new (FALSE, FALSE, sizeof (gint));
+
+		while (g_variant_iter_loop (iter2, "i", &rdf_type)) {
+			g_array_append_val (types, rdf_type);
+		}
+
+		g_hash_table_replace (priv->pending, GINT_TO_POINTER (subject_id), types);
+		g_variant_iter_free (iter2);
+	}
+
+	g_variant_iter_free (iter1);
+
+	if (priv->flush_id == 0 && g_hash_table_size (priv->pending) > 0) {
+		priv->flush_id = g_timeout_add_full (G_PRIORITY_LOW,
+		                                     WRITEBACK_DELAY_MS,
+		                                     flush_pending_cb,
+		                                     self, NULL);
+	}
 }
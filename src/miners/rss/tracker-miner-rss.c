@@ -45,8 +45,8 @@ struct _TrackerMinerRSSPrivate {
 	GDBusConnection *connection;
 	guint graph_updated_id;
 
-	GList *item_inserts;
 	GHashTable *channel_updates;
+	GHashTable *seen_items;
 };
 
 typedef struct {
@@ -58,9 +58,12 @@ typedef struct {
 
 typedef struct {
 	TrackerMinerRSS *miner;
-	GrssFeedItem *item;
+	GrssFeedChannel *channel;
+	GList *items;
+	GPtrArray *urls;
+	GPtrArray *updates;
 	GCancellable *cancellable;
-} FeedItemInsertData;
+} FeedItemsInsertData;
 
 static void         graph_updated_cb                (GDBusConnection       *connection,
                                                      const gchar           *sender_name,
@@ -76,7 +79,7 @@ static void         miner_resumed                   (TrackerMiner          *mine
 static void         retrieve_and_schedule_feeds     (TrackerMinerRSS       *miner);
 static gboolean     feed_channel_changed_timeout_cb (gpointer               user_data);
 static void         feed_channel_update_data_free   (FeedChannelUpdateData *fcud);
-static void         feed_item_insert_data_free      (FeedItemInsertData    *fiid);
+static void         feed_items_insert_data_free     (FeedItemsInsertData   *fiid);
 static void         feed_fetching_cb                (GrssFeedsPool             *pool,
                                                      GrssFeedChannel           *feed,
                                                      gpointer               user_data);
@@ -102,10 +105,8 @@ tracker_miner_rss_finalize (GObject *object)
 	g_dbus_connection_signal_unsubscribe (priv->connection, priv->graph_updated_id);
 	g_object_unref (priv->connection);
 
-	g_list_foreach (priv->item_inserts, (GFunc) feed_item_insert_data_free, NULL);
-	g_list_free (priv->item_inserts);
-
 	g_hash_table_unref (priv->channel_updates);
+	g_hash_table_unref (priv->seen_items);
 
 	G_OBJECT_CLASS (tracker_miner_rss_parent_class)->finalize (object);
 }
@@ -161,6 +162,13 @@ tracker_miner_rss_init (TrackerMinerRSS *object)
 	                                               NULL,
 	                                               (GDestroyNotify) feed_channel_update_data_free);
 
+	/* Channel subject -> set of message URLs known to be stored,
+	 * channel objects are recreated whenever feeds are rescheduled */
+	priv->seen_items = g_hash_table_new_full (g_str_hash,
+	                                          g_str_equal,
+	                                          g_free,
+	                                          (GDestroyNotify) g_hash_table_unref);
+
 	priv->pool = grss_feeds_pool_new ();
 	g_signal_connect (priv->pool, "feed-fetching", G_CALLBACK (feed_fetching_cb), object);
 	g_signal_connect (priv->pool, "feed-ready", G_CALLBACK (feed_ready_cb), object);
@@ -244,22 +252,24 @@ feed_channel_update_data_free (FeedChannelUpdateData *fcud)
 	g_slice_free (FeedChannelUpdateData, fcud);
 }
 
-static FeedItemInsertData *
-feed_item_insert_data_new (TrackerMinerRSS *miner,
-                           GrssFeedItem    *item)
+static FeedItemsInsertData *
+feed_items_insert_data_new (TrackerMinerRSS *miner,
+                            GrssFeedChannel *channel)
 {
-	FeedItemInsertData *fiid;
+	FeedItemsInsertData *fiid;
 
-	fiid = g_slice_new0 (FeedItemInsertData);
+	fiid = g_slice_new0 (FeedItemsInsertData);
 	fiid->miner = g_object_ref (miner);
-	fiid->item = g_object_ref (item);
+	fiid->channel = g_object_ref (channel);
+	fiid->urls = g_ptr_array_new ();
+	fiid->updates = g_ptr_array_new_with_free_func (g_free);
 	fiid->cancellable = g_cancellable_new ();
 
 	return fiid;
 }
 
 static void
-feed_item_insert_data_free (FeedItemInsertData *fiid)
+feed_items_insert_data_free (FeedItemsInsertData *fiid)
 {
 	if (!fiid) {
 		return;
@@ -270,15 +280,21 @@ feed_item_insert_data_free (FeedItemInsertData *fiid)
 		g_object_unref (fiid->cancellable);
 	}
 
-	if (fiid->item) {
-		g_object_unref (fiid->item);
+	/* URLs are owned by the items */
+	g_ptr_array_unref (fiid->urls);
+	g_ptr_array_unref (fiid->updates);
+
+	g_list_free_full (fiid->items, g_object_unref);
+
+	if (fiid->channel) {
+		g_object_unref (fiid->channel);
 	}
 
 	if (fiid->miner) {
 		g_object_unref (fiid->miner);
 	}
 
-	g_slice_free (FeedItemInsertData, fiid);
+	g_slice_free (FeedItemsInsertData, fiid);
 }
 
 static void
@@ -352,17 +368,15 @@ feed_channel_changed_timeout_cb (gpointer user_data)
 }
 
 static void
-feed_channel_change_updated_time (FeedItemInsertData *fiid)
+feed_channel_change_updated_time (TrackerMinerRSS *miner,
+                                  GrssFeedChannel *channel)
 {
 	TrackerMinerRSSPrivate *priv;
-	GrssFeedChannel *channel;
 	FeedChannelUpdateData *fcud;
 
-	priv = TRACKER_MINER_RSS_GET_PRIVATE (fiid->miner);
+	priv = TRACKER_MINER_RSS_GET_PRIVATE (miner);
 
 	/* Check we don't already have an update request for this channel */
-	channel = grss_feed_item_get_parent (fiid->item);
-
 	fcud = g_hash_table_lookup (priv->channel_updates, channel);
 	if (fcud) {
 		/* We already had an update for this channel in
@@ -374,7 +388,7 @@ feed_channel_change_updated_time (FeedItemInsertData *fiid)
 		                                          fcud);
 	} else {
 		/* This is a new update for this channel */
-		fcud = feed_channel_update_data_new (fiid->miner, channel);
+		fcud = feed_channel_update_data_new (miner, channel);
 		g_hash_table_insert (priv->channel_updates,
 		                     fcud->channel,
 		                     fcud);
@@ -409,104 +423,47 @@ feed_fetching_cb (GrssFeedsPool   *pool,
 	g_object_set (miner, "progress", prog, "status", "Fetching…", NULL);
 }
 
-static void
-feed_item_insert_cb (GObject      *source,
-                     GAsyncResult *result,
-                     gpointer      user_data)
+static GHashTable *
+feed_channel_get_seen_items (TrackerMinerRSS *miner,
+                             GrssFeedChannel *channel)
 {
-	FeedItemInsertData *fiid;
-	GError *error;
-	const gchar *title;
+	TrackerMinerRSSPrivate *priv;
+	GHashTable *seen;
+	const gchar *subject;
 
-	fiid = user_data;
-	title = grss_feed_item_get_title (fiid->item);
-	error = NULL;
+	priv = TRACKER_MINER_RSS_GET_PRIVATE (miner);
+	subject = g_object_get_data (G_OBJECT (channel), "subject");
+	seen = g_hash_table_lookup (priv->seen_items, subject);
 
-	tracker_sparql_connection_update_finish (TRACKER_SPARQL_CONNECTION (source), result, &error);
-	if (error != NULL) {
-		g_critical ("Could not insert feed information for message titled:'%s', %s",
-		            title,
-		            error->message);
-		g_error_free (error);
-	} else {
-		feed_channel_change_updated_time (fiid);
+	if (!seen) {
+		seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		g_hash_table_insert (priv->seen_items, g_strdup (subject), seen);
 	}
 
-	feed_item_insert_data_free (fiid);
+	return seen;
 }
 
-static void
-feed_item_check_exists_cb (GObject      *source_object,
-                           GAsyncResult *res,
-                           gpointer      user_data)
+static gchar *
+feed_item_build_sparql (GrssFeedItem *item,
+                        const gchar  *url)
 {
-	TrackerSparqlConnection *connection;
-	FeedItemInsertData *fiid;
-	time_t t;
-	gchar *uri;
-	const gchar *str;
-	const gchar *url;
-	gdouble latitude;
-	gdouble longitude;
-	const gchar *tmp_string;
-	TrackerSparqlCursor *cursor;
-	GError *error;
 	TrackerSparqlBuilder *sparql;
 	GrssFeedChannel *channel;
+	const gchar *tmp_string;
 	gboolean has_geolocation;
+	gdouble latitude;
+	gdouble longitude;
+	gchar *result;
+	gchar *uri;
+	time_t t;
 
-	fiid = user_data;
-	connection = TRACKER_SPARQL_CONNECTION (source_object);
-	error = NULL;
-	cursor = tracker_sparql_connection_query_finish (connection, res, &error);
-
-	if (error != NULL) {
-		g_message ("Could not verify feed existance, %s", error->message);
-		g_error_free (error);
-
-		if (cursor) {
-			g_object_unref (cursor);
-		}
-
-		feed_item_insert_data_free (fiid);
-
-		return;
-	}
-
-	if (!tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-		g_message ("No data in query response??");
-
-		if (cursor) {
-			g_object_unref (cursor);
-		}
-
-		feed_item_insert_data_free (fiid);
-
-		return;
-	}
-
-	url = get_message_url (fiid->item);
-	channel = grss_feed_item_get_parent (fiid->item);
-
-	str = tracker_sparql_cursor_get_string (cursor, 0, NULL);
-	if (str && g_ascii_strcasecmp (str, "true") == 0) {
-		g_message ("  Item already exists '%s'",
-		           grss_feed_item_get_title (fiid->item));
-
-		if (cursor) {
-			g_object_unref (cursor);
-		}
-
-		feed_item_insert_data_free (fiid);
-
-		return;
-	}
+	channel = grss_feed_item_get_parent (item);
 
 	g_message ("Inserting feed item for '%s'", url);
 
 	sparql = tracker_sparql_builder_new_update ();
 
-	has_geolocation = grss_feed_item_get_geo_point (fiid->item, &latitude, &longitude);
+	has_geolocation = grss_feed_item_get_geo_point (item, &latitude, &longitude);
 	tracker_sparql_builder_insert_open (sparql, NULL);
 
 	if (has_geolocation) {
@@ -534,7 +491,7 @@ feed_item_check_exists_cb (GObject      *source_object,
 		tracker_sparql_builder_object (sparql, "_:location");
 	}
 
-	tmp_string = grss_feed_item_get_title (fiid->item);
+	tmp_string = grss_feed_item_get_title (item);
 	if (tmp_string != NULL) {
 		g_message ("  Title:'%s'", tmp_string);
 
@@ -542,16 +499,14 @@ feed_item_check_exists_cb (GObject      *source_object,
 		tracker_sparql_builder_object_unvalidated (sparql, tmp_string);
 	}
 
-	tmp_string = grss_feed_item_get_description (fiid->item);
+	tmp_string = grss_feed_item_get_description (item);
 	if (tmp_string != NULL) {
 		tracker_sparql_builder_predicate (sparql, "nie:plainTextContent");
 		tracker_sparql_builder_object_unvalidated (sparql, tmp_string);
 	}
 
-	if (url != NULL) {
-		tracker_sparql_builder_predicate (sparql, "nie:url");
-		tracker_sparql_builder_object_unvalidated (sparql, url);
-	}
+	tracker_sparql_builder_predicate (sparql, "nie:url");
+	tracker_sparql_builder_object_unvalidated (sparql, url);
 
 	/* TODO nmo:receivedDate and mfo:downloadedTime are the same?
 	 *      Ask for the MFO maintainer */
@@ -564,7 +519,7 @@ feed_item_check_exists_cb (GObject      *source_object,
 	tracker_sparql_builder_predicate (sparql, "mfo:downloadedTime");
 	tracker_sparql_builder_object_date (sparql, &t);
 
-	t = grss_feed_item_get_publish_time (fiid->item);
+	t = grss_feed_item_get_publish_time (item);
 	tracker_sparql_builder_predicate (sparql, "nie:contentCreated");
 	tracker_sparql_builder_object_date (sparql, &t);
 
@@ -577,47 +532,222 @@ feed_item_check_exists_cb (GObject      *source_object,
 
 	tracker_sparql_builder_insert_close (sparql);
 
-	tracker_sparql_connection_update_async (connection,
-	                                        tracker_sparql_builder_get_result (sparql),
-	                                        G_PRIORITY_DEFAULT,
-	                                        fiid->cancellable,
-	                                        feed_item_insert_cb,
-	                                        fiid);
+	result = g_strdup (tracker_sparql_builder_get_result (sparql));
+	g_object_unref (sparql);
+
+	return result;
+}
+
+static void
+feed_items_insert_cb (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+	FeedItemsInsertData *fiid;
+	GHashTable *seen;
+	GPtrArray *errors;
+	GError *error = NULL;
+	guint i, inserted = 0;
+
+	fiid = user_data;
+
+	errors = tracker_sparql_connection_update_array_finish (TRACKER_SPARQL_CONNECTION (source),
+	                                                        result,
+	                                                        &error);
+	if (error != NULL) {
+		g_critical ("Could not insert feed messages for channel:'%s', %s",
+		            grss_feed_channel_get_title (fiid->channel),
+		            error->message);
+		g_error_free (error);
+		feed_items_insert_data_free (fiid);
+		return;
+	}
+
+	seen = feed_channel_get_seen_items (fiid->miner, fiid->channel);
+
+	for (i = 0; i < errors->len; i++) {
+		GError *child_error = g_ptr_array_index (errors, i);
+		const gchar *url = g_ptr_array_index (fiid->urls, i);
+
+		if (child_error) {
+			g_critical ("Could not insert feed information for message:'%s', %s",
+			            url,
+			            child_error->message);
+			continue;
+		}
+
+		g_hash_table_add (seen, g_strdup (url));
+		inserted++;
+	}
+
+	if (inserted > 0) {
+		feed_channel_change_updated_time (fiid->miner, fiid->channel);
+	}
+
+	g_ptr_array_unref (errors);
+	feed_items_insert_data_free (fiid);
+}
+
+static void
+feed_items_check_exists_cb (GObject      *source_object,
+                            GAsyncResult *res,
+                            gpointer      user_data)
+{
+	TrackerSparqlConnection *connection;
+	FeedItemsInsertData *fiid;
+	TrackerSparqlCursor *cursor;
+	GHashTable *seen;
+	GPtrArray *urls;
+	GError *error;
+	GList *l;
+	guint i;
+
+	fiid = user_data;
+	connection = TRACKER_SPARQL_CONNECTION (source_object);
+	error = NULL;
+	cursor = tracker_sparql_connection_query_finish (connection, res, &error);
+
+	if (error != NULL) {
+		g_message ("Could not verify feed existance, %s", error->message);
+		g_error_free (error);
+
+		if (cursor) {
+			g_object_unref (cursor);
+		}
+
+		feed_items_insert_data_free (fiid);
+
+		return;
+	}
+
+	seen = feed_channel_get_seen_items (fiid->miner, fiid->channel);
+
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		g_hash_table_add (seen, g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL)));
+	}
 
 	g_object_unref (cursor);
-	g_object_unref (sparql);
+
+	/* Keep only the URLs of new messages, in the order of the updates */
+	urls = fiid->urls;
+	fiid->urls = g_ptr_array_new ();
+
+	for (i = 0, l = fiid->items; i < urls->len; i++, l = l->next) {
+		const gchar *url = g_ptr_array_index (urls, i);
+
+		if (g_hash_table_contains (seen, url)) {
+			g_message ("  Item already exists '%s'",
+			           grss_feed_item_get_title (l->data));
+			continue;
+		}
+
+		g_ptr_array_add (fiid->updates, feed_item_build_sparql (l->data, url));
+		g_ptr_array_add (fiid->urls, (gpointer) url);
+	}
+
+	g_ptr_array_unref (urls);
+
+	if (fiid->updates->len == 0) {
+		feed_items_insert_data_free (fiid);
+		return;
+	}
+
+	tracker_sparql_connection_update_array_async (connection,
+	                                              (gchar **) fiid->updates->pdata,
+	                                              fiid->updates->len,
+	                                              G_PRIORITY_DEFAULT,
+	                                              fiid->cancellable,
+	                                              feed_items_insert_cb,
+	                                              fiid);
 }
 
 static void
-feed_item_check_exists (TrackerMinerRSS *miner,
-                        GrssFeedItem    *item)
+feed_items_check_exists (TrackerMinerRSS *miner,
+                         GrssFeedChannel *channel,
+                         GList           *items)
 {
-	FeedItemInsertData *fiid;
-	GrssFeedChannel *feed;
-	gchar *query;
+	FeedItemsInsertData *fiid;
+	GHashTable *seen, *current, *pending;
+	GString *query;
 	gchar *communication_channel;
-	const gchar *url;
+	GList *l;
+
+	communication_channel = g_object_get_data (G_OBJECT (channel), "subject");
+	seen = feed_channel_get_seen_items (miner, channel);
+	current = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	pending = g_hash_table_new (g_str_hash, g_str_equal);
 
-	url = get_message_url (item);
-	feed = grss_feed_item_get_parent (item);
-	communication_channel = g_object_get_data (G_OBJECT (feed), "subject");
+	fiid = feed_items_insert_data_new (miner, channel);
 
-	query = g_strdup_printf ("ASK {"
-	                         "  ?message a mfo:FeedMessage ;"
-	                         "             nie:url \"%s\";"
-	                         "             nmo:communicationChannel <%s> "
-	                         "}",
-	                         url,
-	                         communication_channel);
+	query = g_string_new (NULL);
+	g_string_append_printf (query,
+	                        "SELECT ?url {"
+	                        "  ?message a mfo:FeedMessage ;"
+	                        "             nie:url ?url ;"
+	                        "             nmo:communicationChannel <%s> ."
+	                        "  FILTER (?url IN (",
+	                        communication_channel);
 
-	fiid = feed_item_insert_data_new (miner, item);
+	for (l = items; l; l = l->next) {
+		GrssFeedItem *item = l->data;
+		const gchar *url;
+		gchar *escaped;
+
+		url = get_message_url (item);
+
+		if (!url) {
+			continue;
+		}
+
+		if (g_hash_table_contains (seen, url)) {
+			/* Stored on a previous poll, nothing to check */
+			g_hash_table_add (current, g_strdup (url));
+			continue;
+		}
+
+		if (g_hash_table_contains (pending, url)) {
+			/* Feeds may repeat an item */
+			continue;
+		}
+
+		g_hash_table_add (pending, (gpointer) url);
+
+		escaped = tracker_sparql_escape_string (url);
+		g_string_append_printf (query, "%s\"%s\"",
+		                        fiid->urls->len > 0 ? ", " : "",
+		                        escaped);
+		g_free (escaped);
+
+		fiid->items = g_list_prepend (fiid->items, g_object_ref (item));
+		g_ptr_array_add (fiid->urls, (gpointer) url);
+	}
+
+	fiid->items = g_list_reverse (fiid->items);
+	g_string_append (query, ")) }");
+	g_hash_table_unref (pending);
+
+	/* Forget messages no longer in the feed, so the cache is bound
+	 * to the size of the feed */
+	g_hash_table_insert (TRACKER_MINER_RSS_GET_PRIVATE (miner)->seen_items,
+	                     g_strdup (communication_channel),
+	                     current);
+
+	if (fiid->urls->len == 0) {
+		g_message ("  All %d items already exist", g_list_length (items));
+		feed_items_insert_data_free (fiid);
+		g_string_free (query, TRUE);
+		return;
+	}
+
+	g_message ("  Checking %u of %d items",
+	           fiid->urls->len, g_list_length (items));
 
 	tracker_sparql_connection_query_async (tracker_miner_get_connection (TRACKER_MINER (miner)),
-	                                       query,
+	                                       query->str,
 	                                       fiid->cancellable,
-	                                       feed_item_check_exists_cb,
+	                                       feed_items_check_exists_cb,
 	                                       fiid);
-	g_free (query);
+	g_string_free (query, TRUE);
 }
 
 static void
@@ -628,7 +758,6 @@ feed_ready_cb (GrssFeedsPool   *pool,
 {
 	TrackerMinerRSS *miner;
 	TrackerMinerRSSPrivate *priv;
-	GList *iter;
 
 	miner = TRACKER_MINER_RSS (user_data);
 	priv = TRACKER_MINER_RSS_GET_PRIVATE (miner);
@@ -649,11 +778,7 @@ feed_ready_cb (GrssFeedsPool   *pool,
 	g_message ("Verifying channel:'%s' is up to date",
 	           grss_feed_channel_get_title (channel));
 
-	for (iter = items; iter; iter = iter->next) {
-		GrssFeedItem *item = iter->data;
-
-		feed_item_check_exists (miner, item);
-	}
+	feed_items_check_exists (miner, channel, items);
 }
 
 static void
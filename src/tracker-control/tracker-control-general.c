@@ -62,6 +62,7 @@ static gboolean start;
 static gchar *backup;
 static gchar *restore;
 static gboolean collect_debug_info;
+static gboolean optimize;
 
 #define GENERAL_OPTIONS_ENABLED() \
 	(list_processes || \
@@ -75,7 +76,8 @@ static gboolean collect_debug_info;
 	 start || \
 	 backup || \
 	 restore || \
-	 collect_debug_info)
+	 collect_debug_info || \
+	 optimize)
 
 static gboolean term_option_arg_func (const gchar  *option_value,
                                       const gchar  *value,
@@ -109,6 +111,9 @@ static GOptionEntry entries[] = {
 	{ "restore", 'o', 0, G_OPTION_ARG_FILENAME, &restore,
 	  N_("Restore databases from the file provided"),
 	  N_("FILE") },
+	{ "optimize", 0, 0, G_OPTION_ARG_NONE, &optimize,
+	  N_("Merge the full-text search index into a single segment"),
+	  NULL },
 	{ "set-log-verbosity", 0, 0, G_OPTION_ARG_STRING, &set_log_verbosity,
 	  N_("Sets the logging verbosity to LEVEL ('debug', 'detailed', 'minimal', 'errors') for all processes"),
 	  N_("LEVEL") },
@@ -762,6 +767,48 @@ collect_debug (void)
 	g_free (data_dir);
 }
 
+static void
+print_fts_stats (GDBusConnection *connection,
+                 const gchar     *title)
+{
+	GError *error = NULL;
+	GVariant *v;
+	GVariant *stats;
+	gint n_segments = 0, n_levels = 0;
+
+	v = g_dbus_connection_call_sync (connection,
+	                                 "org.freedesktop.Tracker1",
+	                                 "/org/freedesktop/Tracker1/Statistics",
+	                                 "org.freedesktop.Tracker1.Statistics",
+	                                 "GetFts",
+	                                 NULL,
+	                                 G_VARIANT_TYPE ("(a{si})"),
+	                                 G_DBUS_CALL_FLAGS_NONE,
+	                                 -1,
+	                                 NULL,
+	                                 &error);
+
+	if (error) {
+		g_printerr ("  %s: %s\n",
+		            _("Could not get full-text search statistics"),
+		            error->message);
+		g_error_free (error);
+		return;
+	}
+
+	stats = g_variant_get_child_value (v, 0);
+	g_variant_lookup (stats, "segments", "i", &n_segments);
+	g_variant_lookup (stats, "levels", "i", &n_levels);
+
+	g_print ("  %s: %d %s, %d %s\n",
+	         title,
+	         n_segments, _("segments"),
+	         n_levels, _("levels"));
+
+	g_variant_unref (stats);
+	g_variant_unref (v);
+}
+
 void
 tracker_control_general_run_default (void)
 {
@@ -1322,6 +1369,71 @@ tracker_control_general_run (void)
 		g_free (uri);
 	}
 
+	if (optimize) {
+		GDBusConnection *connection;
+		GDBusProxy *proxy;
+		GError *error = NULL;
+		GVariant *v;
+
+		g_print ("%s\n", _("Optimizing full-text search index"));
+
+		connection = g_bus_get_sync (TRACKER_IPC_BUS, NULL, &error);
+
+		if (!connection) {
+			g_critical ("Could not connect to the D-Bus session bus: %s",
+			            error ? error->message : "No error given");
+			g_clear_error (&error);
+
+			return EXIT_FAILURE;
+		}
+
+		print_fts_stats (connection, _("Before"));
+
+		proxy = g_dbus_proxy_new_sync (connection,
+		                               G_DBUS_PROXY_FLAGS_NONE,
+		                               NULL,
+		                               "org.freedesktop.Tracker1",
+		                               "/org/freedesktop/Tracker1/Resources",
+		                               "org.freedesktop.Tracker1.Resources",
+		                               NULL,
+		                               &error);
+
+		if (error) {
+			g_critical ("Could not create proxy on the D-Bus session bus: %s",
+			            error ? error->message : "No error given");
+			g_clear_error (&error);
+
+			return EXIT_FAILURE;
+		}
+
+		/* Merging a large index can take some time */
+		g_dbus_proxy_set_default_timeout (proxy, G_MAXINT);
+
+		v = g_dbus_proxy_call_sync (proxy,
+		                            "Optimize",
+		                            NULL,
+		                            G_DBUS_CALL_FLAGS_NONE,
+		                            -1,
+		                            NULL,
+		                            &error);
+
+		g_object_unref (proxy);
+
+		if (error) {
+			g_critical ("Could not optimize full-text search index: %s",
+			            error ? error->message : "No error given");
+			g_clear_error (&error);
+
+			return EXIT_FAILURE;
+		}
+
+		if (v) {
+			g_variant_unref (v);
+		}
+
+		print_fts_stats (connection, _("After"));
+	}
+
 	if (restore) {
 		GDBusConnection *connection;
 		GDBusProxy *proxy;
@@ -42,9 +42,10 @@ static gint paused_length = 0;
 static gboolean status;
 static gboolean follow;
 static gboolean list_common_statuses;
+static gboolean show_stats;
 
 #define STATUS_OPTIONS_ENABLED() \
-	(status || follow || list_common_statuses)
+	(status || follow || list_common_statuses || show_stats)
 
 /* Make sure our statuses are translated (most from libtracker-miner) */
 static const gchar *statuses[8] = {
@@ -71,6 +72,10 @@ static GOptionEntry entries[] = {
 	  N_("List common statuses for miners and the store"),
 	  NULL
 	},
+	{ "stats", 0, 0, G_OPTION_ARG_NONE, &show_stats,
+	  N_("Show latency statistics for the store and running miners"),
+	  NULL
+	},
 	{ NULL }
 };
 
@@ -498,6 +503,136 @@ store_init (void)
 	return TRUE;
 }
 
+static void
+latency_print (GDBusConnection *bus,
+               const gchar     *title,
+               const gchar     *service,
+               const gchar     *object_path,
+               const gchar     *interface)
+{
+	GError *error = NULL;
+	GVariant *v, *stats;
+	GVariantIter iter;
+	const gchar *stage;
+	gint64 count, total, p50, p90, p99, max;
+
+	g_print ("%s:\n", title);
+
+	v = g_dbus_connection_call_sync (bus,
+	                                 service,
+	                                 object_path,
+	                                 interface,
+	                                 "GetLatency",
+	                                 NULL,
+	                                 G_VARIANT_TYPE ("(a(sxxxxxx))"),
+	                                 G_DBUS_CALL_FLAGS_NO_AUTO_START,
+	                                 -1,
+	                                 NULL,
+	                                 &error);
+
+	if (error) {
+		g_printerr ("  %s: %s\n",
+		            _("Could not get latency statistics"),
+		            error->message);
+		g_error_free (error);
+		return;
+	}
+
+	stats = g_variant_get_child_value (v, 0);
+
+	if (g_variant_n_children (stats) == 0) {
+		g_print ("  %s\n", _("No samples recorded yet"));
+	} else {
+		/* Times are sent in microseconds */
+		g_print ("  %-18s %10s %10s %10s %10s %10s %10s\n",
+		         _("Stage"), _("Count"), _("Mean (ms)"),
+		         "p50", "p90", "p99", _("Max"));
+	}
+
+	g_variant_iter_init (&iter, stats);
+
+	while (g_variant_iter_next (&iter, "(&sxxxxxx)",
+	                            &stage, &count, &total,
+	                            &p50, &p90, &p99, &max)) {
+		g_print ("  %-18s %10" G_GINT64_FORMAT " %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+		         stage, count,
+		         (gdouble) total / MAX (count, 1) / 1000,
+		         p50 / 1000.0, p90 / 1000.0, p99 / 1000.0, max / 1000.0);
+	}
+
+	g_print ("\n");
+
+	g_variant_unref (stats);
+	g_variant_unref (v);
+}
+
+static gint
+latency_print_all (void)
+{
+	TrackerMinerManager *manager;
+	GDBusConnection *bus;
+	GError *error = NULL;
+	GSList *miners_running, *l;
+
+	bus = g_bus_get_sync (TRACKER_IPC_BUS, NULL, &error);
+
+	if (!bus) {
+		g_printerr ("%s: %s\n",
+		            _("Could not connect to the D-Bus session bus"),
+		            error ? error->message : _("No error given"));
+		g_clear_error (&error);
+		return EXIT_FAILURE;
+	}
+
+	latency_print (bus,
+	               _("Store"),
+	               "org.freedesktop.Tracker1",
+	               "/org/freedesktop/Tracker1/Statistics",
+	               "org.freedesktop.Tracker1.Statistics");
+
+	/* Don't auto-start the miners here */
+	manager = tracker_miner_manager_new_full (FALSE, &error);
+
+	if (!manager) {
+		g_printerr (_("Could not get status, manager could not be created, %s"),
+		            error ? error->message : "unknown error");
+		g_printerr ("\n");
+		g_clear_error (&error);
+		g_object_unref (bus);
+		return EXIT_FAILURE;
+	}
+
+	miners_running = tracker_miner_manager_get_running (manager);
+
+	for (l = miners_running; l; l = l->next) {
+		const gchar *name;
+		gchar *object_path;
+
+		name = tracker_miner_manager_get_display_name (manager, l->data);
+
+		/* org.freedesktop.Tracker1.Miner.Files is exported
+		 * at /org/freedesktop/Tracker1/Miner/Files */
+		object_path = g_strdup_printf ("/%s", (gchar *) l->data);
+		g_strdelimit (object_path, ".", '/');
+
+		latency_print (bus,
+		               name ? name : l->data,
+		               l->data,
+		               object_path,
+		               "org.freedesktop.Tracker1.Miner");
+
+		g_free (object_path);
+	}
+
+	g_slist_foreach (miners_running, (GFunc) g_free, NULL);
+	g_slist_free (miners_running);
+
+	g_object_unref (manager);
+	g_object_unref (bus);
+
+	return EXIT_SUCCESS;
+}
+
 void
 tracker_control_status_run_default (void)
 {
@@ -529,6 +664,10 @@ tracker_control_status_run (void)
 		return EXIT_SUCCESS;
 	}
 
+	if (show_stats) {
+		return latency_print_all ();
+	}
+
 	if (status) {
 		GError *error = NULL;
 		GSList *miners_available;
@@ -42,6 +42,7 @@ enum {
 	PROP_SCHED_IDLE,
 	PROP_MAX_BYTES,
 	PROP_MAX_MEDIA_ART_WIDTH,
+	PROP_MAX_THREADS,
 	PROP_WAIT_FOR_MINER_FS,
 };
 
@@ -102,6 +103,16 @@ tracker_config_class_init (TrackerConfigClass *klass)
 	                                                   0,
 	                                                   G_PARAM_READWRITE));
 
+	g_object_class_install_property (object_class,
+	                                 PROP_MAX_THREADS,
+	                                 g_param_spec_int ("max-threads",
+	                                                   "Max threads",
+	                                                   "Maximum number of threads used to extract parts of files in parallel (0=one per CPU, 1->64=max threads)",
+	                                                   0,
+	                                                   64,
+	                                                   0,
+	                                                   G_PARAM_READWRITE));
+
 	g_object_class_install_property (object_class,
 	                                 PROP_WAIT_FOR_MINER_FS,
 	                                 g_param_spec_boolean ("wait-for-miner-fs",
@@ -137,6 +148,7 @@ config_set_property (GObject      *object,
 	case PROP_SCHED_IDLE:
 	case PROP_MAX_BYTES:
 	case PROP_MAX_MEDIA_ART_WIDTH:
+	case PROP_MAX_THREADS:
 	case PROP_WAIT_FOR_MINER_FS:
 		break;
 
@@ -175,6 +187,11 @@ config_get_property (GObject    *object,
 		                 tracker_config_get_max_media_art_width (config));
 		break;
 
+	case PROP_MAX_THREADS:
+		g_value_set_int (value,
+		                 tracker_config_get_max_threads (config));
+		break;
+
 	case PROP_WAIT_FOR_MINER_FS:
 		g_value_set_boolean (value,
 		                     tracker_config_get_wait_for_miner_fs (config));
@@ -213,6 +230,7 @@ config_constructed (GObject *object)
 	g_settings_bind (settings, "sched-idle", object, "sched-idle", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "max-bytes", object, "max-bytes", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "max-media-art-width", object, "max-media-art-width", G_SETTINGS_BIND_GET);
+	g_settings_bind (settings, "max-threads", object, "max-threads", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "wait-for-miner-fs", object, "wait-for-miner-fs", G_SETTINGS_BIND_GET);
 
 	/* Migrate keyfile-based configuration */
@@ -274,6 +292,14 @@ tracker_config_get_max_media_art_width (TrackerConfig *config)
 	return g_settings_get_int (G_SETTINGS (config), "max-media-art-width");
 }
 
+gint
+tracker_config_get_max_threads (TrackerConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_CONFIG (config), 0);
+
+	return g_settings_get_int (G_SETTINGS (config), "max-threads");
+}
+
 gboolean
 tracker_config_get_wait_for_miner_fs (TrackerConfig *config)
 {
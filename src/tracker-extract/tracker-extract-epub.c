@@ -516,7 +516,7 @@ content_xml_text_handler (GMarkupParseContext   *context,
 }
 
 static gchar *
-extract_opf_path (const gchar *uri)
+extract_opf_path (TrackerFileReader *reader)
 {
 	GMarkupParseContext *context;
 	gchar *path = NULL;
@@ -532,7 +532,7 @@ extract_opf_path (const gchar *uri)
 	/* Load the internal container file from the Zip archive,
 	 * and parse it to extract the .opf file to get metadata from
 	 */
-	tracker_gsf_parse_xml_in_zip (uri, "META-INF/container.xml", context, &error);
+	tracker_gsf_parse_xml_in_zip (reader, "META-INF/container.xml", context, &error);
 	g_markup_parse_context_free (context);
 
 	if (error || !path) {
@@ -546,9 +546,9 @@ extract_opf_path (const gchar *uri)
 }
 
 static gchar *
-extract_opf_contents (const gchar *uri,
-                      const gchar *content_prefix,
-                      GList       *content_files)
+extract_opf_contents (TrackerFileReader *reader,
+                      const gchar       *content_prefix,
+                      GList             *content_files)
 {
 	OPFContentData content_data = { 0 };
 	GMarkupParseContext *context;
@@ -574,7 +574,7 @@ extract_opf_contents (const gchar *uri,
 
 		/* Page file is relative to OPF file location */
 		path = g_build_filename (content_prefix, l->data, NULL);
-		tracker_gsf_parse_xml_in_zip (uri, path, context, &error);
+		tracker_gsf_parse_xml_in_zip (reader, path, context, &error);
 		g_free (path);
 
 		if (error) {
@@ -595,7 +595,8 @@ extract_opf_contents (const gchar *uri,
 }
 
 static gboolean
-extract_opf (const gchar          *uri,
+extract_opf (TrackerFileReader    *reader,
+             const gchar          *uri,
              const gchar          *opf_path,
              TrackerExtractInfo   *info)
 {
@@ -623,7 +624,7 @@ extract_opf (const gchar          *uri,
 	/* Load the internal container file from the Zip archive,
 	 * and parse it to extract the .opf file to get metadata from
 	 */
-	tracker_gsf_parse_xml_in_zip (uri, opf_path, context, &error);
+	tracker_gsf_parse_xml_in_zip (reader, opf_path, context, &error);
 	g_markup_parse_context_free (context);
 
 	if (error) {
@@ -635,7 +636,7 @@ extract_opf (const gchar          *uri,
 	}
 
 	dirname = g_path_get_dirname (opf_path);
-	contents = extract_opf_contents (uri, dirname, data->pages);
+	contents = extract_opf_contents (reader, dirname, data->pages);
 	g_free (dirname);
 
 	if (contents && *contents) {
@@ -652,20 +653,29 @@ extract_opf (const gchar          *uri,
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
+	TrackerFileReader *reader;
 	gchar *opf_path, *uri;
 	GFile *file;
 
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
 	file = tracker_extract_info_get_file (info);
 	uri = g_file_get_uri (file);
 
-	opf_path = extract_opf_path (uri);
+	opf_path = extract_opf_path (reader);
 
 	if (!opf_path) {
+		tracker_file_reader_free (reader);
 		g_free (uri);
 		return FALSE;
 	}
 
-	extract_opf (uri, opf_path, info);
+	extract_opf (reader, uri, opf_path, info);
+	tracker_file_reader_free (reader);
 	g_free (opf_path);
 	g_free (uri);
 
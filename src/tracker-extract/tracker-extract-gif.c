@@ -618,18 +618,41 @@ read_metadata (TrackerSparqlBuilder *preupdate,
 	tracker_xmp_free (xd);
 }
 
+typedef struct {
+	TrackerFileReader *reader;
+	goffset offset;
+} GifSource;
+
+static int
+gif_source_read (GifFileType *gifFile,
+                 GifByteType *buffer,
+                 int          length)
+{
+	GifSource *src = gifFile->UserData;
+	gssize n_read;
+
+	n_read = tracker_file_reader_read (src->reader, src->offset, buffer, length);
+
+	if (n_read < 0) {
+		return 0;
+	}
+
+	src->offset += n_read;
+
+	return n_read;
+}
 
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
 	TrackerSparqlBuilder *preupdate, *metadata;
-	goffset size;
+	TrackerFileReader *reader;
+	GifSource src;
 	GifFileType *gifFile = NULL;
 	GString *where;
 	const gchar *graph;
-	gchar *filename, *uri;
+	gchar *uri;
 	GFile *file;
-	int fd;
 #if GIFLIB_MAJOR >= 5
 	int err;
 #endif
@@ -639,38 +662,33 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	graph = tracker_extract_info_get_graph (info);
 
 	file = tracker_extract_info_get_file (info);
-	filename = g_file_get_path (file);
-	size = tracker_file_get_size (filename);
 
-	if (size < 64) {
-		g_free (filename);
+	/* Every frame is decoded, so the whole file is read */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SEQUENTIAL, NULL);
+
+	if (!reader) {
 		return FALSE;
 	}
 
-	fd = tracker_file_open_fd (filename);
-
-	if (fd == -1) {
-		g_warning ("Could not open GIF file '%s': %s\n",
-		           filename,
-		           g_strerror (errno));
-		g_free (filename);
+	if (tracker_file_reader_get_size (reader) < 64) {
+		tracker_file_reader_free (reader);
 		return FALSE;
-	}	
+	}
+
+	src.reader = reader;
+	src.offset = 0;
 
 #if GIFLIB_MAJOR < 5
-	if ((gifFile = DGifOpenFileHandle (fd)) == NULL) {
+	if ((gifFile = DGifOpen (&src, gif_source_read)) == NULL) {
 		print_gif_error ();
 #else   /* GIFLIB_MAJOR < 5 */
-	if ((gifFile = DGifOpenFileHandle (fd, &err)) == NULL) {
-		gif_error ("Could not open GIF file with handle", err);
+	if ((gifFile = DGifOpen (&src, gif_source_read, &err)) == NULL) {
+		gif_error ("Could not open GIF file", err);
 #endif /* GIFLIB_MAJOR < 5 */
-		g_free (filename);
-		close (fd);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
-	g_free (filename);
-
 	tracker_sparql_builder_predicate (metadata, "a");
 	tracker_sparql_builder_object (metadata, "nfo:Image");
 	tracker_sparql_builder_object (metadata, "nmm:Photo");
@@ -692,5 +710,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 #endif /* GIFLIB_MAJOR < 5 */
 	}
 
+	tracker_file_reader_free (reader);
+
 	return TRUE;
 }
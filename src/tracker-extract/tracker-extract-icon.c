@@ -19,20 +19,20 @@
 
 #include "config.h"
 
-#include <libtracker-common/tracker-file-utils.h>
 #include <libtracker-extract/tracker-extract.h>
 
 #define ICON_HEADER_SIZE_16 3
 #define ICON_IMAGE_METADATA_SIZE_8 16
 
 static gboolean
-find_max_width_and_height (const gchar *uri,
-                           guint       *width,
-                           guint       *height)
+find_max_width_and_height (TrackerExtractInfo *info,
+                           const gchar        *uri,
+                           guint              *width,
+                           guint              *height)
 {
+	TrackerFileReader *reader;
 	GError *error = NULL;
-	GFile *file;
-	GFileInputStream *stream;
+	goffset offset;
 	guint n_images;
 	guint i;
 	guint16 header [ICON_HEADER_SIZE_16];
@@ -40,14 +40,12 @@ find_max_width_and_height (const gchar *uri,
 	*width = 0;
 	*height = 0;
 
-	file = g_file_new_for_uri (uri);
-	stream = g_file_read (file, NULL, &error);
-	if (error) {
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SEQUENTIAL, &error);
+	if (!reader) {
 		g_message ("Could not read file '%s': %s",
 		           uri,
 		           error->message);
 		g_error_free (error);
-		g_object_unref (file);
 
 		return FALSE;
 	}
@@ -59,20 +57,15 @@ find_max_width_and_height (const gchar *uri,
 	 *
 	 * Right now we just need the number of images in the file.
 	 */
-	if (!g_input_stream_read_all (G_INPUT_STREAM (stream),
-	                              header,
-	                              ICON_HEADER_SIZE_16 * 2,
-	                              NULL,
-	                              NULL,
-	                              &error)) {
-		g_message ("Error reading icon header from stream: '%s'",
-		           error->message);
-		g_error_free (error);
-		g_object_unref (stream);
-		g_object_unref (file);
+	if (tracker_file_reader_read (reader, 0, header,
+	                              ICON_HEADER_SIZE_16 * 2) != ICON_HEADER_SIZE_16 * 2) {
+		g_message ("Error reading icon header from file '%s'", uri);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
+	offset = ICON_HEADER_SIZE_16 * 2;
+
 	n_images = GUINT16_FROM_LE (header[2]);
 	g_debug ("Found '%u' images in the icon file...", n_images);
 
@@ -85,19 +78,16 @@ find_max_width_and_height (const gchar *uri,
 		 *  - 1 byte, height in pixels, 0 means 256
 		 *  - Plus some other stuff we don't care about...
 		 */
-		if (!g_input_stream_read_all (G_INPUT_STREAM (stream),
-		                              image_metadata,
-		                              ICON_IMAGE_METADATA_SIZE_8,
-		                              NULL,
-		                              NULL,
-		                              &error)) {
-			g_message ("Error reading icon image metadata '%u' from stream: '%s'",
+		if (tracker_file_reader_read (reader, offset, image_metadata,
+		                              ICON_IMAGE_METADATA_SIZE_8) != ICON_IMAGE_METADATA_SIZE_8) {
+			g_message ("Error reading icon image metadata '%u' from file '%s'",
 			           i,
-			           error->message);
-			g_error_free (error);
+			           uri);
 			break;
 		}
 
+		offset += ICON_IMAGE_METADATA_SIZE_8;
+
 		g_debug ("  Image '%u'; width:%u height:%u",
 		         i,
 		         image_metadata[0],
@@ -118,9 +108,7 @@ find_max_width_and_height (const gchar *uri,
 		}
 	}
 
-	g_input_stream_close (G_INPUT_STREAM (stream), NULL, NULL);
-	g_object_unref (stream);
-	g_object_unref (file);
+	tracker_file_reader_free (reader);
 	return TRUE;
 }
 
@@ -144,7 +132,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	tracker_sparql_builder_object (metadata, "nfo:Image");
 	tracker_sparql_builder_object (metadata, "nfo:Icon");
 
-	if (find_max_width_and_height (uri, &max_width, &max_height)) {
+	if (find_max_width_and_height (info, uri, &max_width, &max_height)) {
 		if (max_width > 0) {
 			tracker_sparql_builder_predicate (metadata, "nfo:width");
 			tracker_sparql_builder_object_int64 (metadata, (gint64) max_width);
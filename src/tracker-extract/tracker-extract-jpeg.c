@@ -28,6 +28,7 @@
 #endif
 
 #include <jpeglib.h>
+#include <jerror.h>
 
 #include <libtracker-common/tracker-common.h>
 #include <libtracker-extract/tracker-extract.h>
@@ -37,6 +38,9 @@
 
 #define CM_TO_INCH              0.393700787
 
+/* Size of the chunks the header is read in, in bytes */
+#define JPEG_READ_SIZE          4096
+
 #ifdef HAVE_LIBEXIF
 #define EXIF_NAMESPACE          "Exif"
 #define EXIF_NAMESPACE_LENGTH   4
@@ -86,6 +90,16 @@ struct tej_error_mgr {
 	jmp_buf setjmp_buffer;
 };
 
+/* Data source reading through a TrackerFileReader. Segments libjpeg
+ * skips over (thumbnails, ICC profiles...) are never read from disk.
+ */
+struct tej_source_mgr {
+	struct jpeg_source_mgr jpeg;
+	TrackerFileReader *reader;
+	goffset offset;
+	JOCTET buffer[JPEG_READ_SIZE];
+};
+
 static void
 extract_jpeg_error_exit (j_common_ptr cinfo)
 {
@@ -94,6 +108,82 @@ extract_jpeg_error_exit (j_common_ptr cinfo)
 	longjmp (h->setjmp_buffer, 1);
 }
 
+static void
+extract_jpeg_source_init (j_decompress_ptr cinfo)
+{
+}
+
+static boolean
+extract_jpeg_source_fill (j_decompress_ptr cinfo)
+{
+	struct tej_source_mgr *src = (struct tej_source_mgr *) cinfo->src;
+	gssize n_read;
+
+	n_read = tracker_file_reader_read (src->reader,
+	                                   src->offset,
+	                                   src->buffer,
+	                                   JPEG_READ_SIZE);
+
+	if (n_read <= 0) {
+		/* Insert a fake EOI marker, as jpeg_stdio_src() does */
+		WARNMS (cinfo, JWRN_JPEG_EOF);
+		src->buffer[0] = (JOCTET) 0xFF;
+		src->buffer[1] = (JOCTET) JPEG_EOI;
+		n_read = 2;
+	} else {
+		src->offset += n_read;
+	}
+
+	src->jpeg.next_input_byte = src->buffer;
+	src->jpeg.bytes_in_buffer = n_read;
+
+	return TRUE;
+}
+
+static void
+extract_jpeg_source_skip (j_decompress_ptr cinfo,
+                          long             num_bytes)
+{
+	struct tej_source_mgr *src = (struct tej_source_mgr *) cinfo->src;
+
+	if (num_bytes <= 0) {
+		return;
+	}
+
+	if ((size_t) num_bytes <= src->jpeg.bytes_in_buffer) {
+		src->jpeg.next_input_byte += num_bytes;
+		src->jpeg.bytes_in_buffer -= num_bytes;
+	} else {
+		/* Seek past the rest, the next fill reads from there */
+		src->offset += num_bytes - src->jpeg.bytes_in_buffer;
+		src->jpeg.next_input_byte = src->buffer;
+		src->jpeg.bytes_in_buffer = 0;
+	}
+}
+
+static void
+extract_jpeg_source_term (j_decompress_ptr cinfo)
+{
+}
+
+static void
+extract_jpeg_source_setup (j_decompress_ptr       cinfo,
+                           struct tej_source_mgr *src,
+                           TrackerFileReader     *reader)
+{
+	src->jpeg.init_source = extract_jpeg_source_init;
+	src->jpeg.fill_input_buffer = extract_jpeg_source_fill;
+	src->jpeg.skip_input_data = extract_jpeg_source_skip;
+	src->jpeg.resync_to_restart = jpeg_resync_to_restart;
+	src->jpeg.term_source = extract_jpeg_source_term;
+	src->jpeg.next_input_byte = NULL;
+	src->jpeg.bytes_in_buffer = 0;
+	src->reader = reader;
+	src->offset = 0;
+
+	cinfo->src = &src->jpeg;
+}
+
 static gboolean
 guess_dlna_profile (gint          width,
                     gint          height,
@@ -138,16 +228,16 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
 	struct jpeg_decompress_struct cinfo;
 	struct tej_error_mgr tejerr;
+	struct tej_source_mgr tejsrc;
 	struct jpeg_marker_struct *marker;
 	TrackerSparqlBuilder *preupdate, *metadata;
 	TrackerXmpData *xd = NULL;
 	TrackerExifData *ed = NULL;
 	TrackerIptcData *id = NULL;
 	MergeData md = { 0 };
+	TrackerFileReader *reader;
 	GFile *file;
-	FILE *f;
-	goffset size;
-	gchar *filename, *uri;
+	gchar *uri;
 	gchar *comment = NULL;
 	const gchar *dlna_profile, *dlna_mimetype, *graph;
 	GPtrArray *keywords;
@@ -160,19 +250,16 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	graph = tracker_extract_info_get_graph (info);
 
 	file = tracker_extract_info_get_file (info);
-	filename = g_file_get_path (file);
 
-	size = tracker_file_get_size (filename);
+	/* Only the markers before the image data are read */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
 
-	if (size < 18) {
-		g_free (filename);
+	if (!reader) {
 		return FALSE;
 	}
 
-	f = tracker_file_open (filename);
-	g_free (filename);
-
-	if (!f) {
+	if (tracker_file_reader_get_size (reader) < 18) {
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
@@ -196,7 +283,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	jpeg_save_markers (&cinfo, JPEG_APP0 + 1, 0xFFFF);
 	jpeg_save_markers (&cinfo, JPEG_APP0 + 13, 0xFFFF);
 
-	jpeg_stdio_src (&cinfo, f);
+	extract_jpeg_source_setup (&cinfo, &tejsrc, reader);
 
 	jpeg_read_header (&cinfo, TRUE);
 
@@ -796,7 +883,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	g_free (comment);
 
 fail:
-	tracker_file_close (f, FALSE);
+	tracker_file_reader_free (reader);
 	g_free (uri);
 
 	return success;
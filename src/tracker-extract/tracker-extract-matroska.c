@@ -0,0 +1,716 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <libtracker-common/tracker-common.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+#include "tracker-media-tags.h"
+
+/* Parses Matroska and WebM files. The segment is read up to the first
+ * cluster, the seek head is used to find elements stored after the
+ * media data, usually the tags. Only the element headers on the way
+ * are read, and only the elements parsed are mapped.
+ */
+
+#define EBML_ID_HEADER            0x1A45DFA3
+#define EBML_ID_DOCTYPE           0x4282
+
+#define MKV_ID_SEGMENT            0x18538067
+#define MKV_ID_SEEKHEAD           0x114D9B74
+#define MKV_ID_SEEK               0x4DBB
+#define MKV_ID_SEEKID             0x53AB
+#define MKV_ID_SEEKPOSITION       0x53AC
+#define MKV_ID_INFO               0x1549A966
+#define MKV_ID_TIMECODESCALE      0x2AD7B1
+#define MKV_ID_DURATION           0x4489
+#define MKV_ID_TITLE              0x7BA9
+#define MKV_ID_DATEUTC            0x4461
+#define MKV_ID_TRACKS             0x1654AE6B
+#define MKV_ID_TRACKENTRY         0xAE
+#define MKV_ID_TRACKTYPE          0x83
+#define MKV_ID_CODECID            0x86
+#define MKV_ID_DEFAULTDURATION    0x23E383
+#define MKV_ID_VIDEO              0xE0
+#define MKV_ID_PIXELWIDTH         0xB0
+#define MKV_ID_PIXELHEIGHT        0xBA
+#define MKV_ID_AUDIO              0xE1
+#define MKV_ID_SAMPLINGFREQUENCY  0xB5
+#define MKV_ID_CHANNELS           0x9F
+#define MKV_ID_CLUSTER            0x1F43B675
+#define MKV_ID_TAGS               0x1254C367
+#define MKV_ID_TAG                0x7373
+#define MKV_ID_TARGETS            0x63C0
+#define MKV_ID_TARGETTYPEVALUE    0x68CA
+#define MKV_ID_SIMPLETAG          0x67C8
+#define MKV_ID_TAGNAME            0x45A3
+#define MKV_ID_TAGSTRING          0x4487
+
+#define MKV_TRACK_TYPE_VIDEO      1
+#define MKV_TRACK_TYPE_AUDIO      2
+
+/* Tags at this target level or above describe the whole album
+ * or movie, below it a single track */
+#define MKV_TARGET_ALBUM          50
+
+/* Seconds between the Unix epoch and the Matroska one, 2001-01-01 */
+#define MKV_EPOCH_OFFSET          978307200
+
+#define MKV_UNKNOWN_SIZE          G_MAXUINT64
+
+/* Metadata elements are small, anything bigger is mostly
+ * attachments or binary tags, which are not looked at */
+#define MKV_MAX_ELEMENT_SIZE      (1024 * 1024)
+
+/* Longest element header, a 4 byte ID and an 8 byte size */
+#define MKV_MAX_HEADER_SIZE       12
+
+typedef struct {
+	TrackerFileReader *reader;
+	goffset file_size;
+
+	/* The window mapped for the element being parsed */
+	const guchar *data;
+	gsize len;
+	TrackerMediaTags *tags;
+
+	goffset segment_start;
+	gboolean info_done;
+	gboolean tracks_done;
+	gboolean tags_done;
+
+	guint64 timecode_scale;
+	gdouble duration;
+
+	gchar *album_title;
+	gchar *album_artist;
+} MkvData;
+
+typedef struct {
+	guint32 id;
+	goffset offset;
+	guint64 size;
+} MkvElement;
+
+/* Reads the ID and size of the element starting at @offset,
+ * @size is MKV_UNKNOWN_SIZE if the muxer did not write it */
+static gboolean
+mkv_read_header (const guchar *data,
+                 gsize         offset,
+                 gsize         end,
+                 guint32      *id,
+                 guint64      *size,
+                 gsize        *header_len)
+{
+	gint id_len, size_len, i;
+	gsize start = offset;
+	guchar mask;
+
+	if (offset >= end) {
+		return FALSE;
+	}
+
+	for (id_len = 1, mask = 0x80; id_len <= 4 && !(data[offset] & mask); id_len++) {
+		mask >>= 1;
+	}
+
+	if (id_len > 4 || end - offset < (gsize) id_len + 1) {
+		return FALSE;
+	}
+
+	*id = 0;
+	for (i = 0; i < id_len; i++) {
+		*id = (*id << 8) | data[offset + i];
+	}
+
+	offset += id_len;
+
+	for (size_len = 1, mask = 0x80; size_len <= 8 && !(data[offset] & mask); size_len++) {
+		mask >>= 1;
+	}
+
+	if (size_len > 8 || end - offset < (gsize) size_len) {
+		return FALSE;
+	}
+
+	*size = data[offset] & (mask - 1);
+
+	for (i = 1; i < size_len; i++) {
+		*size = (*size << 8) | data[offset + i];
+	}
+
+	/* All value bits set means the size is unknown */
+	if (*size == (G_GUINT64_CONSTANT (1) << (7 * size_len)) - 1) {
+		*size = MKV_UNKNOWN_SIZE;
+	}
+
+	*header_len = offset + size_len - start;
+
+	return TRUE;
+}
+
+/* Reads the element starting at @offset, the payload is
+ * clamped to @end */
+static gboolean
+mkv_read_element (const guchar *data,
+                  gsize         offset,
+                  gsize         end,
+                  MkvElement   *element)
+{
+	guint64 size;
+	gsize header_len;
+
+	if (!mkv_read_header (data, offset, end, &element->id, &size, &header_len)) {
+		return FALSE;
+	}
+
+	element->offset = offset + header_len;
+	element->size = MIN (size, end - (gsize) element->offset);
+
+	return TRUE;
+}
+
+/* Same as mkv_read_element() for an element of the file, only
+ * its header is read, @element->offset is a file offset */
+static gboolean
+mkv_read_file_element (MkvData    *md,
+                       goffset     offset,
+                       goffset     end,
+                       MkvElement *element)
+{
+	guchar header[MKV_MAX_HEADER_SIZE];
+	guint64 size;
+	gsize header_len;
+	gssize len;
+
+	if (offset >= end) {
+		return FALSE;
+	}
+
+	len = tracker_file_reader_read (md->reader, offset, header,
+	                                MIN (sizeof (header), (guint64) (end - offset)));
+
+	if (len <= 0 ||
+	    !mkv_read_header (header, 0, len, &element->id, &size, &header_len)) {
+		return FALSE;
+	}
+
+	element->offset = offset + header_len;
+	element->size = MIN (size, (guint64) (end - element->offset));
+
+	return TRUE;
+}
+
+/* Maps the payload of the file element @element, and makes
+ * @window describe it within the mapping */
+static gboolean
+mkv_map_element (MkvData    *md,
+                 MkvElement *element,
+                 MkvElement *window)
+{
+	md->data = tracker_file_reader_map (md->reader, element->offset,
+	                                    MIN (element->size, MKV_MAX_ELEMENT_SIZE),
+	                                    &md->len);
+
+	if (!md->data) {
+		return FALSE;
+	}
+
+	window->id = element->id;
+	window->offset = 0;
+	window->size = md->len;
+
+	return TRUE;
+}
+
+static guint64
+mkv_read_uint (const guchar *data,
+               MkvElement   *element)
+{
+	guint64 value = 0;
+	guint64 i;
+
+	for (i = 0; i < element->size && i < 8; i++) {
+		value = (value << 8) | data[element->offset + i];
+	}
+
+	return value;
+}
+
+static gdouble
+mkv_read_float (const guchar *data,
+                MkvElement   *element)
+{
+	union {
+		guint32 i;
+		gfloat f;
+	} f32;
+	union {
+		guint64 i;
+		gdouble d;
+	} f64;
+
+	if (element->size == 4) {
+		f32.i = (guint32) mkv_read_uint (data, element);
+		return f32.f;
+	} else if (element->size == 8) {
+		f64.i = mkv_read_uint (data, element);
+		return f64.d;
+	}
+
+	return 0;
+}
+
+static gchar *
+mkv_read_string (const guchar *data,
+                 MkvElement   *element)
+{
+	if (element->size == 0) {
+		return NULL;
+	}
+
+	return g_strndup ((const gchar *) data + element->offset, element->size);
+}
+
+static void
+mkv_parse_info (MkvData    *md,
+                MkvElement *info)
+{
+	MkvElement child;
+	gsize offset, end;
+
+	offset = info->offset;
+	end = info->offset + info->size;
+
+	while (mkv_read_element (md->data, offset, end, &child)) {
+		switch (child.id) {
+		case MKV_ID_TIMECODESCALE:
+			md->timecode_scale = mkv_read_uint (md->data, &child);
+			break;
+		case MKV_ID_DURATION:
+			md->duration = mkv_read_float (md->data, &child);
+			break;
+		case MKV_ID_TITLE:
+			if (!md->tags->title) {
+				md->tags->title = mkv_read_string (md->data, &child);
+			}
+			break;
+		case MKV_ID_DATEUTC:
+			if (!md->tags->date && child.size == 8) {
+				gint64 ns = (gint64) mkv_read_uint (md->data, &child);
+
+				md->tags->date = tracker_date_to_string (MKV_EPOCH_OFFSET + ns / G_GINT64_CONSTANT (1000000000));
+			}
+			break;
+		default:
+			break;
+		}
+
+		offset = child.offset + child.size;
+	}
+
+	md->info_done = TRUE;
+}
+
+static void
+mkv_parse_track_entry (MkvData    *md,
+                       MkvElement *entry)
+{
+	TrackerMediaTags *tags = md->tags;
+	MkvElement child, sub;
+	gsize offset, end, sub_offset;
+	guint64 type = 0, default_duration = 0;
+	gchar *codec = NULL;
+	gint width = -1, height = -1, channels = -1;
+	gdouble sample_rate = -1;
+
+	offset = entry->offset;
+	end = entry->offset + entry->size;
+
+	while (mkv_read_element (md->data, offset, end, &child)) {
+		switch (child.id) {
+		case MKV_ID_TRACKTYPE:
+			type = mkv_read_uint (md->data, &child);
+			break;
+		case MKV_ID_CODECID:
+			g_free (codec);
+			codec = mkv_read_string (md->data, &child);
+			break;
+		case MKV_ID_DEFAULTDURATION:
+			default_duration = mkv_read_uint (md->data, &child);
+			break;
+		case MKV_ID_VIDEO:
+		case MKV_ID_AUDIO:
+			sub_offset = child.offset;
+
+			while (mkv_read_element (md->data, sub_offset, child.offset + child.size, &sub)) {
+				if (sub.id == MKV_ID_PIXELWIDTH) {
+					width = mkv_read_uint (md->data, &sub);
+				} else if (sub.id == MKV_ID_PIXELHEIGHT) {
+					height = mkv_read_uint (md->data, &sub);
+				} else if (sub.id == MKV_ID_SAMPLINGFREQUENCY) {
+					sample_rate = mkv_read_float (md->data, &sub);
+				} else if (sub.id == MKV_ID_CHANNELS) {
+					channels = mkv_read_uint (md->data, &sub);
+				}
+
+				sub_offset = sub.offset + sub.size;
+			}
+			break;
+		default:
+			break;
+		}
+
+		offset = child.offset + child.size;
+	}
+
+	/* The first track of each type describes the file */
+	if (type == MKV_TRACK_TYPE_VIDEO && !tags->has_video) {
+		tags->has_video = TRUE;
+		tags->width = width;
+		tags->height = height;
+		tags->video_codec = codec;
+		codec = NULL;
+
+		if (default_duration > 0) {
+			tags->frame_rate = 1000000000.0 / default_duration;
+		}
+	} else if (type == MKV_TRACK_TYPE_AUDIO && !tags->has_audio) {
+		tags->has_audio = TRUE;
+		/* Audio elements default to one channel at 8kHz */
+		tags->channels = channels > 0 ? channels : 1;
+		tags->sample_rate = sample_rate > 0 ? (gint) sample_rate : 8000;
+		tags->audio_codec = codec;
+		codec = NULL;
+	}
+
+	g_free (codec);
+}
+
+static void
+mkv_parse_tracks (MkvData    *md,
+                  MkvElement *tracks)
+{
+	MkvElement child;
+	gsize offset, end;
+
+	offset = tracks->offset;
+	end = tracks->offset + tracks->size;
+
+	while (mkv_read_element (md->data, offset, end, &child)) {
+		if (child.id == MKV_ID_TRACKENTRY) {
+			mkv_parse_track_entry (md, &child);
+		}
+
+		offset = child.offset + child.size;
+	}
+
+	md->tracks_done = TRUE;
+}
+
+static void
+mkv_set_tag (MkvData     *md,
+             guint64      target,
+             const gchar *name,
+             const gchar *value)
+{
+	TrackerMediaTags *tags = md->tags;
+	gchar **tag = NULL;
+
+	if (g_ascii_strcasecmp (name, "TITLE") == 0) {
+		tag = target >= MKV_TARGET_ALBUM ? &md->album_title : &tags->title;
+	} else if (g_ascii_strcasecmp (name, "ARTIST") == 0) {
+		tag = target >= MKV_TARGET_ALBUM ? &md->album_artist : &tags->artist;
+	} else if (g_ascii_strcasecmp (name, "PART_NUMBER") == 0) {
+		tag = target >= MKV_TARGET_ALBUM ? &tags->disc_number : &tags->track_number;
+	} else if (g_ascii_strcasecmp (name, "TOTAL_PARTS") == 0) {
+		tag = &tags->track_count;
+	} else if (g_ascii_strcasecmp (name, "GENRE") == 0) {
+		tag = &tags->genre;
+	} else if (g_ascii_strcasecmp (name, "COMMENT") == 0 ||
+	           g_ascii_strcasecmp (name, "DESCRIPTION") == 0) {
+		tag = &tags->comment;
+	} else if (g_ascii_strcasecmp (name, "COPYRIGHT") == 0) {
+		tag = &tags->copyright;
+	} else if (g_ascii_strcasecmp (name, "LICENSE") == 0) {
+		tag = &tags->license;
+	} else if (g_ascii_strcasecmp (name, "DATE_RELEASED") == 0 ||
+	           g_ascii_strcasecmp (name, "DATE_RECORDED") == 0) {
+		if (!tags->date) {
+			tags->date = tracker_date_guess (value);
+		}
+	}
+
+	if (tag && !*tag) {
+		*tag = g_strdup (value);
+	}
+}
+
+static void
+mkv_parse_tags (MkvData    *md,
+                MkvElement *tags)
+{
+	MkvElement tag, child, sub;
+	gsize offset, tag_offset, sub_offset;
+
+	offset = tags->offset;
+
+	while (mkv_read_element (md->data, offset, tags->offset + tags->size, &tag)) {
+		guint64 target = MKV_TARGET_ALBUM;
+
+		if (tag.id != MKV_ID_TAG) {
+			offset = tag.offset + tag.size;
+			continue;
+		}
+
+		tag_offset = tag.offset;
+
+		while (mkv_read_element (md->data, tag_offset, tag.offset + tag.size, &child)) {
+			gchar *name = NULL, *value = NULL;
+
+			sub_offset = child.offset;
+
+			while (mkv_read_element (md->data, sub_offset, child.offset + child.size, &sub)) {
+				if (child.id == MKV_ID_TARGETS && sub.id == MKV_ID_TARGETTYPEVALUE) {
+					target = mkv_read_uint (md->data, &sub);
+				} else if (child.id == MKV_ID_SIMPLETAG && sub.id == MKV_ID_TAGNAME && !name) {
+					name = mkv_read_string (md->data, &sub);
+				} else if (child.id == MKV_ID_SIMPLETAG && sub.id == MKV_ID_TAGSTRING && !value) {
+					value = mkv_read_string (md->data, &sub);
+				}
+
+				sub_offset = sub.offset + sub.size;
+			}
+
+			if (name && value) {
+				mkv_set_tag (md, target, name, value);
+			}
+
+			g_free (name);
+			g_free (value);
+
+			tag_offset = child.offset + child.size;
+		}
+
+		offset = tag.offset + tag.size;
+	}
+
+	md->tags_done = TRUE;
+}
+
+static void
+mkv_parse_top_level (MkvData    *md,
+                     MkvElement *element)
+{
+	if (element->id == MKV_ID_INFO && !md->info_done) {
+		mkv_parse_info (md, element);
+	} else if (element->id == MKV_ID_TRACKS && !md->tracks_done) {
+		mkv_parse_tracks (md, element);
+	} else if (element->id == MKV_ID_TAGS && !md->tags_done) {
+		mkv_parse_tags (md, element);
+	}
+}
+
+static void
+mkv_parse_seek_head (MkvData    *md,
+                     MkvElement *seek_head,
+                     GArray     *positions)
+{
+	MkvElement seek, child;
+	gsize offset, seek_offset;
+
+	offset = seek_head->offset;
+
+	while (mkv_read_element (md->data, offset, seek_head->offset + seek_head->size, &seek)) {
+		guint64 id = 0, position = 0;
+		gboolean has_position = FALSE;
+
+		if (seek.id == MKV_ID_SEEK) {
+			seek_offset = seek.offset;
+
+			while (mkv_read_element (md->data, seek_offset, seek.offset + seek.size, &child)) {
+				if (child.id == MKV_ID_SEEKID) {
+					id = mkv_read_uint (md->data, &child);
+				} else if (child.id == MKV_ID_SEEKPOSITION) {
+					position = mkv_read_uint (md->data, &child);
+					has_position = TRUE;
+				}
+
+				seek_offset = child.offset + child.size;
+			}
+
+			if (has_position &&
+			    (id == MKV_ID_INFO || id == MKV_ID_TRACKS || id == MKV_ID_TAGS)) {
+				g_array_append_val (positions, position);
+			}
+		}
+
+		offset = seek.offset + seek.size;
+	}
+}
+
+static gboolean
+mkv_parse (MkvData *md)
+{
+	MkvElement header, element, window;
+	GArray *positions;
+	gchar *doctype = NULL;
+	goffset offset, end;
+	gsize pos;
+	guint i;
+
+	/* EBML header */
+	if (!mkv_read_file_element (md, 0, md->file_size, &header) ||
+	    header.id != EBML_ID_HEADER ||
+	    !mkv_map_element (md, &header, &window)) {
+		return FALSE;
+	}
+
+	pos = window.offset;
+
+	while (mkv_read_element (md->data, pos, window.offset + window.size, &element)) {
+		if (element.id == EBML_ID_DOCTYPE && !doctype) {
+			doctype = mkv_read_string (md->data, &element);
+		}
+
+		pos = element.offset + element.size;
+	}
+
+	if (g_strcmp0 (doctype, "matroska") != 0 &&
+	    g_strcmp0 (doctype, "webm") != 0) {
+		g_free (doctype);
+		return FALSE;
+	}
+
+	g_free (doctype);
+
+	/* Segment */
+	if (!mkv_read_file_element (md, header.offset + header.size, md->file_size, &element) ||
+	    element.id != MKV_ID_SEGMENT) {
+		return FALSE;
+	}
+
+	md->segment_start = element.offset;
+	offset = element.offset;
+	end = element.offset + element.size;
+	positions = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+	/* Everything up to the first cluster, the size of clusters
+	 * may be unknown when streamed, so stop there */
+	while (mkv_read_file_element (md, offset, end, &element) &&
+	       element.id != MKV_ID_CLUSTER) {
+		if (element.id == MKV_ID_SEEKHEAD) {
+			if (mkv_map_element (md, &element, &window)) {
+				mkv_parse_seek_head (md, &window, positions);
+			}
+		} else if ((element.id == MKV_ID_INFO && !md->info_done) ||
+		           (element.id == MKV_ID_TRACKS && !md->tracks_done) ||
+		           (element.id == MKV_ID_TAGS && !md->tags_done)) {
+			if (mkv_map_element (md, &element, &window)) {
+				mkv_parse_top_level (md, &window);
+			}
+		}
+
+		offset = element.offset + element.size;
+	}
+
+	/* And anything the seek head points to further on */
+	for (i = 0; i < positions->len; i++) {
+		guint64 position = g_array_index (positions, guint64, i);
+
+		if (position < (guint64) (end - md->segment_start) &&
+		    mkv_read_file_element (md, md->segment_start + position, end, &element) &&
+		    mkv_map_element (md, &element, &window)) {
+			mkv_parse_top_level (md, &window);
+		}
+	}
+
+	g_array_free (positions, TRUE);
+
+	return md->tracks_done;
+}
+
+G_MODULE_EXPORT gboolean
+tracker_extract_get_metadata (TrackerExtractInfo *info)
+{
+	TrackerFileReader *reader;
+	TrackerMediaTags tags;
+	MkvData md = { 0 };
+	gboolean retval;
+
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
+	if (tracker_file_reader_get_size (reader) < 16) {
+		tracker_file_reader_free (reader);
+		return FALSE;
+	}
+
+	tracker_media_tags_init (&tags);
+
+	md.reader = reader;
+	md.file_size = tracker_file_reader_get_size (reader);
+	md.tags = &tags;
+	md.timecode_scale = 1000000;
+
+	retval = mkv_parse (&md) && (tags.has_audio || tags.has_video);
+
+	tracker_file_reader_free (reader);
+
+	if (retval) {
+		if (md.duration > 0) {
+			tags.duration = (gint64) (md.duration * md.timecode_scale / 1000000000.0);
+		}
+
+		/* Album level titles are the movie title for videos */
+		if (tags.has_video) {
+			if (!tags.title) {
+				tags.title = md.album_title;
+				md.album_title = NULL;
+			}
+
+			if (!tags.artist) {
+				tags.artist = md.album_artist;
+				md.album_artist = NULL;
+			}
+		} else {
+			tags.album = md.album_title;
+			tags.album_artist = md.album_artist;
+			md.album_title = NULL;
+			md.album_artist = NULL;
+		}
+
+		tracker_media_tags_apply (&tags, info);
+	}
+
+	g_free (md.album_title);
+	g_free (md.album_artist);
+	tracker_media_tags_clear (&tags);
+
+	return retval;
+}
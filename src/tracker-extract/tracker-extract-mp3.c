@@ -506,49 +506,6 @@ guess_dlna_profile (gint          bitrate,
 	return FALSE;
 }
 
-static char *
-read_id3v1_buffer (int     fd,
-                   goffset size)
-{
-	char *buffer;
-	guint bytes_read;
-	guint rc;
-
-	if (size < 128) {
-		return NULL;
-	}
-
-	if (lseek (fd, size - ID3V1_SIZE, SEEK_SET) < 0) {
-		return NULL;
-	}
-
-	buffer = g_malloc (ID3V1_SIZE);
-
-	if (!buffer) {
-		return NULL;
-	}
-
-	bytes_read = 0;
-
-	while (bytes_read < ID3V1_SIZE) {
-		rc = read (fd,
-		           buffer + bytes_read,
-		           ID3V1_SIZE - bytes_read);
-		if (rc == -1) {
-			if (errno != EINTR) {
-				g_free (buffer);
-				return NULL;
-			}
-		} else if (rc == 0) {
-			break;
-		} else {
-			bytes_read += rc;
-		}
-	}
-
-	return buffer;
-}
-
 /* Convert from UCS-2 to UTF-8 checking the BOM.*/
 static gchar *
 ucs2_to_utf8(const gchar *data, guint len)
@@ -2078,12 +2035,12 @@ parse_id3v2 (const gchar          *data,
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
-	gchar *filename, *uri;
-	int fd;
-	void *buffer;
-	void *id3v1_buffer;
+	TrackerFileReader *reader;
+	gchar *uri;
+	const guchar *buffer;
+	gchar id3v1_buffer[ID3V1_SIZE];
 	goffset size;
-	goffset  buffer_size;
+	gsize buffer_size;
 	goffset audio_offset;
 	MP3Data md = { 0 };
 	TrackerSparqlBuilder *metadata, *preupdate;
@@ -2095,56 +2052,33 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	preupdate = tracker_extract_info_get_preupdate_builder (info);
 
 	file = tracker_extract_info_get_file (info);
-	filename = g_file_get_path (file);
 
-	size = tracker_file_get_size (filename);
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
 
-	if (size == 0) {
-		g_free (filename);
+	if (!reader) {
 		return FALSE;
 	}
 
+	size = tracker_file_reader_get_size (reader);
 	md.size = size;
-	buffer_size = MIN (size, MAX_FILE_READ);
-
-	fd = tracker_file_open_fd (filename);
-
-	if (fd == -1) {
-		return FALSE;
-	}
 
-#ifndef G_OS_WIN32
-	/* We don't use GLib's mmap because size can not be specified */
-	buffer = mmap (NULL,
-	               buffer_size,
-	               PROT_READ,
-	               MAP_PRIVATE,
-	               fd,
-	               0);
-#endif
-
-	id3v1_buffer = read_id3v1_buffer (fd, size);
-
-#ifdef HAVE_POSIX_FADVISE
-	posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
-#endif /* HAVE_POSIX_FADVISE */
-
-	close (fd);
+	buffer = tracker_file_reader_map_head (reader, MAX_FILE_READ, &buffer_size);
 
-	if (buffer == NULL || buffer == (void*) -1) {
-		g_free (filename);
+	if (!buffer) {
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
-	if (!get_id3 (id3v1_buffer, ID3V1_SIZE, &md.id3v1)) {
+	if (size < ID3V1_SIZE ||
+	    tracker_file_reader_read (reader, size - ID3V1_SIZE,
+	                              id3v1_buffer, ID3V1_SIZE) != ID3V1_SIZE ||
+	    !get_id3 (id3v1_buffer, ID3V1_SIZE, &md.id3v1)) {
 		/* Do nothing? */
 	}
 
-	g_free (id3v1_buffer);
-
 	/* Get other embedded tags */
 	uri = g_file_get_uri (file);
-	audio_offset = parse_id3v2 (buffer, buffer_size, &md.id3v1, uri, metadata, &md);
+	audio_offset = parse_id3v2 ((const gchar *) buffer, buffer_size, &md.id3v1, uri, metadata, &md);
 
 	md.title = tracker_coalesce_strip (4, md.id3v24.title2,
 	                                   md.id3v23.title2,
@@ -2487,7 +2421,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	g_free (md.album_uri);
 
 	/* Get mp3 stream info */
-	mp3_parse (buffer, buffer_size, audio_offset, uri, metadata, &md);
+	mp3_parse ((const gchar *) buffer, buffer_size, audio_offset, uri, metadata, &md);
 
 #ifdef HAVE_LIBMEDIAART
 	media_art_process (md.media_art_data,
@@ -2506,11 +2440,8 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	id3v2tag_free (&md.id3v24);
 	id3tag_free (&md.id3v1);
 
-#ifndef G_OS_WIN32
-	munmap (buffer, buffer_size);
-#endif
+	tracker_file_reader_free (reader);
 
-	g_free (filename);
 	g_free (uri);
 
 	return TRUE;
@@ -0,0 +1,495 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <libtracker-common/tracker-common.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+#include "tracker-media-tags.h"
+
+/* Parses the ISO base media file format (MP4, M4A, M4V, 3GP) box
+ * structure directly. Only the "moov" box and its children are read,
+ * media data is skipped over without touching it.
+ */
+
+#define BOX_TYPE(a,b,c,d) (((guint32) (a) << 24) | ((b) << 16) | ((c) << 8) | (d))
+
+#define MAX_BOX_DEPTH 8
+
+typedef struct {
+	TrackerMediaTags *tags;
+
+	/* Current track */
+	guint32 handler;
+	guint32 timescale;
+	guint64 media_duration;
+	guint64 n_samples;
+} Mp4Data;
+
+static guint16
+read_uint16 (const guchar *data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+static guint32
+read_uint32 (const guchar *data)
+{
+	return ((guint32) data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+static guint64
+read_uint64 (const guchar *data)
+{
+	return ((guint64) read_uint32 (data) << 32) | read_uint32 (data + 4);
+}
+
+static void mp4_parse_boxes (Mp4Data      *md,
+                             const guchar *data,
+                             gsize         len,
+                             gint          depth);
+
+static void
+mp4_parse_mvhd (Mp4Data      *md,
+                const guchar *data,
+                gsize         len)
+{
+	guint32 timescale;
+	guint64 duration;
+
+	if (len >= 32 && data[0] == 1) {
+		timescale = read_uint32 (data + 20);
+		duration = read_uint64 (data + 24);
+	} else if (len >= 20) {
+		timescale = read_uint32 (data + 12);
+		duration = read_uint32 (data + 16);
+	} else {
+		return;
+	}
+
+	if (timescale > 0) {
+		md->tags->duration = duration / timescale;
+	}
+}
+
+static void
+mp4_parse_mdhd (Mp4Data      *md,
+                const guchar *data,
+                gsize         len)
+{
+	if (len >= 32 && data[0] == 1) {
+		md->timescale = read_uint32 (data + 20);
+		md->media_duration = read_uint64 (data + 24);
+	} else if (len >= 20) {
+		md->timescale = read_uint32 (data + 12);
+		md->media_duration = read_uint32 (data + 16);
+	}
+}
+
+static void
+mp4_parse_stsd (Mp4Data      *md,
+                const guchar *data,
+                gsize         len)
+{
+	TrackerMediaTags *tags = md->tags;
+	const guchar *entry;
+	gchar format[5];
+
+	/* Full box header and entry count, then the first sample
+	 * entry: size, format, 6 reserved bytes, data reference index */
+	if (len < 24) {
+		return;
+	}
+
+	entry = data + 8;
+	memcpy (format, entry + 4, 4);
+	format[4] = '\0';
+
+	if (md->handler == BOX_TYPE ('v','i','d','e') && len >= 8 + 36) {
+		tags->has_video = TRUE;
+
+		if (tags->width < 0) {
+			tags->width = read_uint16 (entry + 32);
+			tags->height = read_uint16 (entry + 34);
+		}
+
+		if (!tags->video_codec) {
+			tags->video_codec = g_strdup (format);
+		}
+	} else if (md->handler == BOX_TYPE ('s','o','u','n') && len >= 8 + 36) {
+		tags->has_audio = TRUE;
+
+		if (tags->channels < 0) {
+			tags->channels = read_uint16 (entry + 24);
+			/* 16.16 fixed point */
+			tags->sample_rate = read_uint32 (entry + 32) >> 16;
+		}
+
+		if (!tags->audio_codec) {
+			tags->audio_codec = g_strdup (format);
+		}
+	}
+}
+
+static void
+mp4_parse_stts (Mp4Data      *md,
+                const guchar *data,
+                gsize         len)
+{
+	guint32 n_entries, i;
+
+	if (len < 8) {
+		return;
+	}
+
+	n_entries = read_uint32 (data + 4);
+
+	for (i = 0; i < n_entries && 8 + (i + 1) * 8 <= len; i++) {
+		md->n_samples += read_uint32 (data + 8 + i * 8);
+	}
+}
+
+static void
+mp4_parse_trak (Mp4Data      *md,
+                const guchar *data,
+                gsize         len,
+                gint          depth)
+{
+	md->handler = 0;
+	md->timescale = 0;
+	md->media_duration = 0;
+	md->n_samples = 0;
+
+	mp4_parse_boxes (md, data, len, depth);
+
+	if (md->handler == BOX_TYPE ('v','i','d','e') &&
+	    md->tags->frame_rate < 0 &&
+	    md->media_duration > 0 && md->n_samples > 0) {
+		md->tags->frame_rate = (gdouble) md->n_samples * md->timescale / md->media_duration;
+	}
+}
+
+static void
+mp4_parse_number_item (gchar        **number,
+                       gchar        **total,
+                       const guchar  *value,
+                       gsize          len)
+{
+	/* 2 reserved bytes, number, total */
+	if (len < 6) {
+		return;
+	}
+
+	if (!*number && read_uint16 (value + 2) > 0) {
+		*number = g_strdup_printf ("%d", read_uint16 (value + 2));
+	}
+
+	if (total && !*total && read_uint16 (value + 4) > 0) {
+		*total = g_strdup_printf ("%d", read_uint16 (value + 4));
+	}
+}
+
+static void
+mp4_parse_ilst_item (Mp4Data      *md,
+                     guint32       type,
+                     const guchar *data,
+                     gsize         len)
+{
+	TrackerMediaTags *tags = md->tags;
+	const guchar *value;
+	guint32 data_size, data_type;
+	gsize value_len;
+	gchar **tag = NULL;
+	gchar *str;
+
+	/* Each item holds a "data" box: size, type, well-known
+	 * value type, locale and the value itself */
+	if (len < 16 || read_uint32 (data + 4) != BOX_TYPE ('d','a','t','a')) {
+		return;
+	}
+
+	data_size = read_uint32 (data);
+
+	if (data_size < 16 || data_size > len) {
+		return;
+	}
+
+	data_type = read_uint32 (data + 8) & 0xffffff;
+	value = data + 16;
+	value_len = data_size - 16;
+
+	switch (type) {
+	case BOX_TYPE (0xa9,'n','a','m'):
+		tag = &tags->title;
+		break;
+	case BOX_TYPE (0xa9,'A','R','T'):
+		tag = &tags->artist;
+		break;
+	case BOX_TYPE ('a','A','R','T'):
+		tag = &tags->album_artist;
+		break;
+	case BOX_TYPE (0xa9,'a','l','b'):
+		tag = &tags->album;
+		break;
+	case BOX_TYPE (0xa9,'g','e','n'):
+		tag = &tags->genre;
+		break;
+	case BOX_TYPE (0xa9,'c','m','t'):
+		tag = &tags->comment;
+		break;
+	case BOX_TYPE ('c','p','r','t'):
+		tag = &tags->copyright;
+		break;
+	case BOX_TYPE (0xa9,'d','a','y'):
+		if (!tags->date && value_len > 0) {
+			str = g_strndup ((const gchar *) value, value_len);
+			tags->date = tracker_date_guess (str);
+			g_free (str);
+		}
+		break;
+	case BOX_TYPE ('t','r','k','n'):
+		mp4_parse_number_item (&tags->track_number, &tags->track_count, value, value_len);
+		break;
+	case BOX_TYPE ('d','i','s','k'):
+		mp4_parse_number_item (&tags->disc_number, NULL, value, value_len);
+		break;
+	case BOX_TYPE ('c','o','v','r'):
+		/* 13 is JPEG, 14 is PNG */
+		if (!tags->cover_data && value_len > 0 &&
+		    (data_type == 13 || data_type == 14)) {
+			tags->cover_data = g_memdup (value, value_len);
+			tags->cover_size = value_len;
+			tags->cover_mime = g_strdup (data_type == 13 ? "image/jpeg" : "image/png");
+		}
+		break;
+	default:
+		break;
+	}
+
+	/* Text values are UTF-8 */
+	if (tag && !*tag && data_type == 1 && value_len > 0) {
+		*tag = g_strndup ((const gchar *) value, value_len);
+	}
+}
+
+static void
+mp4_parse_boxes (Mp4Data      *md,
+                 const guchar *data,
+                 gsize         len,
+                 gint          depth)
+{
+	gsize offset = 0;
+
+	if (depth > MAX_BOX_DEPTH) {
+		return;
+	}
+
+	while (len - offset >= 8) {
+		const guchar *payload;
+		guint64 box_size;
+		gsize header_size = 8;
+		guint32 type;
+
+		box_size = read_uint32 (data + offset);
+		type = read_uint32 (data + offset + 4);
+
+		if (box_size == 1) {
+			if (len - offset < 16) {
+				break;
+			}
+
+			box_size = read_uint64 (data + offset + 8);
+			header_size = 16;
+		} else if (box_size == 0) {
+			/* Box extends to the end of its parent */
+			box_size = len - offset;
+		}
+
+		if (box_size < header_size || box_size > len - offset) {
+			break;
+		}
+
+		payload = data + offset + header_size;
+
+		switch (type) {
+		case BOX_TYPE ('m','o','o','v'):
+		case BOX_TYPE ('m','d','i','a'):
+		case BOX_TYPE ('m','i','n','f'):
+		case BOX_TYPE ('s','t','b','l'):
+		case BOX_TYPE ('u','d','t','a'):
+			mp4_parse_boxes (md, payload, box_size - header_size, depth + 1);
+			break;
+		case BOX_TYPE ('t','r','a','k'):
+			mp4_parse_trak (md, payload, box_size - header_size, depth + 1);
+			break;
+		case BOX_TYPE ('m','e','t','a'):
+			/* Usually a full box, but not always in QuickTime files */
+			if (box_size - header_size >= 8 &&
+			    read_uint32 (payload + 4) == BOX_TYPE ('h','d','l','r')) {
+				mp4_parse_boxes (md, payload, box_size - header_size, depth + 1);
+			} else if (box_size - header_size >= 4) {
+				mp4_parse_boxes (md, payload + 4, box_size - header_size - 4, depth + 1);
+			}
+			break;
+		case BOX_TYPE ('i','l','s','t'): {
+			const guchar *item = payload;
+			gsize item_len = box_size - header_size;
+
+			while (item_len >= 8) {
+				guint32 item_size = read_uint32 (item);
+
+				if (item_size < 8 || item_size > item_len) {
+					break;
+				}
+
+				mp4_parse_ilst_item (md, read_uint32 (item + 4), item + 8, item_size - 8);
+
+				item += item_size;
+				item_len -= item_size;
+			}
+			break;
+		}
+		case BOX_TYPE ('m','v','h','d'):
+			mp4_parse_mvhd (md, payload, box_size - header_size);
+			break;
+		case BOX_TYPE ('m','d','h','d'):
+			mp4_parse_mdhd (md, payload, box_size - header_size);
+			break;
+		case BOX_TYPE ('h','d','l','r'):
+			/* Only track handlers matter, "meta" boxes have
+			 * their own "mdir" handler */
+			if (box_size - header_size >= 12 && md->handler == 0) {
+				md->handler = read_uint32 (payload + 8);
+			}
+			break;
+		case BOX_TYPE ('s','t','s','d'):
+			mp4_parse_stsd (md, payload, box_size - header_size);
+			break;
+		case BOX_TYPE ('s','t','t','s'):
+			mp4_parse_stts (md, payload, box_size - header_size);
+			break;
+		default:
+			break;
+		}
+
+		offset += box_size;
+	}
+}
+
+/* Walks the top level boxes reading only their headers, and maps the
+ * "moov" box. It is usually either at the start or at the very end of
+ * the file, after the media data.
+ */
+static const guchar *
+mp4_map_moov (TrackerFileReader *reader,
+              gsize             *len)
+{
+	goffset offset = 0, size;
+	guchar header[16];
+
+	size = tracker_file_reader_get_size (reader);
+
+	while (size - offset >= 8) {
+		guint64 box_size;
+		guint32 type;
+
+		if (tracker_file_reader_read (reader, offset, header, 16) < 8) {
+			break;
+		}
+
+		box_size = read_uint32 (header);
+		type = read_uint32 (header + 4);
+
+		if (box_size == 1) {
+			if (size - offset < 16) {
+				break;
+			}
+
+			box_size = read_uint64 (header + 8);
+		} else if (box_size == 0) {
+			box_size = size - offset;
+		}
+
+		if (box_size < 8 || box_size > (guint64) (size - offset)) {
+			break;
+		}
+
+		if (type == BOX_TYPE ('m','o','o','v')) {
+			return tracker_file_reader_map (reader, offset, box_size, len);
+		}
+
+		offset += box_size;
+	}
+
+	return NULL;
+}
+
+G_MODULE_EXPORT gboolean
+tracker_extract_get_metadata (TrackerExtractInfo *info)
+{
+	TrackerFileReader *reader;
+	TrackerMediaTags tags;
+	Mp4Data md = { 0 };
+	const guchar *moov;
+	guchar header[8];
+	gsize len;
+
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
+	if (tracker_file_reader_read (reader, 0, header, 8) != 8 ||
+	    read_uint32 (header + 4) != BOX_TYPE ('f','t','y','p')) {
+		tracker_file_reader_free (reader);
+		return FALSE;
+	}
+
+	moov = mp4_map_moov (reader, &len);
+
+	if (!moov) {
+		tracker_file_reader_free (reader);
+		return FALSE;
+	}
+
+	tracker_media_tags_init (&tags);
+	md.tags = &tags;
+
+	mp4_parse_boxes (&md, moov, len, 0);
+
+	tracker_file_reader_free (reader);
+
+	if (!tags.has_audio && !tags.has_video) {
+		/* Leave anything unusual to the generic extractor */
+		tracker_media_tags_clear (&tags);
+		return FALSE;
+	}
+
+	tracker_media_tags_apply (&tags, info);
+	tracker_media_tags_clear (&tags);
+
+	return TRUE;
+}
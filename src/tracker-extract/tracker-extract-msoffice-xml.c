@@ -73,6 +73,7 @@ typedef enum {
 typedef struct {
 	/* Common constant stuff */
 	const gchar *uri;
+	TrackerFileReader *reader;
 	MsOfficeXMLFileType file_type;
 
 	/* Tag type, reused by Content and Metadata parsers */
@@ -570,7 +571,7 @@ xml_read (MsOfficeXMLParserInfo *parser_info,
 
 		/* Load the internal XML file from the Zip archive, and parse it
 		 * using the given context */
-		tracker_gsf_parse_xml_in_zip (parser_info->uri,
+		tracker_gsf_parse_xml_in_zip (parser_info->reader,
 		                              xml_filename,
 		                              context,
 		                              &error);
@@ -758,6 +759,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 	MsOfficeXMLParserInfo info = { 0 };
 	MsOfficeXMLFileType file_type;
 	TrackerSparqlBuilder *metadata;
+	TrackerFileReader *reader;
 	TrackerConfig *config;
 	GMarkupParseContext *context = NULL;
 	GError *error = NULL;
@@ -768,6 +770,14 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 		maximum_size_error_quark = g_quark_from_static_string ("maximum_size_error");
 	}
 
+	/* Zip members are read at the offsets the central directory
+	 * at the end of the archive points to */
+	reader = tracker_file_reader_new (extract_info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
 	metadata = tracker_extract_info_get_metadata_builder (extract_info);
 	file = tracker_extract_info_get_file (extract_info);
 	uri = g_file_get_uri (file);
@@ -790,6 +800,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 	info.style_element_present = FALSE;
 	info.preserve_attribute_present = FALSE;
 	info.uri = uri;
+	info.reader = reader;
 	info.content = NULL;
 	info.title_already_set = FALSE;
 	info.generator_already_set = FALSE;
@@ -804,7 +815,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 	info.timer = g_timer_new ();
 	/* Load the internal XML file from the Zip archive, and parse it
 	 * using the given context */
-	tracker_gsf_parse_xml_in_zip (uri,
+	tracker_gsf_parse_xml_in_zip (reader,
 	                              "[Content_Types].xml",
 	                              context,
 	                              &error);
@@ -837,6 +848,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 
 	g_timer_destroy (info.timer);
 	g_markup_parse_context_free (context);
+	tracker_file_reader_free (reader);
 	g_free (uri);
 
 	return TRUE;
@@ -30,7 +30,6 @@
 #include <gsf/gsf-doc-meta-data.h>
 #include <gsf/gsf-infile.h>
 #include <gsf/gsf-infile-msole.h>
-#include <gsf/gsf-input-stdio.h>
 #include <gsf/gsf-msole-utils.h>
 #include <gsf/gsf-utils.h>
 #include <gsf/gsf-infile-zip.h>
@@ -748,18 +747,13 @@ extract_powerpoint_content (GsfInfile *infile,
 }
 
 static GsfInfile *
-open_file (const gchar *filename, FILE *file)
+open_file (TrackerFileReader *reader)
 {
 	GsfInput *input;
 	GsfInfile *infile;
 	GError *error = NULL;
 
-	input = gsf_input_stdio_new_FILE (filename, file, TRUE);
-	
-	if (!input) {
-		return NULL;
-	}
-
+	input = tracker_gsf_input_new (reader);
 	infile = gsf_infile_msole_new (input, &error);
 
 	if (error) {
@@ -1635,15 +1629,15 @@ G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
 	TrackerSparqlBuilder *metadata;
+	TrackerFileReader *reader;
 	TrackerConfig *config;
 	GsfInfile *infile = NULL;
 	gchar *content = NULL, *uri;
 	gboolean is_encrypted = FALSE;
 	const gchar *mime_used;
 	gsize max_bytes;
+	GError *error = NULL;
 	GFile *file;
-	gchar *filename;
-	FILE *mfile;
 
 	gsf_init ();
 
@@ -1653,25 +1647,23 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	file = tracker_extract_info_get_file (info);
 	uri = g_file_get_uri (file);
 
-	filename = g_filename_from_uri (uri, NULL, NULL);
-
-	mfile = tracker_file_open (filename);
-	g_free (filename);
+	/* OLE streams are chains of sectors spread over the file */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, &error);
 
-	if (!mfile) {
+	if (!reader) {
 		g_warning ("Can't open file from uri '%s': %s",
-		           uri, g_strerror (errno));
+		           uri, error->message);
+		g_error_free (error);
+		gsf_shutdown ();
 		g_free (uri);
 		return FALSE;
 	}
 
-	infile = open_file (uri, mfile);
+	infile = open_file (reader);
 	if (!infile) {
+		tracker_file_reader_free (reader);
 		gsf_shutdown ();
 		g_free (uri);
-		if (mfile) {
-			tracker_file_close (mfile, FALSE);
-		}
 		return FALSE;
 	}
 
@@ -1713,11 +1705,9 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	}
 
 	g_object_unref (infile);
+	tracker_file_reader_free (reader);
 	g_free (uri);
 	gsf_shutdown ();
-	if (mfile) {
-		tracker_file_close (mfile, FALSE);
-	}
 
 	return TRUE;
 }
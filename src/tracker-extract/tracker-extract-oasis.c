@@ -98,13 +98,13 @@ static void xml_text_handler_content           (GMarkupParseContext   *context,
                                                 gsize                  text_len,
                                                 gpointer               user_data,
                                                 GError               **error);
-static void extract_oasis_content              (const gchar           *uri,
+static void extract_oasis_content              (TrackerFileReader     *reader,
                                                 gulong                 total_bytes,
                                                 ODTFileType            file_type,
                                                 TrackerSparqlBuilder  *metadata);
 
 static void
-extract_oasis_content (const gchar          *uri,
+extract_oasis_content (TrackerFileReader    *reader,
                        gulong                total_bytes,
                        ODTFileType           file_type,
                        TrackerSparqlBuilder *metadata)
@@ -137,7 +137,7 @@ extract_oasis_content (const gchar          *uri,
 
 	/* Load the internal XML file from the Zip archive, and parse it
 	 * using the given context */
-	tracker_gsf_parse_xml_in_zip (uri, "content.xml", context, &error);
+	tracker_gsf_parse_xml_in_zip (reader, "content.xml", context, &error);
 
 	if (!error || g_error_matches (error, maximum_size_error_quark, 0)) {
 		content = g_string_free (info.content, FALSE);
@@ -160,6 +160,7 @@ G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 {
 	TrackerSparqlBuilder *metadata;
+	TrackerFileReader *reader;
 	TrackerConfig *config;
 	ODTMetadataParseInfo info;
 	ODTFileType file_type;
@@ -183,6 +184,14 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 	mime_used = tracker_extract_info_get_mimetype (extract_info);
 
 	file = tracker_extract_info_get_file (extract_info);
+	/* Zip members are read at the offsets the central directory
+	 * at the end of the archive points to */
+	reader = tracker_file_reader_new (extract_info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
 	uri = g_file_get_uri (file);
 
 	/* Setup conf */
@@ -206,7 +215,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 
 	/* Load the internal XML file from the Zip archive, and parse it
 	 * using the given context */
-	tracker_gsf_parse_xml_in_zip (uri, "meta.xml", context, NULL);
+	tracker_gsf_parse_xml_in_zip (reader, "meta.xml", context, NULL);
 	g_markup_parse_context_free (context);
 
 	if (g_ascii_strcasecmp (mime_used, "application/vnd.oasis.opendocument.text") == 0) {
@@ -223,11 +232,12 @@ tracker_extract_get_metadata (TrackerExtractInfo *extract_info)
 	}
 
 	/* Extract content with the given limitations */
-	extract_oasis_content (uri,
+	extract_oasis_content (reader,
 	                       tracker_config_get_max_bytes (config),
 	                       file_type,
 	                       metadata);
 
+	tracker_file_reader_free (reader);
 	g_free (uri);
 
 	return TRUE;
@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <libtracker-common/tracker-common.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+#include "tracker-media-tags.h"
+
+/* Parses the identification and comment headers of Vorbis, Opus, FLAC
+ * and Theora streams in Ogg files, the duration comes from the
+ * granule position of the last page.
+ */
+
+#define OGG_PAGE_HEADER_SIZE  27
+#define OGG_MAX_STREAMS       4
+
+/* Headers are expected within this many bytes from the start */
+#define OGG_MAX_HEADER_READ   (16 * 1024 * 1024)
+/* Longer comment packets (mostly embedded cover art) are truncated */
+#define OGG_MAX_PACKET_SIZE   (1024 * 1024)
+/* The last page is looked for this far from the end */
+#define OGG_MAX_TAIL_READ     (64 * 1024)
+
+typedef enum {
+	OGG_CODEC_UNKNOWN,
+	OGG_CODEC_VORBIS,
+	OGG_CODEC_OPUS,
+	OGG_CODEC_FLAC,
+	OGG_CODEC_THEORA
+} OggCodec;
+
+typedef struct {
+	guint32 serial;
+	OggCodec codec;
+	guint n_packets;
+	GByteArray *packet;
+
+	/* Granule position to seconds */
+	guint64 rate;
+	guint64 pre_skip;
+	guint64 frame_rate_n;
+	guint64 frame_rate_d;
+	guint keyframe_shift;
+} OggStream;
+
+typedef struct {
+	TrackerMediaTags *tags;
+	OggStream streams[OGG_MAX_STREAMS];
+	guint n_streams;
+} OggData;
+
+static guint32
+read_uint32_le (const guchar *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((guint32) data[3] << 24);
+}
+
+static guint64
+read_uint64_le (const guchar *data)
+{
+	return read_uint32_le (data) | ((guint64) read_uint32_le (data + 4) << 32);
+}
+
+static guint32
+read_uint_be (const guchar *data,
+              gint          n_bytes)
+{
+	guint32 value = 0;
+	gint i;
+
+	for (i = 0; i < n_bytes; i++) {
+		value = (value << 8) | data[i];
+	}
+
+	return value;
+}
+
+static void
+ogg_parse_ident (OggData      *od,
+                 OggStream    *stream,
+                 const guchar *data,
+                 gsize         len)
+{
+	TrackerMediaTags *tags = od->tags;
+
+	if (len >= 30 && memcmp (data, "\001vorbis", 7) == 0) {
+		stream->codec = OGG_CODEC_VORBIS;
+		stream->rate = read_uint32_le (data + 12);
+
+		if (!tags->has_audio) {
+			tags->has_audio = TRUE;
+			tags->audio_codec = g_strdup ("Vorbis");
+			tags->channels = data[11];
+			tags->sample_rate = stream->rate;
+
+			if ((gint32) read_uint32_le (data + 20) > 0) {
+				tags->bitrate = read_uint32_le (data + 20) / 1000;
+			}
+		}
+	} else if (len >= 19 && memcmp (data, "OpusHead", 8) == 0) {
+		stream->codec = OGG_CODEC_OPUS;
+		/* Granule positions are always at 48kHz */
+		stream->rate = 48000;
+		stream->pre_skip = data[10] | (data[11] << 8);
+
+		if (!tags->has_audio) {
+			tags->has_audio = TRUE;
+			tags->audio_codec = g_strdup ("Opus");
+			tags->channels = data[9];
+			tags->sample_rate = read_uint32_le (data + 12);
+		}
+	} else if (len >= 30 && memcmp (data, "\177FLAC", 5) == 0 &&
+	           memcmp (data + 9, "fLaC", 4) == 0) {
+		/* Mapping header, then the STREAMINFO metadata block */
+		const guchar *info = data + 17;
+
+		stream->codec = OGG_CODEC_FLAC;
+		stream->rate = (info[10] << 12) | (info[11] << 4) | (info[12] >> 4);
+
+		if (!tags->has_audio) {
+			tags->has_audio = TRUE;
+			tags->audio_codec = g_strdup ("FLAC");
+			tags->channels = ((info[12] >> 1) & 0x07) + 1;
+			tags->sample_rate = stream->rate;
+		}
+	} else if (len >= 42 && memcmp (data, "\200theora", 7) == 0) {
+		stream->codec = OGG_CODEC_THEORA;
+		stream->frame_rate_n = read_uint_be (data + 22, 4);
+		stream->frame_rate_d = read_uint_be (data + 26, 4);
+		stream->keyframe_shift = ((data[40] & 0x03) << 3) | (data[41] >> 5);
+
+		if (!tags->has_video) {
+			tags->has_video = TRUE;
+			tags->video_codec = g_strdup ("Theora");
+			tags->width = read_uint_be (data + 14, 3);
+			tags->height = read_uint_be (data + 17, 3);
+
+			if (stream->frame_rate_d > 0) {
+				tags->frame_rate = (gdouble) stream->frame_rate_n / stream->frame_rate_d;
+			}
+		}
+	}
+}
+
+static void
+ogg_parse_comments (OggData      *od,
+                    OggStream    *stream,
+                    const guchar *data,
+                    gsize         len)
+{
+	gsize prefix = 0;
+
+	switch (stream->codec) {
+	case OGG_CODEC_VORBIS:
+		if (len >= 7 && memcmp (data, "\003vorbis", 7) == 0) {
+			prefix = 7;
+		}
+		break;
+	case OGG_CODEC_OPUS:
+		if (len >= 8 && memcmp (data, "OpusTags", 8) == 0) {
+			prefix = 8;
+		}
+		break;
+	case OGG_CODEC_FLAC:
+		/* Metadata block header, type 4 is VORBIS_COMMENT */
+		if (len >= 4 && (data[0] & 0x7f) == 4) {
+			prefix = 4;
+		}
+		break;
+	case OGG_CODEC_THEORA:
+		if (len >= 7 && memcmp (data, "\201theora", 7) == 0) {
+			prefix = 7;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (prefix > 0) {
+		tracker_media_tags_parse_vorbis_comments (od->tags, data + prefix, len - prefix);
+	}
+}
+
+static OggStream *
+ogg_get_stream (OggData *od,
+                guint32  serial,
+                gboolean bos)
+{
+	OggStream *stream;
+	guint i;
+
+	for (i = 0; i < od->n_streams; i++) {
+		if (od->streams[i].serial == serial) {
+			return &od->streams[i];
+		}
+	}
+
+	if (!bos || od->n_streams == OGG_MAX_STREAMS) {
+		return NULL;
+	}
+
+	stream = &od->streams[od->n_streams++];
+	stream->serial = serial;
+	stream->packet = g_byte_array_new ();
+
+	return stream;
+}
+
+static gboolean
+ogg_headers_done (OggData *od)
+{
+	guint i;
+
+	for (i = 0; i < od->n_streams; i++) {
+		/* Streams we know nothing about never complete */
+		if (od->streams[i].codec != OGG_CODEC_UNKNOWN &&
+		    od->streams[i].n_packets < 2) {
+			return FALSE;
+		}
+	}
+
+	return od->n_streams > 0;
+}
+
+static void
+ogg_packet_done (OggData   *od,
+                 OggStream *stream)
+{
+	if (stream->n_packets == 0) {
+		ogg_parse_ident (od, stream, stream->packet->data, stream->packet->len);
+	} else if (stream->n_packets == 1) {
+		ogg_parse_comments (od, stream, stream->packet->data, stream->packet->len);
+	}
+
+	stream->n_packets++;
+	g_byte_array_set_size (stream->packet, 0);
+}
+
+static gboolean
+ogg_parse_headers (OggData      *od,
+                   const guchar *data,
+                   gsize         len)
+{
+	gsize offset = 0;
+
+	while (len - offset >= OGG_PAGE_HEADER_SIZE &&
+	       memcmp (data + offset, "OggS", 4) == 0) {
+		const guchar *segments, *body;
+		OggStream *stream;
+		gsize body_len = 0;
+		guint n_segments, i;
+
+		n_segments = data[offset + 26];
+
+		if (len - offset < OGG_PAGE_HEADER_SIZE + n_segments) {
+			break;
+		}
+
+		segments = data + offset + OGG_PAGE_HEADER_SIZE;
+
+		for (i = 0; i < n_segments; i++) {
+			body_len += segments[i];
+		}
+
+		body = segments + n_segments;
+
+		if (len - (body - data) < body_len) {
+			break;
+		}
+
+		stream = ogg_get_stream (od,
+		                         read_uint32_le (data + offset + 14),
+		                         (data[offset + 5] & 0x02) != 0);
+
+		if (stream && stream->n_packets < 2) {
+			for (i = 0; i < n_segments; i++) {
+				if (stream->packet->len + segments[i] <= OGG_MAX_PACKET_SIZE) {
+					g_byte_array_append (stream->packet, body, segments[i]);
+				}
+
+				body += segments[i];
+
+				/* Segments shorter than 255 bytes end a packet */
+				if (segments[i] < 255) {
+					ogg_packet_done (od, stream);
+
+					if (stream->n_packets == 2) {
+						break;
+					}
+				}
+			}
+		}
+
+		if (ogg_headers_done (od)) {
+			return TRUE;
+		}
+
+		offset += OGG_PAGE_HEADER_SIZE + n_segments + body_len;
+	}
+
+	return ogg_headers_done (od);
+}
+
+static gint64
+ogg_stream_duration (OggStream *stream,
+                     guint64    granule)
+{
+	guint64 frames;
+
+	switch (stream->codec) {
+	case OGG_CODEC_VORBIS:
+	case OGG_CODEC_OPUS:
+	case OGG_CODEC_FLAC:
+		if (stream->rate == 0 || granule < stream->pre_skip) {
+			return -1;
+		}
+
+		return (granule - stream->pre_skip) / stream->rate;
+	case OGG_CODEC_THEORA:
+		if (stream->frame_rate_n == 0) {
+			return -1;
+		}
+
+		/* Frame of the last keyframe, and frames since */
+		frames = (granule >> stream->keyframe_shift) +
+		         (granule & ((G_GUINT64_CONSTANT (1) << stream->keyframe_shift) - 1));
+
+		return frames * stream->frame_rate_d / stream->frame_rate_n;
+	default:
+		return -1;
+	}
+}
+
+static void
+ogg_parse_duration (OggData      *od,
+                    const guchar *data,
+                    gsize         len)
+{
+	OggStream *stream = NULL;
+	guint64 granule = G_MAXUINT64;
+	gsize offset;
+	guint i;
+
+	/* Audio streams give the most accurate duration */
+	for (i = 0; i < od->n_streams; i++) {
+		if (od->streams[i].codec == OGG_CODEC_THEORA) {
+			stream = stream ? stream : &od->streams[i];
+		} else if (od->streams[i].codec != OGG_CODEC_UNKNOWN) {
+			stream = &od->streams[i];
+			break;
+		}
+	}
+
+	if (!stream) {
+		return;
+	}
+
+	for (offset = 0; offset + OGG_PAGE_HEADER_SIZE <= len; offset++) {
+		guint64 page_granule;
+
+		if (data[offset] != 'O' || memcmp (data + offset, "OggS", 4) != 0) {
+			continue;
+		}
+
+		if (read_uint32_le (data + offset + 14) != stream->serial) {
+			continue;
+		}
+
+		page_granule = read_uint64_le (data + offset + 6);
+
+		/* -1 means no packet ends on the page */
+		if (page_granule != G_MAXUINT64) {
+			granule = page_granule;
+		}
+	}
+
+	if (granule != G_MAXUINT64) {
+		od->tags->duration = ogg_stream_duration (stream, granule);
+	}
+}
+
+G_MODULE_EXPORT gboolean
+tracker_extract_get_metadata (TrackerExtractInfo *info)
+{
+	TrackerFileReader *reader;
+	TrackerMediaTags tags;
+	OggData od = { 0 };
+	const guchar *head, *tail;
+	gsize head_len, tail_len;
+	gboolean retval;
+	guint i;
+
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
+
+	if (!reader) {
+		return FALSE;
+	}
+
+	/* Only the first and last pages are touched */
+	head = tracker_file_reader_map_head (reader, OGG_MAX_HEADER_READ, &head_len);
+
+	if (!head || head_len < OGG_PAGE_HEADER_SIZE) {
+		tracker_file_reader_free (reader);
+		return FALSE;
+	}
+
+	tracker_media_tags_init (&tags);
+	od.tags = &tags;
+
+	retval = ogg_parse_headers (&od, head, head_len) &&
+	         (tags.has_audio || tags.has_video);
+
+	if (retval) {
+		tail = tracker_file_reader_map_tail (reader, OGG_MAX_TAIL_READ, &tail_len);
+
+		if (tail) {
+			ogg_parse_duration (&od, tail, tail_len);
+		}
+	}
+
+	tracker_file_reader_free (reader);
+
+	for (i = 0; i < od.n_streams; i++) {
+		g_byte_array_unref (od.streams[i].packet);
+	}
+
+	if (retval) {
+		tracker_media_tags_apply (&tags, info);
+	}
+
+	tracker_media_tags_clear (&tags);
+
+	return retval;
+}
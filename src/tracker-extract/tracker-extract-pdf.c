@@ -25,7 +25,6 @@
 #define _GNU_SOURCE
 #endif
 
-#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/select.h>
@@ -55,6 +54,9 @@
 /* Time in seconds before we stop processing content */
 #define EXTRACTION_PROCESS_TIMEOUT 10
 
+/* Pages taken at a time by each content extraction thread */
+#define EXTRACTION_PAGES_PER_CHUNK 4
+
 typedef struct {
 	gchar *title;
 	gchar *subject;
@@ -197,32 +199,197 @@ read_outline (PopplerDocument      *document,
 	}
 }
 
+typedef struct {
+	gchar *contents;
+	gsize len;
+	gint n_pages;
+	gsize n_bytes;
+	GTimer *timer;
+
+	/* One slot per page, only written by the thread that
+	 * extracted the page */
+	gchar **page_texts;
+	gboolean *pages_done;
+
+	GMutex mutex;
+	gint next_page;
+	gsize extracted_bytes;
+} ContentData;
+
+static gboolean
+content_claim_pages (ContentData *data,
+                     gint        *first,
+                     gint        *last)
+{
+	gboolean claimed = FALSE;
+
+	g_mutex_lock (&data->mutex);
+
+	/* Pages are claimed in order, so once enough text has been
+	 * extracted it is all in the pages claimed so far */
+	if (data->next_page < data->n_pages &&
+	    data->extracted_bytes < data->n_bytes &&
+	    g_timer_elapsed (data->timer, NULL) < EXTRACTION_PROCESS_TIMEOUT) {
+		*first = data->next_page;
+		*last = MIN (*first + EXTRACTION_PAGES_PER_CHUNK, data->n_pages);
+		data->next_page = *last;
+		claimed = TRUE;
+	}
+
+	g_mutex_unlock (&data->mutex);
+
+	return claimed;
+}
+
+static void
+content_extract_pages (ContentData     *data,
+                       PopplerDocument *document)
+{
+	gint first, last, i;
+
+	while (content_claim_pages (data, &first, &last)) {
+		for (i = first; i < last; i++) {
+			PopplerPage *page;
+			gchar *text;
+
+			if (g_timer_elapsed (data->timer, NULL) >= EXTRACTION_PROCESS_TIMEOUT) {
+				break;
+			}
+
+			page = poppler_document_get_page (document, i);
+			text = poppler_page_get_text (page);
+			g_object_unref (page);
+
+			data->pages_done[i] = TRUE;
+
+			if (!text) {
+				continue;
+			}
+
+			data->page_texts[i] = text;
+
+			g_mutex_lock (&data->mutex);
+			data->extracted_bytes += strlen (text);
+			g_mutex_unlock (&data->mutex);
+		}
+	}
+}
+
+/* Helper threads running for all documents being extracted. They
+ * stay below the "max-threads" setting, which also counts the thread
+ * the module is called from */
+static gint helper_threads = 0;
+
+static gint
+helper_threads_reserve (gint wanted,
+                        gint max_threads)
+{
+	gint current, n;
+
+	do {
+		current = g_atomic_int_get (&helper_threads);
+		n = MIN (wanted, max_threads - 1 - current);
+
+		if (n <= 0) {
+			return 0;
+		}
+	} while (!g_atomic_int_compare_and_exchange (&helper_threads, current, current + n));
+
+	return n;
+}
+
+static gpointer
+content_extract_thread (gpointer user_data)
+{
+	ContentData *data = user_data;
+	PopplerDocument *document;
+
+	/* A PopplerDocument must not be used from several threads,
+	 * every thread parses its own one from the mapped file */
+	document = poppler_document_new_from_data (data->contents, data->len, NULL, NULL);
+
+	if (document) {
+		content_extract_pages (data, document);
+		g_object_unref (document);
+	}
+
+	return NULL;
+}
+
 static gchar *
 extract_content_text (PopplerDocument *document,
-                      gsize            n_bytes)
+                      gchar           *contents,
+                      gsize            len,
+                      gsize            n_bytes,
+                      gint             max_threads)
 {
+	ContentData data = { 0 };
+	GThread **threads;
 	GString *string;
-	GTimer *timer;
 	gsize remaining_bytes;
-	gint n_pages, i;
-	gdouble elapsed;
+	gint n_helpers, n_chunks, n_extracted, i;
+
+	data.contents = contents;
+	data.len = len;
+	data.n_pages = poppler_document_get_n_pages (document);
+	data.n_bytes = n_bytes;
+	data.timer = g_timer_new ();
+	data.page_texts = g_new0 (gchar *, MAX (data.n_pages, 1));
+	data.pages_done = g_new0 (gboolean, MAX (data.n_pages, 1));
+	g_mutex_init (&data.mutex);
+
+	if (max_threads <= 0) {
+		max_threads = g_get_num_processors ();
+	}
+
+	/* Parsing the document again only pays off if there are
+	 * enough pages to share */
+	n_chunks = (data.n_pages + EXTRACTION_PAGES_PER_CHUNK - 1) / EXTRACTION_PAGES_PER_CHUNK;
+	n_helpers = helper_threads_reserve (n_chunks - 1, max_threads);
+
+	threads = g_new0 (GThread *, MAX (n_helpers, 1));
+
+	for (i = 0; i < n_helpers; i++) {
+		threads[i] = g_thread_try_new ("tracker-extract-pdf",
+		                               content_extract_thread,
+		                               &data, NULL);
+	}
+
+	/* This thread takes its share with the document it already has */
+	content_extract_pages (&data, document);
+
+	for (i = 0; i < n_helpers; i++) {
+		if (threads[i]) {
+			g_thread_join (threads[i]);
+		}
+	}
+
+	g_free (threads);
+	g_atomic_int_add (&helper_threads, -n_helpers);
 
-	n_pages = poppler_document_get_n_pages (document);
+	if (g_timer_elapsed (data.timer, NULL) >= EXTRACTION_PROCESS_TIMEOUT) {
+		g_debug ("Extraction timed out, %d seconds reached", EXTRACTION_PROCESS_TIMEOUT);
+	}
+
+	/* Reassemble the pages in order within the byte budget */
 	string = g_string_new ("");
-	timer = g_timer_new ();
+	remaining_bytes = n_bytes;
+	n_extracted = 0;
 
-	for (i = 0, remaining_bytes = n_bytes, elapsed = g_timer_elapsed (timer, NULL);
-	     i < n_pages && remaining_bytes > 0 && elapsed < EXTRACTION_PROCESS_TIMEOUT;
-	     i++, elapsed = g_timer_elapsed (timer, NULL)) {
-		PopplerPage *page;
+	for (i = 0; i < data.n_pages && remaining_bytes > 0; i++) {
 		gsize written_bytes = 0;
 		gchar *text;
 
-		page = poppler_document_get_page (document, i);
-		text = poppler_page_get_text (page);
+		/* After a timeout, pages claimed by other threads may
+		 * be missing, the text stops before the first gap */
+		if (!data.pages_done[i]) {
+			g_debug ("Page %d was not extracted, ignoring the pages after it", i);
+			break;
+		}
+
+		text = data.page_texts[i];
 
 		if (!text) {
-			g_object_unref (page);
 			continue;
 		}
 
@@ -234,27 +401,29 @@ extract_content_text (PopplerDocument *document,
 		}
 
 		remaining_bytes -= written_bytes;
+		n_extracted++;
 
 		g_debug ("Extracted %" G_GSIZE_FORMAT " bytes from page %d, "
 		         "%" G_GSIZE_FORMAT " bytes remaining",
 		         written_bytes, i, remaining_bytes);
-
-		g_free (text);
-		g_object_unref (page);
-	}
-
-	if (elapsed >= EXTRACTION_PROCESS_TIMEOUT) {
-		g_debug ("Extraction timed out, %d seconds reached", EXTRACTION_PROCESS_TIMEOUT);
 	}
 
-	g_debug ("Content extraction finished: %d/%d pages indexed in %2.2f seconds, "
+	g_debug ("Content extraction finished: %d/%d pages indexed by %d threads in %2.2f seconds, "
 	         "%" G_GSIZE_FORMAT " bytes extracted",
-	         i,
-	         n_pages,
-	         g_timer_elapsed (timer, NULL),
+	         n_extracted,
+	         data.n_pages,
+	         n_helpers + 1,
+	         g_timer_elapsed (data.timer, NULL),
 	         (n_bytes - remaining_bytes));
 
-	g_timer_destroy (timer);
+	for (i = 0; i < data.n_pages; i++) {
+		g_free (data.page_texts[i]);
+	}
+
+	g_free (data.page_texts);
+	g_free (data.pages_done);
+	g_mutex_clear (&data.mutex);
+	g_timer_destroy (data.timer);
 
 	return g_string_free (string, FALSE);
 }
@@ -313,55 +482,37 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	GString *where;
 	guint i;
 	GFile *file;
-	gchar *filename;
-	int fd;
+	TrackerFileReader *reader;
+	GError *reader_error = NULL;
 	gchar *contents = NULL;
-	gsize len;
-	struct stat st;
+	gsize len = 0;
 
 	metadata = tracker_extract_info_get_metadata_builder (info);
 	preupdate = tracker_extract_info_get_preupdate_builder (info);
 	graph = tracker_extract_info_get_graph (info);
 
 	file = tracker_extract_info_get_file (info);
-	filename = g_file_get_path (file);
 
-	fd = tracker_file_open_fd (filename);
+	/* Most of the document is read for the text, and the page
+	 * threads read it concurrently */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SEQUENTIAL, &reader_error);
 
-	if (fd == -1) {
-		g_warning ("Could not open pdf file '%s': %s\n",
-		           filename,
-		           g_strerror (errno));
-		g_free (filename);
+	if (!reader) {
+		g_warning ("Could not open pdf file: %s\n", reader_error->message);
+		g_error_free (reader_error);
 		return FALSE;
 	}
 
-	if (fstat (fd, &st) == -1) {
-		g_warning ("Could not fstat pdf file '%s': %s\n",
-		           filename,
-		           g_strerror (errno));
-		close (fd);
-		g_free (filename);
-		return FALSE;
-	}
-
-	if (st.st_size == 0) {
-		contents = NULL;
-		len = 0;
-	} else {
-		contents = (gchar *) mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-		if (contents == NULL || contents == MAP_FAILED) {
-			g_warning ("Could not mmap pdf file '%s': %s\n",
-			           filename,
-			           g_strerror (errno));
-			close (fd);
-			g_free (filename);
+	if (tracker_file_reader_get_size (reader) > 0) {
+		contents = (gchar *) tracker_file_reader_map_head (reader,
+		                                                   tracker_file_reader_get_size (reader),
+		                                                   &len);
+		if (!contents) {
+			tracker_file_reader_free (reader);
 			return FALSE;
 		}
-		len = st.st_size;
 	}
 
-	g_free (filename);
 	uri = g_file_get_uri (file);
 
 	document = poppler_document_new_from_data (contents, len, NULL, &error);
@@ -376,7 +527,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 
 			g_error_free (error);
 			g_free (uri);
-			close (fd);
+			tracker_file_reader_free (reader);
 
 			return TRUE;
 		} else {
@@ -386,7 +537,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 
 			g_error_free (error);
 			g_free (uri);
-			close (fd);
+			tracker_file_reader_free (reader);
 
 			return FALSE;
 		}
@@ -397,7 +548,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 		           "NULL returned without an error",
 		           uri);
 		g_free (uri);
-		close (fd);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
@@ -739,7 +890,8 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 
 	config = tracker_main_get_config ();
 	n_bytes = tracker_config_get_max_bytes (config);
-	content = extract_content_text (document, n_bytes);
+	content = extract_content_text (document, contents, len, n_bytes,
+	                                tracker_config_get_max_threads (config));
 
 	if (content) {
 		tracker_sparql_builder_predicate (metadata, "nie:plainTextContent");
@@ -760,11 +912,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 
 	g_object_unref (document);
 
-	if (contents) {
-		munmap (contents, len);
-	}
-
-	close (fd);
+	tracker_file_reader_free (reader);
 
 	return TRUE;
 }
@@ -26,7 +26,6 @@
 
 #include <png.h>
 
-#include <libtracker-common/tracker-file-utils.h>
 #include <libtracker-common/tracker-date-time.h>
 #include <libtracker-extract/tracker-extract.h>
 
@@ -787,11 +786,33 @@ guess_dlna_profile (gint          depth,
 	return FALSE;
 }
 
+typedef struct {
+	TrackerFileReader *reader;
+	goffset offset;
+} PngSource;
+
+static void
+png_source_read (png_structp png_ptr,
+                 png_bytep   data,
+                 png_size_t  length)
+{
+	PngSource *src = png_get_io_ptr (png_ptr);
+	gssize n_read;
+
+	n_read = tracker_file_reader_read (src->reader, src->offset, data, length);
+
+	if (n_read < 0 || (png_size_t) n_read != length) {
+		png_error (png_ptr, "Read error");
+	}
+
+	src->offset += n_read;
+}
+
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
-	goffset size;
-	FILE *f;
+	TrackerFileReader *reader;
+	PngSource src;
 	png_structp png_ptr;
 	png_infop info_ptr;
 	png_infop end_ptr;
@@ -802,26 +823,25 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	gint interlace_type, compression_type, filter_type;
 	const gchar *dlna_profile, *dlna_mimetype, *graph;
 	TrackerSparqlBuilder *preupdate, *metadata;
-	gchar *filename, *uri;
+	gchar *uri;
 	GString *where;
 	GFile *file;
 
 	file = tracker_extract_info_get_file (info);
-	filename = g_file_get_path (file);
-	size = tracker_file_get_size (filename);
 
 	preupdate = tracker_extract_info_get_preupdate_builder (info);
 	metadata = tracker_extract_info_get_metadata_builder (info);
 	graph = tracker_extract_info_get_graph (info);
 
-	if (size < 64) {
+	/* The whole image is decoded to get to the trailing chunks */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SEQUENTIAL, NULL);
+
+	if (!reader) {
 		return FALSE;
 	}
 
-	f = tracker_file_open (filename);
-	g_free (filename);
-
-	if (!f) {
+	if (tracker_file_reader_get_size (reader) < 64) {
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
@@ -830,31 +850,33 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	                                  NULL,
 	                                  NULL);
 	if (!png_ptr) {
-		tracker_file_close (f, FALSE);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
 	info_ptr = png_create_info_struct (png_ptr);
 	if (!info_ptr) {
 		png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
-		tracker_file_close (f, FALSE);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
 	end_ptr = png_create_info_struct (png_ptr);
 	if (!end_ptr) {
 		png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
-		tracker_file_close (f, FALSE);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
 	if (setjmp (png_jmpbuf (png_ptr))) {
 		png_destroy_read_struct (&png_ptr, &info_ptr, &end_ptr);
-		tracker_file_close (f, FALSE);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
-	png_init_io (png_ptr, f);
+	src.reader = reader;
+	src.offset = 0;
+	png_set_read_fn (png_ptr, &src, png_source_read);
 	png_read_info (png_ptr, info_ptr);
 
 	if (!png_get_IHDR (png_ptr,
@@ -867,7 +889,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	                   &compression_type,
 	                   &filter_type)) {
 		png_destroy_read_struct (&png_ptr, &info_ptr, &end_ptr);
-		tracker_file_close (f, FALSE);
+		tracker_file_reader_free (reader);
 		return FALSE;
 	}
 
@@ -917,7 +939,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	}
 
 	png_destroy_read_struct (&png_ptr, &info_ptr, &end_ptr);
-	tracker_file_close (f, FALSE);
+	tracker_file_reader_free (reader);
 
 	return TRUE;
 }
@@ -44,42 +44,40 @@
 #include "tracker-read.h"
 
 static gchar *
-get_file_content (GFile *file,
-                  gsize  n_bytes)
+get_file_content (TrackerExtractInfo *info,
+                  gsize               n_bytes)
 {
-	gchar *text, *uri, *path;
-	int fd;
+	TrackerFileReader *reader;
+	GError *error = NULL;
+	gchar *text, *uri;
 
 	/* If no content requested, return */
 	if (n_bytes == 0) {
 		return NULL;
 	}
 
-	uri = g_file_get_uri (file);
+	uri = g_file_get_uri (tracker_extract_info_get_file (info));
 
-	/* Get filename from URI */
-	path = g_file_get_path (file);
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SEQUENTIAL, &error);
 
-	fd = tracker_file_open_fd (path);
-
-	if (fd == -1) {
+	if (!reader) {
 		g_message ("Could not open file '%s': %s",
 		           uri,
-		           g_strerror (errno));
+		           error->message);
+		g_error_free (error);
 		g_free (uri);
-		g_free (path);
 		return NULL;
 	}
 
 	g_debug ("  Starting to read '%s' up to %" G_GSIZE_FORMAT " bytes...",
 	         uri, n_bytes);
 
-	/* Read up to n_bytes from stream. Output is always, always valid UTF-8,
-	 * this function closes the FD.
+	/* Read up to n_bytes from the file. Output is always, always
+	 * valid UTF-8.
 	 */
-	text = tracker_read_text_from_fd (fd, n_bytes);
+	text = tracker_read_text_from_reader (reader, n_bytes);
+	tracker_file_reader_free (reader);
 	g_free (uri);
-	g_free (path);
 
 	return text;
 }
@@ -102,8 +100,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	config = tracker_main_get_config ();
 	metadata = tracker_extract_info_get_metadata_builder (info);
 
-	content = get_file_content (tracker_extract_info_get_file (info),
-	                            tracker_config_get_max_bytes (config));
+	content = get_file_content (info, tracker_config_get_max_bytes (config));
 
 	tracker_sparql_builder_predicate (metadata, "a");
 	tracker_sparql_builder_object (metadata, "nfo:PlainTextDocument");
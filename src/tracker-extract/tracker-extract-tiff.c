@@ -254,10 +254,97 @@ tag_to_string (TIFF    *image,
 	return NULL;
 }
 
+typedef struct {
+	TrackerFileReader *reader;
+	toff_t offset;
+} TiffSource;
+
+static tsize_t
+tiff_source_read (thandle_t handle,
+                  tdata_t   buffer,
+                  tsize_t   size)
+{
+	TiffSource *src = (TiffSource *) handle;
+	gssize n_read;
+
+	n_read = tracker_file_reader_read (src->reader, src->offset, buffer, size);
+
+	if (n_read > 0) {
+		src->offset += n_read;
+	}
+
+	return n_read;
+}
+
+static tsize_t
+tiff_source_write (thandle_t handle,
+                   tdata_t   buffer,
+                   tsize_t   size)
+{
+	return -1;
+}
+
+static toff_t
+tiff_source_seek (thandle_t handle,
+                  toff_t    offset,
+                  int       whence)
+{
+	TiffSource *src = (TiffSource *) handle;
+
+	switch (whence) {
+	case SEEK_SET:
+		src->offset = offset;
+		break;
+	case SEEK_CUR:
+		src->offset += offset;
+		break;
+	case SEEK_END:
+		src->offset = tracker_file_reader_get_size (src->reader) + offset;
+		break;
+	default:
+		return (toff_t) -1;
+	}
+
+	return src->offset;
+}
+
+static int
+tiff_source_close (thandle_t handle)
+{
+	/* The reader is freed by the caller */
+	return 0;
+}
+
+static toff_t
+tiff_source_size (thandle_t handle)
+{
+	TiffSource *src = (TiffSource *) handle;
+
+	return tracker_file_reader_get_size (src->reader);
+}
+
+static int
+tiff_source_map (thandle_t  handle,
+                 tdata_t   *base,
+                 toff_t    *size)
+{
+	/* Not mapped, so that only the directories and tags are read */
+	return 0;
+}
+
+static void
+tiff_source_unmap (thandle_t handle,
+                   tdata_t   base,
+                   toff_t    size)
+{
+}
+
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo *info)
 {
 	TIFF *image;
+	TrackerFileReader *reader;
+	TiffSource src;
 	TrackerXmpData *xd = NULL;
 	TrackerIptcData *id = NULL;
 	TrackerExifData *ed = NULL;
@@ -272,7 +359,6 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	TrackerSparqlBuilder *metadata, *preupdate;
 	const gchar *graph;
 	GString *where;
-	int fd;
 
 #ifdef HAVE_LIBIPTCDATA
 	gchar *iptc_offset;
@@ -291,20 +377,29 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	metadata = tracker_extract_info_get_metadata_builder (info);
 	graph = tracker_extract_info_get_graph (info);
 
-	fd = tracker_file_open_fd (filename);
+	/* Only the directories and the tags they point to are read */
+	reader = tracker_file_reader_new (info, TRACKER_FILE_READ_SPARSE, NULL);
 
-	if (fd == -1) {
-		g_warning ("Could not open tiff file '%s': %s\n",
-		           filename,
-		           g_strerror (errno));
+	if (!reader) {
+		g_warning ("Could not open tiff file '%s'\n", filename);
 		g_free (filename);
 		return FALSE;
-	}	
+	}
+
+	src.reader = reader;
+	src.offset = 0;
 
-	if ((image = TIFFFdOpen (fd, filename, "r")) == NULL){
+	if ((image = TIFFClientOpen (filename, "rm", (thandle_t) &src,
+	                             tiff_source_read,
+	                             tiff_source_write,
+	                             tiff_source_seek,
+	                             tiff_source_close,
+	                             tiff_source_size,
+	                             tiff_source_map,
+	                             tiff_source_unmap)) == NULL) {
 		g_warning ("Could not open image:'%s'\n", filename);
+		tracker_file_reader_free (reader);
 		g_free (filename);
-		close (fd);
 		return FALSE;
 	}
 
@@ -380,6 +475,7 @@ tracker_extract_get_metadata (TrackerExtractInfo *info)
 	}
 
 	TIFFClose (image);
+	tracker_file_reader_free (reader);
 	g_free (filename);
 
 	md.title = tracker_coalesce_strip (5, xd->title, xd->pdf_title, td.title, ed->document_name, xd->title2);
@@ -48,6 +48,7 @@ extern gboolean debug;
 typedef struct {
 	gint extracted_count;
 	gint failed_count;
+	guint64 bytes_read;
 } StatisticsData;
 
 typedef struct {
@@ -177,16 +178,22 @@ report_statistics (GObject *object)
 		GModule *module = key;
 		StatisticsData *data = value;
 
-		if (data->extracted_count > 0 || data->failed_count > 0) {
+		if (data->extracted_count > 0 || data->failed_count > 0 ||
+		    data->bytes_read > 0) {
 			const gchar *name, *name_without_path;
+			gchar *bytes_read;
 
 			name = g_module_name (module);
 			name_without_path = strrchr (name, G_DIR_SEPARATOR) + 1;
+			bytes_read = g_format_size (data->bytes_read);
 
-			g_message ("    Module:'%s', extracted:%d, failures:%d",
+			g_message ("    Module:'%s', extracted:%d, failures:%d, read:%s",
 			           name_without_path,
 			           data->extracted_count,
-			           data->failed_count);
+			           data->failed_count,
+			           bytes_read);
+
+			g_free (bytes_read);
 		}
 	}
 
@@ -224,6 +231,25 @@ tracker_extract_new (gboolean     disable_shutdown,
 	return object;
 }
 
+/* Must be called with the task mutex held */
+static StatisticsData *
+get_statistics_data (TrackerExtractPrivate *priv,
+                     GModule               *module)
+{
+	StatisticsData *stats_data;
+
+	stats_data = g_hash_table_lookup (priv->statistics_data, module);
+
+	if (!stats_data) {
+		stats_data = g_slice_new0 (StatisticsData);
+		g_hash_table_insert (priv->statistics_data,
+		                     module,
+		                     stats_data);
+	}
+
+	return stats_data;
+}
+
 static void
 notify_task_finish (TrackerExtractTask *task,
                     gboolean            success)
@@ -241,16 +267,7 @@ notify_task_finish (TrackerExtractTask *task,
 	g_mutex_lock (&priv->task_mutex);
 
 	if (task->cur_module) {
-		stats_data = g_hash_table_lookup (priv->statistics_data,
-						  task->cur_module);
-
-		if (!stats_data) {
-			stats_data = g_slice_new0 (StatisticsData);
-			g_hash_table_insert (priv->statistics_data,
-					     task->cur_module,
-					     stats_data);
-		}
-
+		stats_data = get_statistics_data (priv, task->cur_module);
 		stats_data->extracted_count++;
 
 		if (!success) {
@@ -269,12 +286,15 @@ static gboolean
 get_file_metadata (TrackerExtractTask  *task,
                    TrackerExtractInfo **info_out)
 {
+	TrackerExtractPrivate *priv;
+	StatisticsData *stats_data;
 	TrackerExtractInfo *info;
 	GFile *file;
 	gchar *mime_used = NULL;
 	gint items = 0;
 
 	*info_out = NULL;
+	priv = TRACKER_EXTRACT_GET_PRIVATE (task->extract);
 
 	file = g_file_new_for_uri (task->file);
 	info = tracker_extract_info_new (file, task->mimetype, task->graph);
@@ -294,10 +314,20 @@ get_file_metadata (TrackerExtractTask  *task,
 	if (mime_used) {
 		if (task->cur_func) {
 			TrackerSparqlBuilder *statements;
+			gint64 start;
 
 			g_debug ("Using %s...", g_module_name (task->cur_module));
 
+			start = tracker_trace_begin ();
 			(task->cur_func) (info);
+			tracker_trace_end (TRACKER_TRACE_EXTRACT, start);
+
+			/* Reads are accounted to the module doing them, also
+			 * when the file ends up handled by the next one */
+			g_mutex_lock (&priv->task_mutex);
+			stats_data = get_statistics_data (priv, task->cur_module);
+			stats_data->bytes_read += tracker_extract_info_get_bytes_read (info);
+			g_mutex_unlock (&priv->task_mutex);
 
 			statements = tracker_extract_info_get_metadata_builder (info);
 			items = tracker_sparql_builder_get_length (statements);
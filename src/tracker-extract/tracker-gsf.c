@@ -17,16 +17,13 @@
  * Boston, MA  02110-1301, USA.
  */
 
-#include <errno.h>
 #include <string.h>
 
 #include <glib.h>
 
-#include <libtracker-common/tracker-file-utils.h>
-
 #include <gsf/gsf.h>
 #include <gsf/gsf-infile.h>
-#include <gsf/gsf-input-stdio.h>
+#include <gsf/gsf-input-impl.h>
 #include <gsf/gsf-infile-zip.h>
 
 #include "tracker-gsf.h"
@@ -36,6 +33,124 @@
 /* Note: 20 MBytes of max size is really assumed to be a safe limit. */
 #define XML_MAX_BYTES_READ         (20u << 20)  /* bytes */
 
+/* GsfInput reading through a TrackerFileReader, so that archive
+ * members are read with the reader's readahead hints and the bytes
+ * libgsf pulls in are accounted to the extraction.
+ */
+typedef struct {
+	GsfInput parent;
+	TrackerFileReader *reader;
+	guint8 *buf;
+	gsize buf_size;
+} TrackerGsfInput;
+
+typedef struct {
+	GsfInputClass parent_class;
+} TrackerGsfInputClass;
+
+static GType tracker_gsf_input_get_type (void);
+
+G_DEFINE_TYPE (TrackerGsfInput, tracker_gsf_input, GSF_INPUT_TYPE)
+
+static const guint8 *
+tracker_gsf_input_read (GsfInput *input,
+                        size_t    num_bytes,
+                        guint8   *optional_buffer)
+{
+	TrackerGsfInput *self = (TrackerGsfInput *) input;
+	guint8 *buffer = optional_buffer;
+	gssize n_read;
+
+	if (!buffer) {
+		/* Must stay valid until the next read */
+		if (self->buf_size < num_bytes) {
+			self->buf = g_realloc (self->buf, num_bytes);
+			self->buf_size = num_bytes;
+		}
+
+		buffer = self->buf;
+	}
+
+	n_read = tracker_file_reader_read (self->reader,
+	                                   gsf_input_tell (input),
+	                                   buffer,
+	                                   num_bytes);
+
+	if (n_read < 0 || (size_t) n_read != num_bytes) {
+		return NULL;
+	}
+
+	return buffer;
+}
+
+static gboolean
+tracker_gsf_input_seek (GsfInput  *input,
+                        gsf_off_t  offset,
+                        GSeekType  whence)
+{
+	/* Reads are positioned, GsfInput keeps the offset */
+	return FALSE;
+}
+
+static GsfInput *
+tracker_gsf_input_dup (GsfInput  *input,
+                       GError   **err)
+{
+	return tracker_gsf_input_new (((TrackerGsfInput *) input)->reader);
+}
+
+static void
+tracker_gsf_input_finalize (GObject *object)
+{
+	TrackerGsfInput *self = (TrackerGsfInput *) object;
+
+	g_free (self->buf);
+
+	G_OBJECT_CLASS (tracker_gsf_input_parent_class)->finalize (object);
+}
+
+static void
+tracker_gsf_input_class_init (TrackerGsfInputClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GsfInputClass *input_class = GSF_INPUT_CLASS (klass);
+
+	object_class->finalize = tracker_gsf_input_finalize;
+	input_class->Read = tracker_gsf_input_read;
+	input_class->Seek = tracker_gsf_input_seek;
+	input_class->Dup = tracker_gsf_input_dup;
+}
+
+static void
+tracker_gsf_input_init (TrackerGsfInput *self)
+{
+}
+
+/**
+ * tracker_gsf_input_new:
+ * @reader: a #TrackerFileReader
+ *
+ * Creates a #GsfInput on the file opened by @reader. @reader is not
+ * owned by the input and must outlive it and any duplicate libgsf
+ * makes of it.
+ *
+ * Returns: a new #GsfInput.
+ */
+GsfInput *
+tracker_gsf_input_new (TrackerFileReader *reader)
+{
+	TrackerGsfInput *input;
+
+	g_return_val_if_fail (reader != NULL, NULL);
+
+	input = g_object_new (tracker_gsf_input_get_type (), NULL);
+	input->reader = reader;
+	gsf_input_set_size (GSF_INPUT (input),
+	                    tracker_file_reader_get_size (reader));
+
+	return GSF_INPUT (input);
+}
+
 /**
  * based on find_member() from vsd_utils.c:
  * http://vsdump.sourcearchive.com/documentation/0.0.44/vsd__utils_8c-source.html
@@ -71,7 +186,7 @@ find_member (GsfInfile *arch,
 
 /**
  * tracker_gsf_parse_xml_in_zip:
- * @zip_file_uri: URI of the ZIP archive
+ * @reader: reader on the ZIP archive
  * @xml_filename: Name of the XML file stored inside the ZIP archive
  * @context: Markup context to be used when parsing the XML
  *
@@ -80,83 +195,62 @@ find_member (GsfInfile *arch,
  *  maximum size of the uncompressed XML file is limited to be to 20MBytes.
  */
 void
-tracker_gsf_parse_xml_in_zip (const gchar          *zip_file_uri,
+tracker_gsf_parse_xml_in_zip (TrackerFileReader    *reader,
                               const gchar          *xml_filename,
                               GMarkupParseContext  *context,
                               GError              **err)
 {
-	gchar *filename;
 	GError *error = NULL;
 	GsfInfile *infile = NULL;
 	GsfInput *src = NULL;
 	GsfInput *member = NULL;
-	FILE *file;
 
 	g_debug ("Parsing '%s' XML file contained inside zip archive...",
 	         xml_filename);
 
-	/* Get filename from the given URI */
-	if ((filename = g_filename_from_uri (zip_file_uri,
-	                                     NULL, &error)) == NULL) {
-		g_warning ("Can't get filename from uri '%s': %s",
-		           zip_file_uri, error ? error->message : "no error given");
-	} else { /* Create a new Input GSF object for the given file */
-
-		file = tracker_file_open (filename);
-		if (!file) {
-			g_warning ("Can't open file from uri '%s': %s",
-			           zip_file_uri, g_strerror (errno));
-		} else if ((src = gsf_input_stdio_new_FILE (filename, file, TRUE)) == NULL) {
-			g_warning ("Failed creating a GSF Input object for '%s': %s",
-			           zip_file_uri, error ? error->message : "no error given");
-		}
-		/* Input object is a Zip file */
-		else if ((infile = gsf_infile_zip_new (src, &error)) == NULL) {
-			g_warning ("'%s' Not a zip file: %s",
-			           zip_file_uri, error ? error->message : "no error given");
-		}
-		/* Look for requested filename inside the ZIP file */
-		else if ((member = find_member (infile, xml_filename)) == NULL) {
-			g_warning ("No member '%s' in zip file '%s'",
-			           xml_filename, zip_file_uri);
-		}
-		/* Load whole contents of the internal file in the xml buffer */
-		else {
-			guint8 buf[XML_BUFFER_SIZE];
-			size_t remaining_size, chunk_size, accum;
+	/* Create a new Input GSF object for the given file */
+	src = tracker_gsf_input_new (reader);
 
-			/* Get whole size of the contents to read */
-			remaining_size = (size_t) gsf_input_size (GSF_INPUT (member));
+	/* Input object is a Zip file */
+	if ((infile = gsf_infile_zip_new (src, &error)) == NULL) {
+		g_warning ("Not a zip file: %s",
+		           error ? error->message : "no error given");
+	}
+	/* Look for requested filename inside the ZIP file */
+	else if ((member = find_member (infile, xml_filename)) == NULL) {
+		g_warning ("No member '%s' in zip file",
+		           xml_filename);
+	}
+	/* Load whole contents of the internal file in the xml buffer */
+	else {
+		guint8 buf[XML_BUFFER_SIZE];
+		size_t remaining_size, chunk_size, accum;
 
-			/* Note that gsf_input_read() needs to be able to read ALL specified
-			 *  number of bytes, or it will fail */
-			chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
+		/* Get whole size of the contents to read */
+		remaining_size = (size_t) gsf_input_size (GSF_INPUT (member));
 
-			accum = 0;
-			while (!error &&
-			       accum  <= XML_MAX_BYTES_READ &&
-			       chunk_size > 0 &&
-			       gsf_input_read (GSF_INPUT (member), chunk_size, buf) != NULL) {
+		/* Note that gsf_input_read() needs to be able to read ALL specified
+		 *  number of bytes, or it will fail */
+		chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
 
-				/* update accumulated count */
-				accum += chunk_size;
+		accum = 0;
+		while (!error &&
+		       accum  <= XML_MAX_BYTES_READ &&
+		       chunk_size > 0 &&
+		       gsf_input_read (GSF_INPUT (member), chunk_size, buf) != NULL) {
 
-				/* Pass the read stream to the context parser... */
-				g_markup_parse_context_parse (context, buf, chunk_size, &error);
+			/* update accumulated count */
+			accum += chunk_size;
 
-				/* update bytes to be read */
-				remaining_size -= chunk_size;
-				chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
-			}
-		}
+			/* Pass the read stream to the context parser... */
+			g_markup_parse_context_parse (context, buf, chunk_size, &error);
 
-		if (file) {
-			tracker_file_close (file, FALSE);
+			/* update bytes to be read */
+			remaining_size -= chunk_size;
+			chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
 		}
 	}
 
-	g_free (filename);
-
 	if (error)
 		g_propagate_error (err, error);
 	if (infile)
@@ -23,12 +23,16 @@
 #include <glib.h>
 #include <gsf/gsf.h>
 
+#include <libtracker-extract/tracker-extract.h>
+
 G_BEGIN_DECLS
 
-void tracker_gsf_parse_xml_in_zip (const gchar          *zip_file_uri,
-                                   const gchar          *xml_filename,
-                                   GMarkupParseContext  *context,
-                                   GError              **error);
+GsfInput *tracker_gsf_input_new        (TrackerFileReader    *reader);
+
+void      tracker_gsf_parse_xml_in_zip (TrackerFileReader    *reader,
+                                        const gchar          *xml_filename,
+                                        GMarkupParseContext  *context,
+                                        GError              **error);
 
 G_END_DECLS
 
@@ -48,6 +48,7 @@
 #include <libtracker-common/tracker-ioprio.h>
 #include <libtracker-common/tracker-locale.h>
 #include <libtracker-common/tracker-sched.h>
+#include <libtracker-common/tracker-trace.h>
 
 #include <libtracker-data/tracker-db-manager.h>
 
@@ -439,6 +440,7 @@ main (int argc, char *argv[])
 	g_object_unref (decorator);
 	g_object_unref (controller);
 
+	tracker_trace_shutdown ();
 	tracker_log_shutdown ();
 
 	g_object_unref (config);
@@ -0,0 +1,486 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_LIBMEDIAART
+#include <libmediaart/mediaart.h>
+#endif
+
+#include "tracker-media-tags.h"
+
+void
+tracker_media_tags_init (TrackerMediaTags *tags)
+{
+	memset (tags, 0, sizeof (TrackerMediaTags));
+
+	tags->duration = -1;
+	tags->sample_rate = -1;
+	tags->channels = -1;
+	tags->bitrate = -1;
+	tags->width = -1;
+	tags->height = -1;
+	tags->frame_rate = -1;
+}
+
+void
+tracker_media_tags_clear (TrackerMediaTags *tags)
+{
+	g_free (tags->title);
+	g_free (tags->artist);
+	g_free (tags->album_artist);
+	g_free (tags->album);
+	g_free (tags->genre);
+	g_free (tags->date);
+	g_free (tags->comment);
+	g_free (tags->copyright);
+	g_free (tags->license);
+	g_free (tags->track_number);
+	g_free (tags->track_count);
+	g_free (tags->disc_number);
+	g_free (tags->audio_codec);
+	g_free (tags->video_codec);
+	g_free (tags->cover_data);
+	g_free (tags->cover_mime);
+
+	tracker_media_tags_init (tags);
+}
+
+static void
+set_tag (gchar       **tag,
+         const gchar  *value,
+         gsize         len)
+{
+	/* The first instance of a tag wins */
+	if (*tag == NULL && len > 0) {
+		*tag = g_strndup (value, len);
+	}
+}
+
+static void
+set_number_tag (gchar       **number,
+                gchar       **total,
+                const gchar  *value,
+                gsize         len)
+{
+	const gchar *slash;
+
+	/* Numbers are often given as "3/12" */
+	slash = memchr (value, '/', len);
+
+	if (slash) {
+		set_tag (number, value, slash - value);
+
+		if (total) {
+			set_tag (total, slash + 1, len - (slash - value) - 1);
+		}
+	} else {
+		set_tag (number, value, len);
+	}
+}
+
+/**
+ * tracker_media_tags_set_vorbis_comment:
+ * @tags: a #TrackerMediaTags
+ * @comment: a comment in the NAME=value form
+ * @len: length of @comment
+ *
+ * Sets the tag described by a Vorbis comment, as found in Ogg
+ * streams. Comment names are case insensitive.
+ **/
+void
+tracker_media_tags_set_vorbis_comment (TrackerMediaTags *tags,
+                                       const gchar      *comment,
+                                       gsize             len)
+{
+	const gchar *equal, *value;
+	gsize name_len, value_len;
+	gchar *date;
+
+	equal = memchr (comment, '=', len);
+
+	if (!equal) {
+		return;
+	}
+
+	name_len = equal - comment;
+	value = equal + 1;
+	value_len = len - name_len - 1;
+
+#define NAME_IS(n) (name_len == strlen (n) && g_ascii_strncasecmp (comment, n, name_len) == 0)
+
+	if (NAME_IS ("title")) {
+		set_tag (&tags->title, value, value_len);
+	} else if (NAME_IS ("artist")) {
+		set_tag (&tags->artist, value, value_len);
+	} else if (NAME_IS ("albumartist") || NAME_IS ("album artist")) {
+		set_tag (&tags->album_artist, value, value_len);
+	} else if (NAME_IS ("album")) {
+		set_tag (&tags->album, value, value_len);
+	} else if (NAME_IS ("genre")) {
+		set_tag (&tags->genre, value, value_len);
+	} else if (NAME_IS ("date") && !tags->date) {
+		date = g_strndup (value, value_len);
+		tags->date = tracker_date_guess (date);
+		g_free (date);
+	} else if (NAME_IS ("comment") || NAME_IS ("description")) {
+		set_tag (&tags->comment, value, value_len);
+	} else if (NAME_IS ("copyright")) {
+		set_tag (&tags->copyright, value, value_len);
+	} else if (NAME_IS ("license")) {
+		set_tag (&tags->license, value, value_len);
+	} else if (NAME_IS ("tracknumber")) {
+		set_number_tag (&tags->track_number, &tags->track_count, value, value_len);
+	} else if (NAME_IS ("tracktotal") || NAME_IS ("totaltracks") || NAME_IS ("trackcount")) {
+		set_tag (&tags->track_count, value, value_len);
+	} else if (NAME_IS ("discnumber") || NAME_IS ("discno")) {
+		set_number_tag (&tags->disc_number, NULL, value, value_len);
+	}
+
+#undef NAME_IS
+}
+
+static guint32
+read_uint32_le (const guchar *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((guint32) data[3] << 24);
+}
+
+/**
+ * tracker_media_tags_parse_vorbis_comments:
+ * @tags: a #TrackerMediaTags
+ * @data: a Vorbis comment header, without any codec specific prefix
+ * @len: length of @data
+ *
+ * Parses the vendor string and comment list shared by Vorbis, Opus,
+ * Theora and FLAC streams.
+ *
+ * Returns: %TRUE if the comment list could be read completely.
+ **/
+gboolean
+tracker_media_tags_parse_vorbis_comments (TrackerMediaTags *tags,
+                                          const guchar     *data,
+                                          gsize             len)
+{
+	guint32 vendor_len, n_comments, comment_len, i;
+	gsize offset;
+
+	if (len < 8) {
+		return FALSE;
+	}
+
+	vendor_len = read_uint32_le (data);
+
+	if (vendor_len > len - 8) {
+		return FALSE;
+	}
+
+	offset = 4 + vendor_len;
+	n_comments = read_uint32_le (data + offset);
+	offset += 4;
+
+	for (i = 0; i < n_comments; i++) {
+		if (len - offset < 4) {
+			return FALSE;
+		}
+
+		comment_len = read_uint32_le (data + offset);
+		offset += 4;
+
+		if (comment_len > len - offset) {
+			return FALSE;
+		}
+
+		tracker_media_tags_set_vorbis_comment (tags, (const gchar *) data + offset, comment_len);
+		offset += comment_len;
+	}
+
+	return TRUE;
+}
+
+static void
+add_string (TrackerSparqlBuilder *metadata,
+            const gchar          *predicate,
+            const gchar          *value)
+{
+	if (value) {
+		tracker_sparql_builder_predicate (metadata, predicate);
+		tracker_sparql_builder_object_unvalidated (metadata, value);
+	}
+}
+
+static void
+add_int64 (TrackerSparqlBuilder *metadata,
+           const gchar          *predicate,
+           gint64                value)
+{
+	if (value >= 0) {
+		tracker_sparql_builder_predicate (metadata, predicate);
+		tracker_sparql_builder_object_int64 (metadata, value);
+	}
+}
+
+static void
+replace_album_value (TrackerSparqlBuilder *preupdate,
+                     const gchar          *graph,
+                     const gchar          *album_uri,
+                     const gchar          *predicate,
+                     gint64                value)
+{
+	tracker_sparql_builder_delete_open (preupdate, NULL);
+	tracker_sparql_builder_subject_iri (preupdate, album_uri);
+	tracker_sparql_builder_predicate (preupdate, predicate);
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_delete_close (preupdate);
+
+	tracker_sparql_builder_where_open (preupdate);
+	tracker_sparql_builder_subject_iri (preupdate, album_uri);
+	tracker_sparql_builder_predicate (preupdate, predicate);
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_where_close (preupdate);
+
+	tracker_sparql_builder_insert_open (preupdate, NULL);
+	if (graph) {
+		tracker_sparql_builder_graph_open (preupdate, graph);
+	}
+
+	tracker_sparql_builder_subject_iri (preupdate, album_uri);
+	tracker_sparql_builder_predicate (preupdate, predicate);
+	tracker_sparql_builder_object_int64 (preupdate, value);
+
+	if (graph) {
+		tracker_sparql_builder_graph_close (preupdate);
+	}
+	tracker_sparql_builder_insert_close (preupdate);
+}
+
+static void
+apply_music_piece (TrackerMediaTags     *tags,
+                   TrackerSparqlBuilder *preupdate,
+                   TrackerSparqlBuilder *metadata,
+                   const gchar          *graph)
+{
+	gchar *artist_uri = NULL, *album_uri, *album_disc_uri;
+	const gchar *creator;
+	gint disc_number;
+
+	creator = tracker_coalesce_strip (2, tags->artist, tags->album_artist);
+
+	if (creator) {
+		artist_uri = tracker_sparql_escape_uri_printf ("urn:artist:%s", creator);
+
+		tracker_sparql_builder_insert_open (preupdate, NULL);
+		if (graph) {
+			tracker_sparql_builder_graph_open (preupdate, graph);
+		}
+
+		tracker_sparql_builder_subject_iri (preupdate, artist_uri);
+		tracker_sparql_builder_predicate (preupdate, "a");
+		tracker_sparql_builder_object (preupdate, "nmm:Artist");
+		tracker_sparql_builder_predicate (preupdate, "nmm:artistName");
+		tracker_sparql_builder_object_unvalidated (preupdate, creator);
+
+		if (graph) {
+			tracker_sparql_builder_graph_close (preupdate);
+		}
+		tracker_sparql_builder_insert_close (preupdate);
+
+		tracker_sparql_builder_predicate (metadata, "nmm:performer");
+		tracker_sparql_builder_object_iri (metadata, artist_uri);
+	}
+
+	if (tags->track_number) {
+		add_int64 (metadata, "nmm:trackNumber", atoi (tags->track_number));
+	}
+
+	if (!tags->album) {
+		g_free (artist_uri);
+		return;
+	}
+
+	if (tags->album_artist) {
+		album_uri = tracker_sparql_escape_uri_printf ("urn:album:%s:%s", tags->album, tags->album_artist);
+	} else {
+		album_uri = tracker_sparql_escape_uri_printf ("urn:album:%s", tags->album);
+	}
+
+	tracker_sparql_builder_insert_open (preupdate, NULL);
+	if (graph) {
+		tracker_sparql_builder_graph_open (preupdate, graph);
+	}
+
+	tracker_sparql_builder_subject_iri (preupdate, album_uri);
+	tracker_sparql_builder_predicate (preupdate, "a");
+	tracker_sparql_builder_object (preupdate, "nmm:MusicAlbum");
+	tracker_sparql_builder_predicate (preupdate, "nmm:albumTitle");
+	tracker_sparql_builder_object_unvalidated (preupdate, tags->album);
+
+	if (artist_uri) {
+		tracker_sparql_builder_predicate (preupdate, "nmm:albumArtist");
+		tracker_sparql_builder_object_iri (preupdate, artist_uri);
+	}
+
+	if (graph) {
+		tracker_sparql_builder_graph_close (preupdate);
+	}
+	tracker_sparql_builder_insert_close (preupdate);
+
+	if (tags->track_count) {
+		replace_album_value (preupdate, graph, album_uri,
+		                     "nmm:albumTrackCount", atoi (tags->track_count));
+	}
+
+	disc_number = tags->disc_number ? atoi (tags->disc_number) : 1;
+
+	if (tags->album_artist) {
+		album_disc_uri = tracker_sparql_escape_uri_printf ("urn:album-disc:%s:%s:Disc%d",
+		                                                   tags->album, tags->album_artist,
+		                                                   disc_number);
+	} else {
+		album_disc_uri = tracker_sparql_escape_uri_printf ("urn:album-disc:%s:Disc%d",
+		                                                   tags->album, disc_number);
+	}
+
+	tracker_sparql_builder_delete_open (preupdate, NULL);
+	tracker_sparql_builder_subject_iri (preupdate, album_disc_uri);
+	tracker_sparql_builder_predicate (preupdate, "nmm:setNumber");
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_delete_close (preupdate);
+	tracker_sparql_builder_where_open (preupdate);
+	tracker_sparql_builder_subject_iri (preupdate, album_disc_uri);
+	tracker_sparql_builder_predicate (preupdate, "nmm:setNumber");
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_where_close (preupdate);
+
+	tracker_sparql_builder_delete_open (preupdate, NULL);
+	tracker_sparql_builder_subject_iri (preupdate, album_disc_uri);
+	tracker_sparql_builder_predicate (preupdate, "nmm:albumDiscAlbum");
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_delete_close (preupdate);
+	tracker_sparql_builder_where_open (preupdate);
+	tracker_sparql_builder_subject_iri (preupdate, album_disc_uri);
+	tracker_sparql_builder_predicate (preupdate, "nmm:albumDiscAlbum");
+	tracker_sparql_builder_object_variable (preupdate, "unknown");
+	tracker_sparql_builder_where_close (preupdate);
+
+	tracker_sparql_builder_insert_open (preupdate, NULL);
+	if (graph) {
+		tracker_sparql_builder_graph_open (preupdate, graph);
+	}
+
+	tracker_sparql_builder_subject_iri (preupdate, album_disc_uri);
+	tracker_sparql_builder_predicate (preupdate, "a");
+	tracker_sparql_builder_object (preupdate, "nmm:MusicAlbumDisc");
+	tracker_sparql_builder_predicate (preupdate, "nmm:setNumber");
+	tracker_sparql_builder_object_int64 (preupdate, disc_number);
+	tracker_sparql_builder_predicate (preupdate, "nmm:albumDiscAlbum");
+	tracker_sparql_builder_object_iri (preupdate, album_uri);
+
+	if (graph) {
+		tracker_sparql_builder_graph_close (preupdate);
+	}
+	tracker_sparql_builder_insert_close (preupdate);
+
+	tracker_sparql_builder_predicate (metadata, "nmm:musicAlbum");
+	tracker_sparql_builder_object_iri (metadata, album_uri);
+	tracker_sparql_builder_predicate (metadata, "nmm:musicAlbumDisc");
+	tracker_sparql_builder_object_iri (metadata, album_disc_uri);
+
+	g_free (album_disc_uri);
+	g_free (album_uri);
+	g_free (artist_uri);
+}
+
+/**
+ * tracker_media_tags_apply:
+ * @tags: a #TrackerMediaTags
+ * @info: the #TrackerExtractInfo of the file @tags were read from
+ *
+ * Adds @tags to the metadata of @info. Files with a video track are
+ * described as nmm:Video, anything else as nmm:MusicPiece.
+ **/
+void
+tracker_media_tags_apply (TrackerMediaTags   *tags,
+                          TrackerExtractInfo *info)
+{
+	TrackerSparqlBuilder *preupdate, *metadata;
+	const gchar *graph;
+	gchar *uri;
+
+	preupdate = tracker_extract_info_get_preupdate_builder (info);
+	metadata = tracker_extract_info_get_metadata_builder (info);
+	graph = tracker_extract_info_get_graph (info);
+	uri = g_file_get_uri (tracker_extract_info_get_file (info));
+
+	tracker_sparql_builder_predicate (metadata, "a");
+
+	if (tags->has_video) {
+		tracker_sparql_builder_object (metadata, "nmm:Video");
+
+		add_int64 (metadata, "nfo:width", tags->width);
+		add_int64 (metadata, "nfo:height", tags->height);
+
+		if (tags->frame_rate > 0) {
+			tracker_sparql_builder_predicate (metadata, "nfo:frameRate");
+			tracker_sparql_builder_object_double (metadata, tags->frame_rate);
+		}
+
+		add_string (metadata, "nfo:codec", tags->video_codec);
+	} else {
+		tracker_sparql_builder_object (metadata, "nmm:MusicPiece");
+		tracker_sparql_builder_object (metadata, "nfo:Audio");
+
+		apply_music_piece (tags, preupdate, metadata, graph);
+
+		add_string (metadata, "nfo:codec", tags->audio_codec);
+	}
+
+	tracker_guarantee_title_from_file (metadata, "nie:title", tags->title, uri, NULL);
+
+	add_int64 (metadata, "nfo:duration", tags->duration);
+	add_int64 (metadata, "nfo:sampleRate", tags->sample_rate);
+	add_int64 (metadata, "nfo:channels", tags->channels);
+	add_int64 (metadata, "nfo:averageBitrate", tags->bitrate);
+
+	add_string (metadata, "nie:contentCreated", tags->date);
+	add_string (metadata, "nie:comment", tags->comment);
+	add_string (metadata, "nie:copyright", tags->copyright);
+	add_string (metadata, "nie:license", tags->license);
+	add_string (metadata, "nfo:genre", tags->genre);
+
+#ifdef HAVE_LIBMEDIAART
+	if (tags->has_video) {
+		media_art_process (NULL, 0, NULL, MEDIA_ART_VIDEO,
+		                   NULL, tags->title, uri);
+	} else if (tags->album || tags->cover_data) {
+		media_art_process (tags->cover_data,
+		                   tags->cover_size,
+		                   tags->cover_mime,
+		                   MEDIA_ART_ALBUM,
+		                   tags->album_artist ? tags->album_artist : tags->artist,
+		                   tags->album,
+		                   uri);
+	}
+#endif
+
+	g_free (uri);
+}
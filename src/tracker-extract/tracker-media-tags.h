@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_EXTRACT_MEDIA_TAGS_H__
+#define __TRACKER_EXTRACT_MEDIA_TAGS_H__
+
+#include <glib.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+G_BEGIN_DECLS
+
+/* Metadata gathered by the native container parsers (MP4, Matroska,
+ * Ogg), turned into SPARQL the same way for all of them */
+typedef struct {
+	gchar *title;
+	gchar *artist;
+	gchar *album_artist;
+	gchar *album;
+	gchar *genre;
+	gchar *date;
+	gchar *comment;
+	gchar *copyright;
+	gchar *license;
+	gchar *track_number;
+	gchar *track_count;
+	gchar *disc_number;
+	gchar *audio_codec;
+	gchar *video_codec;
+
+	gboolean has_audio;
+	gboolean has_video;
+
+	/* Values below are -1 if unknown */
+	gint64 duration;
+	gint sample_rate;
+	gint channels;
+	gint bitrate;
+	gint width;
+	gint height;
+	gdouble frame_rate;
+
+	guchar *cover_data;
+	gsize cover_size;
+	gchar *cover_mime;
+} TrackerMediaTags;
+
+void     tracker_media_tags_init                (TrackerMediaTags   *tags);
+void     tracker_media_tags_clear               (TrackerMediaTags   *tags);
+
+void     tracker_media_tags_set_vorbis_comment  (TrackerMediaTags   *tags,
+                                                 const gchar        *comment,
+                                                 gsize               len);
+gboolean tracker_media_tags_parse_vorbis_comments (TrackerMediaTags *tags,
+                                                   const guchar     *data,
+                                                   gsize             len);
+
+void     tracker_media_tags_apply               (TrackerMediaTags   *tags,
+                                                 TrackerExtractInfo *info);
+
+G_END_DECLS
+
+#endif /* __TRACKER_EXTRACT_MEDIA_TAGS_H__ */
@@ -19,9 +19,8 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <string.h>
-#include <unistd.h>
-#include <fcntl.h>
 
 #include <glib.h>
 #include <gio/gio.h>
@@ -316,12 +315,12 @@ tracker_read_text_from_stream (GInputStream *stream,
 
 
 /**
- * tracker_read_text_from_fd:
- * @fd: input fd to read from
- * @max_bytes: max number of bytes to read from @fd
+ * tracker_read_text_from_reader:
+ * @reader: reader on the file to read from
+ * @max_bytes: max number of bytes to read from @reader
  *
- * Reads up to @max_bytes from @fd, and validates the read text as proper
- *  UTF-8. Will also properly close the FD when finishes.
+ * Reads up to @max_bytes from the start of the file opened by @reader,
+ *  and validates the read text as proper UTF-8.
  *
  * If the input text is not UTF-8 it will also try to decode it based on the
  * current locale, or windows-1252, or UTF-16.
@@ -329,21 +328,16 @@ tracker_read_text_from_stream (GInputStream *stream,
  * Returns: newly-allocated NUL-terminated UTF-8 string with the read text.
  **/
 gchar *
-tracker_read_text_from_fd (gint  fd,
-                           gsize max_bytes)
+tracker_read_text_from_reader (TrackerFileReader *reader,
+                               gsize              max_bytes)
 {
-	FILE *fz;
 	GString *s = NULL;
 	gsize n_bytes_remaining = max_bytes;
+	goffset offset = 0;
 
+	g_return_val_if_fail (reader, NULL);
 	g_return_val_if_fail (max_bytes > 0, NULL);
 
-	if ((fz = fdopen (fd, "r")) == NULL) {
-		g_warning ("Cannot read from FD... could not extract text");
-		close (fd);
-		return NULL;
-	}
-
 	/* Reading in chunks of BUFFER_SIZE
 	 *   Loop is halted whenever one of this conditions is met:
 	 *     a) Read bytes reached the maximum allowed (max_bytes)
@@ -354,13 +348,19 @@ tracker_read_text_from_fd (gint  fd,
 	 */
 	while (n_bytes_remaining > 0) {
 		gchar buf[BUFFER_SIZE];
-		gsize n_bytes_read;
+		gssize n_bytes_read;
 
 		/* Read bytes */
-		n_bytes_read = fread (buf,
-		                      1,
-		                      MIN (BUFFER_SIZE, n_bytes_remaining),
-		                      fz);
+		n_bytes_read = tracker_file_reader_read (reader,
+		                                         offset,
+		                                         buf,
+		                                         MIN (BUFFER_SIZE, n_bytes_remaining));
+
+		if (n_bytes_read < 0) {
+			g_message ("Error reading from file: '%s'",
+			           g_strerror (errno));
+			break;
+		}
 
 		/* Process read bytes, and halt loop if needed */
 		if (!process_chunk (buf,
@@ -370,13 +370,9 @@ tracker_read_text_from_fd (gint  fd,
 		                    &s)) {
 			break;
 		}
-	}
 
-	/* Close the file here */
-#ifdef HAVE_POSIX_FADVISE
-	posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
-#endif /* HAVE_POSIX_FADVISE */
-	fclose (fz);
+		offset += n_bytes_read;
+	}
 
 	/* Validate UTF-8 if something was read, and return it */
 	return s ? process_whole_string (s) : NULL;
@@ -23,13 +23,15 @@
 #include <glib.h>
 #include <gio/gio.h>
 
+#include <libtracker-extract/tracker-extract.h>
+
 G_BEGIN_DECLS
 
 gchar *tracker_read_text_from_stream (GInputStream *stream,
                                       gsize         max_bytes);
 
-gchar *tracker_read_text_from_fd (gint  fd,
-                                  gsize max_bytes);
+gchar *tracker_read_text_from_reader (TrackerFileReader *reader,
+                                      gsize              max_bytes);
 
 G_END_DECLS
 
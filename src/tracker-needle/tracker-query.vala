@@ -218,6 +218,11 @@ public class Tracker.Query {
 	public uint limit { get; set; }
 	public string query { get; private set; }
 
+	// Token of the page to fetch instead of using offset, and the token
+	// of the page following the results of perform_async()
+	public string? continuation { get; set; }
+	public string? next_continuation { get; private set; }
+
 	public GenericArray<string> tags { get; set; }
 
 	private static Sparql.Connection connection;
@@ -392,6 +397,29 @@ public class Tracker.Query {
 			query += " ORDER BY " + sort_clauses[query_type];
 		}
 
+		next_continuation = null;
+
+		// Paged queries resume after the last result of the previous
+		// page instead of going through all results before the offset
+		if (offset == 0 || continuation != null) {
+			debug ("Running paged query: '%s'", query);
+
+			try {
+				string? next;
+				cursor = yield connection.query_page_async (query, (int) limit, continuation, out next, cancellable);
+				next_continuation = next;
+
+				debug ("Done");
+
+				return cursor;
+			} catch (Sparql.Error.UNSUPPORTED e) {
+				debug ("Could not page query, falling back to OFFSET: %s", e.message);
+			} catch (GLib.Error e) {
+				warning ("Could not run Sparql query: %s", e.message);
+				return null;
+			}
+		}
+
 		query += " OFFSET %u LIMIT %u".printf (offset, limit);
 
 		debug ("Running query: '%s'", query);
@@ -33,6 +33,9 @@ public class Tracker.ResultStore : Gtk.TreeModel, GLib.Object {
 		public ResultNode [] results;
 		public Gdk.Pixbuf pixbuf;
 		public int count;
+
+		// Continuation tokens of the pages known so far, by offset
+		public HashTable<int,string> continuations = new HashTable<int,string> (direct_hash, direct_equal);
 	}
 
 	private struct QueryData {
@@ -95,13 +98,18 @@ public class Tracker.ResultStore : Gtk.TreeModel, GLib.Object {
 			query = new Tracker.Query ();
 			query.criteria = _search_term;
 			query.tags = search_tags;
-			query.limit = limit;
+			query.limit = 100;
 			query.offset = op.offset;
+			query.continuation = op.node.continuations.lookup (op.offset);
 
 			cursor = yield query.perform_async (op.node.query.type, op.node.query.match, op.node.query.args, cancellable);
 
 			cancellable.set_error_if_cancelled ();
 
+			if (query.next_continuation != null) {
+				op.node.continuations.insert (op.offset + 100, query.next_continuation);
+			}
+
 			if (cursor != null) {
 				for (i = op.offset; i < op.offset + 100; i++) {
 					ResultNode *result;
@@ -326,6 +326,7 @@ License which can be viewed at:
 
 		Tracker.DBus.shutdown ();
 		Tracker.Data.Manager.shutdown ();
+		Tracker.Trace.shutdown ();
 		Tracker.Log.shutdown ();
 
 		config.disconnect (config_verbosity_id);
@@ -67,7 +67,27 @@ public class Tracker.Resources : Object {
 		try {
 			var file = File.new_for_uri (uri);
 
-			yield Tracker.Store.queue_turtle_import (file, sender);
+			yield Tracker.Store.queue_turtle_import (file, false, sender);
+
+			request.end ();
+		} catch (DBInterfaceError.NO_SPACE ie) {
+			throw new Sparql.Error.NO_SPACE (ie.message);
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
+
+	public async void load_bulk (BusName sender, string uri) throws Error {
+		var request = DBusRequest.begin (sender, "Resources.LoadBulk (uri: '%s')", uri);
+		try {
+			var file = File.new_for_uri (uri);
+
+			yield Tracker.Store.queue_turtle_import (file, true, sender);
 
 			request.end ();
 		} catch (DBInterfaceError.NO_SPACE ie) {
@@ -177,6 +197,24 @@ public class Tracker.Resources : Object {
 		request.end ();
 	}
 
+	public async void optimize (BusName sender) throws Error {
+		var request = DBusRequest.begin (sender, "Resources.Optimize");
+		try {
+			yield Tracker.Store.fts_optimize (sender);
+
+			request.end ();
+		} catch (DBInterfaceError.NO_SPACE ie) {
+			throw new Sparql.Error.NO_SPACE (ie.message);
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
+
 	public async void batch_sparql_update (BusName sender, string update) throws Error {
 		var request = DBusRequest.begin (sender, "Resources.BatchSparqlUpdate");
 		request.debug ("query: %s", update);
@@ -202,6 +240,8 @@ public class Tracker.Resources : Object {
 
 	bool emit_graph_updated (Class cl) {
 		if (cl.has_insert_events () || cl.has_delete_events ()) {
+			int64 start = Trace.begin ();
+
 			var builder = new VariantBuilder ((VariantType) "a(iiii)");
 			cl.foreach_delete_event ((graph_id, subject_id, pred_id, object_id) => {
 				builder.add ("(iiii)", graph_id, subject_id, pred_id, object_id);
@@ -218,6 +258,8 @@ public class Tracker.Resources : Object {
 
 			cl.reset_ready_events ();
 
+			Trace.end (TraceStage.SIGNAL_EMIT, start);
+
 			return true;
 		}
 		return false;
@@ -21,35 +21,11 @@
 public class Tracker.Statistics : Object {
 	public const string PATH = "/org/freedesktop/Tracker1/Statistics";
 
-	static bool initialized;
-
 	[DBus (signature = "aas")]
 	public new Variant get (BusName sender) throws GLib.Error {
 		var request = DBusRequest.begin (sender, "Statistics.Get");
 
-		if (!initialized) {
-			var iface = DBManager.get_db_interface ();
-
-			foreach (var cl in Ontologies.get_classes ()) {
-				/* xsd classes do not derive from rdfs:Resource and do not use separate tables */
-				if (!cl.name.has_prefix ("xsd:")) {
-					/* update statistics */
-					var stmt = iface.create_statement (DBStatementCacheType.NONE,
-						                           "SELECT COUNT(1) FROM \"%s\"",
-						                            cl.name);
-
-					var stat_cursor = stmt.start_cursor ();
-					if (stat_cursor.next ()) {
-						cl.count = (int) stat_cursor.get_integer (0);
-					} else {
-						warning ("Unable to query instance count for class %s", cl.name);
-					}
-				}
-			}
-
-			initialized = true;
-		}
-
+		/* counts are kept up to date by every transaction */
 		var builder = new VariantBuilder ((VariantType) "aas");
 
 		foreach (var cl in Ontologies.get_classes ()) {
@@ -68,4 +44,76 @@ public class Tracker.Statistics : Object {
 
 		return builder.end ();
 	}
+
+	[DBus (signature = "aas")]
+	public Variant get_properties (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetProperties");
+
+		var builder = new VariantBuilder ((VariantType) "aas");
+
+		foreach (var prop in Ontologies.get_properties ()) {
+			if (prop.count == 0) {
+				/* skip properties without values */
+				continue;
+			}
+
+			builder.open ((VariantType) "as");
+			builder.add ("s", prop.name);
+			builder.add ("s", prop.count.to_string ());
+			builder.close ();
+		}
+
+		request.end ();
+
+		return builder.end ();
+	}
+
+	[DBus (signature = "a(sxxx)")]
+	public Variant get_cache (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetCache");
+
+		var stats = DBManager.get_cache_statistics ();
+
+		request.end ();
+
+		return stats;
+	}
+
+	[DBus (signature = "a{si}")]
+	public Variant get_fts (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetFts");
+
+		int n_levels;
+		int n_segments = Tracker.Data.Manager.get_fts_segment_count (out n_levels);
+
+		var builder = new VariantBuilder ((VariantType) "a{si}");
+		builder.add ("{si}", "segments", n_segments);
+		builder.add ("{si}", "levels", n_levels);
+
+		request.end ();
+
+		return builder.end ();
+	}
+
+	[DBus (signature = "a{sx}")]
+	public Variant get_wal (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetWal");
+
+		var stats = Tracker.Store.get_wal_statistics ();
+
+		request.end ();
+
+		return stats;
+	}
+
+	[DBus (signature = "a(sxxxxxx)")]
+	public Variant get_latency (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetLatency");
+
+		var stats = Tracker.Trace.get_stats ();
+
+		request.end ();
+
+		return stats;
+	}
 }
@@ -24,6 +24,35 @@ public class Tracker.Steroids : Object {
 
 	public const int BUFFER_SIZE = 65536;
 
+	static void write_row (DataOutputStream data_output_stream, DBCursor cursor, int n_columns, int[] column_offsets, string[] column_data) throws Error {
+		int last_offset = -1;
+
+		for (int i = 0; i < n_columns ; i++) {
+			unowned string str = cursor.get_string (i);
+
+			column_data[i]  = str;
+
+			last_offset += (str != null ? str.length : 0) + 1;
+			column_offsets[i] = last_offset;
+		}
+
+		data_output_stream.put_int32 (n_columns);
+
+		for (int i = 0; i < n_columns ; i++) {
+			/* Cast from enum to int */
+			data_output_stream.put_int32 ((int) cursor.get_value_type (i));
+		}
+
+		for (int i = 0; i < n_columns ; i++) {
+			data_output_stream.put_int32 (column_offsets[i]);
+		}
+
+		for (int i = 0; i < n_columns ; i++) {
+			data_output_stream.put_string (column_data[i] != null ? column_data[i] : "");
+			data_output_stream.put_byte (0);
+		}
+	}
+
 	public async string[] query (BusName sender, string query, UnixOutputStream output_stream) throws Error {
 		var request = DBusRequest.begin (sender, "Steroids.Query");
 		request.debug ("query: %s", query);
@@ -36,7 +65,6 @@ public class Tracker.Steroids : Object {
 
 				int n_columns = cursor.n_columns;
 
-				int[] column_sizes = new int[n_columns];
 				int[] column_offsets = new int[n_columns];
 				string[] column_data = new string[n_columns];
 
@@ -46,38 +74,68 @@ public class Tracker.Steroids : Object {
 				}
 
 				while (cursor.next ()) {
-					int last_offset = -1;
+					write_row (data_output_stream, cursor, n_columns, column_offsets, column_data);
+				}
+			}, sender);
+
+			request.end ();
+
+			return variable_names;
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
 
-					for (int i = 0; i < n_columns ; i++) {
-						unowned string str = cursor.get_string (i);
+	/* Like query, but returns at most page_size rows. The returned
+	 * continuation resumes after the last row of the page when passed
+	 * back with the same query, it is empty after the last page.
+	 */
+	public async string[] query_page (BusName sender, string query, int page_size, string continuation, UnixOutputStream output_stream, out string next_continuation) throws Error {
+		var request = DBusRequest.begin (sender, "Steroids.QueryPage");
+		request.debug ("query: %s, page size: %d, continuation: %s", query, page_size, continuation);
+		try {
+			string[] variable_names = null;
+			string next = null;
 
-						column_sizes[i] = str != null ? str.length : 0;
-						column_data[i]  = str;
+			if (page_size < 1) {
+				throw new Sparql.Error.PARSE ("Invalid page size %d".printf (page_size));
+			}
 
-						last_offset += column_sizes[i] + 1;
-						column_offsets[i] = last_offset;
-					}
+			yield Tracker.Store.sparql_query_page (query, page_size, continuation != "" ? continuation : null, Tracker.Store.Priority.HIGH, (cursor, query_object) => {
+				var data_output_stream = new DataOutputStream (new BufferedOutputStream.sized (output_stream, BUFFER_SIZE));
+				data_output_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
 
-					data_output_stream.put_int32 (n_columns);
+				/* Hide the sort key columns */
+				int n_columns = cursor.n_columns - query_object.n_sort_keys;
+				int n_rows = 0;
 
-					for (int i = 0; i < n_columns ; i++) {
-						/* Cast from enum to int */
-						data_output_stream.put_int32 ((int) cursor.get_value_type (i));
-					}
+				int[] column_offsets = new int[n_columns];
+				string[] column_data = new string[n_columns];
 
-					for (int i = 0; i < n_columns ; i++) {
-						data_output_stream.put_int32 (column_offsets[i]);
-					}
+				variable_names = new string[n_columns];
+				for (int i = 0; i < n_columns; i++) {
+					variable_names[i] = cursor.get_variable_name (i);
+				}
+
+				while (cursor.next ()) {
+					write_row (data_output_stream, cursor, n_columns, column_offsets, column_data);
 
-					for (int i = 0; i < n_columns ; i++) {
-						data_output_stream.put_string (column_data[i] != null ? column_data[i] : "");
-						data_output_stream.put_byte (0);
+					if (++n_rows == page_size) {
+						/* A full page, there might be more rows */
+						next = query_object.get_continuation (cursor);
 					}
 				}
 			}, sender);
 
 			request.end ();
 
+			next_continuation = next != null ? next : "";
+
 			return variable_names;
 		} catch (Error e) {
 			request.end (e);
@@ -155,6 +213,82 @@ public class Tracker.Steroids : Object {
 		return yield update_internal (sender, Tracker.Store.Priority.LOW, true, input_stream);
 	}
 
+	static string? read_value (DataInputStream data_input_stream) throws Error {
+		size_t bytes_read;
+
+		int size = data_input_stream.read_int32 ();
+		if (size < 0) {
+			return null;
+		}
+
+		/* We malloc one more char to ensure string is 0 terminated */
+		uint8[] value = new uint8[size + 1];
+		data_input_stream.read_all (value[0:size], out bytes_read);
+
+		if (bytes_read != size) {
+			throw new Sparql.Error.INTERNAL ("Truncated statement data");
+		}
+
+		return (string) value;
+	}
+
+	async void insert_statements_internal (BusName sender, Tracker.Store.Priority priority, UnixInputStream input_stream) throws Error {
+		var request = DBusRequest.begin (sender,
+			"Steroids.%sInsertStatements",
+			priority != Tracker.Store.Priority.HIGH ? "Batch" : "");
+		try {
+			var data_input_stream = new DataInputStream (input_stream);
+			data_input_stream.set_buffer_size (BUFFER_SIZE);
+			data_input_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+
+			int statement_count = data_input_stream.read_int32 ();
+
+			if (statement_count < 0) {
+				throw new Sparql.Error.INTERNAL ("Invalid statement count");
+			}
+
+			var statements = new Tracker.Store.Statement[statement_count];
+
+			for (int i = 0; i < statement_count; i++) {
+				/* Object kind, 0 for IRIs, 1 for literals */
+				statements[i].object_is_uri = data_input_stream.read_int32 () == 0;
+				statements[i].graph = read_value (data_input_stream);
+				statements[i].subject = read_value (data_input_stream);
+				statements[i].predicate = read_value (data_input_stream);
+				statements[i].object = read_value (data_input_stream);
+
+				if (statements[i].subject == null || statements[i].predicate == null || statements[i].object == null) {
+					throw new Sparql.Error.INTERNAL ("Incomplete statement");
+				}
+			}
+
+			data_input_stream = null;
+
+			request.debug ("statements: %d", statement_count);
+
+			yield Tracker.Store.insert_statements ((owned) statements, priority, sender);
+
+			request.end ();
+		} catch (DBInterfaceError.NO_SPACE ie) {
+			throw new Sparql.Error.NO_SPACE (ie.message);
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
+
+	public async void insert_statements (BusName sender, UnixInputStream input_stream) throws Error {
+		yield insert_statements_internal (sender, Tracker.Store.Priority.HIGH, input_stream);
+	}
+
+	public async void batch_insert_statements (BusName sender, UnixInputStream input_stream) throws Error {
+		yield insert_statements_internal (sender, Tracker.Store.Priority.LOW, input_stream);
+	}
+
 	[DBus (signature = "as")]
 	public async Variant update_array (BusName sender, UnixInputStream input_stream) throws Error {
 		var request = DBusRequest.begin (sender, "Steroids.UpdateArray");
@@ -24,6 +24,17 @@ public class Tracker.Store {
 
 	const int MAX_TASK_TIME = 30;
 
+	// seconds the store needs to be idle before FTS segments get merged
+	const int FTS_MERGE_IDLE_TIME = 5;
+
+	// WAL pages after which checkpoints run alongside updates
+	const int WAL_CHECKPOINT_PAGES = 1000;
+	// WAL pages after which updates wait for a checkpoint, only reached
+	// when readers keep the background checkpoints from catching up
+	const int WAL_MAX_PAGES = 20000;
+	// seconds the store needs to be idle before the WAL gets rewound
+	const int WAL_CHECKPOINT_IDLE_TIME = 1;
+
 	static Queue<Task> query_queues[3 /* TRACKER_STORE_N_PRIORITIES */];
 	static Queue<Task> update_queues[3 /* TRACKER_STORE_N_PRIORITIES */];
 	static int n_queries_running;
@@ -35,6 +46,13 @@ public class Tracker.Store {
 	static int max_task_time;
 	static bool active;
 	static SourceFunc active_callback;
+	static uint fts_merge_id;
+	static uint wal_checkpoint_id;
+	// whether updates may have left FTS segments to merge
+	static bool fts_merge_needed;
+	// whether domain indexes may still need to be filled in
+	static bool migration_needed = true;
+	static bool migration_ran_last;
 
 	public enum Priority {
 		HIGH,
@@ -47,10 +65,23 @@ public class Tracker.Store {
 		QUERY,
 		UPDATE,
 		UPDATE_BLANK,
+		STATEMENTS,
 		TURTLE,
+		FTS_MERGE,
+		FTS_OPTIMIZE,
+		MIGRATE,
+	}
+
+	public struct Statement {
+		public string? graph;
+		public string subject;
+		public string predicate;
+		public string object;
+		public bool object_is_uri;
 	}
 
 	public delegate void SparqlQueryInThread (DBCursor cursor) throws Error;
+	public delegate void SparqlPageInThread (DBCursor cursor, Sparql.Query query) throws Error;
 
 	abstract class Task {
 		public TaskType type;
@@ -64,6 +95,9 @@ public class Tracker.Store {
 		public Cancellable cancellable;
 		public uint watchdog_id;
 		public unowned SparqlQueryInThread in_thread;
+		public unowned SparqlPageInThread page_in_thread;
+		public int page_size;
+		public string? continuation;
 
 		~QueryTask () {
 			if (watchdog_id > 0) {
@@ -78,8 +112,18 @@ public class Tracker.Store {
 		public Priority priority;
 	}
 
+	class StatementsTask : UpdateTask {
+		public Statement[] statements;
+	}
+
 	class TurtleTask : Task {
 		public string path;
+		// see Tracker.Data.load_turtle_file_bulk
+		public bool bulk;
+	}
+
+	class MaintenanceTask : Task {
+		public bool more_pending;
 	}
 
 	static void sched () {
@@ -119,13 +163,22 @@ public class Tracker.Store {
 		}
 
 		if (!update_running) {
-			for (int i = 0; i < Priority.N_PRIORITIES; i++) {
-				task = update_queues[i].pop_head ();
-				if (task != null) {
-					break;
+			// migration chunks take turns with updates, so
+			// neither is starved while the store is busy
+			if (!migration_needed || migration_ran_last) {
+				for (int i = 0; i < Priority.N_PRIORITIES; i++) {
+					task = update_queues[i].pop_head ();
+					if (task != null) {
+						break;
+					}
 				}
 			}
+			if (task == null && migration_needed) {
+				task = new MaintenanceTask ();
+				task.type = TaskType.MIGRATE;
+			}
 			if (task != null) {
+				migration_ran_last = (task.type == TaskType.MIGRATE);
 				update_running = true;
 				try {
 					update_pool.push (task);
@@ -134,12 +187,56 @@ public class Tracker.Store {
 				}
 			}
 		}
+
+		if (n_queries_running == 0 && !update_running && fts_merge_needed) {
+			schedule_fts_merge (FTS_MERGE_IDLE_TIME);
+		} else if (fts_merge_id != 0) {
+			// there is work again, merging will be retried once idle
+			Source.remove (fts_merge_id);
+			fts_merge_id = 0;
+		}
+
+		if (n_queries_running == 0 && !update_running && AtomicInt.get (ref wal_pages) > 0) {
+			schedule_idle_checkpoint ();
+		} else if (wal_checkpoint_id != 0) {
+			Source.remove (wal_checkpoint_id);
+			wal_checkpoint_id = 0;
+		}
+	}
+
+	static void schedule_fts_merge (uint timeout) {
+		if (fts_merge_id != 0) {
+			return;
+		}
+
+		fts_merge_id = Timeout.add_seconds (timeout, () => {
+			fts_merge_id = 0;
+
+			if (!active || n_queries_running > 0 || update_running) {
+				return false;
+			}
+
+			// merge steps are bounded, so a later update waits
+			// for at most one of them
+			var task = new MaintenanceTask ();
+			task.type = TaskType.FTS_MERGE;
+
+			update_running = true;
+			try {
+				update_pool.push (task);
+			} catch (Error e) {
+				// ignore harmless thread creation error
+			}
+
+			return false;
+		});
 	}
 
 	static Tracker.Data.CommitType commit_type (Task task) {
 		switch (task.type) {
 			case TaskType.UPDATE:
 			case TaskType.UPDATE_BLANK:
+			case TaskType.STATEMENTS:
 				if (((UpdateTask) task).priority == Priority.HIGH) {
 					return Tracker.Data.CommitType.REGULAR;
 				} else if (update_queues[Priority.LOW].get_length () > 0) {
@@ -176,9 +273,10 @@ public class Tracker.Store {
 
 			running_tasks.remove (task);
 			n_queries_running--;
-		} else if (task.type == TaskType.UPDATE || task.type == TaskType.UPDATE_BLANK) {
+		} else if (task.type == TaskType.UPDATE || task.type == TaskType.UPDATE_BLANK || task.type == TaskType.STATEMENTS) {
 			if (task.error == null) {
 				Tracker.Data.notify_transaction (commit_type (task));
+				fts_merge_needed = true;
 			}
 
 			task.callback ();
@@ -188,11 +286,45 @@ public class Tracker.Store {
 		} else if (task.type == TaskType.TURTLE) {
 			if (task.error == null) {
 				Tracker.Data.notify_transaction (commit_type (task));
+				fts_merge_needed = true;
+			}
+
+			task.callback ();
+			task.error = null;
+
+			update_running = false;
+		} else if (task.type == TaskType.FTS_MERGE) {
+			if (task.error != null) {
+				warning ("Could not merge FTS segments: %s", task.error.message);
+				fts_merge_needed = false;
+			} else {
+				fts_merge_needed = ((MaintenanceTask) task).more_pending;
+			}
+
+			update_running = false;
+
+			if (fts_merge_needed && n_queries_running == 0 && update_queues_empty ()) {
+				// keep merging while nothing else needs the store
+				schedule_fts_merge (0);
+			}
+		} else if (task.type == TaskType.FTS_OPTIMIZE) {
+			if (task.error == null) {
+				fts_merge_needed = false;
 			}
 
 			task.callback ();
 			task.error = null;
 
+			update_running = false;
+		} else if (task.type == TaskType.MIGRATE) {
+			if (task.error != null) {
+				// progress is kept, the next start resumes
+				warning ("Could not migrate domain index: %s", task.error.message);
+				migration_needed = false;
+			} else {
+				migration_needed = ((MaintenanceTask) task).more_pending;
+			}
+
 			update_running = false;
 		}
 
@@ -210,9 +342,16 @@ public class Tracker.Store {
 			if (task.type == TaskType.QUERY) {
 				var query_task = (QueryTask) task;
 
-				var cursor = Tracker.Data.query_sparql_cursor (query_task.query);
+				if (query_task.page_in_thread != null) {
+					var query = new Sparql.Query.paged (query_task.query, query_task.page_size, query_task.continuation);
+					var cursor = query.execute_cursor (false);
+
+					query_task.page_in_thread (cursor, query);
+				} else {
+					var cursor = Tracker.Data.query_sparql_cursor (query_task.query);
 
-				query_task.in_thread (cursor);
+					query_task.in_thread (cursor);
+				}
 			} else {
 				var iface = DBManager.get_db_interface ();
 				iface.sqlite_wal_hook (wal_hook);
@@ -225,6 +364,10 @@ public class Tracker.Store {
 					var update_task = (UpdateTask) task;
 
 					update_task.blank_nodes = Tracker.Data.update_sparql_blank (update_task.query);
+				} else if (task.type == TaskType.STATEMENTS) {
+					var statements_task = (StatementsTask) task;
+
+					insert_statements_in_thread (statements_task.statements);
 				} else if (task.type == TaskType.TURTLE) {
 					var turtle_task = (TurtleTask) task;
 
@@ -232,10 +375,24 @@ public class Tracker.Store {
 
 					Tracker.Events.freeze ();
 					try {
-						Tracker.Data.load_turtle_file (file);
+						if (turtle_task.bulk) {
+							Tracker.Data.load_turtle_file_bulk (file);
+						} else {
+							Tracker.Data.load_turtle_file (file);
+						}
 					} finally {
 						Tracker.Events.reset_pending ();
 					}
+				} else if (task.type == TaskType.FTS_MERGE) {
+					var maintenance_task = (MaintenanceTask) task;
+
+					maintenance_task.more_pending = Tracker.Data.Manager.fts_merge ();
+				} else if (task.type == TaskType.FTS_OPTIMIZE) {
+					Tracker.Data.Manager.fts_optimize ();
+				} else if (task.type == TaskType.MIGRATE) {
+					var maintenance_task = (MaintenanceTask) task;
+
+					maintenance_task.more_pending = Tracker.Data.Manager.migrate ();
 				}
 			}
 		} catch (Error e) {
@@ -248,48 +405,175 @@ public class Tracker.Store {
 		});
 	}
 
-	public static void wal_checkpoint () {
+	static void insert_statements_in_thread (Statement[] statements) throws Error {
+		// run in update thread
+
+		Tracker.Data.begin_transaction ();
+
 		try {
-			debug ("Checkpointing database...");
-			var iface = DBManager.get_db_interface ();
-			iface.execute_query ("PRAGMA wal_checkpoint");
-			debug ("Checkpointing complete...");
+			for (int i = 0; i < statements.length; i++) {
+				if (statements[i].object_is_uri) {
+					Tracker.Data.insert_statement_with_uri (statements[i].graph, statements[i].subject, statements[i].predicate, statements[i].object);
+				} else {
+					Tracker.Data.insert_statement_with_string (statements[i].graph, statements[i].subject, statements[i].predicate, statements[i].object);
+				}
+				Tracker.Data.update_buffer_might_flush ();
+			}
 		} catch (Error e) {
-			warning (e.message);
+			Tracker.Data.rollback_transaction ();
+			throw e;
 		}
+
+		// rolls back by itself if it fails
+		Tracker.Data.commit_transaction ();
 	}
 
+	static int wal_pages;
 	static int checkpointing;
+	// whether the next background checkpoint may rewind the WAL
+	static int checkpoint_escalate;
+
+	static Mutex wal_stats_mutex;
+	static int64 n_checkpoints;
+	static int64 n_busy_checkpoints;
+	static int64 n_blocking_checkpoints;
+	static int64 n_restarts;
+	static int64 last_checkpoint_time;
+	static int64 max_checkpoint_time;
+	static int64 total_checkpoint_time;
+
+	static void checkpoint (bool escalate) {
+		var iface = DBManager.get_db_interface ();
+		int n_log, n_checkpointed, n_restart_log, n_restart_checkpointed;
+		bool complete, restarted = false;
+
+		int64 start = get_monotonic_time ();
+
+		try {
+			// passive checkpoints never wait on readers or writers
+			complete = iface.sqlite_wal_checkpoint (DBCheckpointMode.PASSIVE, out n_log, out n_checkpointed);
+
+			if (complete && escalate) {
+				// every frame is back in the database, rewinding
+				// the WAL gives up right away if it is still read
+				restarted = iface.sqlite_wal_checkpoint (DBCheckpointMode.TRUNCATE, out n_restart_log, out n_restart_checkpointed);
+			}
+		} catch (Error e) {
+			warning ("Could not checkpoint WAL: %s", e.message);
+			return;
+		}
+
+		int64 duration = get_monotonic_time () - start;
+
+		debug ("WAL checkpoint: %d of %d pages%s, %s us",
+		       n_checkpointed, n_log, restarted ? ", rewound" : "", duration.to_string ());
+
+		if (restarted) {
+			AtomicInt.set (ref wal_pages, 0);
+		}
+
+		wal_stats_mutex.lock ();
+		n_checkpoints++;
+		if (!complete) {
+			n_busy_checkpoints++;
+		}
+		if (restarted) {
+			n_restarts++;
+		}
+		last_checkpoint_time = duration;
+		if (duration > max_checkpoint_time) {
+			max_checkpoint_time = duration;
+		}
+		total_checkpoint_time += duration;
+		wal_stats_mutex.unlock ();
+	}
+
+	public static void wal_checkpoint () {
+		checkpoint (false);
+	}
+
+	static void push_checkpoint (bool escalate) {
+		if (!AtomicInt.compare_and_exchange (ref checkpointing, 0, 1)) {
+			// one is running already
+			return;
+		}
+
+		AtomicInt.set (ref checkpoint_escalate, escalate ? 1 : 0);
+
+		try {
+			checkpoint_pool.push (true);
+		} catch (Error e) {
+			warning (e.message);
+			AtomicInt.set (ref checkpointing, 0);
+		}
+	}
 
 	static void wal_hook (int n_pages) {
 		// run in update thread
 
 		debug ("WAL: %d pages", n_pages);
 
-		if (n_pages >= 10000) {
-			// do immediate checkpointing (blocking updates)
-			// to prevent excessive wal file growth
-			wal_checkpoint ();
-		} else if (n_pages >= 1000) {
-			if (AtomicInt.compare_and_exchange (ref checkpointing, 0, 1)) {
-				// initiate asynchronous checkpointing (not blocking updates)
-				try {
-					checkpoint_pool.push (true);
-				} catch (Error e) {
-					warning (e.message);
-					AtomicInt.set (ref checkpointing, 0);
-				}
-			}
+		AtomicInt.set (ref wal_pages, n_pages);
+
+		if (n_pages >= WAL_MAX_PAGES && AtomicInt.get (ref checkpointing) == 0) {
+			// background checkpoints did not catch up, hold
+			// updates back to bound WAL growth
+			checkpoint (false);
+
+			wal_stats_mutex.lock ();
+			n_blocking_checkpoints++;
+			wal_stats_mutex.unlock ();
+		} else if (n_pages >= WAL_CHECKPOINT_PAGES) {
+			// checkpoint in the background, not blocking updates
+			push_checkpoint (false);
 		}
 	}
 
 	static void checkpoint_dispatch_cb (bool task) {
 		// run in checkpoint thread
 
-		wal_checkpoint ();
+		checkpoint (AtomicInt.get (ref checkpoint_escalate) != 0);
 		AtomicInt.set (ref checkpointing, 0);
 	}
 
+	static void schedule_idle_checkpoint () {
+		if (wal_checkpoint_id != 0) {
+			return;
+		}
+
+		wal_checkpoint_id = Timeout.add_seconds (WAL_CHECKPOINT_IDLE_TIME, () => {
+			wal_checkpoint_id = 0;
+
+			if (!active || n_queries_running > 0 || update_running) {
+				return false;
+			}
+
+			// nothing reads or writes, so the WAL can likely be
+			// fully written back and truncated
+			push_checkpoint (true);
+
+			return false;
+		});
+	}
+
+	public static Variant get_wal_statistics () {
+		var builder = new VariantBuilder ((VariantType) "a{sx}");
+
+		builder.add ("{sx}", "pages", (int64) AtomicInt.get (ref wal_pages));
+
+		wal_stats_mutex.lock ();
+		builder.add ("{sx}", "checkpoints", n_checkpoints);
+		builder.add ("{sx}", "busy-checkpoints", n_busy_checkpoints);
+		builder.add ("{sx}", "blocking-checkpoints", n_blocking_checkpoints);
+		builder.add ("{sx}", "restarts", n_restarts);
+		builder.add ("{sx}", "last-duration", last_checkpoint_time);
+		builder.add ("{sx}", "max-duration", max_checkpoint_time);
+		builder.add ("{sx}", "total-duration", total_checkpoint_time);
+		wal_stats_mutex.unlock ();
+
+		return builder.end ();
+	}
+
 	public static void init () {
 		string max_task_time_env = Environment.get_variable ("TRACKER_STORE_MAX_TASK_TIME");
 		if (max_task_time_env != null) {
@@ -321,6 +605,16 @@ public class Tracker.Store {
 	}
 
 	public static void shutdown () {
+		if (fts_merge_id != 0) {
+			Source.remove (fts_merge_id);
+			fts_merge_id = 0;
+		}
+
+		if (wal_checkpoint_id != 0) {
+			Source.remove (wal_checkpoint_id);
+			wal_checkpoint_id = 0;
+		}
+
 		query_pool = null;
 		update_pool = null;
 		checkpoint_pool = null;
@@ -351,6 +645,28 @@ public class Tracker.Store {
 		}
 	}
 
+	public static async void sparql_query_page (string sparql, int page_size, string? continuation, Priority priority, SparqlPageInThread in_thread, string client_id) throws Error {
+		var task = new QueryTask ();
+		task.type = TaskType.QUERY;
+		task.query = sparql;
+		task.page_size = page_size;
+		task.continuation = continuation;
+		task.cancellable = new Cancellable ();
+		task.page_in_thread = in_thread;
+		task.callback = sparql_query_page.callback;
+		task.client_id = client_id;
+
+		query_queues[priority].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+	}
+
 	public static async void sparql_update (string sparql, Priority priority, string client_id) throws Error {
 		var task = new UpdateTask ();
 		task.type = TaskType.UPDATE;
@@ -391,10 +707,30 @@ public class Tracker.Store {
 		return task.blank_nodes;
 	}
 
-	public static async void queue_turtle_import (File file, string client_id) throws Error {
+	public static async void insert_statements (owned Statement[] statements, Priority priority, string client_id) throws Error {
+		var task = new StatementsTask ();
+		task.type = TaskType.STATEMENTS;
+		task.statements = (owned) statements;
+		task.priority = priority;
+		task.callback = insert_statements.callback;
+		task.client_id = client_id;
+
+		update_queues[priority].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+	}
+
+	public static async void queue_turtle_import (File file, bool bulk, string client_id) throws Error {
 		var task = new TurtleTask ();
 		task.type = TaskType.TURTLE;
 		task.path = file.get_path ();
+		task.bulk = bulk;
 		task.callback = queue_turtle_import.callback;
 		task.client_id = client_id;
 
@@ -409,6 +745,33 @@ public class Tracker.Store {
 		}
 	}
 
+	public static async void fts_optimize (string client_id) throws Error {
+		var task = new MaintenanceTask ();
+		task.type = TaskType.FTS_OPTIMIZE;
+		task.callback = fts_optimize.callback;
+		task.client_id = client_id;
+
+		update_queues[Priority.LOW].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+	}
+
+	static bool update_queues_empty () {
+		for (int i = 0; i < Priority.N_PRIORITIES; i++) {
+			if (update_queues[i].get_length () > 0) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	public uint get_queue_size () {
 		uint result = 0;
 
@@ -491,6 +854,14 @@ public class Tracker.Store {
 
 	public static void resume () {
 		Tracker.Store.active = true;
+		// a restored backup may come with its own migrations
+		migration_needed = true;
+
+		// only wake up for merges if a level has segments to merge,
+		// anything written from now on sets the flag again
+		int n_levels;
+		int n_segments = Tracker.Data.Manager.get_fts_segment_count (out n_levels);
+		fts_merge_needed = (n_segments > n_levels);
 
 		sched ();
 	}
@@ -44,8 +44,13 @@
 
 static gchar        **filenames = NULL;
 static gboolean       print_version;
+static gboolean       bulk;
 
 static GOptionEntry   entries[] = {
+	{ "bulk", 'b', 0, G_OPTION_ARG_NONE, &bulk,
+	  N_("Load large files faster, without notifying about the new data"),
+	  NULL,
+	},
 	{ "version", 'V', 0, G_OPTION_ARG_NONE, &print_version,
 	  N_("Print version"),
 	  NULL,
@@ -56,10 +61,42 @@ static GOptionEntry   entries[] = {
 	{ NULL }
 };
 
+/* tracker_sparql_connection_load() with the store's bulk mode,
+ * see Tracker.Resources.load_bulk */
+static void
+load_bulk (GDBusConnection  *bus,
+           GFile            *file,
+           GError          **error)
+{
+	GVariant *v;
+	gchar *uri;
+
+	uri = g_file_get_uri (file);
+	v = g_dbus_connection_call_sync (bus,
+	                                 "org.freedesktop.Tracker1",
+	                                 "/org/freedesktop/Tracker1/Resources",
+	                                 "org.freedesktop.Tracker1.Resources",
+	                                 "LoadBulk",
+	                                 g_variant_new ("(s)", uri),
+	                                 NULL,
+	                                 G_DBUS_CALL_FLAGS_NONE,
+	                                 G_MAXINT,
+	                                 NULL,
+	                                 error);
+	g_free (uri);
+
+	if (v) {
+		g_variant_unref (v);
+	} else if (error && *error) {
+		g_dbus_error_strip_remote_error (*error);
+	}
+}
+
 int
 main (int argc, char **argv)
 {
-	TrackerSparqlConnection *connection;
+	TrackerSparqlConnection *connection = NULL;
+	GDBusConnection *bus = NULL;
 	GOptionContext *context;
 	GError *error = NULL;
 	gchar **p;
@@ -102,9 +139,13 @@ main (int argc, char **argv)
 
 	g_option_context_free (context);
 
-	connection = tracker_sparql_connection_get (NULL, &error);
+	if (bulk) {
+		bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+	} else {
+		connection = tracker_sparql_connection_get (NULL, &error);
+	}
 
-	if (!connection) {
+	if (!connection && !bus) {
 		g_printerr ("%s: %s\n",
 		            _("Could not establish a connection to Tracker"),
 		            error ? error->message : _("No error given"));
@@ -121,7 +162,11 @@ main (int argc, char **argv)
 		         *p);
 
 		file = g_file_new_for_commandline_arg (*p);
-		tracker_sparql_connection_load (connection, file, NULL, &error);
+		if (bulk) {
+			load_bulk (bus, file, &error);
+		} else {
+			tracker_sparql_connection_load (connection, file, NULL, &error);
+		}
 		g_object_unref (file);
 
 		if (error) {
@@ -137,7 +182,13 @@ main (int argc, char **argv)
 		g_print ("\n");
 	}
 
-	g_object_unref (connection);
+	if (bus) {
+		g_object_unref (bus);
+	}
+
+	if (connection) {
+		g_object_unref (connection);
+	}
 
 	return EXIT_SUCCESS;
 }
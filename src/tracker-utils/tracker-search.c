@@ -52,6 +52,8 @@
 
 static gint limit = -1;
 static gint offset;
+static gchar *continuation;
+static gchar *next_continuation;
 static gchar **terms;
 static gboolean or_operator;
 static gboolean detailed;
@@ -84,6 +86,10 @@ static GOptionEntry semantic_entries[] = {
 	  N_("Offset the results"),
 	  "0"
 	},
+	{ "continue", 0, 0, G_OPTION_ARG_STRING, &continuation,
+	  N_("Continue a previous search after the last result it showed"),
+	  N_("TOKEN")
+	},
 	{ "or-operator", 'r', 0, G_OPTION_ARG_NONE, &or_operator,
 	  N_("Use OR for search terms instead of AND (the default)"),
 	  NULL
@@ -195,6 +201,61 @@ show_limit_warning (void)
 	            disable_color ? "" : WARN_BEGIN,
 	            _("NOTE: Limit was reached, there are more items in the database not listed here"),
 	            disable_color ? "" : WARN_END);
+
+	if (next_continuation) {
+		g_printerr ("%s%s --continue=%s%s\n",
+		            disable_color ? "" : WARN_BEGIN,
+		            _("To list them, run the same search with"),
+		            next_continuation,
+		            disable_color ? "" : WARN_END);
+	}
+}
+
+static TrackerSparqlCursor *
+search_query (TrackerSparqlConnection  *connection,
+              const gchar              *query,
+              gint                      search_offset,
+              gint                      search_limit,
+              GError                  **error)
+{
+	TrackerSparqlCursor *cursor;
+	GError *inner_error = NULL;
+	gchar *offset_query;
+
+	g_free (next_continuation);
+	next_continuation = NULL;
+
+	/* Paged queries resume after the last result of the previous
+	 * page, so the store does not have to go through all results
+	 * before the offset again. Fall back to OFFSET for queries or
+	 * connections which can not be paged.
+	 */
+	if (search_offset == 0 || continuation) {
+		cursor = tracker_sparql_connection_query_page (connection,
+		                                               query,
+		                                               search_limit,
+		                                               continuation,
+		                                               &next_continuation,
+		                                               NULL,
+		                                               &inner_error);
+
+		if (continuation ||
+		    !g_error_matches (inner_error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_UNSUPPORTED)) {
+			if (inner_error) {
+				g_propagate_error (error, inner_error);
+			}
+
+			return cursor;
+		}
+
+		g_clear_error (&inner_error);
+	}
+
+	offset_query = g_strdup_printf ("%s OFFSET %d LIMIT %d", query, search_offset, search_limit);
+	cursor = tracker_sparql_connection_query (connection, offset_query, NULL, error);
+	g_free (offset_query);
+
+	return cursor;
 }
 
 static gchar *
@@ -277,13 +338,14 @@ print_snippet (const gchar *snippet)
 static gboolean
 get_contacts_results (TrackerSparqlConnection *connection,
                       const gchar             *query,
+                      gint                     search_offset,
                       gint                     search_limit,
                       gboolean                 details)
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -354,29 +416,21 @@ get_contacts (TrackerSparqlConnection *connection,
 		                         "  ?contact a nco:Contact ;"
 		                         "  fts:match \"%s\" ."
 		                         "} "
-		                         "ORDER BY ASC(nco:fullname(?contact)) ASC(nco:hasEmailAddress(?contact)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nco:fullname(?contact)) ASC(nco:hasEmailAddress(?contact)) ",
                                          _("No name"),
                                          _("No E-mail address"),
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         fts);
 	} else {
 		query = g_strdup_printf ("SELECT tracker:coalesce(nco:fullname(?contact), fn:concat(nco:nameFamily(?contact), \" \", nco:nameGiven(?contact)), \"%s\") tracker:coalesce(nco:hasEmailAddress(?contact), \"%s\") ?contact "
 		                         "WHERE { "
 		                         "  ?contact a nco:Contact ."
 		                         "} "
-		                         "ORDER BY ASC(nco:fullname(?contact)) ASC(nco:hasEmailAddress(?contact)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nco:fullname(?contact)) ASC(nco:hasEmailAddress(?contact)) ",
                                          _("No name"),
-                                         _("No E-mail address"),
-		                         search_offset,
-		                         search_limit);
+                                         _("No E-mail address"));
 	}
 
-	success = get_contacts_results (connection, query, search_limit, details);
+	success = get_contacts_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -386,13 +440,14 @@ get_contacts (TrackerSparqlConnection *connection,
 static gboolean
 get_emails_results (TrackerSparqlConnection *connection,
                     const gchar             *query,
+                    gint                     search_offset,
                     gint                     search_limit,
                     gboolean                 details)
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -467,27 +522,19 @@ get_emails (TrackerSparqlConnection *connection,
 		                         "  ?email a nmo:Email ;"
 		                         "  fts:match \"%s\" ."
 		                         "} "
-		                         "ORDER BY ASC(nmo:messageSubject(?email)) ASC(nmo:receivedDate(?email))"
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nmo:messageSubject(?email)) ASC(nmo:receivedDate(?email))",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT nmo:receivedDate(?email) nmo:messageSubject(?email) nie:url(?email) "
-		                         "WHERE { "
-		                         "  ?email a nmo:Email ."
-		                         "} "
-		                         "ORDER BY ASC(nmo:messageSubject(?email)) ASC(nmo:receivedDate(?email))"
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT nmo:receivedDate(?email) nmo:messageSubject(?email) nie:url(?email) "
+		                  "WHERE { "
+		                  "  ?email a nmo:Email ."
+		                  "} "
+		                  "ORDER BY ASC(nmo:messageSubject(?email)) ASC(nmo:receivedDate(?email))");
 	}
 
-	success = get_emails_results (connection, query, search_limit, details);
+	success = get_emails_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -497,13 +544,14 @@ get_emails (TrackerSparqlConnection *connection,
 static gboolean
 get_files_results (TrackerSparqlConnection *connection,
                    const gchar             *query,
+                   gint                     search_offset,
                    gint                     search_limit,
                    gboolean                 details)
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -579,30 +627,22 @@ get_document_files (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?document)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?document)) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?document nie:url(?document) "
 		                         "WHERE { "
 		                         "  ?document a nfo:Document ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?document)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?document)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -633,30 +673,22 @@ get_video_files (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?video)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?video)) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?video nie:url(?video) "
 		                         "WHERE { "
 		                         "  ?video a nfo:Video ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?video)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?video)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -687,30 +719,22 @@ get_image_files (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?image)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?image)) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?image nie:url(?image) "
 		                         "WHERE { "
 		                         "  ?image a nfo:Image ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?image)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?image)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -741,30 +765,22 @@ get_music_files (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?song)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?song)) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?song nie:url(?song) "
 		                         "WHERE { "
 		                         "  ?song a nmm:MusicPiece ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?song)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?song)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -793,28 +809,20 @@ get_music_artists (TrackerSparqlConnection *connection,
 		                         "  nmm:artistName ?title ;"
 		                         "  fts:match \"%s\" . "
 		                         "} "
-		                         "ORDER BY ASC(?title) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(?title) ",
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT ?artist ?title "
-		                         "WHERE {"
-		                         "  ?artist a nmm:Artist ;"
-		                         "  nmm:artistName ?title . "
-		                         "} "
-		                         "ORDER BY ASC(?title) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT ?artist ?title "
+		                  "WHERE {"
+		                  "  ?artist a nmm:Artist ;"
+		                  "  nmm:artistName ?title . "
+		                  "} "
+		                  "ORDER BY ASC(?title) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -883,27 +891,19 @@ get_music_albums (TrackerSparqlConnection *connection,
 		                         "  ?album a nmm:MusicAlbum ;"
 		                         "  fts:match \"%s\" ."
 		                         "} "
-		                         "ORDER BY ASC(nie:title(?album)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:title(?album)) ",
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT ?album nie:title(?album) "
-		                         "WHERE {"
-		                         "  ?album a nmm:MusicAlbum ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?album)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT ?album nie:title(?album) "
+		                  "WHERE {"
+		                  "  ?album a nmm:MusicAlbum ."
+		                  "} "
+		                  "ORDER BY ASC(nie:title(?album)) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -972,28 +972,20 @@ get_bookmarks (TrackerSparqlConnection *connection,
 		                         "       nfo:bookmarks ?bookmark ."
 		                         "  ?urn fts:match \"%s\" . "
 		                         "} "
-		                         "ORDER BY ASC(nie:title(?urn)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:title(?urn)) ",
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT nie:title(?urn) nie:url(?bookmark) "
-		                         "WHERE {"
-		                         "  ?urn a nfo:Bookmark ;"
-		                         "       nfo:bookmarks ?bookmark ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?urn)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT nie:title(?urn) nie:url(?bookmark) "
+		                  "WHERE {"
+		                  "  ?urn a nfo:Bookmark ;"
+		                  "       nfo:bookmarks ?bookmark ."
+		                  "} "
+		                  "ORDER BY ASC(nie:title(?urn)) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -1055,27 +1047,19 @@ get_feeds (TrackerSparqlConnection *connection,
 		                         "  ?feed a mfo:FeedMessage ;"
 		                         "  fts:match \"%s\" . "
 		                         "} "
-		                         "ORDER BY ASC(nie:title(?feed)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:title(?feed)) ",
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT ?feed nie:title(?feed) "
-		                         "WHERE {"
-		                         "  ?feed a mfo:FeedMessage ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?feed)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT ?feed nie:title(?feed) "
+		                  "WHERE {"
+		                  "  ?feed a mfo:FeedMessage ."
+		                  "} "
+		                  "ORDER BY ASC(nie:title(?feed)) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -1137,29 +1121,21 @@ get_software (TrackerSparqlConnection *connection,
 		                         "  ?soft a nfo:Software ;"
 		                         "  fts:match \"%s\" . "
 		                         "} "
-		                         "ORDER BY ASC(nie:title(?soft)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:title(?soft)) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT ?soft nie:title(?soft) "
-		                         "WHERE {"
-		                         "  ?soft a nfo:Software ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?soft)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT ?soft nie:title(?soft) "
+		                  "WHERE {"
+		                  "  ?soft a nfo:Software ."
+		                  "} "
+		                  "ORDER BY ASC(nie:title(?soft)) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -1221,27 +1197,19 @@ get_software_categories (TrackerSparqlConnection *connection,
 		                         "  ?cat a nfo:SoftwareCategory ;"
 		                         "  fts:match \"%s\" . "
 		                         "} "
-		                         "ORDER BY ASC(nie:title(?cat)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         fts,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:title(?cat)) ",
+		                         fts);
 	} else {
-		query = g_strdup_printf ("SELECT ?cat nie:title(?cat) "
-		                         "WHERE {"
-		                         "  ?cat a nfo:SoftwareCategory ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?cat)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         search_offset,
-		                         search_limit);
+		query = g_strdup ("SELECT ?cat nie:title(?cat) "
+		                  "WHERE {"
+		                  "  ?cat a nfo:SoftwareCategory ."
+		                  "} "
+		                  "ORDER BY ASC(nie:title(?cat)) ");
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
@@ -1307,28 +1275,20 @@ get_files (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?u)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?u)) ",
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?u nie:url(?u) "
 		                         "WHERE { "
 		                         "  ?u a nie:InformationElement ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?u)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?u)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -1359,28 +1319,20 @@ get_folders (TrackerSparqlConnection *connection,
 		                         "  fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?u)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
+		                         "ORDER BY ASC(nie:url(?u)) ",
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT ?u nie:url(?u) "
 		                         "WHERE { "
 		                         "  ?u a nfo:Folder ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY ASC(nie:url(?u)) "
-		                         "OFFSET %d "
-		                         "LIMIT %d",
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         "ORDER BY ASC(nie:url(?u)) ",
+		                         show_all_str);
 	}
 
-	success = get_files_results (connection, query, search_limit, details);
+	success = get_files_results (connection, query, search_offset, search_limit, details);
 	g_free (query);
 	g_free (fts);
 
@@ -1417,33 +1369,27 @@ get_all_by_search (TrackerSparqlConnection *connection,
 		                         "  %s"
 		                         "} "
 		                         "GROUP BY nie:url(?s) "
-		                         "ORDER BY nie:url(?s) "
-		                         "OFFSET %d LIMIT %d",
+		                         "ORDER BY nie:url(?s) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	} else {
 		query = g_strdup_printf ("SELECT tracker:coalesce (nie:url (?s), ?s) fts:snippet(?document, \"%s\", \"%s\") "
 		                         "WHERE {"
 		                         "  ?s fts:match \"%s\" ."
 		                         "  %s"
 		                         "} "
-		                         "ORDER BY nie:url(?s) "
-		                         "OFFSET %d LIMIT %d",
+		                         "ORDER BY nie:url(?s) ",
 		                         disable_color ? "" : SNIPPET_BEGIN,
 		                         disable_color ? "" : SNIPPET_END,
 		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         search_limit);
+		                         show_all_str);
 	}
 
 	g_free (fts);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	cursor = search_query (connection, query, search_offset, search_limit, &error);
 	g_free (query);
 
 	if (error) {
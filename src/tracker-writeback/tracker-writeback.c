@@ -45,6 +45,7 @@ typedef struct {
 	GList *writeback_handlers;
 	guint cancel_id;
 	GError *error;
+	guint superseded : 1;
 } WritebackData;
 
 typedef struct {
@@ -214,11 +215,15 @@ task_cancellable_cancelled_cb (GCancellable  *cancellable,
 
 	g_mutex_lock (&priv->mutex);
 
+	/* The current task is not interrupted, _exit()ing here would
+	 * lose every other queued request with the process. File modules
+	 * write to a copy that is renamed over the file, so the file is
+	 * left consistent either way.
+	 */
 	if (priv->current == data) {
-		g_message ("Cancelled writeback task for '%s' was currently being "
-		           "processed, _exit()ing immediately",
+		g_message ("Cancelled writeback task for '%s' is currently being "
+		           "processed, not interrupting it",
 		           data->subject);
-		_exit (0);
 	}
 
 	g_mutex_unlock (&priv->mutex);
@@ -246,6 +251,7 @@ writeback_data_new (TrackerController       *controller,
 	data->writeback_handlers = writeback_handlers;
 	data->request = request;
 	data->error = NULL;
+	data->superseded = FALSE;
 
 	data->cancel_id = g_cancellable_connect (data->cancellable,
 	                                         G_CALLBACK (task_cancellable_cancelled_cb),
@@ -438,7 +444,9 @@ perform_writeback_cb (gpointer user_data)
 	tracker_dbus_request_end (data->request, NULL);
 
 	g_mutex_lock (&priv->mutex);
-	priv->current = NULL;
+	if (priv->current == data) {
+		priv->current = NULL;
+	}
 	g_mutex_unlock (&priv->mutex);
 
 	writeback_data_free (data);
@@ -446,6 +454,18 @@ perform_writeback_cb (gpointer user_data)
 	return FALSE;
 }
 
+static void
+writeback_data_finish (WritebackData *data)
+{
+	GSource *source;
+
+	/* Finish in the controller thread, which owns the task list */
+	source = g_idle_source_new ();
+	g_source_set_callback (source, perform_writeback_cb, data, NULL);
+	g_source_attach (source, data->controller->priv->context);
+	g_source_unref (source);
+}
+
 static gboolean
 sparql_rdf_types_match (const gchar * const *module_types,
                         const gchar * const *rdf_types)
@@ -476,11 +496,23 @@ io_writeback_job (GTask        *task,
 	GError *error = NULL;
 	gboolean handled = FALSE;
 	GList *writeback_handlers;
+	gboolean superseded;
 
 	g_mutex_lock (&priv->mutex);
-	priv->current = data;
+	superseded = data->superseded;
+	if (!superseded) {
+		priv->current = data;
+	}
 	g_mutex_unlock (&priv->mutex);
 
+	if (superseded) {
+		/* A later request writes this file with all its metadata */
+		g_message ("Skipping writeback for '%s', superseded by a later request",
+		           data->subject);
+		writeback_data_finish (data);
+		return;
+	}
+
 	writeback_handlers = data->writeback_handlers;
 
 	while (writeback_handlers) {
@@ -506,7 +538,7 @@ io_writeback_job (GTask        *task,
 		g_clear_error (&error);
 	}
 
-	g_idle_add (perform_writeback_cb, data);
+	writeback_data_finish (data);
 }
 
 static void
@@ -580,6 +612,7 @@ handle_method_call_perform_writeback (TrackerController     *controller,
 
 	if (writeback_handlers != NULL) {
 		WritebackData *data;
+		GList *l;
 		GTask *task;
 
 		data = writeback_data_new (controller,
@@ -589,6 +622,23 @@ handle_method_call_perform_writeback (TrackerController     *controller,
 		                           results,
 		                           invocation,
 		                           request);
+
+		/* Consecutive edits of a file only need the last request
+		 * written, it carries all the metadata to write back */
+		g_mutex_lock (&priv->mutex);
+
+		for (l = priv->ongoing_tasks; l; l = l->next) {
+			WritebackData *other = l->data;
+
+			if (other != priv->current &&
+			    g_strcmp0 (other->subject, subject) == 0) {
+				other->superseded = TRUE;
+			}
+		}
+
+		priv->ongoing_tasks = g_list_prepend (priv->ongoing_tasks, data);
+		g_mutex_unlock (&priv->mutex);
+
 		task = g_task_new (controller, data->cancellable, NULL, NULL);
 
 		/* No need to free data here, it's done in the callback. */
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026, agent <agent@local>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+# 02110-1301, USA.
+#
+"""
+Compares two directories of results written by "make benchmark"
+and lists the results that changed more than a threshold.
+
+Exits with 1 if any result regressed, so it can be used in scripts:
+
+  compare-results.py [--threshold=PERCENT] BASELINE-DIR RESULTS-DIR
+"""
+
+import glob
+import json
+import optparse
+import os
+import sys
+
+
+def load_results(directory):
+    results = {}
+
+    for path in sorted(glob.glob(os.path.join(directory, '*.json'))):
+        with open(path) as f:
+            report = json.load(f)
+
+        for result in report['results']:
+            key = '%s:%s' % (report['suite'], result['name'])
+            results[key] = result
+
+    return results
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] BASELINE-DIR RESULTS-DIR')
+    parser.add_option('-t', '--threshold', type='float', default=5.0,
+                      help='change in percent reported as a regression (default: 5)')
+    options, args = parser.parse_args()
+
+    if len(args) != 2:
+        parser.error('two result directories must be given')
+
+    baseline = load_results(args[0])
+    current = load_results(args[1])
+    n_regressions = 0
+
+    for key in sorted(baseline):
+        if key not in current:
+            print('%-40s missing' % key)
+            continue
+
+        old = baseline[key]['value']
+        new = current[key]['value']
+        unit = current[key]['unit']
+
+        if old == 0:
+            continue
+
+        change = (new - old) * 100.0 / old
+
+        if current[key]['better'] == 'lower':
+            change = -change
+
+        if change < -options.threshold:
+            status = 'REGRESSION'
+            n_regressions += 1
+        elif change > options.threshold:
+            status = 'improvement'
+        else:
+            status = ''
+
+        print('%-40s %12.3f -> %12.3f %-10s %+7.1f%% %s' %
+              (key, old, new, unit, change, status))
+
+    for key in sorted(set(current) - set(baseline)):
+        print('%-40s new' % key)
+
+    return 1 if n_regressions > 0 else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
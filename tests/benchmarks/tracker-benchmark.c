@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tracker-benchmark.h"
+
+struct _TrackerBenchmarkReport {
+	gchar *suite;
+	GString *parameters;
+	GString *results;
+};
+
+static gchar *output_filename;
+static gint seed = TRACKER_BENCHMARK_DEFAULT_SEED;
+
+static const GOptionEntry common_options[] = {
+	{
+		"output", 'o', 0,
+		G_OPTION_ARG_FILENAME, &output_filename,
+		"Write the results as JSON to FILE",
+		"FILE"
+	},
+	{
+		"seed", 0, 0,
+		G_OPTION_ARG_INT, &seed,
+		"Seed of the generated data, only compare runs with the same seed (default: 42)",
+		NULL
+	},
+	{ NULL }
+};
+
+gboolean
+tracker_benchmark_parse_options (gint                 *argc,
+                                 gchar              ***argv,
+                                 const GOptionEntry   *entries,
+                                 const gchar          *description)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	gboolean retval;
+
+	setlocale (LC_ALL, "");
+
+	context = g_option_context_new (description);
+
+	if (entries) {
+		g_option_context_add_main_entries (context, entries, NULL);
+	}
+
+	g_option_context_add_main_entries (context, common_options, NULL);
+
+	retval = g_option_context_parse (context, argc, argv, &error);
+
+	if (!retval) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+	}
+
+	g_option_context_free (context);
+
+	return retval;
+}
+
+guint32
+tracker_benchmark_get_seed (void)
+{
+	return (guint32) seed;
+}
+
+gchar *
+tracker_benchmark_make_tmp_dir (const gchar *name)
+{
+	GError *error = NULL;
+	gchar *template, *path;
+
+	template = g_strdup_printf ("%s-XXXXXX", name);
+	path = g_dir_make_tmp (template, &error);
+	g_free (template);
+
+	if (!path) {
+		g_printerr ("Could not create temporary directory: %s\n", error->message);
+		g_error_free (error);
+	}
+
+	return path;
+}
+
+void
+tracker_benchmark_remove_dir (const gchar *path)
+{
+	const gchar *name;
+	GDir *dir;
+
+	dir = g_dir_open (path, 0, NULL);
+
+	while (dir && (name = g_dir_read_name (dir)) != NULL) {
+		gchar *child;
+
+		child = g_build_filename (path, name, NULL);
+
+		if (g_file_test (child, G_FILE_TEST_IS_DIR) &&
+		    !g_file_test (child, G_FILE_TEST_IS_SYMLINK)) {
+			tracker_benchmark_remove_dir (child);
+		} else {
+			g_unlink (child);
+		}
+
+		g_free (child);
+	}
+
+	if (dir) {
+		g_dir_close (dir);
+	}
+
+	g_rmdir (path);
+}
+
+static void
+append_json_string (GString     *str,
+                    const gchar *value)
+{
+	const gchar *p;
+
+	g_string_append_c (str, '"');
+
+	for (p = value; *p; p++) {
+		switch (*p) {
+		case '"':
+			g_string_append (str, "\\\"");
+			break;
+		case '\\':
+			g_string_append (str, "\\\\");
+			break;
+		case '\n':
+			g_string_append (str, "\\n");
+			break;
+		default:
+			if ((guchar) *p < 0x20) {
+				g_string_append_printf (str, "\\u%04x", (guint) *p);
+			} else {
+				g_string_append_c (str, *p);
+			}
+		}
+	}
+
+	g_string_append_c (str, '"');
+}
+
+static void
+append_json_double (GString *str,
+                    gdouble  value)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	/* The locale must not change the decimal separator */
+	g_ascii_formatd (buf, sizeof (buf), "%.6g", value);
+	g_string_append (str, buf);
+}
+
+static void
+report_begin_result (TrackerBenchmarkReport *report,
+                     const gchar            *name,
+                     const gchar            *unit,
+                     gboolean                higher_is_better)
+{
+	if (report->results->len > 0) {
+		g_string_append_c (report->results, ',');
+	}
+
+	g_string_append (report->results, "\n    { \"name\": ");
+	append_json_string (report->results, name);
+	g_string_append (report->results, ", \"unit\": ");
+	append_json_string (report->results, unit);
+	g_string_append_printf (report->results, ", \"better\": \"%s\"",
+	                        higher_is_better ? "higher" : "lower");
+}
+
+TrackerBenchmarkReport *
+tracker_benchmark_report_new (const gchar *suite)
+{
+	TrackerBenchmarkReport *report;
+
+	report = g_slice_new0 (TrackerBenchmarkReport);
+	report->suite = g_strdup (suite);
+	report->parameters = g_string_new (NULL);
+	report->results = g_string_new (NULL);
+
+	tracker_benchmark_report_add_parameter (report, "seed", seed);
+
+	return report;
+}
+
+void
+tracker_benchmark_report_free (TrackerBenchmarkReport *report)
+{
+	g_string_free (report->parameters, TRUE);
+	g_string_free (report->results, TRUE);
+	g_free (report->suite);
+	g_slice_free (TrackerBenchmarkReport, report);
+}
+
+void
+tracker_benchmark_report_add_parameter (TrackerBenchmarkReport *report,
+                                        const gchar            *name,
+                                        gint64                  value)
+{
+	if (report->parameters->len > 0) {
+		g_string_append (report->parameters, ", ");
+	}
+
+	append_json_string (report->parameters, name);
+	g_string_append_printf (report->parameters, ": %" G_GINT64_FORMAT, value);
+}
+
+void
+tracker_benchmark_report_add_rate (TrackerBenchmarkReport *report,
+                                   const gchar            *name,
+                                   gdouble                 count,
+                                   gdouble                 seconds,
+                                   const gchar            *unit)
+{
+	gchar *rate_unit;
+	gdouble rate;
+
+	rate = seconds > 0 ? count / seconds : 0;
+	rate_unit = g_strdup_printf ("%s/s", unit);
+
+	g_print ("%-28s: %.0f %s in %.3f s, %.1f %s\n",
+	         name, count, unit, seconds, rate, rate_unit);
+
+	report_begin_result (report, name, rate_unit, TRUE);
+	g_string_append (report->results, ", \"value\": ");
+	append_json_double (report->results, rate);
+	g_string_append (report->results, ", \"count\": ");
+	append_json_double (report->results, count);
+	g_string_append (report->results, ", \"seconds\": ");
+	append_json_double (report->results, seconds);
+	g_string_append (report->results, " }");
+
+	g_free (rate_unit);
+}
+
+void
+tracker_benchmark_report_add_value (TrackerBenchmarkReport *report,
+                                    const gchar            *name,
+                                    gdouble                 value,
+                                    const gchar            *unit,
+                                    gboolean                higher_is_better)
+{
+	g_print ("%-28s: %.3f %s\n", name, value, unit);
+
+	report_begin_result (report, name, unit, higher_is_better);
+	g_string_append (report->results, ", \"value\": ");
+	append_json_double (report->results, value);
+	g_string_append (report->results, " }");
+}
+
+void
+tracker_benchmark_report_add_time (TrackerBenchmarkReport *report,
+                                   const gchar            *name,
+                                   gdouble                 seconds)
+{
+	tracker_benchmark_report_add_value (report, name, seconds, "s", FALSE);
+}
+
+static gint
+compare_double (gconstpointer a,
+                gconstpointer b)
+{
+	gdouble da = *((const gdouble *) a);
+	gdouble db = *((const gdouble *) b);
+
+	return (da > db) - (da < db);
+}
+
+static gdouble
+percentile (GArray  *sorted,
+            gdouble  fraction)
+{
+	guint index;
+
+	index = (guint) (fraction * (sorted->len - 1) + 0.5);
+
+	return g_array_index (sorted, gdouble, index);
+}
+
+/**
+ * tracker_benchmark_report_add_latencies:
+ * @report: a #TrackerBenchmarkReport
+ * @name: what was measured
+ * @latencies: array of #gdouble, in milliseconds
+ *
+ * Adds the distribution of @latencies to @report, the median is
+ * used as the value to compare between runs. @latencies is sorted.
+ **/
+void
+tracker_benchmark_report_add_latencies (TrackerBenchmarkReport *report,
+                                        const gchar            *name,
+                                        GArray                 *latencies)
+{
+	gdouble total = 0, mean, p50, p95, p99, max;
+	guint i;
+
+	if (latencies->len == 0) {
+		g_print ("%-28s: no samples\n", name);
+		return;
+	}
+
+	g_array_sort (latencies, compare_double);
+
+	for (i = 0; i < latencies->len; i++) {
+		total += g_array_index (latencies, gdouble, i);
+	}
+
+	mean = total / latencies->len;
+	p50 = percentile (latencies, 0.5);
+	p95 = percentile (latencies, 0.95);
+	p99 = percentile (latencies, 0.99);
+	max = g_array_index (latencies, gdouble, latencies->len - 1);
+
+	g_print ("%-28s: mean %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+	         name, mean, p50, p95, p99, max);
+
+	report_begin_result (report, name, "ms", FALSE);
+	g_string_append (report->results, ", \"value\": ");
+	append_json_double (report->results, p50);
+	g_string_append_printf (report->results, ", \"count\": %u", latencies->len);
+	g_string_append (report->results, ", \"mean\": ");
+	append_json_double (report->results, mean);
+	g_string_append (report->results, ", \"p95\": ");
+	append_json_double (report->results, p95);
+	g_string_append (report->results, ", \"p99\": ");
+	append_json_double (report->results, p99);
+	g_string_append (report->results, ", \"max\": ");
+	append_json_double (report->results, max);
+	g_string_append (report->results, " }");
+}
+
+/**
+ * tracker_benchmark_report_write:
+ * @report: a #TrackerBenchmarkReport
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes @report to the file given with --output, if any.
+ *
+ * Returns: %FALSE if the file could not be written.
+ **/
+gboolean
+tracker_benchmark_report_write (TrackerBenchmarkReport  *report,
+                                GError                 **error)
+{
+	GString *json;
+	gboolean retval;
+
+	if (!output_filename) {
+		return TRUE;
+	}
+
+	json = g_string_new ("{\n  \"suite\": ");
+	append_json_string (json, report->suite);
+	g_string_append (json, ",\n  \"version\": ");
+	append_json_string (json, PACKAGE_VERSION);
+	g_string_append_printf (json, ",\n  \"parameters\": { %s },", report->parameters->str);
+	g_string_append_printf (json, "\n  \"results\": [%s\n  ]\n}\n", report->results->str);
+
+	retval = g_file_set_contents (output_filename, json->str, json->len, error);
+	g_string_free (json, TRUE);
+
+	return retval;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_BENCHMARK_H__
+#define __TRACKER_BENCHMARK_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define TRACKER_BENCHMARK_DEFAULT_SEED 42
+
+typedef struct _TrackerBenchmarkReport TrackerBenchmarkReport;
+
+gboolean                tracker_benchmark_parse_options      (gint                    *argc,
+                                                              gchar                 ***argv,
+                                                              const GOptionEntry      *entries,
+                                                              const gchar             *description);
+guint32                 tracker_benchmark_get_seed           (void);
+
+gchar                  *tracker_benchmark_make_tmp_dir       (const gchar             *name);
+void                    tracker_benchmark_remove_dir         (const gchar             *path);
+
+TrackerBenchmarkReport *tracker_benchmark_report_new         (const gchar             *suite);
+void                    tracker_benchmark_report_free        (TrackerBenchmarkReport  *report);
+void                    tracker_benchmark_report_add_parameter (TrackerBenchmarkReport *report,
+                                                              const gchar             *name,
+                                                              gint64                   value);
+void                    tracker_benchmark_report_add_rate    (TrackerBenchmarkReport  *report,
+                                                              const gchar             *name,
+                                                              gdouble                  count,
+                                                              gdouble                  seconds,
+                                                              const gchar             *unit);
+void                    tracker_benchmark_report_add_value   (TrackerBenchmarkReport  *report,
+                                                              const gchar             *name,
+                                                              gdouble                  value,
+                                                              const gchar             *unit,
+                                                              gboolean                 higher_is_better);
+void                    tracker_benchmark_report_add_time    (TrackerBenchmarkReport  *report,
+                                                              const gchar             *name,
+                                                              gdouble                  seconds);
+void                    tracker_benchmark_report_add_latencies (TrackerBenchmarkReport *report,
+                                                              const gchar             *name,
+                                                              GArray                  *latencies);
+gboolean                tracker_benchmark_report_write       (TrackerBenchmarkReport  *report,
+                                                              GError                 **error);
+
+G_END_DECLS
+
+#endif /* __TRACKER_BENCHMARK_H__ */
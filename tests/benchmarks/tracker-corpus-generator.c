@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include "tracker-benchmark.h"
+#include "tracker-corpus.h"
+
+/* Writes the same file tree the benchmarks use, to index it
+ * with a running tracker-miner-fs or tracker-extract */
+
+static gint n_files = 10000;
+static gint files_per_dir = 100;
+static gchar **directories;
+
+static const GOptionEntry options[] = {
+	{
+		"files", 'f', 0,
+		G_OPTION_ARG_INT, &n_files,
+		"Number of generated files (default: 10000)",
+		NULL
+	},
+	{
+		"files-per-dir", 'p', 0,
+		G_OPTION_ARG_INT, &files_per_dir,
+		"Files in each directory (default: 100)",
+		NULL
+	},
+	{
+		G_OPTION_REMAINING, 0, 0,
+		G_OPTION_ARG_FILENAME_ARRAY, &directories,
+		"Directory to create the files in",
+		"DIRECTORY"
+	},
+	{ NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+	TrackerCorpus *corpus;
+	GPtrArray *files;
+	GError *error = NULL;
+	guint counts[TRACKER_CORPUS_N_FILE_TYPES] = { 0 };
+	guint64 n_bytes = 0;
+	guint i;
+
+	if (!tracker_benchmark_parse_options (&argc, &argv, options,
+	                                      "- Generate a deterministic tree of documents, music and other files")) {
+		return EXIT_FAILURE;
+	}
+
+	if (!directories || !directories[0] || directories[1]) {
+		g_printerr ("One directory must be given\n");
+		return EXIT_FAILURE;
+	}
+
+	if (n_files < 1 || files_per_dir < 1) {
+		g_printerr ("File counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	corpus = tracker_corpus_new (tracker_benchmark_get_seed ());
+	files = tracker_corpus_write_tree (corpus, directories[0], n_files, files_per_dir, &error);
+	tracker_corpus_free (corpus);
+
+	if (!files) {
+		g_printerr ("Could not write the files: %s\n", error->message);
+		g_error_free (error);
+		g_strfreev (directories);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < files->len; i++) {
+		TrackerCorpusFile *file = g_ptr_array_index (files, i);
+
+		counts[file->type]++;
+		n_bytes += file->size;
+	}
+
+	g_print ("%u documents, %u music files and %u other files, %" G_GUINT64_FORMAT " bytes written to '%s'\n",
+	         counts[TRACKER_CORPUS_FILE_DOCUMENT],
+	         counts[TRACKER_CORPUS_FILE_MUSIC],
+	         counts[TRACKER_CORPUS_FILE_OTHER],
+	         n_bytes, directories[0]);
+
+	g_ptr_array_unref (files);
+	g_strfreev (directories);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tracker-corpus.h"
+
+/* Everything is generated from a GRand, which yields the same
+ * sequence for a seed on every platform, so runs with the same
+ * seed index byte-identical data */
+
+#define DIRS_PER_LEVEL     16
+
+/* MPEG-1 layer III, 128 kbps, 44.1 kHz, no padding */
+#define MPEG_FRAME_HEADER  "\xff\xfb\x90\x00"
+#define MPEG_FRAME_SIZE    417
+#define MPEG_FRAMES_PER_S  38
+
+#define N_ARTISTS          200
+#define N_ALBUMS           1000
+
+struct _TrackerCorpus {
+	GRand *rand;
+};
+
+/* Common words first, picks are skewed towards them the way
+ * natural text is. Accented ones exercise unaccenting. */
+static const gchar *words[] = {
+	"the", "of", "and", "to", "in", "is", "for", "that", "with", "on",
+	"file", "music", "document", "picture", "video", "search", "index",
+	"metadata", "album", "artist", "title", "folder", "desktop", "mail",
+	"contact", "calendar", "event", "project", "report", "meeting",
+	"summer", "winter", "holiday", "garden", "kitchen", "journey",
+	"mountain", "river", "ocean", "forest", "village", "market",
+	"library", "station", "bridge", "tower", "castle", "harbour",
+	"morning", "evening", "yesterday", "tomorrow", "quickly", "slowly",
+	"between", "through", "without", "against", "beneath", "beyond",
+	"guitar", "piano", "violin", "trumpet", "drummer", "chorus",
+	"symphony", "concerto", "ballad", "anthem", "lullaby", "overture",
+	"invoice", "contract", "proposal", "agenda", "minutes", "budget",
+	"schedule", "deadline", "release", "version", "feature", "request",
+	"database", "journal", "crawler", "monitor", "extractor", "ontology",
+	"sparql", "triple", "resource", "property", "class", "graph",
+	"yellow", "purple", "orange", "silver", "golden", "crimson",
+	"elephant", "giraffe", "penguin", "dolphin", "sparrow", "tortoise",
+	"running", "swimming", "climbing", "dancing", "singing", "reading",
+	"café", "naïve", "résumé", "façade", "jalapeño", "Ångström",
+	"über", "straße", "crème", "brûlée", "déjà", "señor",
+	"1984", "2014", "42", "365", "1000", "7"
+};
+
+static const gchar *genres[] = {
+	"Rock", "Jazz", "Classical", "Pop", "Electronic", "Folk", "Blues", "Metal"
+};
+
+static const gchar *extensions[] = {
+	"txt", "mp3", "bin"
+};
+
+static const gchar *mimetypes[] = {
+	"text/plain", "audio/mpeg", "application/octet-stream"
+};
+
+TrackerCorpus *
+tracker_corpus_new (guint32 seed)
+{
+	TrackerCorpus *corpus;
+
+	corpus = g_slice_new0 (TrackerCorpus);
+	corpus->rand = g_rand_new_with_seed (seed);
+
+	return corpus;
+}
+
+void
+tracker_corpus_free (TrackerCorpus *corpus)
+{
+	g_rand_free (corpus->rand);
+	g_slice_free (TrackerCorpus, corpus);
+}
+
+const gchar *
+tracker_corpus_word (TrackerCorpus *corpus)
+{
+	gdouble r;
+
+	r = g_rand_double (corpus->rand);
+
+	return words[(guint) (r * r * G_N_ELEMENTS (words))];
+}
+
+gchar *
+tracker_corpus_text (TrackerCorpus *corpus,
+                     guint          n_words)
+{
+	GString *text;
+	guint i;
+
+	text = g_string_new (NULL);
+
+	for (i = 0; i < n_words; i++) {
+		const gchar *word;
+
+		word = tracker_corpus_word (corpus);
+
+		if (i % 12 == 0) {
+			/* Sentence start */
+			g_string_append_unichar (text, g_unichar_toupper (g_utf8_get_char (word)));
+			g_string_append (text, g_utf8_next_char (word));
+		} else {
+			g_string_append (text, word);
+		}
+
+		if (i == n_words - 1 || i % 12 == 11) {
+			g_string_append (text, i % 48 == 47 ? ".\n\n" : ". ");
+		} else {
+			g_string_append_c (text, ' ');
+		}
+	}
+
+	return g_string_free (text, FALSE);
+}
+
+static void
+append_syncsafe (GByteArray *data,
+                 guint32     value)
+{
+	guint8 bytes[4];
+
+	bytes[0] = (value >> 21) & 0x7f;
+	bytes[1] = (value >> 14) & 0x7f;
+	bytes[2] = (value >> 7) & 0x7f;
+	bytes[3] = value & 0x7f;
+
+	g_byte_array_append (data, bytes, 4);
+}
+
+static void
+append_text_frame (GByteArray  *data,
+                   const gchar *id,
+                   const gchar *text)
+{
+	guint8 flags[2] = { 0, 0 };
+	guint8 encoding = 3; /* UTF-8 */
+	gsize len;
+
+	len = strlen (text);
+
+	g_byte_array_append (data, (const guint8 *) id, 4);
+	append_syncsafe (data, len + 1);
+	g_byte_array_append (data, flags, 2);
+	g_byte_array_append (data, &encoding, 1);
+	g_byte_array_append (data, (const guint8 *) text, len);
+}
+
+/**
+ * tracker_corpus_music:
+ * @corpus: a #TrackerCorpus
+ * @index: number of the song, artist and album are derived from it
+ * @length: return location for the size of the data
+ *
+ * Generates a silent MP3 of a few seconds with an ID3v2.4 tag.
+ *
+ * Returns: the file contents, free with g_free()
+ **/
+guint8 *
+tracker_corpus_music (TrackerCorpus *corpus,
+                      guint          index,
+                      gsize         *length)
+{
+	GByteArray *tag, *data;
+	guint8 header[6] = { 'I', 'D', '3', 4, 0, 0 };
+	guint8 frame[MPEG_FRAME_SIZE] = { 0 };
+	gchar *str;
+	guint i, n_frames;
+
+	tag = g_byte_array_new ();
+
+	str = g_strdup_printf ("%s %s", tracker_corpus_word (corpus), tracker_corpus_word (corpus));
+	append_text_frame (tag, "TIT2", str);
+	g_free (str);
+
+	str = g_strdup_printf ("Artist %u", index % N_ARTISTS);
+	append_text_frame (tag, "TPE1", str);
+	g_free (str);
+
+	str = g_strdup_printf ("Album %u", index % N_ALBUMS);
+	append_text_frame (tag, "TALB", str);
+	g_free (str);
+
+	str = g_strdup_printf ("%u", index % 12 + 1);
+	append_text_frame (tag, "TRCK", str);
+	g_free (str);
+
+	str = g_strdup_printf ("%u", 1960 + index % 55);
+	append_text_frame (tag, "TDRC", str);
+	g_free (str);
+
+	append_text_frame (tag, "TCON", genres[index % G_N_ELEMENTS (genres)]);
+
+	data = g_byte_array_sized_new (10 + tag->len + 6 * MPEG_FRAMES_PER_S * MPEG_FRAME_SIZE);
+
+	g_byte_array_append (data, header, 6);
+	append_syncsafe (data, tag->len);
+	g_byte_array_append (data, tag->data, tag->len);
+	g_byte_array_free (tag, TRUE);
+
+	memcpy (frame, MPEG_FRAME_HEADER, 4);
+	n_frames = g_rand_int_range (corpus->rand, 2, 7) * MPEG_FRAMES_PER_S;
+
+	for (i = 0; i < n_frames; i++) {
+		g_byte_array_append (data, frame, MPEG_FRAME_SIZE);
+	}
+
+	*length = data->len;
+
+	return g_byte_array_free (data, FALSE);
+}
+
+static guint8 *
+generate_other (TrackerCorpus *corpus,
+                gsize         *length)
+{
+	guint8 *data;
+	gsize i;
+
+	*length = g_rand_int_range (corpus->rand, 1024, 16384);
+	data = g_malloc (*length);
+
+	for (i = 0; i < *length; i++) {
+		data[i] = g_rand_int (corpus->rand) & 0xff;
+	}
+
+	return data;
+}
+
+static void
+corpus_file_free (TrackerCorpusFile *file)
+{
+	g_free (file->path);
+	g_slice_free (TrackerCorpusFile, file);
+}
+
+/**
+ * tracker_corpus_write_tree:
+ * @corpus: a #TrackerCorpus
+ * @root: directory to create the files in
+ * @n_files: number of files
+ * @files_per_dir: files in each directory
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes a two level tree of documents, tagged music and
+ * other files, roughly in a 5:3:2 proportion.
+ *
+ * Returns: a #GPtrArray of #TrackerCorpusFile, or %NULL on error.
+ **/
+GPtrArray *
+tracker_corpus_write_tree (TrackerCorpus  *corpus,
+                           const gchar    *root,
+                           guint           n_files,
+                           guint           files_per_dir,
+                           GError        **error)
+{
+	GPtrArray *files;
+	guint i, n_songs = 0;
+
+	g_return_val_if_fail (files_per_dir > 0, NULL);
+
+	files = g_ptr_array_new_with_free_func ((GDestroyNotify) corpus_file_free);
+
+	for (i = 0; i < n_files; i++) {
+		TrackerCorpusFile *file;
+		gchar *dir, *data = NULL;
+		guint dir_index, pick;
+		gsize length;
+
+		dir_index = i / files_per_dir;
+		dir = g_strdup_printf ("%s/%02u/%02u", root,
+		                       dir_index / DIRS_PER_LEVEL,
+		                       dir_index % DIRS_PER_LEVEL);
+
+		if (i % files_per_dir == 0 &&
+		    g_mkdir_with_parents (dir, 0755) != 0) {
+			g_set_error (error, G_FILE_ERROR,
+			             g_file_error_from_errno (errno),
+			             "Could not create '%s'", dir);
+			g_free (dir);
+			g_ptr_array_unref (files);
+			return NULL;
+		}
+
+		file = g_slice_new0 (TrackerCorpusFile);
+		pick = g_rand_int_range (corpus->rand, 0, 10);
+
+		if (pick < 5) {
+			file->type = TRACKER_CORPUS_FILE_DOCUMENT;
+			data = tracker_corpus_text (corpus, g_rand_int_range (corpus->rand, 50, 2000));
+			length = strlen (data);
+		} else if (pick < 8) {
+			file->type = TRACKER_CORPUS_FILE_MUSIC;
+			data = (gchar *) tracker_corpus_music (corpus, n_songs++, &length);
+		} else {
+			file->type = TRACKER_CORPUS_FILE_OTHER;
+			data = (gchar *) generate_other (corpus, &length);
+		}
+
+		file->path = g_strdup_printf ("%s/file-%06u.%s", dir, i,
+		                              extensions[file->type]);
+		file->size = length;
+		g_ptr_array_add (files, file);
+		g_free (dir);
+
+		if (!g_file_set_contents (file->path, data, length, error)) {
+			g_free (data);
+			g_ptr_array_unref (files);
+			return NULL;
+		}
+
+		g_free (data);
+	}
+
+	return files;
+}
+
+const gchar *
+tracker_corpus_file_type_get_mimetype (TrackerCorpusFileType type)
+{
+	g_return_val_if_fail (type < TRACKER_CORPUS_N_FILE_TYPES, NULL);
+
+	return mimetypes[type];
+}
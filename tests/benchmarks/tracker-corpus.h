@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_CORPUS_H__
+#define __TRACKER_CORPUS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _TrackerCorpus TrackerCorpus;
+
+typedef enum {
+	TRACKER_CORPUS_FILE_DOCUMENT,
+	TRACKER_CORPUS_FILE_MUSIC,
+	TRACKER_CORPUS_FILE_OTHER,
+	TRACKER_CORPUS_N_FILE_TYPES
+} TrackerCorpusFileType;
+
+typedef struct {
+	gchar *path;
+	TrackerCorpusFileType type;
+	gsize size;
+} TrackerCorpusFile;
+
+TrackerCorpus *tracker_corpus_new                    (guint32                 seed);
+void           tracker_corpus_free                   (TrackerCorpus          *corpus);
+
+const gchar   *tracker_corpus_word                   (TrackerCorpus          *corpus);
+gchar         *tracker_corpus_text                   (TrackerCorpus          *corpus,
+                                                      guint                   n_words);
+guint8        *tracker_corpus_music                  (TrackerCorpus          *corpus,
+                                                      guint                   index,
+                                                      gsize                  *length);
+
+GPtrArray     *tracker_corpus_write_tree             (TrackerCorpus          *corpus,
+                                                      const gchar            *root,
+                                                      guint                   n_files,
+                                                      guint                   files_per_dir,
+                                                      GError                **error);
+
+const gchar   *tracker_corpus_file_type_get_mimetype (TrackerCorpusFileType   type);
+
+G_END_DECLS
+
+#endif /* __TRACKER_CORPUS_H__ */
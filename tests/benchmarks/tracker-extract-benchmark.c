@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gmodule.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+#include "tracker-main.h"
+
+#include "tracker-benchmark.h"
+#include "tracker-corpus.h"
+
+#define MODULES_DIR TOP_BUILDDIR "/src/tracker-extract/.libs"
+
+static gchar *modules_dir;
+static gint n_files = 2000;
+static gint n_iterations = 3;
+
+static const GOptionEntry options[] = {
+	{
+		"modules-dir", 'm', 0,
+		G_OPTION_ARG_FILENAME, &modules_dir,
+		"Directory with the extractor modules (default: the build tree)",
+		NULL
+	},
+	{
+		"files", 'f', 0,
+		G_OPTION_ARG_INT, &n_files,
+		"Number of generated files (default: 2000)",
+		NULL
+	},
+	{
+		"iterations", 'i', 0,
+		G_OPTION_ARG_INT, &n_iterations,
+		"Times every file is extracted (default: 3)",
+		NULL
+	},
+	{ NULL }
+};
+
+/* Module handling each kind of generated file */
+static const struct {
+	const gchar *name;
+	const gchar *module;
+	TrackerCorpusFileType type;
+} extractors[] = {
+#ifdef HAVE_TEXT
+	{ "extract/text", "libextract-text.so", TRACKER_CORPUS_FILE_DOCUMENT },
+#endif
+#ifdef HAVE_MP3
+	{ "extract/mp3", "libextract-mp3.so", TRACKER_CORPUS_FILE_MUSIC },
+#endif
+	{ NULL }
+};
+
+#ifdef HAVE_POPPLER
+/* Multi-page documents for the PDF content extraction, which the
+ * corpus generator does not write */
+static const gchar *pdf_fixtures[] = {
+	TOP_SRCDIR "/tests/functional-tests/test-extraction-data/office/pdf-doc.pdf",
+	TOP_SRCDIR "/tests/functional-tests/common/data/Pdf/office-tools-test-document.pdf",
+	NULL
+};
+#endif
+
+#ifdef HAVE_MP4
+/* Containers are extracted by the native module, and by the
+ * generic media module if one is built */
+static const gchar *mp4_fixtures[] = {
+	TOP_SRCDIR "/tests/functional-tests/test-extraction-data/video/184505.mp4",
+	TOP_SRCDIR "/tests/functional-tests/test-extraction-data/video/video-1.mp4",
+	NULL
+};
+#endif
+
+static TrackerConfig *config;
+
+/* Some modules read the extractor settings through this */
+TrackerConfig *
+tracker_main_get_config (void)
+{
+	return config;
+}
+
+static TrackerExtractMetadataFunc
+load_module (const gchar *name)
+{
+	TrackerExtractInitFunc init_func;
+	TrackerExtractMetadataFunc func;
+	TrackerModuleThreadAwareness thread_awareness;
+	GModule *module;
+	GError *error = NULL;
+	gchar *path;
+
+	path = g_build_filename (modules_dir, name, NULL);
+	module = g_module_open (path, G_MODULE_BIND_LOCAL);
+	g_free (path);
+
+	if (!module) {
+		g_printerr ("Could not load module '%s': %s\n", name, g_module_error ());
+		return NULL;
+	}
+
+	if (!g_module_symbol (module, "tracker_extract_get_metadata", (gpointer *) &func)) {
+		g_printerr ("Module '%s' has no extract function\n", name);
+		g_module_close (module);
+		return NULL;
+	}
+
+	if (g_module_symbol (module, "tracker_extract_module_init", (gpointer *) &init_func) &&
+	    !init_func (&thread_awareness, &error)) {
+		g_printerr ("Could not initialize module '%s': %s\n", name, error->message);
+		g_error_free (error);
+		g_module_close (module);
+		return NULL;
+	}
+
+	g_module_make_resident (module);
+
+	return func;
+}
+
+static gboolean
+benchmark_extractor (TrackerBenchmarkReport *report,
+                     GPtrArray              *files,
+                     guint                   extractor)
+{
+	TrackerExtractMetadataFunc func;
+	const gchar *mimetype;
+	GArray *latencies;
+	GTimer *timer;
+	gdouble total = 0;
+	guint64 n_bytes = 0;
+	guint n_extracted = 0, n_failed = 0;
+	gchar *name;
+	gint i;
+	guint j;
+
+	func = load_module (extractors[extractor].module);
+
+	if (!func) {
+		return FALSE;
+	}
+
+	mimetype = tracker_corpus_file_type_get_mimetype (extractors[extractor].type);
+	latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_iterations; i++) {
+		for (j = 0; j < files->len; j++) {
+			TrackerCorpusFile *corpus_file = g_ptr_array_index (files, j);
+			TrackerExtractInfo *info;
+			gdouble elapsed;
+			gboolean success;
+			GFile *file;
+
+			if (corpus_file->type != extractors[extractor].type) {
+				continue;
+			}
+
+			file = g_file_new_for_path (corpus_file->path);
+			info = tracker_extract_info_new (file, mimetype, NULL);
+
+			g_timer_start (timer);
+			success = func (info);
+			elapsed = g_timer_elapsed (timer, NULL);
+
+			tracker_extract_info_unref (info);
+			g_object_unref (file);
+
+			if (!success) {
+				n_failed++;
+				continue;
+			}
+
+			total += elapsed;
+			elapsed *= 1000;
+			g_array_append_val (latencies, elapsed);
+
+			n_extracted++;
+			n_bytes += corpus_file->size;
+		}
+	}
+
+	tracker_benchmark_report_add_rate (report, extractors[extractor].name,
+	                                   n_extracted, total, "files");
+
+	name = g_strdup_printf ("%s/bytes", extractors[extractor].name);
+	tracker_benchmark_report_add_rate (report, name, n_bytes, total, "bytes");
+	g_free (name);
+
+	name = g_strdup_printf ("%s/latency", extractors[extractor].name);
+	tracker_benchmark_report_add_latencies (report, name, latencies);
+	g_free (name);
+
+	if (n_failed > 0) {
+		g_printerr ("%u files could not be extracted by '%s'\n",
+		            n_failed, extractors[extractor].module);
+	}
+
+	g_timer_destroy (timer);
+	g_array_free (latencies, TRUE);
+
+	return n_failed == 0;
+}
+
+#if defined (HAVE_POPPLER) || defined (HAVE_MP4)
+static gboolean
+benchmark_fixtures (TrackerBenchmarkReport *report,
+                    const gchar            *name,
+                    const gchar            *module,
+                    const gchar            *mimetype,
+                    const gchar           **fixtures)
+{
+	TrackerExtractMetadataFunc func;
+	GArray *latencies;
+	GTimer *timer;
+	gdouble total = 0;
+	guint n_extracted = 0, n_failed = 0;
+	gchar *latency_name;
+	gint i, j;
+
+	func = load_module (module);
+
+	if (!func) {
+		return FALSE;
+	}
+
+	latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_iterations; i++) {
+		for (j = 0; fixtures[j]; j++) {
+			TrackerExtractInfo *info;
+			gdouble elapsed;
+			gboolean success;
+			GFile *file;
+
+			file = g_file_new_for_path (fixtures[j]);
+			info = tracker_extract_info_new (file, mimetype, NULL);
+
+			g_timer_start (timer);
+			success = func (info);
+			elapsed = g_timer_elapsed (timer, NULL);
+
+			tracker_extract_info_unref (info);
+			g_object_unref (file);
+
+			if (!success) {
+				n_failed++;
+				continue;
+			}
+
+			total += elapsed;
+			elapsed *= 1000;
+			g_array_append_val (latencies, elapsed);
+
+			n_extracted++;
+		}
+	}
+
+	tracker_benchmark_report_add_rate (report, name, n_extracted, total, "files");
+
+	latency_name = g_strdup_printf ("%s/latency", name);
+	tracker_benchmark_report_add_latencies (report, latency_name, latencies);
+	g_free (latency_name);
+
+	if (n_failed > 0) {
+		g_printerr ("%u files could not be extracted by '%s'\n",
+		            n_failed, module);
+	}
+
+	g_timer_destroy (timer);
+	g_array_free (latencies, TRUE);
+
+	return n_failed == 0;
+}
+#endif /* HAVE_POPPLER || HAVE_MP4 */
+
+#ifdef HAVE_POPPLER
+static gboolean
+benchmark_pdf (TrackerBenchmarkReport *report,
+               const gchar            *name,
+               gint                    max_threads)
+{
+	gboolean retval;
+
+	/* The module reads this for every document, 0 is one
+	 * thread per CPU */
+	g_settings_set_int (G_SETTINGS (config), "max-threads", max_threads);
+
+	retval = benchmark_fixtures (report, name, "libextract-pdf.so",
+	                             "application/pdf", pdf_fixtures);
+
+	g_settings_reset (G_SETTINGS (config), "max-threads");
+
+	return retval;
+}
+#endif /* HAVE_POPPLER */
+
+int
+main (int argc, char **argv)
+{
+	TrackerBenchmarkReport *report;
+	TrackerCorpus *corpus;
+	GPtrArray *files;
+	GError *error = NULL;
+	gchar *data_dir;
+	gboolean success = TRUE;
+	guint i;
+
+	if (!tracker_benchmark_parse_options (&argc, &argv, options,
+	                                      "- Measure extractor module throughput")) {
+		return EXIT_FAILURE;
+	}
+
+	if (n_files < 1 || n_iterations < 1) {
+		g_printerr ("File and iteration counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!modules_dir) {
+		modules_dir = g_strdup (MODULES_DIR);
+	}
+
+	/* Use the schemas compiled by "make benchmark", and leave
+	 * the user settings alone */
+	if (!g_getenv ("GSETTINGS_SCHEMA_DIR")) {
+		g_setenv ("GSETTINGS_SCHEMA_DIR", BENCHMARK_SCHEMAS_DIR, TRUE);
+	}
+
+	g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+
+	data_dir = tracker_benchmark_make_tmp_dir ("tracker-extract-benchmark");
+
+	if (!data_dir) {
+		return EXIT_FAILURE;
+	}
+
+	config = tracker_config_new ();
+
+	report = tracker_benchmark_report_new ("extract");
+	tracker_benchmark_report_add_parameter (report, "files", n_files);
+	tracker_benchmark_report_add_parameter (report, "iterations", n_iterations);
+
+	corpus = tracker_corpus_new (tracker_benchmark_get_seed ());
+	files = tracker_corpus_write_tree (corpus, data_dir, n_files, 100, &error);
+
+	if (!files) {
+		g_printerr ("Could not write the files: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	} else {
+		for (i = 0; extractors[i].name; i++) {
+			if (!benchmark_extractor (report, files, i)) {
+				success = FALSE;
+			}
+		}
+
+		g_ptr_array_unref (files);
+	}
+
+#ifdef HAVE_POPPLER
+	/* Sequential and threaded page extraction */
+	if (!benchmark_pdf (report, "extract/pdf/1-thread", 1) ||
+	    !benchmark_pdf (report, "extract/pdf", 0)) {
+		success = FALSE;
+	}
+#endif
+
+#ifdef HAVE_MP4
+	if (!benchmark_fixtures (report, "extract/mp4", "libextract-mp4.so",
+	                         "video/mp4", mp4_fixtures)) {
+		success = FALSE;
+	}
+
+#ifdef BENCHMARK_GSTREAMER
+	if (!benchmark_fixtures (report, "extract/mp4/gstreamer", "libextract-gstreamer.so",
+	                         "video/mp4", mp4_fixtures)) {
+		success = FALSE;
+	}
+#endif
+#endif /* HAVE_MP4 */
+
+	if (!tracker_benchmark_report_write (report, &error)) {
+		g_printerr ("Could not write results: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	}
+
+	tracker_benchmark_report_free (report);
+	tracker_corpus_free (corpus);
+	g_object_unref (config);
+
+	tracker_benchmark_remove_dir (data_dir);
+	g_free (data_dir);
+	g_free (modules_dir);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libtracker-common/tracker-common.h>
+#include <libtracker-fts/tracker-parser.h>
+#include <libtracker-fts/tracker-fts-config.h>
+
+#include "tracker-benchmark.h"
+#include "tracker-corpus.h"
+
+/* MATCH queries are measured by tracker-store-benchmark, on the
+ * same documents as the rest of the store queries */
+
+static gint n_documents = 1000;
+static gint words_per_document = 500;
+static gint n_iterations = 5;
+static gint n_threads = 4;
+
+static const GOptionEntry options[] = {
+	{
+		"documents", 'd', 0,
+		G_OPTION_ARG_INT, &n_documents,
+		"Number of generated documents (default: 1000)",
+		NULL
+	},
+	{
+		"words", 'w', 0,
+		G_OPTION_ARG_INT, &words_per_document,
+		"Words per generated document (default: 500)",
+		NULL
+	},
+	{
+		"iterations", 'i', 0,
+		G_OPTION_ARG_INT, &n_iterations,
+		"Times every document is tokenized (default: 5)",
+		NULL
+	},
+	{
+		"threads", 't', 0,
+		G_OPTION_ARG_INT, &n_threads,
+		"Threads tokenizing concurrently in tokenize/threads (default: 4)",
+		NULL
+	},
+	{ NULL }
+};
+
+typedef struct {
+	const gchar *name;
+	gboolean enable_stemmer;
+	gboolean enable_unaccent;
+	gboolean ignore_stop_words;
+} Variant;
+
+static const Variant variants[] = {
+	{ "tokenize/plain", FALSE, FALSE, FALSE },
+	{ "tokenize/unaccent", FALSE, TRUE, FALSE },
+	{ "tokenize/stem", TRUE, FALSE, FALSE },
+	{ "tokenize/default", TRUE, TRUE, TRUE },
+};
+
+/* What the store is configured with out of the box */
+#define DEFAULT_VARIANT (&variants[G_N_ELEMENTS (variants) - 1])
+
+/* Real text, paragraphs are tokenized as separate documents. The
+ * ASCII one goes through the parser's ASCII fast path. */
+static const struct {
+	const gchar *name;
+	const gchar *filename;
+} corpus_files[] = {
+	{ "tokenize/ascii", TOP_SRCDIR "/tests/libtracker-fts/corpus/ascii.txt" },
+	{ "tokenize/mixed", TOP_SRCDIR "/tests/libtracker-fts/corpus/mixed.txt" },
+};
+
+typedef struct {
+	TrackerLanguage *language;
+	TrackerFTSConfig *config;
+	GPtrArray *documents;
+	guint64 n_words;
+} ThreadData;
+
+static guint64
+tokenize_documents (TrackerLanguage  *language,
+                    TrackerFTSConfig *config,
+                    GPtrArray        *documents,
+                    const Variant    *variant)
+{
+	TrackerParser *parser;
+	guint64 n_words = 0;
+	gint i;
+	guint j;
+
+	parser = tracker_parser_new (language);
+
+	for (i = 0; i < n_iterations; i++) {
+		for (j = 0; j < documents->len; j++) {
+			const gchar *text = g_ptr_array_index (documents, j);
+
+			tracker_parser_reset (parser,
+			                      text,
+			                      strlen (text),
+			                      tracker_fts_config_get_max_word_length (config),
+			                      variant->enable_stemmer,
+			                      variant->enable_unaccent,
+			                      variant->ignore_stop_words,
+			                      TRUE,
+			                      tracker_fts_config_get_ignore_numbers (config));
+
+			while (TRUE) {
+				const gchar *word;
+				gint position, start, end, length;
+				gboolean stop_word;
+
+				word = tracker_parser_next (parser, &position,
+				                            &start, &end,
+				                            &stop_word, &length);
+				if (!word) {
+					break;
+				}
+
+				n_words++;
+			}
+		}
+	}
+
+	tracker_parser_free (parser);
+
+	return n_words;
+}
+
+static gsize
+documents_get_size (GPtrArray *documents)
+{
+	gsize n_bytes = 0;
+	guint i;
+
+	for (i = 0; i < documents->len; i++) {
+		n_bytes += strlen (g_ptr_array_index (documents, i));
+	}
+
+	return n_bytes;
+}
+
+static void
+benchmark_tokenizer (TrackerBenchmarkReport *report,
+                     const gchar            *name,
+                     TrackerLanguage        *language,
+                     TrackerFTSConfig       *config,
+                     GPtrArray              *documents,
+                     const Variant          *variant)
+{
+	GTimer *timer;
+	guint64 n_words;
+	gdouble elapsed;
+	gchar *bytes_name;
+
+	timer = g_timer_new ();
+	n_words = tokenize_documents (language, config, documents, variant);
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	tracker_benchmark_report_add_rate (report, name, n_words, elapsed, "words");
+
+	bytes_name = g_strdup_printf ("%s/bytes", name);
+	tracker_benchmark_report_add_rate (report, bytes_name,
+	                                   (gdouble) documents_get_size (documents) * n_iterations,
+	                                   elapsed, "bytes");
+	g_free (bytes_name);
+
+	g_timer_destroy (timer);
+}
+
+static gpointer
+tokenize_thread_func (gpointer user_data)
+{
+	ThreadData *data = user_data;
+
+	data->n_words = tokenize_documents (data->language, data->config,
+	                                    data->documents,
+	                                    DEFAULT_VARIANT);
+
+	return NULL;
+}
+
+static void
+benchmark_threads (TrackerBenchmarkReport *report,
+                   TrackerLanguage        *language,
+                   TrackerFTSConfig       *config,
+                   GPtrArray              *documents)
+{
+	ThreadData *data;
+	GThread **threads;
+	GTimer *timer;
+	guint64 n_words = 0;
+	gint i;
+
+	data = g_new0 (ThreadData, n_threads);
+	threads = g_new0 (GThread *, n_threads);
+	timer = g_timer_new ();
+
+	/* All threads share the language, as the FTS tokenizer does */
+	for (i = 0; i < n_threads; i++) {
+		data[i].language = language;
+		data[i].config = config;
+		data[i].documents = documents;
+		threads[i] = g_thread_new ("tokenize", tokenize_thread_func, &data[i]);
+	}
+
+	for (i = 0; i < n_threads; i++) {
+		g_thread_join (threads[i]);
+		n_words += data[i].n_words;
+	}
+
+	tracker_benchmark_report_add_rate (report, "tokenize/threads",
+	                                   n_words, g_timer_elapsed (timer, NULL),
+	                                   "words");
+
+	g_timer_destroy (timer);
+	g_free (threads);
+	g_free (data);
+}
+
+static GPtrArray *
+load_corpus_file (const gchar  *filename,
+                  GError      **error)
+{
+	GPtrArray *documents;
+	gchar *contents;
+	gchar **paragraphs;
+	gint i;
+
+	if (!g_file_get_contents (filename, &contents, NULL, error)) {
+		return NULL;
+	}
+
+	paragraphs = g_strsplit (contents, "\n\n", -1);
+	documents = g_ptr_array_new_with_free_func (g_free);
+
+	for (i = 0; paragraphs[i]; i++) {
+		g_ptr_array_add (documents, paragraphs[i]);
+	}
+
+	g_free (paragraphs);
+	g_free (contents);
+
+	return documents;
+}
+
+int
+main (int argc, char **argv)
+{
+	TrackerBenchmarkReport *report;
+	TrackerFTSConfig *config;
+	TrackerLanguage *language;
+	TrackerCorpus *corpus;
+	GPtrArray *documents;
+	GError *error = NULL;
+	gboolean success = TRUE;
+	guint i;
+
+	if (!tracker_benchmark_parse_options (&argc, &argv, options,
+	                                      "- Measure FTS tokenizer throughput")) {
+		return EXIT_FAILURE;
+	}
+
+	if (n_documents < 1 || words_per_document < 1 ||
+	    n_iterations < 1 || n_threads < 1) {
+		g_printerr ("Document, word, iteration and thread counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	report = tracker_benchmark_report_new ("fts");
+	tracker_benchmark_report_add_parameter (report, "documents", n_documents);
+	tracker_benchmark_report_add_parameter (report, "words", words_per_document);
+	tracker_benchmark_report_add_parameter (report, "iterations", n_iterations);
+	tracker_benchmark_report_add_parameter (report, "threads", n_threads);
+
+	corpus = tracker_corpus_new (tracker_benchmark_get_seed ());
+	documents = g_ptr_array_new_with_free_func (g_free);
+
+	for (i = 0; i < (guint) n_documents; i++) {
+		g_ptr_array_add (documents, tracker_corpus_text (corpus, words_per_document));
+	}
+
+	config = tracker_fts_config_new ();
+	language = tracker_language_new (NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (variants); i++) {
+		benchmark_tokenizer (report, variants[i].name, language, config,
+		                     documents, &variants[i]);
+	}
+
+	benchmark_threads (report, language, config, documents);
+
+	for (i = 0; i < G_N_ELEMENTS (corpus_files); i++) {
+		GPtrArray *paragraphs;
+
+		paragraphs = load_corpus_file (corpus_files[i].filename, &error);
+
+		if (!paragraphs) {
+			g_printerr ("Could not read '%s': %s\n",
+			            corpus_files[i].filename, error->message);
+			g_clear_error (&error);
+			success = FALSE;
+			continue;
+		}
+
+		benchmark_tokenizer (report, corpus_files[i].name, language, config,
+		                     paragraphs, DEFAULT_VARIANT);
+		g_ptr_array_unref (paragraphs);
+	}
+
+	if (!tracker_benchmark_report_write (report, &error)) {
+		g_printerr ("Could not write results: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	}
+
+	g_object_unref (language);
+	g_object_unref (config);
+	g_ptr_array_unref (documents);
+	tracker_corpus_free (corpus);
+	tracker_benchmark_report_free (report);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include <libtracker-miner/tracker-crawler.h>
+#include <libtracker-miner/tracker-monitor.h>
+
+#include "tracker-benchmark.h"
+#include "tracker-corpus.h"
+
+/* Events are merged for a while before being emitted, give
+ * up on the missing ones well after that */
+#define EVENTS_TIMEOUT_SECONDS 60
+
+static gint n_files = 10000;
+static gint files_per_dir = 100;
+static gint n_iterations = 3;
+static gint n_events = 500;
+
+static const GOptionEntry options[] = {
+	{
+		"files", 'f', 0,
+		G_OPTION_ARG_INT, &n_files,
+		"Number of files in the crawled tree (default: 10000)",
+		NULL
+	},
+	{
+		"files-per-dir", 'p', 0,
+		G_OPTION_ARG_INT, &files_per_dir,
+		"Files in each directory of the tree (default: 100)",
+		NULL
+	},
+	{
+		"iterations", 'i', 0,
+		G_OPTION_ARG_INT, &n_iterations,
+		"Times the tree is crawled (default: 3)",
+		NULL
+	},
+	{
+		"events", 'e', 0,
+		G_OPTION_ARG_INT, &n_events,
+		"Files created and deleted in a monitored directory (default: 500)",
+		NULL
+	},
+	{ NULL }
+};
+
+typedef struct {
+	GMainLoop *main_loop;
+	guint files_found;
+	guint directories_found;
+	gboolean interrupted;
+} CrawlData;
+
+typedef struct {
+	GMainLoop *main_loop;
+	GHashTable *pending;
+	GArray *latencies;
+	gint64 last_event;
+	guint timeout_id;
+	gboolean deleting;
+} EventData;
+
+static void
+crawler_directory_crawled_cb (TrackerCrawler *crawler,
+                              GFile          *directory,
+                              GNode          *tree,
+                              guint           directories_found,
+                              guint           directories_ignored,
+                              guint           files_found,
+                              guint           files_ignored,
+                              gpointer        user_data)
+{
+	CrawlData *data = user_data;
+
+	data->directories_found = directories_found;
+	data->files_found = files_found;
+}
+
+static void
+crawler_finished_cb (TrackerCrawler *crawler,
+                     gboolean        interrupted,
+                     gpointer        user_data)
+{
+	CrawlData *data = user_data;
+
+	data->interrupted = interrupted;
+	g_main_loop_quit (data->main_loop);
+}
+
+static gboolean
+benchmark_crawl (TrackerBenchmarkReport *report,
+                 GFile                  *root)
+{
+	TrackerCrawler *crawler;
+	CrawlData data = { 0 };
+	GArray *latencies;
+	GTimer *timer;
+	gdouble total = 0;
+	guint64 total_files = 0;
+	gint i;
+
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+	latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	timer = g_timer_new ();
+
+	crawler = tracker_crawler_new ();
+	g_signal_connect (crawler, "directory-crawled",
+	                  G_CALLBACK (crawler_directory_crawled_cb), &data);
+	g_signal_connect (crawler, "finished",
+	                  G_CALLBACK (crawler_finished_cb), &data);
+
+	for (i = 0; i < n_iterations && !data.interrupted; i++) {
+		gdouble elapsed;
+
+		g_timer_start (timer);
+
+		if (!tracker_crawler_start (crawler, root, TRUE)) {
+			g_printerr ("Could not start crawling\n");
+			data.interrupted = TRUE;
+			break;
+		}
+
+		g_main_loop_run (data.main_loop);
+
+		elapsed = g_timer_elapsed (timer, NULL);
+		total += elapsed;
+		total_files += data.files_found + data.directories_found;
+
+		elapsed *= 1000;
+		g_array_append_val (latencies, elapsed);
+	}
+
+	if (!data.interrupted) {
+		tracker_benchmark_report_add_rate (report, "crawl", total_files, total, "files");
+		tracker_benchmark_report_add_latencies (report, "crawl/tree", latencies);
+	}
+
+	g_object_unref (crawler);
+	g_timer_destroy (timer);
+	g_array_free (latencies, TRUE);
+	g_main_loop_unref (data.main_loop);
+
+	return !data.interrupted;
+}
+
+static void
+add_directories (TrackerMonitor *monitor,
+                 GFile          *directory,
+                 guint          *n_directories)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+
+	if (!tracker_monitor_add (monitor, directory)) {
+		return;
+	}
+
+	(*n_directories)++;
+
+	enumerator = g_file_enumerate_children (directory,
+	                                        G_FILE_ATTRIBUTE_STANDARD_NAME ","
+	                                        G_FILE_ATTRIBUTE_STANDARD_TYPE,
+	                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                                        NULL, NULL);
+
+	while (enumerator &&
+	       (info = g_file_enumerator_next_file (enumerator, NULL, NULL)) != NULL) {
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+			GFile *child;
+
+			child = g_file_get_child (directory, g_file_info_get_name (info));
+			add_directories (monitor, child, n_directories);
+			g_object_unref (child);
+		}
+
+		g_object_unref (info);
+	}
+
+	if (enumerator) {
+		g_object_unref (enumerator);
+	}
+}
+
+static void
+handle_event (EventData *data,
+              GFile     *file)
+{
+	gpointer start;
+	gchar *path;
+
+	path = g_file_get_path (file);
+
+	if (g_hash_table_lookup_extended (data->pending, path, NULL, &start)) {
+		gdouble latency;
+
+		data->last_event = g_get_monotonic_time ();
+		latency = (data->last_event - *((gint64 *) start)) / 1000.0;
+		g_array_append_val (data->latencies, latency);
+		g_hash_table_remove (data->pending, path);
+
+		if (g_hash_table_size (data->pending) == 0) {
+			g_main_loop_quit (data->main_loop);
+		}
+	}
+
+	g_free (path);
+}
+
+static void
+monitor_item_created_cb (TrackerMonitor *monitor,
+                         GFile          *file,
+                         gboolean        is_directory,
+                         gpointer        user_data)
+{
+	EventData *data = user_data;
+
+	/* Created files may be reported as updated once the
+	 * writes are done, both count as handled */
+	if (!data->deleting) {
+		handle_event (data, file);
+	}
+}
+
+static void
+monitor_item_deleted_cb (TrackerMonitor *monitor,
+                         GFile          *file,
+                         gboolean        is_directory,
+                         gpointer        user_data)
+{
+	EventData *data = user_data;
+
+	if (data->deleting) {
+		handle_event (data, file);
+	}
+}
+
+static gboolean
+events_timeout_cb (gpointer user_data)
+{
+	EventData *data = user_data;
+
+	data->timeout_id = 0;
+	g_main_loop_quit (data->main_loop);
+
+	return FALSE;
+}
+
+static gboolean
+benchmark_events (TrackerBenchmarkReport *report,
+                  EventData              *data,
+                  const gchar            *directory,
+                  TrackerCorpus          *corpus,
+                  gboolean                create)
+{
+	const gchar *name;
+	gint64 first_event;
+	gchar *result;
+	guint n_missed;
+	gint i;
+
+	name = create ? "monitor/created" : "monitor/deleted";
+	data->deleting = !create;
+	first_event = data->last_event = g_get_monotonic_time ();
+
+	for (i = 0; i < n_events; i++) {
+		gint64 *start;
+		gchar *path;
+
+		path = g_strdup_printf ("%s/event-%06d.txt", directory, i);
+		start = g_new (gint64, 1);
+		*start = g_get_monotonic_time ();
+
+		if (create) {
+			gchar *text;
+			FILE *f;
+
+			/* Not g_file_set_contents(), renames are reported as moves */
+			text = tracker_corpus_text (corpus, 20);
+			f = g_fopen (path, "w");
+
+			if (f) {
+				fputs (text, f);
+				fclose (f);
+			}
+
+			g_free (text);
+		} else {
+			g_unlink (path);
+		}
+
+		g_hash_table_insert (data->pending, path, start);
+	}
+
+	data->timeout_id = g_timeout_add_seconds (EVENTS_TIMEOUT_SECONDS, events_timeout_cb, data);
+	g_main_loop_run (data->main_loop);
+
+	if (data->timeout_id) {
+		g_source_remove (data->timeout_id);
+		data->timeout_id = 0;
+	}
+
+	n_missed = g_hash_table_size (data->pending);
+	g_hash_table_remove_all (data->pending);
+
+	tracker_benchmark_report_add_rate (report, name,
+	                                   data->latencies->len,
+	                                   (data->last_event - first_event) / (gdouble) G_USEC_PER_SEC,
+	                                   "events");
+
+	result = g_strdup_printf ("%s/latency", name);
+	tracker_benchmark_report_add_latencies (report, result, data->latencies);
+	g_free (result);
+
+	g_array_set_size (data->latencies, 0);
+
+	if (n_missed > 0) {
+		g_printerr ("%u of %d events were not received\n", n_missed, n_events);
+	}
+
+	return n_missed == 0;
+}
+
+static gboolean
+benchmark_monitor (TrackerBenchmarkReport *report,
+                   GFile                  *root,
+                   const gchar            *events_dir,
+                   TrackerCorpus          *corpus)
+{
+	TrackerMonitor *monitor;
+	EventData data = { 0 };
+	GFile *file;
+	GTimer *timer;
+	guint n_directories = 0;
+	gboolean success;
+
+	monitor = tracker_monitor_new ();
+	tracker_monitor_set_enabled (monitor, TRUE);
+
+	timer = g_timer_new ();
+	add_directories (monitor, root, &n_directories);
+	tracker_benchmark_report_add_rate (report, "monitor/add", n_directories,
+	                                   g_timer_elapsed (timer, NULL), "directories");
+	g_timer_destroy (timer);
+
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+	data.pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	data.latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+
+	g_signal_connect (monitor, "item-created",
+	                  G_CALLBACK (monitor_item_created_cb), &data);
+	g_signal_connect (monitor, "item-updated",
+	                  G_CALLBACK (monitor_item_created_cb), &data);
+	g_signal_connect (monitor, "item-deleted",
+	                  G_CALLBACK (monitor_item_deleted_cb), &data);
+
+	file = g_file_new_for_path (events_dir);
+	tracker_monitor_add (monitor, file);
+	g_object_unref (file);
+
+	success = benchmark_events (report, &data, events_dir, corpus, TRUE);
+
+	if (success) {
+		success = benchmark_events (report, &data, events_dir, corpus, FALSE);
+	}
+
+	g_object_unref (monitor);
+	g_hash_table_unref (data.pending);
+	g_array_free (data.latencies, TRUE);
+	g_main_loop_unref (data.main_loop);
+
+	return success;
+}
+
+int
+main (int argc, char **argv)
+{
+	TrackerBenchmarkReport *report;
+	TrackerCorpus *corpus;
+	GPtrArray *files;
+	GError *error = NULL;
+	gchar *data_dir, *tree_dir, *events_dir;
+	gboolean success = TRUE;
+	GFile *root;
+
+	if (!tracker_benchmark_parse_options (&argc, &argv, options,
+	                                      "- Measure crawling and monitor event handling")) {
+		return EXIT_FAILURE;
+	}
+
+	if (n_files < 1 || files_per_dir < 1 || n_iterations < 1 || n_events < 1) {
+		g_printerr ("File, directory, iteration and event counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	data_dir = tracker_benchmark_make_tmp_dir ("tracker-miner-benchmark");
+
+	if (!data_dir) {
+		return EXIT_FAILURE;
+	}
+
+	tree_dir = g_build_filename (data_dir, "tree", NULL);
+	events_dir = g_build_filename (data_dir, "events", NULL);
+	g_mkdir (events_dir, 0755);
+
+	report = tracker_benchmark_report_new ("miner");
+	tracker_benchmark_report_add_parameter (report, "files", n_files);
+	tracker_benchmark_report_add_parameter (report, "files-per-dir", files_per_dir);
+	tracker_benchmark_report_add_parameter (report, "iterations", n_iterations);
+	tracker_benchmark_report_add_parameter (report, "events", n_events);
+
+	corpus = tracker_corpus_new (tracker_benchmark_get_seed ());
+	files = tracker_corpus_write_tree (corpus, tree_dir, n_files, files_per_dir, &error);
+
+	if (!files) {
+		g_printerr ("Could not write the file tree: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	} else {
+		root = g_file_new_for_path (tree_dir);
+
+		if (!benchmark_crawl (report, root)) {
+			success = FALSE;
+		}
+
+		if (!benchmark_monitor (report, root, events_dir, corpus)) {
+			success = FALSE;
+		}
+
+		g_object_unref (root);
+		g_ptr_array_unref (files);
+	}
+
+	if (!tracker_benchmark_report_write (report, &error)) {
+		g_printerr ("Could not write results: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	}
+
+	tracker_benchmark_report_free (report);
+	tracker_corpus_free (corpus);
+
+	tracker_benchmark_remove_dir (data_dir);
+	g_free (events_dir);
+	g_free (tree_dir);
+	g_free (data_dir);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
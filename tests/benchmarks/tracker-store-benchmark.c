@@ -0,0 +1,802 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libtracker-common/tracker-common.h>
+
+#include <libtracker-data/tracker-data-manager.h>
+#include <libtracker-data/tracker-data-query.h>
+#include <libtracker-data/tracker-data-update.h>
+#include <libtracker-data/tracker-db-interface.h>
+#include <libtracker-data/tracker-db-journal.h>
+#include <libtracker-data/tracker-sparql-query.h>
+
+#include "tracker-benchmark.h"
+#include "tracker-corpus.h"
+
+#define N_ARTISTS    200
+#define N_ALBUMS     1000
+#define N_STARTUPS   10
+
+#define RDF_TYPE     "http://www.w3.org/1999/02/22-rdf-syntax-ns#type"
+#define NFO_DOCUMENT "http://www.semanticdesktop.org/ontologies/2007/03/22/nfo#Document"
+#define NIE_TITLE    "http://www.semanticdesktop.org/ontologies/2007/01/19/nie#title"
+
+static gint n_songs = 10000;
+static gint n_documents = 10000;
+static gint batch_size = 100;
+static gint n_iterations = 50;
+
+static const GOptionEntry options[] = {
+	{
+		"songs", 's', 0,
+		G_OPTION_ARG_INT, &n_songs,
+		"Number of generated songs (default: 10000)",
+		NULL
+	},
+	{
+		"documents", 'd', 0,
+		G_OPTION_ARG_INT, &n_documents,
+		"Number of generated documents (default: 10000)",
+		NULL
+	},
+	{
+		"batch", 'b', 0,
+		G_OPTION_ARG_INT, &batch_size,
+		"Resources inserted per transaction (default: 100)",
+		NULL
+	},
+	{
+		"iterations", 'i', 0,
+		G_OPTION_ARG_INT, &n_iterations,
+		"Times each query class is run (default: 50)",
+		NULL
+	},
+	{ NULL }
+};
+
+typedef enum {
+	ARG_SONG,
+	ARG_ALBUM,
+	ARG_ARTIST,
+	ARG_DOCUMENT,
+	ARG_WORD,
+	ARG_PREFIX_1,
+	ARG_PREFIX_2,
+	ARG_PREFIX_3,
+	ARG_OFFSET
+} QueryArg;
+
+/* One query per class of query applications issue, the
+ * argument is replaced with a random existing value */
+static const struct {
+	const gchar *name;
+	const gchar *query;
+	QueryArg arg;
+	gboolean fts;
+} queries[] = {
+	{ "query/lookup",
+	  "SELECT ?song ?title { "
+	  "  ?song a nmm:MusicPiece ; nie:title ?title ; "
+	  "        nie:url \"file:///music/song-%s.mp3\" "
+	  "}", ARG_SONG, FALSE },
+	{ "query/join",
+	  "SELECT ?song ?title { "
+	  "  ?song a nmm:MusicPiece ; nie:title ?title ; nmm:musicAlbum ?album . "
+	  "  ?album nie:title \"Album %s\" "
+	  "}", ARG_ALBUM, FALSE },
+	{ "query/join-artist",
+	  "SELECT ?song ?url { "
+	  "  ?song a nmm:MusicPiece ; nie:url ?url ; nmm:performer ?artist . "
+	  "  ?artist nmm:artistName \"Artist %s\" "
+	  "}", ARG_ARTIST, FALSE },
+	{ "query/aggregate",
+	  "SELECT ?album COUNT(?song) { "
+	  "  ?song a nmm:MusicPiece ; nmm:musicAlbum ?album ; nmm:performer ?artist . "
+	  "  ?artist nmm:artistName \"Artist %s\" "
+	  "} GROUP BY ?album", ARG_ARTIST, FALSE },
+	{ "query/filter",
+	  "SELECT ?song { "
+	  "  ?song a nmm:MusicPiece ; nie:title ?title . "
+	  "  FILTER (fn:contains (?title, \"%s\")) "
+	  "} LIMIT 100", ARG_WORD, FALSE },
+	{ "query/order-limit",
+	  "SELECT ?doc ?title { "
+	  "  ?doc a nfo:Document ; nie:title ?title "
+	  "} ORDER BY ?title LIMIT 50 OFFSET %s", ARG_OFFSET, FALSE },
+	{ "query/optional",
+	  "SELECT ?doc ?title ?url { "
+	  "  ?doc a nfo:Document ; nie:url \"file:///documents/doc-%s.txt\" . "
+	  "  OPTIONAL { ?doc nie:title ?title } "
+	  "  OPTIONAL { ?doc nie:url ?url } "
+	  "}", ARG_DOCUMENT, FALSE },
+	{ "query/fts-match",
+	  "SELECT ?doc fts:rank(?doc) { "
+	  "  ?doc fts:match \"%s\" "
+	  "} ORDER BY DESC (fts:rank(?doc)) LIMIT 50", ARG_WORD, TRUE },
+	/* Every keystroke issues a new query while typing a word */
+	{ "query/fts-prefix-1",
+	  "SELECT ?doc { "
+	  "  ?doc fts:match \"%s*\" "
+	  "} LIMIT 50", ARG_PREFIX_1, TRUE },
+	{ "query/fts-prefix-2",
+	  "SELECT ?doc { "
+	  "  ?doc fts:match \"%s*\" "
+	  "} LIMIT 50", ARG_PREFIX_2, TRUE },
+	{ "query/fts-prefix-3",
+	  "SELECT ?doc { "
+	  "  ?doc fts:match \"%s*\" "
+	  "} LIMIT 50", ARG_PREFIX_3, TRUE },
+};
+
+/* Walked page by page with OFFSET and with continuation tokens */
+#define PAGED_QUERY \
+	"SELECT ?doc ?title { " \
+	"  ?doc a nfo:Document ; nie:title ?title " \
+	"} ORDER BY ?title"
+#define PAGE_SIZE 50
+
+static gboolean
+insert_batch (GString                *update,
+              GArray                 *latencies,
+              GError                **error)
+{
+	GTimer *timer;
+	gdouble elapsed;
+
+	g_string_append (update, " }");
+
+	timer = g_timer_new ();
+	tracker_data_update_sparql (update->str, error);
+	elapsed = g_timer_elapsed (timer, NULL) * 1000;
+	g_timer_destroy (timer);
+
+	g_array_append_val (latencies, elapsed);
+	g_string_assign (update, "INSERT {");
+
+	return *error == NULL;
+}
+
+static gboolean
+populate (TrackerBenchmarkReport  *report,
+          TrackerCorpus           *corpus,
+          GError                 **error)
+{
+	GArray *latencies;
+	GString *update;
+	GTimer *timer;
+	gint i, n_batched = 0;
+
+	latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	update = g_string_new ("INSERT {");
+	timer = g_timer_new ();
+
+	for (i = 0; i < N_ARTISTS; i++) {
+		g_string_append_printf (update,
+		                        " <urn:artist:%d> a nmm:Artist ;"
+		                        " nmm:artistName \"Artist %d\" .",
+		                        i, i);
+	}
+
+	for (i = 0; i < N_ALBUMS; i++) {
+		g_string_append_printf (update,
+		                        " <urn:album:%d> a nmm:MusicAlbum ;"
+		                        " nie:title \"Album %d\" .",
+		                        i, i);
+	}
+
+	insert_batch (update, latencies, error);
+
+	for (i = 0; i < n_songs && !*error; i++) {
+		g_string_append_printf (update,
+		                        " <urn:song:%d> a nmm:MusicPiece, nfo:FileDataObject ;"
+		                        " nie:title \"%s %s\" ;"
+		                        " nie:url \"file:///music/song-%d.mp3\" ;"
+		                        " nmm:musicAlbum <urn:album:%d> ;"
+		                        " nmm:performer <urn:artist:%d> ;"
+		                        " nmm:trackNumber %d .",
+		                        i,
+		                        tracker_corpus_word (corpus),
+		                        tracker_corpus_word (corpus),
+		                        i, i % N_ALBUMS, i % N_ARTISTS, i % 12 + 1);
+
+		if (++n_batched == batch_size || i == n_songs - 1) {
+			insert_batch (update, latencies, error);
+			n_batched = 0;
+		}
+	}
+
+	for (i = 0; i < n_documents && !*error; i++) {
+		gchar *title, *content;
+
+		title = tracker_corpus_text (corpus, 4);
+		content = tracker_corpus_text (corpus, 100 + (i % 7) * 50);
+
+		g_string_append_printf (update,
+		                        " <urn:document:%d> a nfo:Document, nfo:FileDataObject ;"
+		                        " nie:title \"%s\" ;"
+		                        " nie:url \"file:///documents/doc-%d.txt\" ;"
+		                        " nie:plainTextContent \"\"\"%s\"\"\" .",
+		                        i, title, i, content);
+
+		g_free (title);
+		g_free (content);
+
+		if (++n_batched == batch_size || i == n_documents - 1) {
+			insert_batch (update, latencies, error);
+			n_batched = 0;
+		}
+	}
+
+	if (!*error) {
+		tracker_benchmark_report_add_rate (report, "insert",
+		                                   N_ARTISTS + N_ALBUMS + n_songs + n_documents,
+		                                   g_timer_elapsed (timer, NULL),
+		                                   "resources");
+		tracker_benchmark_report_add_latencies (report, "insert/transaction", latencies);
+	}
+
+	g_timer_destroy (timer);
+	g_string_free (update, TRUE);
+	g_array_free (latencies, TRUE);
+
+	return *error == NULL;
+}
+
+static gchar *
+query_arg (QueryArg       arg,
+           GRand         *rand,
+           TrackerCorpus *corpus)
+{
+	switch (arg) {
+	case ARG_SONG:
+		return g_strdup_printf ("%d", g_rand_int_range (rand, 0, n_songs));
+	case ARG_ALBUM:
+		return g_strdup_printf ("%d", g_rand_int_range (rand, 0, N_ALBUMS));
+	case ARG_ARTIST:
+		return g_strdup_printf ("%d", g_rand_int_range (rand, 0, N_ARTISTS));
+	case ARG_DOCUMENT:
+		return g_strdup_printf ("%d", g_rand_int_range (rand, 0, n_documents));
+	case ARG_OFFSET:
+		return g_strdup_printf ("%d", g_rand_int_range (rand, 0, MAX (n_documents - 50, 1)));
+	case ARG_WORD:
+		return g_strdup (tracker_corpus_word (corpus));
+	case ARG_PREFIX_1:
+	case ARG_PREFIX_2:
+	case ARG_PREFIX_3: {
+		const gchar *word;
+		glong length;
+
+		word = tracker_corpus_word (corpus);
+		length = arg - ARG_PREFIX_1 + 1;
+
+		if (g_utf8_strlen (word, -1) <= length) {
+			return g_strdup (word);
+		}
+
+		return g_utf8_substring (word, 0, length);
+	}
+	}
+
+	g_assert_not_reached ();
+}
+
+static gboolean
+benchmark_query (TrackerBenchmarkReport  *report,
+                 TrackerCorpus           *corpus,
+                 guint                    query,
+                 GError                 **error)
+{
+	GArray *latencies;
+	GTimer *timer;
+	GRand *rand;
+	gint i;
+
+	latencies = g_array_sized_new (FALSE, FALSE, sizeof (gdouble), n_iterations);
+	rand = g_rand_new_with_seed (tracker_benchmark_get_seed () + query);
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_iterations; i++) {
+		TrackerDBCursor *cursor;
+		gdouble elapsed;
+		gchar *sparql, *arg;
+
+		arg = query_arg (queries[query].arg, rand, corpus);
+		sparql = g_strdup_printf (queries[query].query, arg);
+		g_free (arg);
+
+		/* Translation is part of what applications wait for */
+		g_timer_start (timer);
+
+		cursor = tracker_data_query_sparql_cursor (sparql, error);
+
+		if (cursor) {
+			while (tracker_db_cursor_iter_next (cursor, NULL, error))
+				;
+
+			g_object_unref (cursor);
+		}
+
+		elapsed = g_timer_elapsed (timer, NULL) * 1000;
+		g_free (sparql);
+
+		if (*error) {
+			break;
+		}
+
+		g_array_append_val (latencies, elapsed);
+	}
+
+	if (!*error) {
+		tracker_benchmark_report_add_latencies (report, queries[query].name, latencies);
+	}
+
+	g_array_free (latencies, TRUE);
+	g_timer_destroy (timer);
+	g_rand_free (rand);
+
+	return *error == NULL;
+}
+
+static gboolean
+benchmark_paging (TrackerBenchmarkReport  *report,
+                  GError                 **error)
+{
+	GArray *offset_latencies, *continuation_latencies;
+	gchar *continuation = NULL;
+	GTimer *timer;
+	gint page = 0;
+
+	offset_latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	continuation_latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	timer = g_timer_new ();
+
+	do {
+		TrackerSparqlQuery *query;
+		TrackerDBCursor *cursor;
+		gdouble elapsed;
+		gchar *sparql;
+		gint n_rows = 0;
+
+		g_timer_start (timer);
+
+		query = tracker_sparql_query_new_paged (PAGED_QUERY, PAGE_SIZE, continuation);
+		cursor = tracker_sparql_query_execute_cursor (query, FALSE, error);
+
+		g_free (continuation);
+		continuation = NULL;
+
+		if (cursor) {
+			while (tracker_db_cursor_iter_next (cursor, NULL, error)) {
+				if (++n_rows == PAGE_SIZE) {
+					/* A full page, there might be more rows */
+					continuation = tracker_sparql_query_get_continuation (query, cursor);
+				}
+			}
+
+			g_object_unref (cursor);
+		}
+
+		elapsed = g_timer_elapsed (timer, NULL) * 1000;
+		g_object_unref (query);
+
+		if (*error) {
+			break;
+		}
+
+		g_array_append_val (continuation_latencies, elapsed);
+
+		/* The same page, making SQLite skip all previous rows */
+		sparql = g_strdup_printf ("%s LIMIT %d OFFSET %d",
+		                          PAGED_QUERY, PAGE_SIZE, page * PAGE_SIZE);
+
+		g_timer_start (timer);
+
+		cursor = tracker_data_query_sparql_cursor (sparql, error);
+
+		if (cursor) {
+			while (tracker_db_cursor_iter_next (cursor, NULL, error))
+				;
+
+			g_object_unref (cursor);
+		}
+
+		elapsed = g_timer_elapsed (timer, NULL) * 1000;
+		g_free (sparql);
+
+		if (*error) {
+			break;
+		}
+
+		g_array_append_val (offset_latencies, elapsed);
+		page++;
+	} while (continuation);
+
+	if (!*error) {
+		tracker_benchmark_report_add_latencies (report, "page/offset", offset_latencies);
+		tracker_benchmark_report_add_latencies (report, "page/continuation", continuation_latencies);
+	}
+
+	g_free (continuation);
+	g_timer_destroy (timer);
+	g_array_free (offset_latencies, TRUE);
+	g_array_free (continuation_latencies, TRUE);
+
+	return *error == NULL;
+}
+
+static gboolean
+insert_statements_batch (gint      first,
+                         gint      last,
+                         GError  **error)
+{
+	GError *inner_error = NULL;
+	gint i;
+
+	tracker_data_begin_transaction (&inner_error);
+
+	if (inner_error) {
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
+
+	for (i = first; i < last && !inner_error; i++) {
+		gchar *subject, *title;
+
+		subject = g_strdup_printf ("urn:statement:%d", i);
+		title = g_strdup_printf ("Statement %d", i);
+
+		tracker_data_insert_statement_with_uri (NULL, subject, RDF_TYPE,
+		                                        NFO_DOCUMENT, &inner_error);
+
+		if (!inner_error) {
+			tracker_data_insert_statement_with_string (NULL, subject, NIE_TITLE,
+			                                           title, &inner_error);
+		}
+
+		if (!inner_error) {
+			tracker_data_update_buffer_might_flush (&inner_error);
+		}
+
+		g_free (subject);
+		g_free (title);
+	}
+
+	if (inner_error) {
+		tracker_data_rollback_transaction ();
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
+
+	tracker_data_commit_transaction (error);
+
+	return *error == NULL;
+}
+
+static gboolean
+benchmark_insert_statements (TrackerBenchmarkReport  *report,
+                             GError                 **error)
+{
+	GString *update;
+	GTimer *timer;
+	gint i, j;
+
+	timer = g_timer_new ();
+
+	/* What the store does for every batch sent with
+	 * tracker_sparql_connection_update_statements() */
+	for (i = 0; i < n_documents; i += batch_size) {
+		if (!insert_statements_batch (i, MIN (i + batch_size, n_documents), error)) {
+			break;
+		}
+	}
+
+	if (!*error) {
+		tracker_benchmark_report_add_rate (report, "insert/statements",
+		                                   n_documents, g_timer_elapsed (timer, NULL),
+		                                   "resources");
+	}
+
+	/* The same statements as SPARQL updates */
+	update = g_string_new (NULL);
+	g_timer_start (timer);
+
+	for (i = 0; i < n_documents && !*error; i += batch_size) {
+		g_string_assign (update, "INSERT {");
+
+		for (j = i; j < i + batch_size && j < n_documents; j++) {
+			g_string_append_printf (update,
+			                        " <urn:statement-sparql:%d> a nfo:Document ;"
+			                        " nie:title \"Statement %d\" .",
+			                        j, j);
+		}
+
+		g_string_append (update, " }");
+		tracker_data_update_sparql (update->str, error);
+	}
+
+	if (!*error) {
+		tracker_benchmark_report_add_rate (report, "insert/statements-sparql",
+		                                   n_documents, g_timer_elapsed (timer, NULL),
+		                                   "resources");
+	}
+
+	g_string_free (update, TRUE);
+	g_timer_destroy (timer);
+
+	return *error == NULL;
+}
+
+static gboolean
+benchmark_startup (TrackerBenchmarkReport  *report,
+                   const gchar             *name,
+                   GError                 **error)
+{
+	GArray *latencies;
+	GTimer *timer;
+	gboolean retval = TRUE;
+	gint i;
+
+	latencies = g_array_sized_new (FALSE, FALSE, sizeof (gdouble), N_STARTUPS);
+	timer = g_timer_new ();
+
+	/* Direct connections initialize the store read-only */
+	for (i = 0; i < N_STARTUPS && retval; i++) {
+		gdouble elapsed;
+
+		tracker_data_manager_shutdown ();
+
+		g_timer_start (timer);
+		retval = tracker_data_manager_init (TRACKER_DB_MANAGER_READONLY,
+		                                    NULL, NULL, FALSE, FALSE,
+		                                    100, 100, NULL, NULL, NULL, error);
+		elapsed = g_timer_elapsed (timer, NULL) * 1000;
+
+		g_array_append_val (latencies, elapsed);
+	}
+
+	if (retval) {
+		tracker_benchmark_report_add_latencies (report, name, latencies);
+	}
+
+	g_timer_destroy (timer);
+	g_array_free (latencies, TRUE);
+
+	return retval;
+}
+
+static gboolean
+benchmark_startups (TrackerBenchmarkReport  *report,
+                    GError                 **error)
+{
+	gchar *snapshot, *hidden;
+	gboolean retval;
+
+	snapshot = g_build_filename (g_get_user_cache_dir (), "tracker",
+	                             "ontologies.snapshot", NULL);
+	hidden = g_strconcat (snapshot, ".hidden", NULL);
+
+	retval = benchmark_startup (report, "startup/snapshot", error);
+
+	/* Without the snapshot, the ontology comes from the gvdb cache */
+	if (retval && g_rename (snapshot, hidden) == 0) {
+		retval = benchmark_startup (report, "startup/gvdb", error);
+		g_rename (hidden, snapshot);
+	}
+
+	g_free (hidden);
+	g_free (snapshot);
+
+	return retval;
+}
+
+#ifndef DISABLE_JOURNAL
+
+static void
+report_trace_stage (TrackerBenchmarkReport *report,
+                    TrackerTraceStage       stage)
+{
+	GVariantIter iter;
+	GVariant *stats;
+	const gchar *name;
+	gint64 count, total, p50, p90, p99, max;
+
+	stats = tracker_trace_get_stats ();
+	g_variant_iter_init (&iter, stats);
+
+	while (g_variant_iter_next (&iter, "(&sxxxxxx)", &name,
+	                            &count, &total, &p50, &p90, &p99, &max)) {
+		gchar *result;
+
+		if (strcmp (name, tracker_trace_stage_get_name (stage)) != 0) {
+			continue;
+		}
+
+		result = g_strdup_printf ("%s/p50", name);
+		tracker_benchmark_report_add_value (report, result, p50 / 1000.0, "ms", FALSE);
+		g_free (result);
+
+		result = g_strdup_printf ("%s/p99", name);
+		tracker_benchmark_report_add_value (report, result, p99 / 1000.0, "ms", FALSE);
+		g_free (result);
+	}
+
+	g_variant_unref (stats);
+}
+
+static gboolean
+benchmark_journal_replay (TrackerBenchmarkReport  *report,
+                          GError                 **error)
+{
+	GTimer *timer;
+	gboolean retval;
+
+	tracker_data_manager_shutdown ();
+
+	/* Reindexing keeps the journal, which is then replayed */
+	timer = g_timer_new ();
+	retval = tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                                    NULL, NULL, TRUE, FALSE,
+	                                    100, 100, NULL, NULL, NULL, error);
+
+	if (retval) {
+		tracker_benchmark_report_add_rate (report, "journal-replay",
+		                                   N_ARTISTS + N_ALBUMS + n_songs + n_documents,
+		                                   g_timer_elapsed (timer, NULL),
+		                                   "resources");
+	}
+
+	g_timer_destroy (timer);
+
+	return retval;
+}
+
+#endif /* DISABLE_JOURNAL */
+
+int
+main (int argc, char **argv)
+{
+	TrackerBenchmarkReport *report;
+	TrackerCorpus *corpus;
+	GError *error = NULL;
+	gchar *data_dir;
+	gboolean initialized, success = TRUE;
+	guint i;
+
+	if (!tracker_benchmark_parse_options (&argc, &argv, options,
+	                                      "- Measure store insert, query and journal performance")) {
+		return EXIT_FAILURE;
+	}
+
+	if (n_songs < 1 || n_documents < 1 || batch_size < 1 || n_iterations < 1) {
+		g_printerr ("Song, document, batch and iteration counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	data_dir = tracker_benchmark_make_tmp_dir ("tracker-store-benchmark");
+
+	if (!data_dir) {
+		return EXIT_FAILURE;
+	}
+
+	g_setenv ("XDG_DATA_HOME", data_dir, TRUE);
+	g_setenv ("XDG_CACHE_HOME", data_dir, TRUE);
+	g_setenv ("TRACKER_DB_ONTOLOGIES_DIR", TOP_SRCDIR "/data/ontologies/", TRUE);
+
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+
+	if (!tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                                NULL, NULL, FALSE, FALSE,
+	                                100, 100, NULL, NULL, NULL, &error)) {
+		g_printerr ("Could not initialize the store: %s\n", error->message);
+		g_error_free (error);
+		tracker_benchmark_remove_dir (data_dir);
+		g_free (data_dir);
+		return EXIT_FAILURE;
+	}
+
+	initialized = TRUE;
+
+	report = tracker_benchmark_report_new ("store");
+	tracker_benchmark_report_add_parameter (report, "songs", n_songs);
+	tracker_benchmark_report_add_parameter (report, "documents", n_documents);
+	tracker_benchmark_report_add_parameter (report, "batch", batch_size);
+	tracker_benchmark_report_add_parameter (report, "iterations", n_iterations);
+
+	corpus = tracker_corpus_new (tracker_benchmark_get_seed ());
+
+	if (!populate (report, corpus, &error)) {
+		g_printerr ("Could not insert data: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	} else {
+		for (i = 0; i < G_N_ELEMENTS (queries); i++) {
+#if !HAVE_TRACKER_FTS
+			if (queries[i].fts) {
+				continue;
+			}
+#endif
+
+			if (!benchmark_query (report, corpus, i, &error)) {
+				g_printerr ("Query '%s' failed: %s\n",
+				            queries[i].name, error->message);
+				g_clear_error (&error);
+				success = FALSE;
+			}
+		}
+
+		if (!benchmark_paging (report, &error)) {
+			g_printerr ("Could not page through documents: %s\n", error->message);
+			g_clear_error (&error);
+			success = FALSE;
+		}
+
+#ifndef DISABLE_JOURNAL
+		report_trace_stage (report, TRACKER_TRACE_JOURNAL_WRITE);
+		report_trace_stage (report, TRACKER_TRACE_JOURNAL_FSYNC);
+
+		if (!benchmark_journal_replay (report, &error)) {
+			g_printerr ("Could not replay the journal: %s\n", error->message);
+			g_clear_error (&error);
+			initialized = FALSE;
+			success = FALSE;
+		}
+#endif /* DISABLE_JOURNAL */
+
+		/* Adds resources, so it runs after everything
+		 * measured on the generated data */
+		if (initialized && !benchmark_insert_statements (report, &error)) {
+			g_printerr ("Could not insert statements: %s\n", error->message);
+			g_clear_error (&error);
+			success = FALSE;
+		}
+
+		if (initialized && !benchmark_startups (report, &error)) {
+			g_printerr ("Could not start the store: %s\n", error->message);
+			g_clear_error (&error);
+			initialized = FALSE;
+			success = FALSE;
+		}
+	}
+
+	if (initialized) {
+		tracker_data_manager_shutdown ();
+	}
+
+	if (!tracker_benchmark_report_write (report, &error)) {
+		g_printerr ("Could not write results: %s\n", error->message);
+		g_clear_error (&error);
+		success = FALSE;
+	}
+
+	tracker_benchmark_report_free (report);
+	tracker_corpus_free (corpus);
+
+	tracker_benchmark_remove_dir (data_dir);
+	g_free (data_dir);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -122,6 +122,30 @@ class TrackerStoreStatisticsTests (CommonTrackerStoreTest):
             else:
                 self.assertEquals (old_stats [k], new_stats [k])
 
+    def __get_property_stats (self):
+        results = {}
+        for propname, count in self.tracker.get_property_stats ():
+            results [str(propname)] = int(count)
+        return results
+
+    def test_stats_04_property_counts (self):
+        self.clean_up_instances.append ("test://stats-04")
+        old_stats = self.__get_property_stats ()
+        self.tracker.update ("INSERT { <test://stats-04> a nie:InformationElement ; nie:title 'stats' ; nie:keyword 'a', 'b' . }")
+        new_stats = self.__get_property_stats ()
+
+        self.assertEquals (old_stats.get ("nie:title", 0)+1, new_stats.get ("nie:title", 0))
+        self.assertEquals (old_stats.get ("nie:keyword", 0)+2, new_stats.get ("nie:keyword", 0))
+
+        # Replacing a single valued property keeps the count
+        self.tracker.update ("INSERT OR REPLACE { <test://stats-04> nie:title 'other' . }")
+        self.assertEquals (new_stats.get ("nie:title", 0), self.__get_property_stats ().get ("nie:title", 0))
+
+        self.tracker.update ("DELETE { <test://stats-04> a rdfs:Resource. }")
+        final_stats = self.__get_property_stats ()
+        self.assertEquals (old_stats.get ("nie:title", 0), final_stats.get ("nie:title", 0))
+        self.assertEquals (old_stats.get ("nie:keyword", 0), final_stats.get ("nie:keyword", 0))
+
 if __name__ == "__main__":
     ut.main ()
 
@@ -436,6 +436,15 @@ class StoreHelper (Helper):
                 return self.stats_iface.Get ()
             raise (e)
 
+    def get_property_stats (self):
+        try:
+            return self.stats_iface.GetProperties ()
+        except dbus.DBusException as (e):
+            if (e.get_dbus_name().startswith ("org.freedesktop.DBus")):
+                self.start ()
+                return self.stats_iface.GetProperties ()
+            raise (e)
+
 
     def get_tracker_iface (self):
         return self.resources
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libtracker-common/tracker-common.h>
+
+/* Histograms are per process, so every test uses its own stage */
+
+static gboolean
+lookup_stats (TrackerTraceStage  stage,
+              gint64            *count,
+              gint64            *total,
+              gint64            *p50,
+              gint64            *p90,
+              gint64            *p99,
+              gint64            *max)
+{
+	GVariantIter iter;
+	GVariant *stats;
+	const gchar *name;
+	gboolean found = FALSE;
+
+	stats = tracker_trace_get_stats ();
+	g_variant_iter_init (&iter, stats);
+
+	while (g_variant_iter_next (&iter, "(&sxxxxxx)", &name,
+	                            count, total, p50, p90, p99, max)) {
+		if (strcmp (name, tracker_trace_stage_get_name (stage)) == 0) {
+			found = TRUE;
+			break;
+		}
+	}
+
+	g_variant_unref (stats);
+
+	return found;
+}
+
+static void
+assert_within_bucket (gint64 value,
+                      gint64 expected)
+{
+	/* Buckets are 1/8th of the magnitude wide */
+	g_assert_cmpint (value, >=, expected);
+	g_assert_cmpint (value, <=, expected + expected / 8 + 1);
+}
+
+static void
+test_trace_percentiles (void)
+{
+	gint64 count, total, p50, p90, p99, max;
+	gint64 i;
+
+	for (i = 1; i <= 1000; i++) {
+		tracker_trace_record (TRACKER_TRACE_SQLITE_STATEMENT, 0, i);
+	}
+
+	g_assert (lookup_stats (TRACKER_TRACE_SQLITE_STATEMENT,
+	                        &count, &total, &p50, &p90, &p99, &max));
+
+	g_assert_cmpint (count, ==, 1000);
+	g_assert_cmpint (total, ==, 500500);
+	g_assert_cmpint (max, ==, 1000);
+
+	assert_within_bucket (p50, 500);
+	assert_within_bucket (p90, 900);
+	g_assert_cmpint (p99, >=, 990);
+	g_assert_cmpint (p99, <=, max);
+}
+
+static void
+test_trace_small_values (void)
+{
+	gint64 count, total, p50, p90, p99, max;
+
+	/* Values below 16us get a bucket each */
+	tracker_trace_record (TRACKER_TRACE_CHECKPOINT, 0, 3);
+	tracker_trace_record (TRACKER_TRACE_CHECKPOINT, 0, 3);
+	tracker_trace_record (TRACKER_TRACE_CHECKPOINT, 0, 7);
+
+	g_assert (lookup_stats (TRACKER_TRACE_CHECKPOINT,
+	                        &count, &total, &p50, &p90, &p99, &max));
+
+	g_assert_cmpint (count, ==, 3);
+	g_assert_cmpint (total, ==, 13);
+	g_assert_cmpint (p50, ==, 3);
+	g_assert_cmpint (p90, ==, 7);
+	g_assert_cmpint (max, ==, 7);
+}
+
+static gpointer
+record_in_thread (gpointer user_data)
+{
+	tracker_trace_record (TRACKER_TRACE_JOURNAL_WRITE, 0, GPOINTER_TO_INT (user_data));
+
+	return NULL;
+}
+
+static void
+test_trace_threads (void)
+{
+	gint64 count, total, p50, p90, p99, max;
+	GThread *thread;
+
+	/* Events of running and exited threads are both accounted */
+	tracker_trace_record (TRACKER_TRACE_JOURNAL_WRITE, 0, 10);
+
+	thread = g_thread_new ("trace-test", record_in_thread, GINT_TO_POINTER (30));
+	g_thread_join (thread);
+
+	g_assert (lookup_stats (TRACKER_TRACE_JOURNAL_WRITE,
+	                        &count, &total, &p50, &p90, &p99, &max));
+
+	g_assert_cmpint (count, ==, 2);
+	g_assert_cmpint (total, ==, 40);
+	g_assert_cmpint (max, ==, 30);
+}
+
+static void
+test_trace_unused_stage (void)
+{
+	gint64 count, total, p50, p90, p99, max;
+
+	g_assert (!lookup_stats (TRACKER_TRACE_SIGNAL_EMIT,
+	                         &count, &total, &p50, &p90, &p99, &max));
+}
+
+static void
+test_trace_dump (void)
+{
+	gchar *path, *contents;
+
+	tracker_trace_record (TRACKER_TRACE_JOURNAL_FSYNC, 1000, 250);
+
+	path = g_build_filename (g_getenv ("TRACKER_TRACE"), "dump.json", NULL);
+	g_assert (tracker_trace_dump (path, NULL));
+	g_assert (g_file_get_contents (path, &contents, NULL, NULL));
+
+	g_assert (g_str_has_prefix (contents, "{\"traceEvents\":["));
+	g_assert (strstr (contents, "\"name\":\"journal-fsync\",\"cat\":\"tracker\",\"ph\":\"X\","
+	                            "\"ts\":1000,\"dur\":250") != NULL);
+
+	g_unlink (path);
+	g_free (contents);
+	g_free (path);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	gchar *trace_dir;
+	gint result;
+
+	/* Must be set before the first event is recorded */
+	trace_dir = g_dir_make_tmp ("tracker-trace-test-XXXXXX", NULL);
+	g_assert (trace_dir != NULL);
+	g_setenv ("TRACKER_TRACE", trace_dir, TRUE);
+
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-common/trace/percentiles",
+	                 test_trace_percentiles);
+	g_test_add_func ("/libtracker-common/trace/small-values",
+	                 test_trace_small_values);
+	g_test_add_func ("/libtracker-common/trace/threads",
+	                 test_trace_threads);
+	g_test_add_func ("/libtracker-common/trace/unused-stage",
+	                 test_trace_unused_stage);
+	g_test_add_func ("/libtracker-common/trace/dump",
+	                 test_trace_dump);
+
+	result = g_test_run ();
+
+	g_rmdir (trace_dir);
+	g_free (trace_dir);
+
+	return result;
+}
@@ -27,6 +27,7 @@
 #include <libtracker-common/tracker-common.h>
 
 #include <libtracker-data/tracker-data-backup.h>
+#include <libtracker-data/tracker-db-backup.h>
 #include <libtracker-data/tracker-data-manager.h>
 #include <libtracker-data/tracker-data-query.h>
 #include <libtracker-data/tracker-data-update.h>
@@ -211,6 +212,119 @@ test_journal_then_backup_and_restore (void)
 	backup_calls = 0;
 }
 
+static void
+save_backup (GFile *backup_file)
+{
+	tracker_db_backup_save (backup_file,
+	                        backup_finished_cb,
+	                        NULL,
+	                        NULL);
+
+	loop = g_main_loop_new (NULL, FALSE);
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+	loop = NULL;
+}
+
+/*
+ * Back-up, modify the DB and back-up again over the first backup,
+ * which only copies the pages that changed where the filesystem can
+ * clone the first one. Both are checked against their manifest, the
+ * second must restore the change, and a damaged backup must fail the
+ * check.
+ */
+static void
+test_incremental_backup (void)
+{
+	gchar  *data_prefix, *data_filename, *backup_filename, *db_location, *contents;
+	GError *error = NULL;
+	GFile  *backup_file, *manifest_file;
+	gchar *test_schemas[5] = { NULL, NULL, NULL, NULL, NULL };
+	gsize len;
+
+	db_location = g_build_path (G_DIR_SEPARATOR_S, g_get_current_dir (), "tracker", NULL);
+	data_prefix = g_build_path (G_DIR_SEPARATOR_S,
+	                            TOP_SRCDIR, "tests", "libtracker-data", "backup", "backup",
+	                            NULL);
+
+	test_schemas[0] = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-data", "ontologies", "20-dc", NULL);
+	test_schemas[1] = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-data", "ontologies", "31-nao", NULL);
+	test_schemas[2] = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-data", "ontologies", "90-tracker", NULL);
+	test_schemas[3] = data_prefix;
+
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+
+	tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                           (const gchar **) test_schemas,
+	                           NULL, FALSE, FALSE,
+	                           100, 100, NULL, NULL, NULL, &error);
+
+	g_assert_no_error (error);
+
+	data_filename = g_strconcat (data_prefix, ".data", NULL);
+	tracker_turtle_reader_load (data_filename, &error);
+	g_assert_no_error (error);
+	g_free (data_filename);
+
+	g_mkdir_with_parents (db_location, 0777);
+	backup_filename = g_build_filename (db_location, "incremental.dump", NULL);
+	backup_file = g_file_new_for_path (backup_filename);
+	g_free (backup_filename);
+
+	backup_filename = g_build_filename (db_location, "incremental.dump.manifest", NULL);
+	manifest_file = g_file_new_for_path (backup_filename);
+	g_free (backup_filename);
+
+	/* Left over from a previous run, the first backup must be full */
+	g_file_delete (backup_file, NULL, NULL);
+	g_file_delete (manifest_file, NULL, NULL);
+
+	save_backup (backup_file);
+
+	g_assert (g_file_query_exists (manifest_file, NULL));
+	g_assert (tracker_db_backup_verify (backup_file, &error));
+	g_assert_no_error (error);
+
+	tracker_data_update_sparql ("INSERT { <http://example.org/ns#instance14> a <http://example.org/ns#class1> }",
+	                            &error);
+	g_assert_no_error (error);
+
+	save_backup (backup_file);
+
+	g_assert (tracker_db_backup_verify (backup_file, &error));
+	g_assert_no_error (error);
+	g_assert_cmpint (backup_calls, ==, 2);
+
+#ifdef DISABLE_JOURNAL
+	tracker_data_backup_restore (backup_file, (const gchar **) test_schemas, NULL, NULL, &error);
+	g_assert_no_error (error);
+	check_content_in_db (4, 1);
+#endif /* DISABLE_JOURNAL */
+
+	/* Damage the backup */
+	g_assert (g_file_load_contents (backup_file, NULL, &contents, &len, NULL, NULL));
+	contents[len / 2] ^= 0xff;
+	g_assert (g_file_replace_contents (backup_file, contents, len, NULL, FALSE,
+	                                   G_FILE_CREATE_NONE, NULL, NULL, NULL));
+	g_free (contents);
+
+	g_assert (!tracker_db_backup_verify (backup_file, &error));
+	g_assert_error (error, TRACKER_DB_BACKUP_ERROR, TRACKER_DB_BACKUP_ERROR_CORRUPT);
+	g_clear_error (&error);
+
+	tracker_data_manager_shutdown ();
+
+	g_object_unref (manifest_file);
+	g_object_unref (backup_file);
+	g_free (test_schemas[0]);
+	g_free (test_schemas[1]);
+	g_free (test_schemas[2]);
+	g_free (test_schemas[3]);
+	g_free (db_location);
+
+	backup_calls = 0;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -233,6 +347,9 @@ main (int argc, char **argv)
 	g_test_add_func ("/tracker/libtracker-data/backup/save_and_restore",
 	                 test_backup_and_restore);
 
+	g_test_add_func ("/tracker/libtracker-data/backup/incremental_save",
+	                 test_incremental_backup);
+
 	/* run tests */
 	result = g_test_run ();
 
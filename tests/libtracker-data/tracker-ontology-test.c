@@ -269,6 +269,97 @@ test_query (gconstpointer test_data)
 	tracker_data_manager_shutdown ();
 }
 
+static gint
+count_indexes (void)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gint count;
+
+	iface = tracker_db_manager_get_db_interface ();
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &error,
+	                                              "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index'");
+	g_assert_no_error (error);
+
+	cursor = tracker_db_statement_start_cursor (stmt, &error);
+	g_assert_no_error (error);
+	g_object_unref (stmt);
+
+	g_assert (tracker_db_cursor_iter_next (cursor, NULL, &error));
+	g_assert_no_error (error);
+	count = tracker_db_cursor_get_int (cursor, 0);
+	g_object_unref (cursor);
+
+	return count;
+}
+
+static void
+test_bulk_load (void)
+{
+	GError *error = NULL;
+	GFile *file;
+	gchar *prefix;
+	gchar *data_filename, *query_filename, *results_filename;
+	gint n_indexes;
+#if HAVE_TRACKER_FTS
+	TrackerDBCursor *cursor;
+#endif
+
+	prefix = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-data", "nie", NULL);
+	data_filename = g_build_filename (prefix, "data-1.ttl", NULL);
+	query_filename = g_build_filename (prefix, "filter-title-1.rq", NULL);
+	results_filename = g_build_filename (prefix, "filter-title-1.out", NULL);
+	g_free (prefix);
+
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+
+	tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                           NULL, NULL, FALSE, FALSE,
+	                           100, 100, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	n_indexes = count_indexes ();
+
+	file = g_file_new_for_path (data_filename);
+	tracker_data_load_turtle_file_bulk (file, &error);
+	g_assert_no_error (error);
+
+	/* same results as a regular load */
+	query_helper (query_filename, results_filename);
+
+	/* indexes dropped for the load are back */
+	g_assert_cmpint (count_indexes (), ==, n_indexes);
+
+	/* tables that have rows keep their indexes */
+	tracker_data_load_turtle_file_bulk (file, &error);
+	g_assert_no_error (error);
+	g_object_unref (file);
+
+	query_helper (query_filename, results_filename);
+	g_assert_cmpint (count_indexes (), ==, n_indexes);
+
+#if HAVE_TRACKER_FTS
+	/* and so is the text of the new resources */
+	cursor = tracker_data_query_sparql_cursor ("SELECT ?title WHERE { ?x fts:match 'stringly' ; nie:title ?title }",
+	                                           &error);
+	g_assert_no_error (error);
+
+	g_assert (tracker_db_cursor_iter_next (cursor, NULL, &error));
+	g_assert_cmpstr (tracker_db_cursor_get_string (cursor, 0, NULL), ==, "stringly data for nie:title");
+	g_assert (!tracker_db_cursor_iter_next (cursor, NULL, &error));
+	g_assert_no_error (error);
+	g_object_unref (cursor);
+#endif
+
+	g_free (data_filename);
+	g_free (query_filename);
+	g_free (results_filename);
+
+	tracker_data_manager_shutdown ();
+}
+
 int
 main (int argc, char **argv)
 {
@@ -312,6 +403,8 @@ main (int argc, char **argv)
 		g_free (testpath);
 	}
 
+	g_test_add_func ("/libtracker-data/bulk-load", test_bulk_load);
+
 	/* run tests */
 
 	result = g_test_run ();
@@ -115,6 +115,8 @@ const TestInfo tests[] = {
 	{ "sort/query-sort-6", "sort/data-sort-4", FALSE },
 	{ "sort/query-sort-7", "sort/data-sort-1", FALSE },
 	{ "sort/query-sort-8", "sort/data-sort-5", FALSE },
+	{ "sort/query-sort-9", "sort/data-sort-6", FALSE },
+	{ "sort/query-sort-10", "sort/data-sort-6", FALSE },
 	{ "subqueries/subqueries-1", "subqueries/data-1", FALSE },
 	{ "subqueries/subqueries-union-1", "subqueries/data-1", FALSE },
 	{ "subqueries/subqueries-union-2", "subqueries/data-1", FALSE },
@@ -317,6 +319,134 @@ test_sparql_query (gconstpointer test_data)
 	tracker_data_manager_shutdown ();
 }
 
+static gchar *
+read_paged_results (const gchar *query,
+                    gint         page_size)
+{
+	TrackerSparqlQuery *sparql_query;
+	TrackerDBCursor *cursor;
+	GString *results;
+	GError *error = NULL;
+	gchar *continuation = NULL;
+
+	results = g_string_new ("");
+
+	do {
+		gint n_rows = 0;
+
+		sparql_query = tracker_sparql_query_new_paged (query, page_size, continuation);
+		cursor = tracker_sparql_query_execute_cursor (sparql_query, FALSE, &error);
+		g_assert_no_error (error);
+
+		g_free (continuation);
+		continuation = NULL;
+
+		while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+			/* sort keys follow the selected variables */
+			g_assert_cmpint (tracker_db_cursor_get_n_columns (cursor) -
+			                 tracker_sparql_query_get_n_sort_keys (sparql_query), ==, 2);
+
+			g_string_append_printf (results, "\"%s\"\t\"%s\"\n",
+			                        tracker_db_cursor_get_string (cursor, 0, NULL),
+			                        tracker_db_cursor_get_string (cursor, 1, NULL));
+
+			if (++n_rows == page_size) {
+				continuation = tracker_sparql_query_get_continuation (sparql_query, cursor);
+			}
+		}
+
+		g_assert_no_error (error);
+		g_assert_cmpint (n_rows, <=, page_size);
+
+		g_object_unref (cursor);
+		g_object_unref (sparql_query);
+	} while (continuation);
+
+	return g_string_free (results, FALSE);
+}
+
+typedef struct _PagedTestInfo PagedTestInfo;
+
+struct _PagedTestInfo {
+	const gchar *data;
+	const gchar *query;
+	gint n_rows;
+};
+
+const PagedTestInfo paged_tests[] = {
+	/* "Bob" appears twice, the tie breaker has to keep both */
+	{ "sort/data-sort-4",
+	  "PREFIX foaf: <http://xmlns.com/foaf/0.1/> "
+	  "PREFIX ex: <http://example.org/things#> "
+	  "SELECT ?name ?emp WHERE { ?x foaf:name ?name ; ex:empId ?emp } "
+	  "ORDER BY DESC(?name)",
+	  5 },
+	/* several rows of the same resource with multi-valued literals,
+	 * they only differ in the literal values */
+	{ "sort/data-sort-7",
+	  "PREFIX foaf: <http://xmlns.com/foaf/0.1/> "
+	  "PREFIX ex: <http://example.org/things#> "
+	  "SELECT ?name ?emp WHERE { ?x foaf:name ?name ; ex:empId ?emp } "
+	  "ORDER BY DESC(?x)",
+	  11 },
+	{ "sort/data-sort-7",
+	  "PREFIX foaf: <http://xmlns.com/foaf/0.1/> "
+	  "PREFIX ex: <http://example.org/things#> "
+	  "SELECT ?name ?emp WHERE { ?x foaf:name ?name ; ex:empId ?emp }",
+	  11 },
+	{ NULL }
+};
+
+static void
+test_sparql_query_paged (gconstpointer test_data)
+{
+	const PagedTestInfo *test_info = test_data;
+	GError *error = NULL;
+	gchar *data_filename;
+	gchar *prefix, *data_prefix;
+	gchar *expected, *results;
+	gchar **lines;
+	const gchar *test_schemas[2] = { NULL, NULL };
+	gint page_size;
+
+	prefix = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-data", NULL);
+	data_prefix = g_build_filename (prefix, test_info->data, NULL);
+	g_free (prefix);
+
+	test_schemas[0] = data_prefix;
+
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+
+	tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                           test_schemas,
+	                           NULL, FALSE, FALSE,
+	                           100, 100, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	data_filename = g_strconcat (data_prefix, ".ttl", NULL);
+	tracker_turtle_reader_load (data_filename, &error);
+	g_assert_no_error (error);
+
+	expected = read_paged_results (test_info->query, 100);
+
+	lines = g_strsplit (expected, "\n", -1);
+	/* the last line is empty */
+	g_assert_cmpint (g_strv_length (lines) - 1, ==, test_info->n_rows);
+	g_strfreev (lines);
+
+	for (page_size = 1; page_size <= 4; page_size++) {
+		results = read_paged_results (test_info->query, page_size);
+		g_assert_cmpstr (results, ==, expected);
+		g_free (results);
+	}
+
+	g_free (expected);
+	g_free (data_filename);
+	g_free (data_prefix);
+
+	tracker_data_manager_shutdown ();
+}
+
 int
 main (int argc, char **argv)
 {
@@ -356,6 +486,14 @@ main (int argc, char **argv)
 		g_free (testpath);
 	}
 
+	for (i = 0; paged_tests[i].data; i++) {
+		gchar *testpath;
+
+		testpath = g_strdup_printf ("/libtracker-data/sparql/paged_%d", i + 1);
+		g_test_add_data_func (testpath, &paged_tests[i], test_sparql_query_paged);
+		g_free (testpath);
+	}
+
 	/* run tests */
 	result = g_test_run ();
 
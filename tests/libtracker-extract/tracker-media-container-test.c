@@ -0,0 +1,562 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+/* Runs the MP4, Matroska and Ogg extractors over small files built
+ * in memory, and over every truncation of them, which must be
+ * refused or partially described but never crash. */
+
+typedef struct {
+	const gchar *module;
+	const gchar *mimetype;
+	GByteArray * (* build) (void);
+	const gchar *expected[8];
+} ContainerTest;
+
+static void
+append_uint (GByteArray *data,
+             guint64     value,
+             guint       n_bytes)
+{
+	guchar bytes[8];
+	guint i;
+
+	for (i = 0; i < n_bytes; i++) {
+		bytes[i] = (value >> (8 * (n_bytes - i - 1))) & 0xff;
+	}
+
+	g_byte_array_append (data, bytes, n_bytes);
+}
+
+static void
+append_uint_le (GByteArray *data,
+                guint64     value,
+                guint       n_bytes)
+{
+	guchar bytes[8];
+	guint i;
+
+	for (i = 0; i < n_bytes; i++) {
+		bytes[i] = (value >> (8 * i)) & 0xff;
+	}
+
+	g_byte_array_append (data, bytes, n_bytes);
+}
+
+static void
+append_string (GByteArray  *data,
+               const gchar *str)
+{
+	g_byte_array_append (data, (const guint8 *) str, strlen (str));
+}
+
+static void
+append_zeros (GByteArray *data,
+              guint       n_bytes)
+{
+	guint len = data->len;
+
+	g_byte_array_set_size (data, len + n_bytes);
+	memset (data->data + len, 0, n_bytes);
+}
+
+static void
+append_array (GByteArray *data,
+              GByteArray *child)
+{
+	g_byte_array_append (data, child->data, child->len);
+	g_byte_array_unref (child);
+}
+
+/* MP4 */
+
+static GByteArray *
+mp4_box (const gchar *type,
+         GByteArray  *payload)
+{
+	GByteArray *box = g_byte_array_new ();
+
+	append_uint (box, 8 + payload->len, 4);
+	g_byte_array_append (box, (const guint8 *) type, 4);
+	append_array (box, payload);
+
+	return box;
+}
+
+static GByteArray *
+mp4_hdlr (const gchar *handler)
+{
+	GByteArray *payload = g_byte_array_new ();
+
+	append_zeros (payload, 8);
+	append_string (payload, handler);
+	append_zeros (payload, 13);
+
+	return mp4_box ("hdlr", payload);
+}
+
+static GByteArray *
+mp4_ilst_item (const gchar  *type,
+               guint32       data_type,
+               const guint8 *value,
+               gsize         value_len)
+{
+	GByteArray *data = g_byte_array_new ();
+
+	append_uint (data, data_type, 4);
+	append_zeros (data, 4);
+	g_byte_array_append (data, value, value_len);
+
+	return mp4_box (type, mp4_box ("data", data));
+}
+
+static GByteArray *
+build_mp4 (void)
+{
+	GByteArray *file, *payload, *stsd, *trak, *ilst, *meta;
+	const guint8 trkn[] = { 0, 0, 0, 3, 0, 12, 0, 0 };
+
+	file = g_byte_array_new ();
+
+	payload = g_byte_array_new ();
+	append_string (payload, "M4A ");
+	append_zeros (payload, 4);
+	append_string (payload, "M4A isom");
+	append_array (file, mp4_box ("ftyp", payload));
+
+	/* Sample entry: size, format, reserved and data reference
+	 * index, version, revision, vendor, channels, sample size,
+	 * compression id, packet size and 16.16 sample rate */
+	stsd = g_byte_array_new ();
+	append_zeros (stsd, 4);
+	append_uint (stsd, 1, 4);
+	append_uint (stsd, 36, 4);
+	append_string (stsd, "mp4a");
+	append_zeros (stsd, 6);
+	append_uint (stsd, 1, 2);
+	append_zeros (stsd, 8);
+	append_uint (stsd, 2, 2);
+	append_uint (stsd, 16, 2);
+	append_zeros (stsd, 4);
+	append_uint (stsd, (guint64) 44100 << 16, 4);
+
+	trak = g_byte_array_new ();
+	append_array (trak, mp4_hdlr ("soun"));
+	payload = g_byte_array_new ();
+	append_array (payload, mp4_box ("stsd", stsd));
+	payload = mp4_box ("stbl", payload);
+	payload = mp4_box ("minf", payload);
+	append_array (trak, payload);
+	trak = mp4_box ("trak", mp4_box ("mdia", trak));
+
+	ilst = g_byte_array_new ();
+	append_array (ilst, mp4_ilst_item ("\251nam", 1, (const guint8 *) "Test title", 10));
+	append_array (ilst, mp4_ilst_item ("\251ART", 1, (const guint8 *) "Test artist", 11));
+	append_array (ilst, mp4_ilst_item ("trkn", 0, trkn, sizeof (trkn)));
+
+	meta = g_byte_array_new ();
+	append_zeros (meta, 4);
+	append_array (meta, mp4_hdlr ("mdir"));
+	append_array (meta, mp4_box ("ilst", ilst));
+
+	/* Version 0 movie header: timescale 1000, duration 5s */
+	payload = g_byte_array_new ();
+	append_zeros (payload, 12);
+	append_uint (payload, 1000, 4);
+	append_uint (payload, 5000, 4);
+	append_zeros (payload, 80);
+
+	payload = mp4_box ("mvhd", payload);
+	append_array (payload, trak);
+	append_array (payload, mp4_box ("udta", mp4_box ("meta", meta)));
+	append_array (file, mp4_box ("moov", payload));
+
+	payload = g_byte_array_new ();
+	append_zeros (payload, 64);
+	append_array (file, mp4_box ("mdat", payload));
+
+	return file;
+}
+
+/* Matroska */
+
+static GByteArray *
+ebml_element (guint32     id,
+              GByteArray *payload)
+{
+	GByteArray *element = g_byte_array_new ();
+
+	if (id > 0xffffff) {
+		append_uint (element, id, 4);
+	} else if (id > 0xffff) {
+		append_uint (element, id, 3);
+	} else if (id > 0xff) {
+		append_uint (element, id, 2);
+	} else {
+		append_uint (element, id, 1);
+	}
+
+	g_assert_cmpuint (payload->len, <, 0x3fff);
+
+	if (payload->len < 0x7f) {
+		append_uint (element, 0x80 | payload->len, 1);
+	} else {
+		append_uint (element, 0x4000 | payload->len, 2);
+	}
+
+	append_array (element, payload);
+
+	return element;
+}
+
+static GByteArray *
+ebml_uint (guint32 id,
+           guint64 value,
+           guint   n_bytes)
+{
+	GByteArray *payload = g_byte_array_new ();
+
+	append_uint (payload, value, n_bytes);
+
+	return ebml_element (id, payload);
+}
+
+static GByteArray *
+ebml_float (guint32 id,
+            gdouble value)
+{
+	union {
+		guint64 i;
+		gdouble d;
+	} f64;
+
+	f64.d = value;
+
+	return ebml_uint (id, f64.i, 8);
+}
+
+static GByteArray *
+ebml_string (guint32      id,
+             const gchar *value)
+{
+	GByteArray *payload = g_byte_array_new ();
+
+	append_string (payload, value);
+
+	return ebml_element (id, payload);
+}
+
+static GByteArray *
+mkv_simple_tag (const gchar *name,
+                const gchar *value)
+{
+	GByteArray *payload = g_byte_array_new ();
+
+	append_array (payload, ebml_string (0x45A3, name));
+	append_array (payload, ebml_string (0x4487, value));
+
+	return ebml_element (0x67C8, payload);
+}
+
+static GByteArray *
+build_matroska (void)
+{
+	GByteArray *file, *payload, *segment, *audio, *entry, *tag;
+
+	file = g_byte_array_new ();
+
+	payload = g_byte_array_new ();
+	append_array (payload, ebml_uint (0x4286, 1, 1));
+	append_array (payload, ebml_string (0x4282, "matroska"));
+	append_array (file, ebml_element (0x1A45DFA3, payload));
+
+	segment = g_byte_array_new ();
+
+	/* Info: 1ms timecodes, 5000 of them */
+	payload = g_byte_array_new ();
+	append_array (payload, ebml_uint (0x2AD7B1, 1000000, 3));
+	append_array (payload, ebml_float (0x4489, 5000.0));
+	append_array (payload, ebml_string (0x7BA9, "Test title"));
+	append_array (segment, ebml_element (0x1549A966, payload));
+
+	audio = g_byte_array_new ();
+	append_array (audio, ebml_float (0xB5, 44100.0));
+	append_array (audio, ebml_uint (0x9F, 2, 1));
+
+	entry = g_byte_array_new ();
+	append_array (entry, ebml_uint (0x83, 2, 1));
+	append_array (entry, ebml_string (0x86, "A_VORBIS"));
+	append_array (entry, ebml_element (0xE1, audio));
+	append_array (segment, ebml_element (0x1654AE6B, ebml_element (0xAE, entry)));
+
+	/* Track level tags */
+	tag = g_byte_array_new ();
+	append_array (tag, ebml_element (0x63C0, ebml_uint (0x68CA, 30, 1)));
+	append_array (tag, mkv_simple_tag ("ARTIST", "Test artist"));
+	append_array (tag, mkv_simple_tag ("PART_NUMBER", "3"));
+	append_array (segment, ebml_element (0x1254C367, ebml_element (0x7373, tag)));
+
+	payload = g_byte_array_new ();
+	append_array (payload, ebml_uint (0xE7, 0, 1));
+	append_zeros (payload, 64);
+	append_array (segment, ebml_element (0x1F43B675, payload));
+
+	append_array (file, ebml_element (0x18538067, segment));
+
+	return file;
+}
+
+/* Ogg */
+
+static void
+append_ogg_page (GByteArray *file,
+                 guint8      flags,
+                 guint64     granule,
+                 guint32     sequence,
+                 GByteArray *packet)
+{
+	g_assert_cmpuint (packet->len, <, 255);
+
+	append_string (file, "OggS");
+	append_uint (file, 0, 1);
+	append_uint (file, flags, 1);
+	append_uint_le (file, granule, 8);
+	append_uint_le (file, 0x1234, 4);
+	append_uint_le (file, sequence, 4);
+	/* The CRC is not checked */
+	append_zeros (file, 4);
+	append_uint (file, 1, 1);
+	append_uint (file, packet->len, 1);
+	append_array (file, packet);
+}
+
+static GByteArray *
+build_ogg (void)
+{
+	const gchar *comments[] = { "TITLE=Test title", "ARTIST=Test artist", "TRACKNUMBER=3/12" };
+	GByteArray *file, *packet;
+	guint i;
+
+	file = g_byte_array_new ();
+
+	/* Opus identification header: version, channels, pre-skip,
+	 * input sample rate, output gain and mapping family */
+	packet = g_byte_array_new ();
+	append_string (packet, "OpusHead");
+	append_uint (packet, 1, 1);
+	append_uint (packet, 2, 1);
+	append_uint_le (packet, 312, 2);
+	append_uint_le (packet, 44100, 4);
+	append_zeros (packet, 3);
+	append_ogg_page (file, 0x02, 0, 0, packet);
+
+	packet = g_byte_array_new ();
+	append_string (packet, "OpusTags");
+	append_uint_le (packet, 4, 4);
+	append_string (packet, "test");
+	append_uint_le (packet, G_N_ELEMENTS (comments), 4);
+
+	for (i = 0; i < G_N_ELEMENTS (comments); i++) {
+		append_uint_le (packet, strlen (comments[i]), 4);
+		append_string (packet, comments[i]);
+	}
+
+	append_ogg_page (file, 0, 0, 1, packet);
+
+	/* Granules count 48kHz samples after the pre-skip */
+	packet = g_byte_array_new ();
+	append_zeros (packet, 32);
+	append_ogg_page (file, 0x04, 312 + 48000 * 5, 2, packet);
+
+	return file;
+}
+
+static const ContainerTest container_tests[] = {
+#ifdef HAVE_MP4
+	{ "libextract-mp4.so", "audio/mp4", build_mp4,
+	  { "nmm:MusicPiece", "nie:title \"Test title\"", "nmm:performer",
+	    "nmm:trackNumber 3", "nfo:duration 5", "nfo:sampleRate 44100",
+	    "nfo:channels 2", NULL } },
+#endif
+#ifdef HAVE_MATROSKA
+	{ "libextract-matroska.so", "audio/x-matroska", build_matroska,
+	  { "nmm:MusicPiece", "nie:title \"Test title\"", "nmm:performer",
+	    "nmm:trackNumber 3", "nfo:duration 5", "nfo:sampleRate 44100",
+	    "nfo:channels 2", NULL } },
+#endif
+#ifdef HAVE_OGG
+	{ "libextract-ogg.so", "audio/x-opus+ogg", build_ogg,
+	  { "nmm:MusicPiece", "nie:title \"Test title\"", "nmm:performer",
+	    "nmm:trackNumber 3", "nfo:duration 5", "nfo:sampleRate 44100",
+	    "nfo:channels 2", NULL } },
+#endif
+	{ NULL }
+};
+
+static TrackerExtractMetadataFunc
+load_module (const gchar *name)
+{
+	TrackerExtractMetadataFunc func;
+	GModule *module;
+	gchar *path;
+
+	path = g_build_filename (TOP_BUILDDIR, "src", "tracker-extract", ".libs", name, NULL);
+	module = g_module_open (path, G_MODULE_BIND_LOCAL);
+	g_free (path);
+
+	if (!module) {
+		g_printerr ("Could not load module '%s': %s\n", name, g_module_error ());
+		return NULL;
+	}
+
+	g_assert (g_module_symbol (module, "tracker_extract_get_metadata", (gpointer *) &func));
+	g_module_make_resident (module);
+
+	return func;
+}
+
+static TrackerExtractInfo *
+extract_file (TrackerExtractMetadataFunc  func,
+              const gchar                *mimetype,
+              const guint8               *data,
+              gsize                       len,
+              gboolean                   *success)
+{
+	TrackerExtractInfo *info;
+	GError *error = NULL;
+	GFile *file;
+	gchar *path;
+	gint fd;
+
+	fd = g_file_open_tmp ("tracker-media-container-XXXXXX", &path, &error);
+	g_assert_no_error (error);
+	close (fd);
+
+	g_file_set_contents (path, (const gchar *) data, len, &error);
+	g_assert_no_error (error);
+
+	file = g_file_new_for_path (path);
+	info = tracker_extract_info_new (file, mimetype, NULL);
+	*success = func (info);
+
+	g_object_unref (file);
+	g_unlink (path);
+	g_free (path);
+
+	return info;
+}
+
+static void
+test_container (gconstpointer user_data)
+{
+	const ContainerTest *test = user_data;
+	TrackerExtractMetadataFunc func;
+	TrackerExtractInfo *info;
+	const gchar *result;
+	GByteArray *data;
+	gboolean success;
+	gsize i;
+
+	func = load_module (test->module);
+
+	if (!func) {
+		g_test_message ("Module %s not built, skipping", test->module);
+		return;
+	}
+
+	data = test->build ();
+	info = extract_file (func, test->mimetype, data->data, data->len, &success);
+	g_assert (success);
+
+	result = tracker_sparql_builder_get_result (tracker_extract_info_get_metadata_builder (info));
+
+	for (i = 0; test->expected[i]; i++) {
+		if (!strstr (result, test->expected[i])) {
+			g_error ("'%s' not found in: %s", test->expected[i], result);
+		}
+	}
+
+	tracker_extract_info_unref (info);
+	g_byte_array_unref (data);
+}
+
+static void
+test_container_truncated (gconstpointer user_data)
+{
+	const ContainerTest *test = user_data;
+	TrackerExtractMetadataFunc func;
+	GByteArray *data;
+	gboolean success;
+	gsize len;
+
+	func = load_module (test->module);
+
+	if (!func) {
+		g_test_message ("Module %s not built, skipping", test->module);
+		return;
+	}
+
+	data = test->build ();
+
+	/* Whether a prefix is accepted depends on where it is cut, it
+	 * only has to be walked within its bounds */
+	for (len = 0; len < data->len; len++) {
+		tracker_extract_info_unref (extract_file (func, test->mimetype,
+		                                          data->data, len, &success));
+	}
+
+	g_byte_array_unref (data);
+}
+
+int
+main (int argc, char **argv)
+{
+	guint i;
+
+	g_test_init (&argc, &argv, NULL);
+
+	for (i = 0; container_tests[i].module; i++) {
+		gchar *name, *testpath;
+
+		name = g_strndup (container_tests[i].module + strlen ("libextract-"),
+		                  strlen (container_tests[i].module) - strlen ("libextract-.so"));
+
+		testpath = g_strdup_printf ("/libtracker-extract/media-container/%s", name);
+		g_test_add_data_func (testpath, &container_tests[i], test_container);
+		g_free (testpath);
+
+		testpath = g_strdup_printf ("/libtracker-extract/media-container/%s/truncated", name);
+		g_test_add_data_func (testpath, &container_tests[i], test_container_truncated);
+		g_free (testpath);
+
+		g_free (name);
+	}
+
+	return g_test_run ();
+}
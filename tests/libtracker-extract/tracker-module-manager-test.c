@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <string.h>
+#include <utime.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+/* The module manager is initialized once per process, so every test
+ * runs the lookups in a subprocess sharing the rules and cache dirs */
+
+static const struct {
+	const gchar *name;
+	const gchar *contents;
+} rule_files[] = {
+	{ "10-exact.rule",
+	  "[ExtractorRule]\n"
+	  "ModulePath=libextract-exact.so\n"
+	  "MimeTypes=audio/mpeg;audio/*;\n"
+	  "FallbackRdfTypes=nfo:Exact;\n" },
+	{ "20-prefix.rule",
+	  "[ExtractorRule]\n"
+	  "ModulePath=libextract-prefix.so\n"
+	  "MimeTypes=audio/*;application/vnd.oasis.opendocument.*;\n"
+	  "FallbackRdfTypes=nfo:Prefix;\n" },
+	{ "30-glob.rule",
+	  "[ExtractorRule]\n"
+	  "ModulePath=libextract-glob.so\n"
+	  "MimeTypes=application/x-*-image;\n"
+	  "FallbackRdfTypes=nfo:Glob;\n" },
+	{ "README",
+	  "Not a rule\n" },
+};
+
+static gchar *
+fallback_types (const gchar *mimetype)
+{
+	GStrv types;
+	GPtrArray *sorted;
+	gchar *str;
+	gint i;
+
+	types = tracker_extract_module_manager_get_fallback_rdf_types (mimetype);
+	sorted = g_ptr_array_new ();
+
+	for (i = 0; types && types[i]; i++) {
+		g_ptr_array_add (sorted, types[i]);
+	}
+
+	g_ptr_array_sort (sorted, (GCompareFunc) g_strcmp0);
+	g_ptr_array_add (sorted, NULL);
+
+	str = g_strjoinv (" ", (gchar **) sorted->pdata);
+
+	g_ptr_array_free (sorted, TRUE);
+	g_strfreev (types);
+
+	return str;
+}
+
+static void
+assert_fallback_types (const gchar *mimetype,
+                       const gchar *expected)
+{
+	gchar *types;
+
+	types = fallback_types (mimetype);
+	g_assert_cmpstr (types, ==, expected);
+	g_free (types);
+}
+
+static void
+test_lookup_subprocess (void)
+{
+	g_assert (tracker_extract_module_manager_init ());
+
+	/* Exact and prefix patterns of one rule only count once */
+	assert_fallback_types ("audio/mpeg", "nfo:Exact nfo:Prefix");
+	assert_fallback_types ("audio/x-vorbis+ogg", "nfo:Exact nfo:Prefix");
+	assert_fallback_types ("application/vnd.oasis.opendocument.text", "nfo:Prefix");
+	assert_fallback_types ("application/x-cd-image", "nfo:Glob");
+	assert_fallback_types ("audio", "");
+	assert_fallback_types ("text/plain", "");
+
+	/* Misses are cached too, look them up again */
+	assert_fallback_types ("text/plain", "");
+
+	g_assert (tracker_extract_module_manager_mimetype_is_handled ("audio/mpeg"));
+	g_assert (!tracker_extract_module_manager_mimetype_is_handled ("text/plain"));
+}
+
+static void
+test_rules_parsed (void)
+{
+	g_test_trap_subprocess ("/libtracker-extract/module-manager/lookup/subprocess", 0, 0);
+	g_test_trap_assert_passed ();
+	g_test_trap_assert_stderr ("*Loading extractor rules*");
+}
+
+static void
+test_rules_cached (void)
+{
+	g_test_trap_subprocess ("/libtracker-extract/module-manager/lookup/subprocess", 0, 0);
+	g_test_trap_assert_passed ();
+	g_test_trap_assert_stderr ("*Extractor rules loaded from cache*");
+	g_test_trap_assert_stderr_unmatched ("*Loading extractor rules*");
+}
+
+static void
+test_rules_changed (void)
+{
+	struct utimbuf buf;
+	GStatBuf st;
+	gchar *path;
+
+	path = g_build_filename (g_getenv ("TRACKER_EXTRACTOR_RULES_DIR"), "20-prefix.rule", NULL);
+	g_assert_cmpint (g_stat (path, &st), ==, 0);
+
+	buf.actime = st.st_atime;
+	buf.modtime = st.st_mtime + 10;
+	g_assert_cmpint (g_utime (path, &buf), ==, 0);
+	g_free (path);
+
+	g_test_trap_subprocess ("/libtracker-extract/module-manager/lookup/subprocess", 0, 0);
+	g_test_trap_assert_passed ();
+	g_test_trap_assert_stderr ("*Loading extractor rules*");
+}
+
+int
+main (int argc, char **argv)
+{
+	gchar *rules_dir = NULL, *cache_dir = NULL, *path;
+	gint result;
+	guint i;
+
+	/* Subprocesses inherit the directories set up by the parent */
+	if (!g_getenv ("TRACKER_EXTRACTOR_RULES_DIR")) {
+		cache_dir = g_dir_make_tmp ("tracker-module-manager-test-XXXXXX", NULL);
+		g_assert (cache_dir != NULL);
+
+		rules_dir = g_build_filename (cache_dir, "rules", NULL);
+		g_assert_cmpint (g_mkdir (rules_dir, 0700), ==, 0);
+
+		for (i = 0; i < G_N_ELEMENTS (rule_files); i++) {
+			path = g_build_filename (rules_dir, rule_files[i].name, NULL);
+			g_assert (g_file_set_contents (path, rule_files[i].contents, -1, NULL));
+			g_free (path);
+		}
+
+		g_setenv ("TRACKER_EXTRACTOR_RULES_DIR", rules_dir, TRUE);
+		g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+	}
+
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-extract/module-manager/lookup/subprocess",
+	                 test_lookup_subprocess);
+	g_test_add_func ("/libtracker-extract/module-manager/rules-parsed",
+	                 test_rules_parsed);
+	g_test_add_func ("/libtracker-extract/module-manager/rules-cached",
+	                 test_rules_cached);
+	g_test_add_func ("/libtracker-extract/module-manager/rules-changed",
+	                 test_rules_changed);
+
+	result = g_test_run ();
+
+	if (rules_dir) {
+		for (i = 0; i < G_N_ELEMENTS (rule_files); i++) {
+			path = g_build_filename (rules_dir, rule_files[i].name, NULL);
+			g_unlink (path);
+			g_free (path);
+		}
+
+		path = g_build_filename (cache_dir, "tracker", "extract-rules.cache", NULL);
+		g_unlink (path);
+		g_free (path);
+
+		path = g_build_filename (cache_dir, "tracker", NULL);
+		g_rmdir (path);
+		g_free (path);
+
+		g_rmdir (rules_dir);
+		g_rmdir (cache_dir);
+
+		g_free (rules_dir);
+		g_free (cache_dir);
+	}
+
+	return result;
+}
@@ -25,6 +25,7 @@
 #include <gio/gio.h>
 
 #include <libtracker-fts/tracker-parser.h>
+#include <libtracker-fts/tracker-parser-utils.h>
 
 /* -------------- COMMON FOR ALL TESTS ----------------- */
 
@@ -309,6 +310,11 @@ static const TestDataExpectedNWords test_data_nwords[] = {
 	{ "filename.txt",                                           TRUE,   2, -1 },
 	{ ".hidden.txt",                                            TRUE,   2, -1 },
 	{ "noextension.",                                           TRUE,   1, -1 },
+	/* Pure ASCII input, may be split without the unicode word breaker */
+	{ "The quick (\"brown\") fox can't jump 32.3 feet, right?", TRUE,   8, -1 },
+	{ "The quick (\"brown\") fox can't jump 32.3 feet, right?", FALSE, 10, -1 },
+	{ "snake_case_word and 1,000",                              TRUE,   2, -1 },
+	{ "snake_case_word and 1,000",                              FALSE,  3, -1 },
 	{ "ホモ・サピエンス",                                          TRUE,   2, -1 }, /* katakana */
 	{ "喂人类",                                                   TRUE,   2, 3 }, /* chinese */
 	{ "Американские суда находятся в международных водах.",     TRUE,   6, -1 }, /* russian */
@@ -326,6 +332,128 @@ static const TestDataStopWord test_data_stop_words[] = {
 	{ NULL,    FALSE, FALSE }
 };
 
+#ifdef HAVE_LIBICU
+/* -------------- ASCII FAST PATH TESTS ----------------- */
+
+/* Strings exercising the word break rules the fast path mimics */
+static const gchar *test_data_ascii_fast_path[] = {
+	"don't can't o'clock 'quoted' rock'n'roll",
+	"3.14 1,000 1.000,5 v1.2.3 2014-02-27",
+	"file.txt e-mail user@example.com http://example.com/a_b?c=d",
+	"snake_case __init__ a_1 _ __",
+	"a:b a.b",
+	"a:b",
+	"a.b",
+	"Hello...World!!! ?? -- ;; (x) [y] {z}",
+	"The stopwords of the parser and a word",
+	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa b",
+	"  leading and trailing whitespace \t\n",
+	"",
+	NULL
+};
+
+static TrackerParser *
+ascii_fast_path_parser_new (gboolean ascii_fast_path)
+{
+	TrackerLanguage *language;
+	TrackerParser *parser;
+
+	language = tracker_language_new ("en");
+	parser = tracker_parser_new_full (language, ascii_fast_path);
+	g_object_unref (language);
+
+	return parser;
+}
+
+static void
+ascii_fast_path_compare (TrackerParser *fast,
+                         TrackerParser *icu,
+                         const gchar   *str,
+                         guint          flags)
+{
+	gboolean enable_stemmer = (flags & 1) != 0;
+	gboolean enable_unaccent = (flags & 2) != 0;
+	gboolean ignore_stop_words = (flags & 4) != 0;
+	gboolean ignore_numbers = (flags & 8) != 0;
+	gsize len = strlen (str);
+
+	tracker_parser_reset (fast, str, len, 50,
+	                      enable_stemmer, enable_unaccent,
+	                      ignore_stop_words, TRUE, ignore_numbers);
+	tracker_parser_reset (icu, str, len, 50,
+	                      enable_stemmer, enable_unaccent,
+	                      ignore_stop_words, TRUE, ignore_numbers);
+
+	while (TRUE) {
+		const gchar *fast_word, *icu_word;
+		gint fast_position, icu_position;
+		gint fast_start, icu_start;
+		gint fast_end, icu_end;
+		gboolean fast_stop_word, icu_stop_word;
+		gint fast_length, icu_length;
+
+		fast_word = tracker_parser_next (fast, &fast_position,
+		                                 &fast_start, &fast_end,
+		                                 &fast_stop_word, &fast_length);
+		icu_word = tracker_parser_next (icu, &icu_position,
+		                                &icu_start, &icu_end,
+		                                &icu_stop_word, &icu_length);
+
+		if (!fast_word || !icu_word) {
+			g_assert (fast_word == NULL);
+			g_assert (icu_word == NULL);
+			break;
+		}
+
+		g_assert_cmpstr (fast_word, ==, icu_word);
+		g_assert_cmpint (fast_position, ==, icu_position);
+		g_assert_cmpint (fast_start, ==, icu_start);
+		g_assert_cmpint (fast_end, ==, icu_end);
+		g_assert_cmpint (fast_stop_word, ==, icu_stop_word);
+		g_assert_cmpint (fast_length, ==, icu_length);
+	}
+}
+
+/* Runs the ASCII fast path and the ICU path over the same input and
+ * checks that every token, offset and position is the same. */
+static void
+test_ascii_fast_path (void)
+{
+	TrackerParser *fast, *icu;
+	gchar *corpus;
+	gchar **lines;
+	GError *error = NULL;
+	guint flags;
+	gint i;
+
+	fast = ascii_fast_path_parser_new (TRUE);
+	icu = ascii_fast_path_parser_new (FALSE);
+
+	g_file_get_contents (TOP_SRCDIR "/tests/libtracker-fts/corpus/ascii.txt",
+	                     &corpus, NULL, &error);
+	g_assert_no_error (error);
+
+	lines = g_strsplit (corpus, "\n", -1);
+
+	for (flags = 0; flags < 16; flags++) {
+		ascii_fast_path_compare (fast, icu, corpus, flags);
+
+		for (i = 0; lines[i] != NULL; i++) {
+			ascii_fast_path_compare (fast, icu, lines[i], flags);
+		}
+
+		for (i = 0; test_data_ascii_fast_path[i] != NULL; i++) {
+			ascii_fast_path_compare (fast, icu, test_data_ascii_fast_path[i], flags);
+		}
+	}
+
+	g_strfreev (lines);
+	g_free (corpus);
+	tracker_parser_free (icu);
+	tracker_parser_free (fast);
+}
+#endif /* HAVE_LIBICU */
+
 int
 main (int argc, char **argv)
 {
@@ -426,5 +554,10 @@ main (int argc, char **argv)
 		g_free (testpath);
 	}
 
+#ifdef HAVE_LIBICU
+	g_test_add_func ("/libtracker-fts/parser/ascii_fast_path",
+	                 test_ascii_fast_path);
+#endif
+
 	return g_test_run ();
 }
@@ -17,117 +17,103 @@
  * 02110-1301, USA.
  */
 
-#include <glib-object.h>
-#include <gobject/gvaluecollector.h>
+#include <gio/gio.h>
 
 #include "empty-gobject.h"
 #include "thumbnailer-mock.h"
 
 static GList *calls = NULL;
 
-void
-dbus_mock_call_log_reset ()
+static void
+dbus_mock_call_free (DBusMockCall *call)
 {
-	if (calls) {
-		g_list_foreach (calls, (GFunc)g_free, NULL);
-		g_list_free (calls);
-		calls = NULL;
+	g_free (call->method);
+
+	if (call->parameters) {
+		g_variant_unref (call->parameters);
 	}
+
+	g_slice_free (DBusMockCall, call);
+}
+
+void
+dbus_mock_call_log_reset (void)
+{
+	g_list_free_full (calls, (GDestroyNotify) dbus_mock_call_free);
+	calls = NULL;
 }
 
 GList *
-dbus_mock_call_log_get ()
+dbus_mock_call_log_get (void)
 {
 	return calls;
 }
 
-#if 0
-
 static void
-dbus_mock_call_log_append (const gchar *function_name)
+dbus_mock_call_log_append (const gchar *method,
+                           GVariant    *parameters)
 {
-	calls = g_list_append (calls, g_strdup (function_name));
-}
+	DBusMockCall *call;
 
+	call = g_slice_new0 (DBusMockCall);
+	call->method = g_strdup (method);
+	call->parameters = parameters ? g_variant_ref_sink (parameters) : NULL;
+
+	calls = g_list_append (calls, call);
+}
 
-/* Port to gdbus */
 /*
- * DBus overrides
+ * GDBus overrides, the thumbnailer is linked statically into the
+ * test, so these are picked instead of the GIO ones
  */
 
-DBusGConnection *
-dbus_g_bus_get (DBusBusType type, GError **error)
+GDBusConnection *
+g_bus_get_sync (GBusType       bus_type,
+                GCancellable  *cancellable,
+                GError       **error)
 {
-	return (DBusGConnection *) empty_object_new ();
+	return (GDBusConnection *) empty_object_new ();
 }
 
-DBusGProxy *
-dbus_g_proxy_new_for_name (DBusGConnection *connection,
-                           const gchar *service,
-                           const gchar *path,
-                           const gchar *interface )
+GDBusProxy *
+g_dbus_proxy_new_sync (GDBusConnection     *connection,
+                       GDBusProxyFlags      flags,
+                       GDBusInterfaceInfo  *info,
+                       const gchar         *name,
+                       const gchar         *object_path,
+                       const gchar         *interface_name,
+                       GCancellable        *cancellable,
+                       GError             **error)
 {
-	return (DBusGProxy *) empty_object_new ();
+	return (GDBusProxy *) empty_object_new ();
 }
 
-gboolean
-dbus_g_proxy_call (DBusGProxy *proxy,
-                   const gchar *function_name,
-                   GError  **error,
-                   GType first_arg_type, ...)
+GVariant *
+g_dbus_proxy_call_sync (GDBusProxy      *proxy,
+                        const gchar     *method_name,
+                        GVariant        *parameters,
+                        GDBusCallFlags   flags,
+                        gint             timeout_msec,
+                        GCancellable    *cancellable,
+                        GError         **error)
 {
-	va_list args;
-	GType arg_type;
-	const gchar *supported_mimes[] = { "mock/one", "mock/two", NULL};
-	int     counter;
-
-	g_assert (g_strcmp0 (function_name, "GetSupported") == 0);
-
-	/*
-	  G_TYPE_INVALID,
-	  G_TYPE_STRV, &uri_schemes,
-	  G_TYPE_STRV, &mime_types,
-	  G_TYPE_INVALID);
-
-	  Set the mock values in the second parameter :)
-	*/
-
-	va_start (args, first_arg_type);
-	arg_type = va_arg (args, GType);
-
-	counter = 1;
-	while (arg_type != G_TYPE_INVALID) {
-
-		if (arg_type == G_TYPE_STRV && counter == 2) {
-			gchar *local_error = NULL;
-			GValue value = { 0, };
-			g_value_init (&value, arg_type);
-			g_value_set_boxed (&value, supported_mimes);
-			G_VALUE_LCOPY (&value,
-			               args, 0,
-			               &local_error);
-			g_free (local_error);
-			g_value_unset (&value);
-		} else {
-			gpointer *out_param;
-			out_param = va_arg (args, gpointer *);
-		}
-		arg_type = va_arg (args, GType);
-		counter += 1;
-	}
+	const gchar *uri_schemes[] = { "file", "file", NULL };
+	const gchar *mime_types[] = { "mock/one", "mock/two", NULL };
 
-	va_end (args);
-	return TRUE;
-}
+	g_assert_cmpstr (method_name, ==, "GetSupported");
 
+	return g_variant_ref_sink (g_variant_new ("(^as^as)", uri_schemes, mime_types));
+}
 
 void
-dbus_g_proxy_call_no_reply (DBusGProxy        *proxy,
-                            const char        *method,
-                            GType              first_arg_type,
-                            ...)
+g_dbus_proxy_call (GDBusProxy          *proxy,
+                   const gchar         *method_name,
+                   GVariant            *parameters,
+                   GDBusCallFlags       flags,
+                   gint                 timeout_msec,
+                   GCancellable        *cancellable,
+                   GAsyncReadyCallback  callback,
+                   gpointer             user_data)
 {
-	dbus_mock_call_log_append (method);
+	dbus_mock_call_log_append (method_name, parameters);
 }
-#endif
-
@@ -24,6 +24,12 @@
 
 G_BEGIN_DECLS
 
+typedef struct {
+	gchar *method;
+	GVariant *parameters;
+} DBusMockCall;
+
+/* List of DBusMockCall, in the order the calls were made */
 void    dbus_mock_call_log_reset (void);
 GList * dbus_mock_call_log_get   (void);
 
@@ -19,114 +19,255 @@
 
 #include <glib.h>
 #include <glib-object.h>
-#include <libtracker-miner/tracker-miner.h>
+#include <libtracker-miner/tracker-thumbnailer.h>
 #include "thumbnailer-mock.h"
 
-#if 0
-/* port thumbnailer-mock.c to gdbus first */
+/* Checks the next logged D-Bus call, @parameters in GVariant text
+ * format, and returns the one after it */
+static GList *
+assert_call (GList       *l,
+             const gchar *method,
+             const gchar *parameters)
+{
+	DBusMockCall *call;
+	GVariant *expected;
+
+	g_assert (l != NULL);
+	call = l->data;
+
+	g_assert_cmpstr (call->method, ==, method);
+
+	expected = g_variant_new_parsed (parameters);
+	g_variant_ref_sink (expected);
+
+	if (!g_variant_equal (call->parameters, expected)) {
+		gchar *str = g_variant_print (call->parameters, FALSE);
+
+		g_error ("%s called with %s, expected %s", method, str, parameters);
+	}
+
+	g_variant_unref (expected);
+
+	return l->next;
+}
 
 static void
-test_thumbnailer_init ()
+test_thumbnailer_init (void)
 {
-        g_assert (tracker_thumbnailer_init ());
+	TrackerThumbnailer *thumbnailer;
+
+	thumbnailer = tracker_thumbnailer_new ();
+	g_assert (thumbnailer != NULL);
+
+	g_object_unref (thumbnailer);
+}
+
+static void
+test_thumbnailer_send_empty (void)
+{
+	TrackerThumbnailer *thumbnailer;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
+	tracker_thumbnailer_send (thumbnailer);
+
+	g_assert (dbus_mock_call_log_get () == NULL);
+
+	g_object_unref (thumbnailer);
+}
+
+static void
+test_thumbnailer_send_moves (void)
+{
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
+
+	/* Returns TRUE, but there is no dbus call */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (dbus_mock_call_log_get () == NULL);
+
+	/* Returns FALSE, unsupported mime */
+	g_assert (!tracker_thumbnailer_move_add (thumbnailer, "file:///c.jpeg", "unsupported", "file:///d.jpeg"));
+	g_assert (dbus_mock_call_log_get () == NULL);
 
-        tracker_thumbnailer_shutdown ();
+	tracker_thumbnailer_send (thumbnailer);
+
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Move", "(['file:///a.jpeg'], ['file:///b.jpeg'])");
+	g_assert (l == NULL);
+
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
 }
 
 static void
-test_thumbnailer_send_empty () 
+test_thumbnailer_send_removes (void)
 {
-        GList *dbus_calls = NULL;
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
 
-        dbus_mock_call_log_reset ();
+	/* Returns TRUE, but there is no dbus call */
+	g_assert (tracker_thumbnailer_remove_add (thumbnailer, "file:///a.jpeg", "mock/one"));
+	g_assert (dbus_mock_call_log_get () == NULL);
 
-        tracker_thumbnailer_init ();
-        tracker_thumbnailer_send ();
+	/* Returns FALSE, unsupported mime */
+	g_assert (!tracker_thumbnailer_remove_add (thumbnailer, "file:///b.jpeg", "unsupported"));
+	g_assert (dbus_mock_call_log_get () == NULL);
 
-        dbus_calls = dbus_mock_call_log_get ();
-        g_assert (dbus_calls == NULL);
+	tracker_thumbnailer_send (thumbnailer);
 
-        tracker_thumbnailer_shutdown ();
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Delete", "(['file:///a.jpeg'],)");
+	g_assert (l == NULL);
+
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
 }
 
 static void
-test_thumbnailer_send_moves ()
+test_thumbnailer_send_cleanup (void)
 {
-        GList *dbus_calls = NULL;
-        
-        dbus_mock_call_log_reset ();
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
 
-        tracker_thumbnailer_init ();
-        /* Returns TRUE, but there is no dbus call */
-        g_assert (tracker_thumbnailer_move_add ("file://a.jpeg", "mock/one", "file://b.jpeg"));
-        g_assert (dbus_mock_call_log_get () == NULL);
+	dbus_mock_call_log_reset ();
 
-        /* Returns FALSE, unsupported mime */
-        g_assert (!tracker_thumbnailer_move_add ("file://a.jpeg", "unsupported", "file://b.jpeg"));
-        g_assert (dbus_mock_call_log_get () == NULL);
+	thumbnailer = tracker_thumbnailer_new ();
 
-        tracker_thumbnailer_send ();
+	/* Returns TRUE, and there is a dbus call */
+	g_assert (tracker_thumbnailer_cleanup (thumbnailer, "file:///tri/lu/ri"));
 
-        /* One call to "move" method */
-        dbus_calls = dbus_mock_call_log_get ();
-        g_assert_cmpint (g_list_length (dbus_calls), ==, 1);
-        g_assert_cmpstr (dbus_calls->data, ==, "Move");
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Cleanup", "('file:///tri/lu/ri',)");
+	g_assert (l == NULL);
 
-        tracker_thumbnailer_shutdown ();
-        dbus_mock_call_log_reset ();
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
 }
 
 static void
-test_thumbnailer_send_removes ()
+test_thumbnailer_move_chain (void)
 {
-        GList *dbus_calls = NULL;
-        
-        dbus_mock_call_log_reset ();
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
 
+	/* Successive moves of a file are sent as a single one */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///b.jpeg", "mock/one", "file:///c.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///c.jpeg", "mock/one", "file:///d.jpeg"));
 
-        tracker_thumbnailer_init ();
+	tracker_thumbnailer_send (thumbnailer);
 
-        /* Returns TRUE, but there is no dbus call */
-        g_assert (tracker_thumbnailer_remove_add ("file://a.jpeg", "mock/one"));
-        g_assert (dbus_mock_call_log_get () == NULL);
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Move", "(['file:///a.jpeg'], ['file:///d.jpeg'])");
+	g_assert (l == NULL);
 
-        /* Returns FALSE, unsupported mime */
-        g_assert (!tracker_thumbnailer_remove_add ("file://a.jpeg", "unsupported"));
-        g_assert (dbus_mock_call_log_get () == NULL);
+	dbus_mock_call_log_reset ();
 
-        tracker_thumbnailer_send ();
+	/* Unless another file took the original place in between,
+	 * then both moves stay in order */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///c.jpeg", "mock/one", "file:///a.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///b.jpeg", "mock/one", "file:///d.jpeg"));
 
-        /* One call to "Delete" method */
-        dbus_calls = dbus_mock_call_log_get ();
-        g_assert_cmpint (g_list_length (dbus_calls), ==, 1);
-        g_assert_cmpstr (dbus_calls->data, ==, "Delete");
+	tracker_thumbnailer_send (thumbnailer);
 
-        tracker_thumbnailer_shutdown ();
-        dbus_mock_call_log_reset ();
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Move",
+	                 "(['file:///a.jpeg', 'file:///c.jpeg', 'file:///b.jpeg'],"
+	                 " ['file:///b.jpeg', 'file:///a.jpeg', 'file:///d.jpeg'])");
+	g_assert (l == NULL);
+
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
 }
 
 static void
-test_thumbnailer_send_cleanup ()
+test_thumbnailer_move_back (void)
 {
-        GList *dbus_calls = NULL;
-        
-        dbus_mock_call_log_reset ();
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
+
+	/* Moving a file back where it was cancels the queued move */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///b.jpeg", "mock/one", "file:///a.jpeg"));
 
-        tracker_thumbnailer_init ();
+	tracker_thumbnailer_send (thumbnailer);
 
-        /* Returns TRUE, and there is a dbus call */
-        g_assert (tracker_thumbnailer_cleanup ("file://tri/lu/ri"));
+	g_assert (dbus_mock_call_log_get () == NULL);
 
-        /* One call to "Clean" method */
-        dbus_calls = dbus_mock_call_log_get ();
-        g_assert_cmpint (g_list_length (dbus_calls), ==, 1);
-        g_assert_cmpstr (dbus_calls->data, ==, "Cleanup");
+	/* Other moves are still sent */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///c.jpeg", "mock/one", "file:///d.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///b.jpeg", "mock/one", "file:///a.jpeg"));
 
-        tracker_thumbnailer_shutdown ();
-        dbus_mock_call_log_reset ();
+	tracker_thumbnailer_send (thumbnailer);
+
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Move", "(['file:///c.jpeg'], ['file:///d.jpeg'])");
+	g_assert (l == NULL);
+
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
 }
 
-#endif
+static void
+test_thumbnailer_remove_after_move (void)
+{
+	TrackerThumbnailer *thumbnailer;
+	GList *l;
+
+	dbus_mock_call_log_reset ();
+
+	thumbnailer = tracker_thumbnailer_new ();
+
+	/* The move was never sent, so the thumbnail to delete is
+	 * still the one of the original location */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///b.jpeg", "mock/one", "file:///c.jpeg"));
+	g_assert (tracker_thumbnailer_remove_add (thumbnailer, "file:///c.jpeg", "mock/one"));
+
+	tracker_thumbnailer_send (thumbnailer);
+
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Delete", "(['file:///a.jpeg'],)");
+	g_assert (l == NULL);
+
+	dbus_mock_call_log_reset ();
+
+	/* Also when another file was moved there in between, the
+	 * delete is sent before that move */
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///a.jpeg", "mock/one", "file:///b.jpeg"));
+	g_assert (tracker_thumbnailer_move_add (thumbnailer, "file:///c.jpeg", "mock/one", "file:///a.jpeg"));
+	g_assert (tracker_thumbnailer_remove_add (thumbnailer, "file:///b.jpeg", "mock/one"));
+
+	tracker_thumbnailer_send (thumbnailer);
+
+	l = dbus_mock_call_log_get ();
+	l = assert_call (l, "Delete", "(['file:///a.jpeg'],)");
+	l = assert_call (l, "Move", "(['file:///c.jpeg'], ['file:///a.jpeg'])");
+	g_assert (l == NULL);
+
+	g_object_unref (thumbnailer);
+	dbus_mock_call_log_reset ();
+}
 
 int
 main (int    argc,
@@ -136,21 +277,22 @@ main (int    argc,
 
 	g_test_message ("Testing thumbnailer");
 
-#if 0
-/* port thumbnailer-mock.c to gdbus first */
-
 	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/init",
 	                 test_thumbnailer_init);
 	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/send_empty",
 	                 test_thumbnailer_send_empty);
-        g_test_add_func ("/libtracker-minter/tracker-thumbnailer/send_moves",
-                         test_thumbnailer_send_moves);
-        g_test_add_func ("/libtracker-minter/tracker-thumbnailer/send_removes",
-                         test_thumbnailer_send_removes);
-        g_test_add_func ("/libtracker-minter/tracker-thumbnailer/send_cleanup",
-                         test_thumbnailer_send_cleanup);
-
-#endif
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/send_moves",
+	                 test_thumbnailer_send_moves);
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/send_removes",
+	                 test_thumbnailer_send_removes);
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/send_cleanup",
+	                 test_thumbnailer_send_cleanup);
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/move_chain",
+	                 test_thumbnailer_move_chain);
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/move_back",
+	                 test_thumbnailer_move_back);
+	g_test_add_func ("/libtracker-miner/tracker-thumbnailer/remove_after_move",
+	                 test_thumbnailer_remove_after_move);
 
 	return g_test_run ();
 }
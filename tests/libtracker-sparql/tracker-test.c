@@ -121,6 +121,31 @@ test_tracker_sparql_escape_uri_vprintf (void)
 	g_free (result);
 }
 
+static void
+test_tracker_sparql_statement_buffer_to_sparql (void)
+{
+	TrackerSparqlStatementBuffer *buffer;
+	gchar *result;
+
+	buffer = tracker_sparql_statement_buffer_new ();
+
+	result = tracker_sparql_statement_buffer_to_sparql (buffer);
+	g_assert_cmpstr (result, ==, "INSERT { }");
+	g_free (result);
+
+	tracker_sparql_statement_buffer_insert_iri (buffer, NULL, "urn:a", "urn:p", "urn:o");
+	tracker_sparql_statement_buffer_insert_string (buffer, "urn:g", "urn:a", "urn:q", "a \"b\"");
+	g_assert_cmpint (tracker_sparql_statement_buffer_get_length (buffer), ==, 2);
+
+	result = tracker_sparql_statement_buffer_to_sparql (buffer);
+	g_assert_cmpstr (result, ==,
+	                 "INSERT { <urn:a> <urn:p> <urn:o> ."
+	                 " GRAPH <urn:g> { <urn:a> <urn:q> \"a \\\"b\\\"\" . } }");
+	g_free (result);
+
+	g_object_unref (buffer);
+}
+
 #if HAVE_TRACKER_FTS
 
 static void test_tracker_sparql_cursor_next_async_query (gint query);
@@ -414,6 +439,8 @@ main (gint argc, gchar **argv)
 	                 test_tracker_sparql_escape_string);
 	g_test_add_func ("/libtracker-sparql/tracker/tracker_sparql_escape_uri_vprintf",
 	                 test_tracker_sparql_escape_uri_vprintf);
+	g_test_add_func ("/libtracker-sparql/tracker/tracker_sparql_statement_buffer_to_sparql",
+	                 test_tracker_sparql_statement_buffer_to_sparql);
 	g_test_add_func ("/libtracker-sparql/tracker/tracker_sparql_connection_interleaved",
 	                 test_tracker_sparql_connection_interleaved);
 	g_test_add_func ("/libtracker-sparql/tracker/tracker_sparql_connection_locking_sync",